@@ -0,0 +1,280 @@
+// Copyright (c) 2010-2020, Lawrence Livermore National Security, LLC. Produced
+// at the Lawrence Livermore National Laboratory. All Rights reserved. See files
+// LICENSE and NOTICE for details. LLNL-CODE-806117.
+//
+// This file is part of the MFEM library. For more information and source code
+// availability visit https://mfem.org.
+//
+// MFEM is free software; you can redistribute it and/or modify it under the
+// terms of the BSD-3 license. We welcome feedback and contributions, see file
+// CONTRIBUTING.md for details.
+
+#include "auxiliary.hpp"
+
+namespace mfem
+{
+
+/// Chebyshev smoother of an assembled BilinearForm, constrained on ess_bdr.
+class MatrixFreeAuxiliarySpace::FormChebyshevSmoother : public Solver
+{
+private:
+   Array<int> ess_tdof_list;
+   Vector diag;
+   OperatorHandle op;
+   OperatorChebyshevSmoother *cheb;
+
+public:
+   FormChebyshevSmoother(BilinearForm &form, const Array<int> &ess_bdr,
+                         int order)
+   {
+      FiniteElementSpace &fes = *form.FESpace();
+      if (ess_bdr.Size())
+      {
+         fes.GetEssentialTrueDofs(ess_bdr, ess_tdof_list);
+      }
+      height = width = fes.GetTrueVSize();
+      diag.SetSize(height);
+      form.AssembleDiagonal(diag);
+      form.FormSystemMatrix(ess_tdof_list, op);
+      cheb = new OperatorChebyshevSmoother(op.Ptr(), diag, ess_tdof_list,
+                                           order);
+   }
+
+   virtual void SetOperator(const Operator &) { }
+
+   virtual void Mult(const Vector &x, Vector &y) const { cheb->Mult(x, y); }
+
+   virtual ~FormChebyshevSmoother() { delete cheb; }
+};
+
+/// Apply a (scalar) solver to each component of a vector ordered byNODES.
+class MatrixFreeAuxiliarySpace::ComponentSolver : public Solver
+{
+private:
+   Solver *solver;
+   const int vdim;
+   mutable Vector xc, yc;
+
+public:
+   ComponentSolver(Solver *solver_, int vdim_)
+      : Solver(vdim_*solver_->Height()), solver(solver_), vdim(vdim_) { }
+
+   virtual void SetOperator(const Operator &) { }
+
+   virtual void Mult(const Vector &x, Vector &y) const
+   {
+      const int n = solver->Height();
+      for (int c = 0; c < vdim; c++)
+      {
+         xc.MakeRef(const_cast<Vector&>(x), c*n, n);
+         yc.MakeRef(y, c*n, n);
+         solver->Mult(xc, yc);
+      }
+   }
+
+   virtual ~ComponentSolver() { delete solver; }
+};
+
+MatrixFreeAuxiliarySpace::MatrixFreeAuxiliarySpace(BilinearForm &a,
+                                                   const Array<int> &ess_bdr_,
+                                                   int cheb_order_)
+   : Solver(a.FESpace()->GetTrueVSize()), cheb_order(cheb_order_)
+{
+   FiniteElementSpace &fes = *a.FESpace();
+   MFEM_VERIFY(a.GetAssemblyLevel() == AssemblyLevel::PARTIAL,
+               "the form must use AssemblyLevel::PARTIAL");
+   MFEM_VERIFY(fes.Conforming(), "only conforming meshes are supported");
+   MFEM_VERIFY(fes.GetVDim() == 1, "vector dimension > 1 is not supported");
+
+   ess_bdr_.Copy(ess_bdr);
+   if (ess_bdr.Size())
+   {
+      fes.GetEssentialTrueDofs(ess_bdr, ess_tdof_list);
+   }
+   diag.SetSize(height);
+   a.AssembleDiagonal(diag);
+   a.FormSystemMatrix(ess_tdof_list, A);
+   smoother = new OperatorChebyshevSmoother(A.Ptr(), diag, ess_tdof_list,
+                                            cheb_order);
+}
+
+BilinearForm *MatrixFreeAuxiliarySpace::NewAuxiliaryForm(
+   FiniteElementSpace *fes)
+{
+   BilinearForm *form = new BilinearForm(fes);
+   form->SetAssemblyLevel(AssemblyLevel::PARTIAL);
+   aux_forms.Append(form);
+   return form;
+}
+
+Solver *MatrixFreeAuxiliarySpace::NewChebyshevSolver(BilinearForm &form,
+                                                     int vdim)
+{
+   Solver *cheb = new FormChebyshevSmoother(form, ess_bdr, cheb_order);
+   if (vdim == 1) { return cheb; }
+   return new ComponentSolver(cheb, vdim);
+}
+
+SparseMatrix *MatrixFreeAuxiliarySpace::AssembleInterpolation(
+   FiniteElementSpace &domain, FiniteElementSpace &range,
+   DiscreteInterpolator *di) const
+{
+   DiscreteLinearOperator interp(&domain, &range);
+   interp.AddDomainInterpolator(di);
+   interp.Assemble();
+   interp.Finalize();
+   SparseMatrix *P_ = interp.LoseMat();
+   if (ess_bdr.Size() == 0) { return P_; }
+
+   Array<int> ess_rows, ess_cols;
+   range.GetEssentialTrueDofs(ess_bdr, ess_rows);
+   domain.GetEssentialTrueDofs(ess_bdr, ess_cols);
+   Array<bool> row_marker(P_->Height()), col_marker(P_->Width());
+   row_marker = false;
+   col_marker = false;
+   for (int i = 0; i < ess_rows.Size(); i++) { row_marker[ess_rows[i]] = true; }
+   for (int i = 0; i < ess_cols.Size(); i++) { col_marker[ess_cols[i]] = true; }
+
+   const int *I = P_->HostReadI(), *J = P_->HostReadJ();
+   double *data = P_->HostReadWriteData();
+   for (int i = 0; i < P_->Height(); i++)
+   {
+      for (int k = I[i]; k < I[i+1]; k++)
+      {
+         if (row_marker[i] || col_marker[J[k]]) { data[k] = 0.0; }
+      }
+   }
+   return P_;
+}
+
+void MatrixFreeAuxiliarySpace::AddAuxiliarySpace(SparseMatrix *P_,
+                                                 Solver *C_)
+{
+   MFEM_VERIFY(P_->Height() == height && P_->Width() == C_->Height(),
+               "incompatible auxiliary space");
+   P.Append(P_);
+   C.Append(C_);
+}
+
+void MatrixFreeAuxiliarySpace::Correct(int k, const Vector &x,
+                                       Vector &y) const
+{
+   A->Mult(y, r);
+   subtract(x, r, r);
+   Pr.SetSize(P[k]->Width());
+   Pz.SetSize(P[k]->Width());
+   P[k]->MultTranspose(r, Pr);
+   C[k]->Mult(Pr, Pz);
+   P[k]->AddMult(Pz, y);
+}
+
+void MatrixFreeAuxiliarySpace::Mult(const Vector &x, Vector &y) const
+{
+   r.SetSize(height);
+   z.SetSize(height);
+
+   smoother->Mult(x, y);
+   const int n = P.Size();
+   for (int k = 0; k < n; k++) { Correct(k, x, y); }
+   for (int k = n - 2; k >= 0; k--) { Correct(k, x, y); }
+   A->Mult(y, r);
+   subtract(x, r, r);
+   smoother->Mult(r, z);
+   y += z;
+}
+
+MatrixFreeAuxiliarySpace::~MatrixFreeAuxiliarySpace()
+{
+   delete smoother;
+   for (int k = 0; k < C.Size(); k++) { delete C[k]; }
+   for (int k = 0; k < P.Size(); k++) { delete P[k]; }
+   for (int k = 0; k < aux_forms.Size(); k++) { delete aux_forms[k]; }
+   for (int k = 0; k < aux_fes.Size(); k++) { delete aux_fes[k]; }
+   for (int k = 0; k < aux_fec.Size(); k++) { delete aux_fec[k]; }
+}
+
+MatrixFreeAMS::MatrixFreeAMS(BilinearForm &a, const Array<int> &ess_bdr_,
+                             Coefficient &alpha, Coefficient *beta,
+                             int cheb_order_)
+   : MatrixFreeAuxiliarySpace(a, ess_bdr_, cheb_order_)
+{
+   FiniteElementSpace &fes = *a.FESpace();
+   MFEM_VERIFY(dynamic_cast<const ND_FECollection*>(fes.FEColl()),
+               "MatrixFreeAMS requires a Nedelec space");
+   Mesh *mesh = fes.GetMesh();
+   const int dim = mesh->Dimension();
+   const int order = fes.GetFE(0)->GetOrder();
+
+   FiniteElementCollection *h1_fec = new H1_FECollection(order, dim);
+   FiniteElementSpace *h1_fes = new FiniteElementSpace(mesh, h1_fec);
+   FiniteElementSpace *vh1_fes = new FiniteElementSpace(mesh, h1_fec, dim);
+   aux_fec.Append(h1_fec);
+   aux_fes.Append(h1_fes);
+   aux_fes.Append(vh1_fes);
+
+   // The gradients are in the kernel of the curl, so the gradient correction
+   // only sees the (beta u, v) term.
+   if (beta)
+   {
+      BilinearForm *grad_form = NewAuxiliaryForm(h1_fes);
+      grad_form->AddDomainIntegrator(new DiffusionIntegrator(*beta));
+      grad_form->Assemble();
+      AddAuxiliarySpace(AssembleInterpolation(*h1_fes, fes,
+                                              new GradientInterpolator),
+                        NewChebyshevSolver(*grad_form));
+   }
+
+   BilinearForm *pi_form = NewAuxiliaryForm(h1_fes);
+   pi_form->AddDomainIntegrator(new DiffusionIntegrator(alpha));
+   if (beta) { pi_form->AddDomainIntegrator(new MassIntegrator(*beta)); }
+   pi_form->Assemble();
+   AddAuxiliarySpace(AssembleInterpolation(*vh1_fes, fes,
+                                           new IdentityInterpolator),
+                     NewChebyshevSolver(*pi_form, dim));
+}
+
+MatrixFreeADS::MatrixFreeADS(BilinearForm &a, const Array<int> &ess_bdr_,
+                             Coefficient &alpha, Coefficient &beta,
+                             int cheb_order_)
+   : MatrixFreeAuxiliarySpace(a, ess_bdr_, cheb_order_)
+{
+   FiniteElementSpace &fes = *a.FESpace();
+   MFEM_VERIFY(dynamic_cast<const RT_FECollection*>(fes.FEColl()),
+               "MatrixFreeADS requires a Raviart-Thomas space");
+   Mesh *mesh = fes.GetMesh();
+   const int dim = mesh->Dimension();
+   MFEM_VERIFY(dim == 3, "MatrixFreeADS requires a 3D mesh");
+   const int order = fes.GetFE(0)->GetOrder();
+
+   FiniteElementCollection *nd_fec = new ND_FECollection(order, dim);
+   FiniteElementCollection *h1_fec = new H1_FECollection(order, dim);
+   FiniteElementSpace *nd_fes = new FiniteElementSpace(mesh, nd_fec);
+   FiniteElementSpace *h1_fes = new FiniteElementSpace(mesh, h1_fec);
+   FiniteElementSpace *vh1_fes = new FiniteElementSpace(mesh, h1_fec, dim);
+   aux_fec.Append(nd_fec);
+   aux_fec.Append(h1_fec);
+   aux_fes.Append(nd_fes);
+   aux_fes.Append(h1_fes);
+   aux_fes.Append(vh1_fes);
+
+   // The curls are in the kernel of the divergence, so the curl correction
+   // only sees the (beta u, v) term. Its auxiliary problem is a curl-curl
+   // problem, preconditioned in turn with MatrixFreeAMS.
+   BilinearForm *curl_form = NewAuxiliaryForm(nd_fes);
+   curl_form->AddDomainIntegrator(new CurlCurlIntegrator(beta));
+   curl_form->Assemble();
+   AddAuxiliarySpace(AssembleInterpolation(*nd_fes, fes,
+                                           new CurlInterpolator),
+                     new MatrixFreeAMS(*curl_form, ess_bdr, beta, NULL,
+                                       cheb_order));
+
+   BilinearForm *pi_form = NewAuxiliaryForm(h1_fes);
+   pi_form->AddDomainIntegrator(new DiffusionIntegrator(alpha));
+   pi_form->AddDomainIntegrator(new MassIntegrator(beta));
+   pi_form->Assemble();
+   AddAuxiliarySpace(AssembleInterpolation(*vh1_fes, fes,
+                                           new IdentityInterpolator),
+                     NewChebyshevSolver(*pi_form, dim));
+}
+
+} // namespace mfem
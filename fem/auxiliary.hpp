@@ -0,0 +1,164 @@
+// Copyright (c) 2010-2020, Lawrence Livermore National Security, LLC. Produced
+// at the Lawrence Livermore National Laboratory. All Rights reserved. See files
+// LICENSE and NOTICE for details. LLNL-CODE-806117.
+//
+// This file is part of the MFEM library. For more information and source code
+// availability visit https://mfem.org.
+//
+// MFEM is free software; you can redistribute it and/or modify it under the
+// terms of the BSD-3 license. We welcome feedback and contributions, see file
+// CONTRIBUTING.md for details.
+
+#ifndef MFEM_AUXILIARY
+#define MFEM_AUXILIARY
+
+#include "../config/config.hpp"
+#include "bilinearform.hpp"
+#include "../linalg/solvers.hpp"
+
+namespace mfem
+{
+
+/** @brief Base class for the matrix-free auxiliary space preconditioners
+    MatrixFreeAMS and MatrixFreeADS.
+
+    The preconditioner of the operator A of a BilinearForm is the symmetric
+    multiplicative cycle
+
+        S, B_0, B_1, ..., B_{n-1}, ..., B_1, B_0, S,
+
+    where S is an OperatorChebyshevSmoother of A, based on the diagonal
+    computed by BilinearForm::AssembleDiagonal(), and B_k is the auxiliary
+    space correction y += P_k C_k P_k^t (x - A y). The interpolation P_k maps
+    the true dofs of an auxiliary (e.g. H1) space to the true dofs of the space
+    of A, and C_k is an approximate inverse of the auxiliary operator, by
+    default a Chebyshev smoother of a partially assembled BilinearForm on the
+    auxiliary space.
+
+    With partial assembly, no matrix of the high-order operators is formed;
+    only the (sparse) interpolation matrices P_k are assembled. The
+    preconditioner is symmetric and can be used with PCG. It is currently
+    supported in serial, on conforming meshes. */
+class MatrixFreeAuxiliarySpace : public Solver
+{
+protected:
+   class FormChebyshevSmoother;
+   class ComponentSolver;
+
+   const int cheb_order;
+   Array<int> ess_bdr;
+   Array<int> ess_tdof_list;
+   OperatorHandle A;
+   Vector diag;
+   OperatorChebyshevSmoother *smoother;
+
+   /// Interpolations P_k and auxiliary solvers C_k, both owned.
+   Array<SparseMatrix*> P;
+   Array<Solver*> C;
+
+   /// Auxiliary collections, spaces and forms, all owned.
+   Array<FiniteElementCollection*> aux_fec;
+   Array<FiniteElementSpace*> aux_fes;
+   Array<BilinearForm*> aux_forms;
+
+   mutable Vector r, z, Pr, Pz;
+
+   /** @brief Set up the smoother of the assembled BilinearForm @a a, with
+       essential boundary attributes @a ess_bdr_. */
+   /** The system operator is formed with BilinearForm::FormSystemMatrix(), so
+       @a a should use a matrix-free assembly level. */
+   MatrixFreeAuxiliarySpace(BilinearForm &a, const Array<int> &ess_bdr_,
+                            int cheb_order_);
+
+   /** @brief Create (and own) a BilinearForm on the auxiliary space @a fes,
+       using AssemblyLevel::PARTIAL. */
+   BilinearForm *NewAuxiliaryForm(FiniteElementSpace *fes);
+
+   /** @brief Create a Chebyshev smoother of the assembled auxiliary form
+       @a form, see NewAuxiliaryForm(), with the essential boundary of the
+       preconditioner. If @a vdim > 1, the smoother is applied to each of the
+       @a vdim components of a vector ordered byNODES. */
+   Solver *NewChebyshevSolver(BilinearForm &form, int vdim = 1);
+
+   /** @brief Assemble the interpolation from the true dofs of @a domain to
+       the true dofs of @a range defined by @a di (owned). */
+   /** The rows of the essential true dofs of @a range and the columns of the
+       essential true dofs of @a domain are set to zero, so that the
+       corrections do not change the essential dofs. */
+   SparseMatrix *AssembleInterpolation(FiniteElementSpace &domain,
+                                       FiniteElementSpace &range,
+                                       DiscreteInterpolator *di) const;
+
+   /** @brief Add the auxiliary space correction with interpolation @a P_ and
+       solver @a C_, both owned. The corrections are applied in the order in
+       which they were added, and then in reverse order. */
+   void AddAuxiliarySpace(SparseMatrix *P_, Solver *C_);
+
+   /// Apply the correction @a k: y += P_k C_k P_k^t (x - A y).
+   void Correct(int k, const Vector &x, Vector &y) const;
+
+public:
+   /// Apply the preconditioner with a zero initial guess.
+   virtual void Mult(const Vector &x, Vector &y) const;
+
+   /// The operator is fixed at construction; only the size is checked.
+   virtual void SetOperator(const Operator &op)
+   {
+      MFEM_VERIFY(op.Height() == height && op.Width() == width,
+                  "incompatible operator size");
+   }
+
+   /// Return the system operator of the form, constrained on the boundary.
+   const Operator &GetOperator() const { return *A.Ptr(); }
+
+   /// Return the number of auxiliary space corrections.
+   int NumAuxiliarySpaces() const { return P.Size(); }
+
+   virtual ~MatrixFreeAuxiliarySpace();
+};
+
+/** @brief Matrix-free auxiliary space Maxwell solver (AMS) for the H(curl)
+    problem (alpha curl u, curl v) + (beta u, v).
+
+    The form @a a on a Nedelec space of order p, on quadrilaterals or
+    hexahedra, is typically partially assembled with CurlCurlIntegrator and
+    VectorFEMassIntegrator. The corrections are:
+    - the gradient correction through the discrete gradient from H1 of order
+      p, with auxiliary operator (beta grad u, grad v), used when @a beta is
+      given;
+    - the vector nodal correction through the interpolation of (H1)^dim of
+      order p, with auxiliary operator (alpha grad u, grad v) + (beta u, v)
+      applied component-wise.
+
+    The coefficients are not owned and must outlive the preconditioner. */
+class MatrixFreeAMS : public MatrixFreeAuxiliarySpace
+{
+public:
+   MatrixFreeAMS(BilinearForm &a, const Array<int> &ess_bdr,
+                 Coefficient &alpha, Coefficient *beta, int cheb_order = 2);
+};
+
+/** @brief Matrix-free auxiliary space divergence solver (ADS) for the H(div)
+    problem (alpha div u, div v) + (beta u, v) in 3D.
+
+    The form @a a on a Raviart-Thomas space of order p, on hexahedra, is
+    typically partially assembled with DivDivIntegrator and
+    VectorFEMassIntegrator. The corrections are:
+    - the curl correction through the discrete curl from the Nedelec space of
+      order p, with auxiliary operator (beta curl u, curl v) preconditioned
+      by MatrixFreeAMS;
+    - the vector nodal correction through the interpolation of (H1)^3 of
+      order p, with auxiliary operator (alpha grad u, grad v) + (beta u, v)
+      applied component-wise.
+
+    The coefficients are not owned and must outlive the preconditioner. */
+class MatrixFreeADS : public MatrixFreeAuxiliarySpace
+{
+public:
+   MatrixFreeADS(BilinearForm &a, const Array<int> &ess_bdr,
+                 Coefficient &alpha, Coefficient &beta, int cheb_order = 2);
+};
+
+} // namespace mfem
+
+#endif
@@ -13,6 +13,7 @@
 
 #include "fem.hpp"
 #include "../general/device.hpp"
+#include "../general/forall.hpp"
 #include <cmath>
 
 namespace mfem
@@ -144,7 +145,8 @@ void BilinearForm::SetAssemblyLevel(AssemblyLevel assembly_level)
 void BilinearForm::EnableStaticCondensation()
 {
    delete static_cond;
-   if (assembly != AssemblyLevel::LEGACYFULL)
+   if (assembly != AssemblyLevel::LEGACYFULL &&
+       assembly != AssemblyLevel::ELEMENT)
    {
       static_cond = NULL;
       MFEM_WARNING("Static condensation not supported for this assembly level");
@@ -169,7 +171,8 @@ void BilinearForm::EnableHybridization(FiniteElementSpace *constr_space,
                                        const Array<int> &ess_tdof_list)
 {
    delete hybridization;
-   if (assembly != AssemblyLevel::LEGACYFULL)
+   if (assembly != AssemblyLevel::LEGACYFULL &&
+       assembly != AssemblyLevel::ELEMENT)
    {
       delete constr_integ;
       hybridization = NULL;
@@ -224,7 +227,7 @@ MatrixInverse * BilinearForm::Inverse() const
 
 void BilinearForm::Finalize (int skip_zeros)
 {
-   if (assembly == AssemblyLevel::LEGACYFULL)
+   if (assembly == AssemblyLevel::LEGACYFULL || static_cond || hybridization)
    {
       if (!static_cond) { mat->Finalize(skip_zeros); }
       if (mat_e) { mat_e->Finalize(skip_zeros); }
@@ -318,6 +321,66 @@ void BilinearForm::ComputeBdrElementMatrix(int i, DenseMatrix &elmat)
    }
 }
 
+void BilinearForm::AssembleElementMatricesEA(int skip_zeros)
+{
+   MFEM_VERIFY(bbfi.Size() == 0 && fbfi.Size() == 0 && bfbfi.Size() == 0,
+               "static condensation and hybridization with element assembly"
+               " support only domain integrators");
+   const int NE = fes->GetNE();
+   if (NE == 0) { return; }
+   const Vector &ea_data =
+      static_cast<EABilinearFormExtension*>(ext)->GetElementMatrices();
+   const FiniteElement &fe = *fes->GetFE(0);
+   const int nd = fe.GetDof();
+   MFEM_VERIFY(fes->GetVDim() == 1 && ea_data.Size() == NE*nd*nd,
+               "invalid element matrices");
+
+   // Map from the element restriction ordering of the element dofs to their
+   // native ordering, with signs
+   Array<int> dof_map(nd);
+   const TensorBasisElement *tfe =
+      dynamic_cast<const TensorBasisElement*>(&fe);
+   if (tfe && UsesTensorBasis(*fes) && tfe->GetDofMap().Size() > 0)
+   {
+      dof_map = tfe->GetDofMap();
+   }
+   else { for (int i = 0; i < nd; i++) { dof_map[i] = i; } }
+
+   DenseTensor elmats(nd, nd, NE);
+   auto MAP = dof_map.Read();
+   auto A_ea = Reshape(ea_data.Read(), nd, nd, NE);
+   auto A_el = Reshape(elmats.Write(), nd, nd, NE);
+   MFEM_FORALL(e, NE,
+   {
+      for (int j = 0; j < nd; j++)
+      {
+         const int s_j = MAP[j];
+         const int c = (s_j >= 0) ? s_j : -1-s_j;
+         for (int i = 0; i < nd; i++)
+         {
+            const int s_i = MAP[i];
+            const int r = (s_i >= 0) ? s_i : -1-s_i;
+            const double a_ij = A_ea(j,i,e); // row major
+            A_el(r,c,e) = ((s_i >= 0) == (s_j >= 0)) ? a_ij : -a_ij;
+         }
+      }
+   });
+
+   if (static_cond)
+   {
+      static_cond->AssembleMatrices(elmats);
+      return;
+   }
+   if (mat == NULL) { AllocMat(); }
+   elmats.HostRead();
+   for (int i = 0; i < NE; i++)
+   {
+      fes->GetElementVDofs(i, vdofs);
+      mat->AddSubMatrix(vdofs, vdofs, elmats(i), skip_zeros);
+      hybridization->AssembleMatrix(i, elmats(i));
+   }
+}
+
 void BilinearForm::AssembleElementMatrix(
    int i, const DenseMatrix &elmat, int skip_zeros)
 {
@@ -379,6 +442,10 @@ void BilinearForm::Assemble(int skip_zeros)
    if (ext)
    {
       ext->Assemble();
+      if (static_cond || hybridization)
+      {
+         AssembleElementMatricesEA(skip_zeros);
+      }
       return;
    }
 
@@ -648,7 +715,7 @@ void BilinearForm::FormLinearSystem(const Array<int> &ess_tdof_list, Vector &x,
                                     Vector &b, OperatorHandle &A, Vector &X,
                                     Vector &B, int copy_interior)
 {
-   if (ext)
+   if (ext && !static_cond && !hybridization)
    {
       ext->FormLinearSystem(ess_tdof_list, x, b, A, X, B, copy_interior);
       return;
@@ -716,7 +783,7 @@ void BilinearForm::FormLinearSystem(const Array<int> &ess_tdof_list, Vector &x,
 void BilinearForm::FormSystemMatrix(const Array<int> &ess_tdof_list,
                                     OperatorHandle &A)
 {
-   if (ext)
+   if (ext && !static_cond && !hybridization)
    {
       ext->FormSystemMatrix(ess_tdof_list, A);
       return;
@@ -759,7 +826,7 @@ void BilinearForm::FormSystemMatrix(const Array<int> &ess_tdof_list,
 void BilinearForm::RecoverFEMSolution(const Vector &X,
                                       const Vector &b, Vector &x)
 {
-   if (ext)
+   if (ext && !static_cond && !hybridization)
    {
       ext->RecoverFEMSolution(X, b, x);
       return;
@@ -114,6 +114,10 @@ protected:
 
    void ConformingAssemble();
 
+   /** Pass the element matrices computed with AssemblyLevel::ELEMENT to the
+       static condensation or the hybridization, see Assemble(). */
+   void AssembleElementMatricesEA(int skip_zeros);
+
    // may be used in the construction of derived classes
    BilinearForm() : Matrix (0)
    {
@@ -171,7 +175,10 @@ public:
    /** @brief Enable the use of static condensation. For details see the
        description for class StaticCondensation in fem/staticcond.hpp This method
        should be called before assembly. If the number of unknowns after static
-       condensation is not reduced, it is not enabled. */
+       condensation is not reduced, it is not enabled. Static condensation is
+       supported with AssemblyLevel::LEGACYFULL and AssemblyLevel::ELEMENT; in
+       the latter case, the element matrices of all elements are condensed as
+       a batch, see StaticCondensation::AssembleMatrices(). */
    void EnableStaticCondensation();
 
    /** @brief Check if static condensation was actually enabled by a previous
@@ -185,7 +192,8 @@ public:
    /// Enable hybridization.
    /** For details see the description for class
        Hybridization in fem/hybridization.hpp. This method should be called
-       before assembly. */
+       before assembly. Hybridization is supported with
+       AssemblyLevel::LEGACYFULL and AssemblyLevel::ELEMENT. */
    void EnableHybridization(FiniteElementSpace *constr_space,
                             BilinearFormIntegrator *constr_integ,
                             const Array<int> &ess_tdof_list);
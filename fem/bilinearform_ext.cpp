@@ -50,10 +50,17 @@ PABilinearFormExtension::PABilinearFormExtension(BilinearForm *form)
 
 void PABilinearFormExtension::SetupRestrictionOperators(const L2FaceValues m)
 {
-   ElementDofOrdering ordering = UsesTensorBasis(*a->FESpace())?
+   // On meshes with mixed element types, the lexicographic ordering applies
+   // only to the elements with a tensor basis, see ElementRestriction.
+   const Mesh &mesh = *trialFes->GetMesh();
+   const bool mixed = mesh.GetNumGeometries(mesh.Dimension()) > 1;
+   ElementDofOrdering ordering = (mixed || UsesTensorBasis(*a->FESpace())) ?
                                  ElementDofOrdering::LEXICOGRAPHIC:
                                  ElementDofOrdering::NATIVE;
-   elem_restrict = trialFes->GetElementRestriction(ordering);
+   // The integrators on NURBS spaces act patch-wise on L-vectors, see
+   // NURBSPatchPA, so no element restriction is used.
+   elem_restrict = trialFes->GetNURBSext() ? NULL :
+                   trialFes->GetElementRestriction(ordering);
    if (elem_restrict)
    {
       localX.SetSize(elem_restrict->Height(), Device::GetDeviceMemoryType());
@@ -91,8 +98,13 @@ void PABilinearFormExtension::Assemble()
 
    Array<BilinearFormIntegrator*> &integrators = *a->GetDBFI();
    const int integratorCount = integrators.Size();
+   const Mesh &mesh = *a->FESpace()->GetMesh();
+   const bool mixed = mesh.GetNumGeometries(mesh.Dimension()) > 1;
    for (int i = 0; i < integratorCount; ++i)
    {
+      MFEM_VERIFY(!mixed || integrators[i]->SupportsMixedMeshPA(),
+                  "this integrator does not support partial assembly on"
+                  " meshes with mixed element types");
       integrators[i]->AssemblePA(*a->FESpace());
    }
 
@@ -708,10 +720,25 @@ void FABilinearFormExtension::Assemble()
    {
       const ElementRestriction &rest =
          static_cast<const ElementRestriction&>(*elem_restrict);
-      rest.FillSparseMatrix(ea_data, mat);
+      // The sparsity pattern depends only on the mesh and the space, so it is
+      // computed once and only the entries are updated by new assemblies.
+      if (ea_map.Size() != ea_data.Size())
+      {
+         rest.FillSparsityPattern(mat, ea_map);
+      }
+      rest.FillData(ea_data, ea_map, mat);
    }
 }
 
+void FABilinearFormExtension::Update()
+{
+   ea_map.DeleteAll();
+   const int size = a->FESpace()->GetVSize();
+   SparseMatrix empty(size, size, 0);
+   mat.Swap(empty);
+   EABilinearFormExtension::Update();
+}
+
 void FABilinearFormExtension::Mult(const Vector &x, Vector &y) const
 {
    mat.Mult(x, y);
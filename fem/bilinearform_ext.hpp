@@ -111,6 +111,11 @@ public:
    void Assemble();
    void Mult(const Vector &x, Vector &y) const;
    void MultTranspose(const Vector &x, Vector &y) const;
+
+   /** @brief Return the element matrices of the domain integrators, stored
+       row major with the element dofs in the ordering of the element
+       restriction. */
+   const Vector &GetElementMatrices() const { return ea_data; }
 };
 
 /// Data and methods for fully-assembled bilinear forms
@@ -121,6 +126,10 @@ private:
    /// face_mat handles parallelism for DG face terms.
    SparseMatrix face_mat;
    bool use_face_mat;
+   /** Position in mat of the entries of the element matrices, computed with
+       the sparsity pattern and reused by the subsequent assemblies, see
+       ElementRestriction::FillSparsityPattern(). */
+   Array<int> ea_map;
 
 public:
    FABilinearFormExtension(BilinearForm *form);
@@ -128,6 +137,10 @@ public:
    void Assemble();
    void Mult(const Vector &x, Vector &y) const;
    void MultTranspose(const Vector &x, Vector &y) const;
+   void Update();
+
+   /// Return the assembled matrix on the local dofs (L-vectors).
+   SparseMatrix &GetMatrix() { return mat; }
 };
 
 /// Data and methods for matrix-free bilinear forms NOT YET IMPLEMENTED.
@@ -12,6 +12,7 @@
 // Implementation of Bilinear Form Integrators
 
 #include "fem.hpp"
+#include "../general/forall.hpp"
 #include <cmath>
 #include <algorithm>
 
@@ -20,6 +21,95 @@ using namespace std;
 namespace mfem
 {
 
+void PAGeometryBatch::MakeBatches(const FiniteElementSpace &fes,
+                                  Array<PAGeometryBatch*> &batches)
+{
+   DeleteBatches(batches);
+   const Mesh &mesh = *fes.GetMesh();
+   Array<Geometry::Type> geoms;
+   mesh.GetGeometries(mesh.Dimension(), geoms);
+   int offset = 0;
+   for (int g = 0; g < geoms.Size(); g++)
+   {
+      PAGeometryBatch *batch = new PAGeometryBatch;
+      batch->geom = geoms[g];
+      for (int e = 0; e < mesh.GetNE(); e++)
+      {
+         if (mesh.GetElementBaseGeometry(e) == geoms[g])
+         {
+            batch->elements.Append(e);
+         }
+      }
+      batch->offset = offset;
+      batch->ndof = fes.GetFE(batch->elements[0])->GetDof();
+      batch->ir = NULL;
+      batch->maps = NULL;
+      offset += fes.GetVDim()*batch->ndof*batch->elements.Size();
+      batches.Append(batch);
+   }
+}
+
+void PAGeometryBatch::DeleteBatches(Array<PAGeometryBatch*> &batches)
+{
+   for (int i = 0; i < batches.Size(); i++) { delete batches[i]; }
+   batches.SetSize(0);
+}
+
+void PAGeometryBatch::GetJacobians(Mesh &mesh, Vector &J) const
+{
+   const int NE = elements.Size();
+   const int NQ = ir->GetNPoints();
+   const int dim = mesh.Dimension();
+   const int sdim = mesh.SpaceDimension();
+   J.SetSize(NQ*sdim*dim*NE);
+   auto d_J = Reshape(J.HostWrite(), NQ, sdim, dim, NE);
+   for (int e = 0; e < NE; e++)
+   {
+      ElementTransformation &T = *mesh.GetElementTransformation(elements[e]);
+      for (int q = 0; q < NQ; q++)
+      {
+         T.SetIntPoint(&ir->IntPoint(q));
+         const DenseMatrix &Jq = T.Jacobian();
+         for (int j = 0; j < dim; j++)
+         {
+            for (int i = 0; i < sdim; i++) { d_J(q,i,j,e) = Jq(i,j); }
+         }
+      }
+   }
+}
+
+void PAGeometryBatch::EvalCoefficient(Mesh &mesh, Coefficient *Q,
+                                      Vector &coeff) const
+{
+   if (Q == NULL)
+   {
+      coeff.SetSize(1);
+      coeff(0) = 1.0;
+      return;
+   }
+   if (ConstantCoefficient *cQ = dynamic_cast<ConstantCoefficient*>(Q))
+   {
+      coeff.SetSize(1);
+      coeff(0) = cQ->constant;
+      return;
+   }
+   MFEM_VERIFY(dynamic_cast<QuadratureFunctionCoefficient*>(Q) == NULL,
+               "QuadratureFunction coefficients are not supported on meshes"
+               " with mixed element types");
+   const int NE = elements.Size();
+   const int NQ = ir->GetNPoints();
+   coeff.SetSize(NQ*NE);
+   auto C = Reshape(coeff.HostWrite(), NQ, NE);
+   for (int e = 0; e < NE; e++)
+   {
+      ElementTransformation &T = *mesh.GetElementTransformation(elements[e]);
+      for (int q = 0; q < NQ; q++)
+      {
+         C(q,e) = Q->Eval(T, ir->IntPoint(q));
+      }
+   }
+}
+
 void BilinearFormIntegrator::AssemblePA(const FiniteElementSpace&)
 {
    mfem_error ("BilinearFormIntegrator::AssemblePA(...)\n"
@@ -93,6 +183,14 @@ void BilinearFormIntegrator::AddMultTransposePA(const Vector &, Vector &) const
                "   is not implemented for this class.");
 }
 
+void BilinearFormIntegrator::AddMultComplexPA(const BilinearFormIntegrator &,
+                                              const Vector &, const Vector &,
+                                              Vector &, Vector &) const
+{
+   mfem_error ("BilinearFormIntegrator::AddMultComplexPA(...)\n"
+               "   is not implemented for this class.");
+}
+
 void BilinearFormIntegrator::AssembleElementMatrix (
    const FiniteElement &el, ElementTransformation &Trans,
    DenseMatrix &elmat )
@@ -15,11 +15,46 @@
 #include "../config/config.hpp"
 #include "nonlininteg.hpp"
 #include "fespace.hpp"
+#include "nurbs_pa.hpp"
 #include "libceed/ceed.hpp"
 
 namespace mfem
 {
 
+/// The elements of one geometry type of a mesh with mixed element types.
+/** On such meshes the E-vectors are ordered by geometry, see
+    ElementRestriction. The integrators supporting them, see
+    BilinearFormIntegrator::SupportsMixedMeshPA(), keep the partial assembly
+    data of each batch separately and apply it with the kernels of its element
+    type, one launch per batch. */
+class PAGeometryBatch
+{
+public:
+   Geometry::Type geom;
+   Array<int> elements;       ///< The mesh elements, in E-vector order
+   int offset;                ///< Offset of the first element in the E-vector
+   int ndof;                  ///< Number of scalar dofs per element
+   const IntegrationRule *ir; ///< Not owned
+   const DofToQuad *maps;     ///< Not owned
+   Vector pa_data;
+
+   /** @brief Split the elements of @a fes into one batch per geometry, in the
+       order of the E-vectors of its ElementRestriction. */
+   static void MakeBatches(const FiniteElementSpace &fes,
+                           Array<PAGeometryBatch*> &batches);
+
+   /// Delete the batches and set the size of @a batches to zero.
+   static void DeleteBatches(Array<PAGeometryBatch*> &batches);
+
+   /** @brief Compute the Jacobians of the elements at the points of #ir, with
+       the layout (NQ, sdim, dim, NE) of GeometricFactors::J. */
+   void GetJacobians(Mesh &mesh, Vector &J) const;
+
+   /** @brief Evaluate @a Q at the points of #ir, with the layout (NQ, NE).
+       A NULL or constant coefficient gives a Vector of size 1. */
+   void EvalCoefficient(Mesh &mesh, Coefficient *Q, Vector &coeff) const;
+};
+
 /// Abstract base class BilinearFormIntegrator
 class BilinearFormIntegrator : public NonlinearFormIntegrator
 {
@@ -50,6 +85,10 @@ public:
    virtual void AssemblePA(const FiniteElementSpace &trial_fes,
                            const FiniteElementSpace &test_fes);
 
+   /** @brief Return true if AssemblePA() supports meshes with mixed element
+       types, see PAGeometryBatch. */
+   virtual bool SupportsMixedMeshPA() const { return false; }
+
    virtual void AssemblePAInteriorFaces(const FiniteElementSpace &fes);
 
    virtual void AssemblePABoundaryFaces(const FiniteElementSpace &fes);
@@ -78,6 +117,21 @@ public:
        called. */
    virtual void AddMultTransposePA(const Vector &x, Vector &y) const;
 
+   /** @brief Return true if AddMultComplexPA() supports this integrator as the
+       real part and @a imag as the imaginary part of a complex operator. */
+   virtual bool SupportsComplexPA(const BilinearFormIntegrator &imag) const
+   { return false; }
+
+   /// Method for the fused partially assembled action of a complex operator.
+   /** With A_r the action of this integrator and A_i the one of @a imag, both
+       assembled with AssemblePA() on the same space, add A_r x_r - A_i x_i to
+       @a y_r and A_r x_i + A_i x_r to @a y_i, in one pass over the elements
+       which reads both coefficients. All vectors are E-vectors. See
+       SupportsComplexPA() and PAComplexOperator. */
+   virtual void AddMultComplexPA(const BilinearFormIntegrator &imag,
+                                 const Vector &x_r, const Vector &x_i,
+                                 Vector &y_r, Vector &y_i) const;
+
    /// Method defining element assembly.
    /** The result of the element assembly is added and stored in the @a emat
        Vector. */
@@ -1865,6 +1919,11 @@ private:
    const GeometricFactors *geom;  ///< Not owned
    int dim, ne, dofs1D, quad1D;
    Vector pa_data;
+   // Patch-wise PA on NURBS spaces
+   NURBSPatchPA *patch_pa;
+   int patch_q1d;
+   // PA on meshes with mixed element types
+   Array<PAGeometryBatch*> batches;
 
 #ifdef MFEM_USE_CEED
    // CEED extension
@@ -1879,6 +1938,8 @@ public:
       MQ = NULL;
       maps = NULL;
       geom = NULL;
+      patch_pa = NULL;
+      patch_q1d = 0;
 #ifdef MFEM_USE_CEED
       ceedDataPtr = NULL;
 #endif
@@ -1891,6 +1952,8 @@ public:
       MQ = NULL;
       maps = NULL;
       geom = NULL;
+      patch_pa = NULL;
+      patch_q1d = 0;
 #ifdef MFEM_USE_CEED
       ceedDataPtr = NULL;
 #endif
@@ -1903,6 +1966,8 @@ public:
       Q = NULL;
       maps = NULL;
       geom = NULL;
+      patch_pa = NULL;
+      patch_q1d = 0;
 #ifdef MFEM_USE_CEED
       ceedDataPtr = NULL;
 #endif
@@ -1910,6 +1975,8 @@ public:
 
    virtual ~DiffusionIntegrator()
    {
+      delete patch_pa;
+      PAGeometryBatch::DeleteBatches(batches);
 #ifdef MFEM_USE_CEED
       delete ceedDataPtr;
 #endif
@@ -1945,6 +2012,8 @@ public:
 
    virtual void AssemblePA(const FiniteElementSpace &fes);
 
+   virtual bool SupportsMixedMeshPA() const { return true; }
+
    virtual void AssembleEA(const FiniteElementSpace &fes, Vector &emat);
 
    virtual void AssembleDiagonalPA(Vector &diag);
@@ -1955,6 +2024,11 @@ public:
                                          const FiniteElement &test_fe);
 
    void SetupPA(const FiniteElementSpace &fes);
+
+   /** @brief Set the number of Gauss points per knot span and direction of
+       the patch-wise PA on NURBS spaces, see NURBSPatchPA::SetPointsPerSpan().
+       The default, 0, uses the same rule as the element-wise assembly. */
+   void SetPatchPointsPerSpan(int q) { patch_q1d = q; }
 };
 
 /** Class for local mass matrix assembling a(u,v) := (Q u, v) */
@@ -1971,6 +2045,11 @@ protected:
    const DofToQuad *maps;         ///< Not owned
    const GeometricFactors *geom;  ///< Not owned
    int dim, ne, nq, dofs1D, quad1D;
+   // Patch-wise PA on NURBS spaces
+   NURBSPatchPA *patch_pa;
+   int patch_q1d;
+   // PA on meshes with mixed element types
+   Array<PAGeometryBatch*> batches;
 
 #ifdef MFEM_USE_CEED
    // CEED extension
@@ -1984,6 +2063,8 @@ public:
       Q = NULL;
       maps = NULL;
       geom = NULL;
+      patch_pa = NULL;
+      patch_q1d = 0;
 #ifdef MFEM_USE_CEED
       ceedDataPtr = NULL;
 #endif
@@ -1995,6 +2076,8 @@ public:
    {
       maps = NULL;
       geom = NULL;
+      patch_pa = NULL;
+      patch_q1d = 0;
 #ifdef MFEM_USE_CEED
       ceedDataPtr = NULL;
 #endif
@@ -2002,6 +2085,8 @@ public:
 
    virtual ~MassIntegrator()
    {
+      delete patch_pa;
+      PAGeometryBatch::DeleteBatches(batches);
 #ifdef MFEM_USE_CEED
       delete ceedDataPtr;
 #endif
@@ -2020,17 +2105,32 @@ public:
 
    virtual void AssemblePA(const FiniteElementSpace &fes);
 
+   virtual bool SupportsMixedMeshPA() const { return true; }
+
    virtual void AssembleEA(const FiniteElementSpace &fes, Vector &emat);
 
    virtual void AssembleDiagonalPA(Vector &diag);
 
    virtual void AddMultPA(const Vector&, Vector&) const;
 
+   /** Supported for a MassIntegrator @a imag assembled with the same basis
+       maps, on tensor-product, simplex and mixed meshes. */
+   virtual bool SupportsComplexPA(const BilinearFormIntegrator &imag) const;
+
+   virtual void AddMultComplexPA(const BilinearFormIntegrator &imag,
+                                 const Vector &x_r, const Vector &x_i,
+                                 Vector &y_r, Vector &y_i) const;
+
    static const IntegrationRule &GetRule(const FiniteElement &trial_fe,
                                          const FiniteElement &test_fe,
                                          ElementTransformation &Trans);
 
    void SetupPA(const FiniteElementSpace &fes);
+
+   /** @brief Set the number of Gauss points per knot span and direction of
+       the patch-wise PA on NURBS spaces, see NURBSPatchPA::SetPointsPerSpan().
+       The default, 0, uses the same rule as the element-wise assembly. */
+   void SetPatchPointsPerSpan(int q) { patch_q1d = q; }
 };
 
 /** Mass integrator (u, v) restricted to the boundary of a domain */
@@ -2370,7 +2470,7 @@ class VectorFEMassIntegrator: public BilinearFormIntegrator
 {
 private:
    void Init(Coefficient *q, VectorCoefficient *vq, MatrixCoefficient *mq)
-   { Q = q; VQ = vq; MQ = mq; }
+   { Q = q; VQ = vq; MQ = mq; mapsO = mapsC = NULL; }
 
 #ifndef MFEM_THREAD_SAFE
    Vector shape;
@@ -2414,6 +2514,11 @@ public:
    virtual void AssemblePA(const FiniteElementSpace &fes);
    virtual void AddMultPA(const Vector &x, Vector &y) const;
    virtual void AssembleDiagonalPA(Vector& diag);
+   /// Supported for H(curl) spaces, with a VectorFEMassIntegrator @a imag.
+   virtual bool SupportsComplexPA(const BilinearFormIntegrator &imag) const;
+   virtual void AddMultComplexPA(const BilinearFormIntegrator &imag,
+                                 const Vector &x_r, const Vector &x_i,
+                                 Vector &y_r, Vector &y_i) const;
 };
 
 /** Integrator for (Q div u, p) where u=(v1,...,vn) and all vi are in the same
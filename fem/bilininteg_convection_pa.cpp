@@ -10,6 +10,7 @@
 // CONTRIBUTING.md for details.
 
 #include "../general/forall.hpp"
+#include "../general/kernel_stats.hpp"
 #include "bilininteg.hpp"
 #include "gridfunc.hpp"
 
@@ -836,6 +837,16 @@ static void PAConvectionApply(const int dim,
                               const Vector &x,
                               Vector &y)
 {
+   // Analytic counts of the sum-factorized kernels: x and op are read, y is
+   // read and written. The gradient is interpolated with B and G, the result
+   // is integrated with B only.
+   const double D1 = D1D, Q1 = Q1D;
+   const double bytes = NE*sizeof(double)*(3*pow(D1,dim) + dim*pow(Q1,dim));
+   const double flops =
+      NE*((dim == 2) ? 6*(D1*D1*Q1 + D1*Q1*Q1) + 3*Q1*Q1 :
+          2*(3*D1*D1*D1*Q1 + 4*D1*D1*Q1*Q1 + 4*D1*Q1*Q1*Q1) + 5*Q1*Q1*Q1);
+   KernelTimer timer("ConvectionIntegrator::AddMultPA", dim, D1D, Q1D,
+                     bytes, flops);
    if (dim == 2)
    {
       switch ((D1D << 4 ) | Q1D)
@@ -848,7 +859,9 @@ static void PAConvectionApply(const int dim,
          case 0x77: return SmemPAConvectionApply2D<7,7,1>(NE,B,G,Bt,Gt,op,x,y);
          case 0x88: return SmemPAConvectionApply2D<8,8,1>(NE,B,G,Bt,Gt,op,x,y);
          case 0x99: return SmemPAConvectionApply2D<9,9,1>(NE,B,G,Bt,Gt,op,x,y);
-         default:   return PAConvectionApply2D(NE,B,G,Bt,Gt,op,x,y,D1D,Q1D);
+         default:
+            timer.Fallback();
+            return PAConvectionApply2D(NE,B,G,Bt,Gt,op,x,y,D1D,Q1D);
       }
    }
    else if (dim == 3)
@@ -862,7 +875,9 @@ static void PAConvectionApply(const int dim,
          case 0x67: return SmemPAConvectionApply3D<6,7>(NE,B,G,Bt,Gt,op,x,y);
          case 0x78: return SmemPAConvectionApply3D<7,8>(NE,B,G,Bt,Gt,op,x,y);
          case 0x89: return SmemPAConvectionApply3D<8,9>(NE,B,G,Bt,Gt,op,x,y);
-         default:   return PAConvectionApply3D(NE,B,G,Bt,Gt,op,x,y,D1D,Q1D);
+         default:
+            timer.Fallback();
+            return PAConvectionApply3D(NE,B,G,Bt,Gt,op,x,y,D1D,Q1D);
       }
    }
    MFEM_ABORT("Unknown kernel.");
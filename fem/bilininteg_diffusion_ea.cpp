@@ -130,8 +130,8 @@ static void EADiffusionAssemble2D(const int NE,
 
 template<int T_D1D = 0, int T_Q1D = 0>
 static void EADiffusionAssemble3D(const int NE,
-                                  const Array<double> &g,
                                   const Array<double> &b,
+                                  const Array<double> &g,
                                   const Vector &padata,
                                   Vector &eadata,
                                   const int d1d = 0,
@@ -218,13 +218,59 @@ static void EADiffusionAssemble3D(const int NE,
    });
 }
 
+// Element matrices of non-tensor elements, with the full basis matrices:
+// A(i,j,e) = sum_q grad(phi_i)^T D(q,e) grad(phi_j), where D is stored by
+// rows of its upper triangle.
+static void EADiffusionAssembleFull(const int dim, const int NE, const int ND,
+                                    const int NQ,
+                                    const Array<double> &gt,
+                                    const Vector &padata,
+                                    Vector &eadata)
+{
+   const int DIM = dim;
+   const int SYM = (dim*(dim+1))/2;
+   auto Gt = Reshape(gt.Read(), ND, NQ, DIM);
+   auto D = Reshape(padata.Read(), NQ, SYM, NE);
+   auto A = Reshape(eadata.ReadWrite(), ND, ND, NE);
+   MFEM_FORALL(e, NE,
+   {
+      for (int q = 0; q < NQ; ++q)
+      {
+         for (int k = 0; k < DIM; ++k)
+         {
+            for (int l = 0; l < DIM; ++l)
+            {
+               const int kl = (k <= l) ? k*DIM - k*(k-1)/2 + (l-k) :
+                              l*DIM - l*(l-1)/2 + (k-l);
+               const double Dkl = D(q,kl,e);
+               for (int j = 0; j < ND; ++j)
+               {
+                  const double DG = Dkl * Gt(j,q,l);
+                  for (int i = 0; i < ND; ++i)
+                  {
+                     A(i,j,e) += Gt(i,q,k) * DG;
+                  }
+               }
+            }
+         }
+      }
+   });
+}
+
 void DiffusionIntegrator::AssembleEA(const FiniteElementSpace &fes,
                                      Vector &ea_data)
 {
    AssemblePA(fes);
+   MFEM_VERIFY(batches.Size() == 0, "element assembly is not supported on"
+               " meshes with mixed element types");
    const int ne = fes.GetMesh()->GetNE();
    const Array<double> &B = maps->B;
    const Array<double> &G = maps->G;
+   if (maps->mode == DofToQuad::FULL)
+   {
+      return EADiffusionAssembleFull(dim, ne, dofs1D, quad1D, maps->Gt,
+                                     pa_data, ea_data);
+   }
    if (dim == 1)
    {
       switch ((dofs1D << 4 ) | quad1D)
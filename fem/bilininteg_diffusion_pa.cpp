@@ -10,6 +10,7 @@
 // CONTRIBUTING.md for details.
 
 #include "../general/forall.hpp"
+#include "../general/kernel_stats.hpp"
 #include "bilininteg.hpp"
 #include "gridfunc.hpp"
 #include "libceed/diffusion.hpp"
@@ -82,21 +83,20 @@ static void OccaPADiffusionSetup3D(const int D1D,
 
 // PA Diffusion Assemble 2D kernel
 template<const int T_SDIM>
-static void PADiffusionSetup2D(const int Q1D,
+static void PADiffusionSetup2D(const int NQ,
                                const int NE,
                                const Array<double> &w,
                                const Vector &j,
                                const Vector &c,
                                Vector &d);
 template<>
-void PADiffusionSetup2D<2>(const int Q1D,
+void PADiffusionSetup2D<2>(const int NQ,
                            const int NE,
                            const Array<double> &w,
                            const Vector &j,
                            const Vector &c,
                            Vector &d)
 {
-   const int NQ = Q1D*Q1D;
    const bool const_c = c.Size() == 1;
    auto W = w.Read();
    auto J = Reshape(j.Read(), NQ, 2, 2, NE);
@@ -122,7 +122,7 @@ void PADiffusionSetup2D<2>(const int Q1D,
 
 // PA Diffusion Assemble 2D kernel with 3D node coords
 template<>
-void PADiffusionSetup2D<3>(const int Q1D,
+void PADiffusionSetup2D<3>(const int NQ,
                            const int NE,
                            const Array<double> &w,
                            const Vector &j,
@@ -131,7 +131,6 @@ void PADiffusionSetup2D<3>(const int Q1D,
 {
    constexpr int DIM = 2;
    constexpr int SDIM = 3;
-   const int NQ = Q1D*Q1D;
    const bool const_c = c.Size() == 1;
 
    auto W = w.Read();
@@ -163,14 +162,13 @@ void PADiffusionSetup2D<3>(const int Q1D,
 }
 
 // PA Diffusion Assemble 3D kernel
-static void PADiffusionSetup3D(const int Q1D,
+static void PADiffusionSetup3D(const int NQ,
                                const int NE,
                                const Array<double> &w,
                                const Vector &j,
                                const Vector &c,
                                Vector &d)
 {
-   const int NQ = Q1D*Q1D*Q1D;
    const bool const_c = c.Size() == 1;
    auto W = w.Read();
    auto J = Reshape(j.Read(), NQ, 3, 3, NE);
@@ -215,10 +213,14 @@ static void PADiffusionSetup3D(const int Q1D,
    });
 }
 
+// The quadrature data depends only on the points, so the same kernels are used
+// for the NQ = Q1D^dim points of tensor elements and for the NQ points of the
+// non-tensor ones; the OCCA kernels assume the former.
 static void PADiffusionSetup(const int dim,
                              const int sdim,
                              const int D1D,
                              const int Q1D,
+                             const int NQ,
                              const int NE,
                              const Array<double> &W,
                              const Vector &J,
@@ -229,36 +231,70 @@ static void PADiffusionSetup(const int dim,
    if (dim == 2)
    {
 #ifdef MFEM_USE_OCCA
-      if (DeviceCanUseOcca())
+      if (DeviceCanUseOcca() && NQ == Q1D*Q1D)
       {
          OccaPADiffusionSetup2D(D1D, Q1D, NE, W, J, C, D);
          return;
       }
 #else
       MFEM_CONTRACT_VAR(D1D);
+      MFEM_CONTRACT_VAR(Q1D);
 #endif // MFEM_USE_OCCA
-      if (sdim == 2) { PADiffusionSetup2D<2>(Q1D, NE, W, J, C, D); }
-      if (sdim == 3) { PADiffusionSetup2D<3>(Q1D, NE, W, J, C, D); }
+      if (sdim == 2) { PADiffusionSetup2D<2>(NQ, NE, W, J, C, D); }
+      if (sdim == 3) { PADiffusionSetup2D<3>(NQ, NE, W, J, C, D); }
    }
    if (dim == 3)
    {
 #ifdef MFEM_USE_OCCA
-      if (DeviceCanUseOcca())
+      if (DeviceCanUseOcca() && NQ == Q1D*Q1D*Q1D)
       {
          OccaPADiffusionSetup3D(D1D, Q1D, NE, W, J, C, D);
          return;
       }
 #endif // MFEM_USE_OCCA
-      PADiffusionSetup3D(Q1D, NE, W, J, C, D);
+      PADiffusionSetup3D(NQ, NE, W, J, C, D);
    }
 }
 
 void DiffusionIntegrator::SetupPA(const FiniteElementSpace &fes)
 {
-   // Assuming the same element type
+   // Assuming the same element type, unless the mesh has mixed element types
    fespace = &fes;
    Mesh *mesh = fes.GetMesh();
    if (mesh->GetNE() == 0) { return; }
+   PAGeometryBatch::DeleteBatches(batches);
+   if (mesh->GetNumGeometries(mesh->Dimension()) > 1)
+   {
+      // One batch per element type, with the default rule of each geometry
+      MFEM_VERIFY(IntRule == NULL && MQ == NULL && !DeviceCanUseCeed(),
+                  "custom integration rules, matrix coefficients and libCEED"
+                  " are not supported on meshes with mixed element types");
+      dim = mesh->Dimension();
+      ne = mesh->GetNE();
+      const int sdim = mesh->SpaceDimension();
+      const int symmDims = (dim * (dim + 1)) / 2;
+      PAGeometryBatch::MakeBatches(fes, batches);
+      for (int b = 0; b < batches.Size(); b++)
+      {
+         PAGeometryBatch &batch = *batches[b];
+         const FiniteElement &el = *fes.GetFE(batch.elements[0]);
+         batch.ir = &GetRule(el, el);
+         batch.maps = &el.GetDofToQuad(*batch.ir,
+                                       dynamic_cast<const TensorBasisElement*>
+                                       (&el) ? DofToQuad::TENSOR :
+                                       DofToQuad::FULL);
+         const int NE = batch.elements.Size();
+         const int NQ = batch.ir->GetNPoints();
+         Vector J, coeff;
+         batch.GetJacobians(*mesh, J);
+         batch.EvalCoefficient(*mesh, Q, coeff);
+         batch.pa_data.SetSize(symmDims*NQ*NE, Device::GetDeviceMemoryType());
+         PADiffusionSetup(dim, sdim, batch.maps->ndof, batch.maps->nqpt, NQ,
+                          NE, batch.ir->GetWeights(), J, coeff,
+                          batch.pa_data);
+      }
+      return;
+   }
    const FiniteElement &el = *fes.GetFE(0);
    const IntegrationRule *ir = IntRule ? IntRule : &GetRule(el, el);
 #ifdef MFEM_USE_CEED
@@ -278,7 +314,9 @@ void DiffusionIntegrator::SetupPA(const FiniteElementSpace &fes)
    ne = fes.GetNE();
    geom = mesh->GetGeometricFactors(*ir, GeometricFactors::JACOBIANS);
    const int sdim = mesh->SpaceDimension();
-   maps = &el.GetDofToQuad(*ir, DofToQuad::TENSOR);
+   // Simplices use the full basis matrices, see PADiffusionApplyFull()
+   maps = &el.GetDofToQuad(*ir, UsesTensorBasis(fes) ? DofToQuad::TENSOR :
+                           DofToQuad::FULL);
    dofs1D = maps->ndof;
    quad1D = maps->nqpt;
    pa_data.SetSize(symmDims * nq * ne, Device::GetDeviceMemoryType());
@@ -319,12 +357,27 @@ void DiffusionIntegrator::SetupPA(const FiniteElementSpace &fes)
          }
       }
    }
-   PADiffusionSetup(dim, sdim, dofs1D, quad1D, ne, ir->GetWeights(), geom->J,
-                    coeff, pa_data);
+   PADiffusionSetup(dim, sdim, dofs1D, quad1D, nq, ne, ir->GetWeights(),
+                    geom->J, coeff, pa_data);
 }
 
 void DiffusionIntegrator::AssemblePA(const FiniteElementSpace &fes)
 {
+   delete patch_pa;
+   patch_pa = NULL;
+   if (fes.GetNURBSext() && fes.GetNE() > 0)
+   {
+      // Patch-wise assembly, acting on L-vectors
+      MFEM_VERIFY(MQ == NULL, "matrix coefficients are not supported by the"
+                  " patch-wise PA of NURBS spaces");
+      fespace = &fes;
+      const FiniteElement &el = *fes.GetFE(0);
+      const IntegrationRule *ir = IntRule ? IntRule : &GetRule(el, el);
+      patch_pa = new NURBSPatchPA(NURBSPatchPA::DIFFUSION);
+      patch_pa->SetPointsPerSpan(patch_q1d);
+      patch_pa->Assemble(fes, Q, ir->GetOrder());
+      return;
+   }
    SetupPA(fes);
 }
 
@@ -702,6 +755,47 @@ static void SmemPADiffusionDiagonal3D(const int NE,
    });
 }
 
+// Index of the entry (k,l) of the symmetric matrices stored by the setup
+// kernels, i.e. by rows of their upper triangle.
+MFEM_HOST_DEVICE static inline int PADiffusionSymIdx(const int dim, int k,
+                                                     int l)
+{
+   if (k > l) { const int t = k; k = l; l = t; }
+   return k*dim - k*(k-1)/2 + (l-k);
+}
+
+// PA Diffusion Diagonal kernel for non-tensor elements, with the full basis
+// matrices: diag(i,e) = sum_q grad(phi_i)^T D(q,e) grad(phi_i).
+static void PADiffusionAssembleDiagonalFull(const int dim, const int NE,
+                                            const int ND, const int NQ,
+                                            const Array<double> &gt,
+                                            const Vector &d,
+                                            Vector &y)
+{
+   const int DIM = dim;
+   const int SYM = (dim*(dim+1))/2;
+   auto Gt = Reshape(gt.Read(), ND, NQ, DIM);
+   auto D = Reshape(d.Read(), NQ, SYM, NE);
+   auto Y = Reshape(y.ReadWrite(), ND, NE);
+   MFEM_FORALL(e, NE,
+   {
+      for (int q = 0; q < NQ; ++q)
+      {
+         for (int k = 0; k < DIM; ++k)
+         {
+            for (int l = 0; l < DIM; ++l)
+            {
+               const double Dkl = D(q,PADiffusionSymIdx(DIM,k,l),e);
+               for (int i = 0; i < ND; ++i)
+               {
+                  Y(i,e) += Gt(i,q,k) * Dkl * Gt(i,q,l);
+               }
+            }
+         }
+      }
+   });
+}
+
 static void PADiffusionAssembleDiagonal(const int dim,
                                         const int D1D,
                                         const int Q1D,
@@ -744,8 +838,25 @@ static void PADiffusionAssembleDiagonal(const int dim,
    MFEM_ABORT("Unknown kernel.");
 }
 
+// PA Diffusion Diagonal of NE elements of the same type, with the kernels of
+// the basis matrices in maps
+static void PADiffusionAssembleDiagonal(const int dim, const int NE,
+                                        const DofToQuad &maps,
+                                        const Vector &D,
+                                        Vector &Y)
+{
+   if (maps.mode == DofToQuad::FULL)
+   {
+      return PADiffusionAssembleDiagonalFull(dim, NE, maps.ndof, maps.nqpt,
+                                             maps.Gt, D, Y);
+   }
+   PADiffusionAssembleDiagonal(dim, maps.ndof, maps.nqpt, NE, maps.B, maps.G,
+                               D, Y);
+}
+
 void DiffusionIntegrator::AssembleDiagonalPA(Vector &diag)
 {
+   if (patch_pa) { patch_pa->AssembleDiagonal(diag); return; }
 #ifdef MFEM_USE_CEED
    if (DeviceCanUseCeed())
    {
@@ -754,8 +865,19 @@ void DiffusionIntegrator::AssembleDiagonalPA(Vector &diag)
    else
 #endif
    {
-      PADiffusionAssembleDiagonal(dim, dofs1D, quad1D, ne,
-                                  maps->B, maps->G, pa_data, diag);
+      if (batches.Size() == 0)
+      {
+         PADiffusionAssembleDiagonal(dim, ne, *maps, pa_data, diag);
+      }
+      for (int b = 0; b < batches.Size(); b++)
+      {
+         const PAGeometryBatch &batch = *batches[b];
+         const int NE = batch.elements.Size();
+         Vector diag_b;
+         diag_b.MakeRef(diag, batch.offset, batch.ndof*NE);
+         PADiffusionAssembleDiagonal(dim, NE, *batch.maps, batch.pa_data,
+                                     diag_b);
+      }
    }
 }
 
@@ -1642,6 +1764,55 @@ static void SmemPADiffusionApply3D(const int NE,
    });
 }
 
+// PA Diffusion Apply kernel for non-tensor elements (triangles, tetrahedra,
+// ...), the batched product G^T D_e G x_e over the elements, see
+// PAMassApplyFull().
+template<int T_DIM>
+static void PADiffusionApplyFull(const int NE, const int ND, const int NQ,
+                                 const Array<double> &gt,
+                                 const Vector &d,
+                                 const Vector &x,
+                                 Vector &y)
+{
+   constexpr int DIM = T_DIM;
+   constexpr int SYM = (DIM*(DIM+1))/2;
+   const double bytes = NE*sizeof(double)*(3.0*ND + SYM*NQ);
+   const double flops = NE*NQ*(4.0*DIM*ND + 2.0*DIM*DIM);
+   // the counts are recorded with the total numbers of dofs and points
+   KernelTimer timer("DiffusionIntegrator::AddMultPA (full)", DIM, ND, NQ,
+                     bytes, flops);
+   auto Gt = Reshape(gt.Read(), ND, NQ, DIM);
+   auto D = Reshape(d.Read(), NQ, SYM, NE);
+   auto X = Reshape(x.Read(), ND, NE);
+   auto Y = Reshape(y.ReadWrite(), ND, NE);
+   MFEM_FORALL(e, NE,
+   {
+      for (int q = 0; q < NQ; ++q)
+      {
+         double grad[DIM], flux[DIM];
+         for (int k = 0; k < DIM; ++k) { grad[k] = flux[k] = 0.0; }
+         for (int i = 0; i < ND; ++i)
+         {
+            const double xi = X(i,e);
+            for (int k = 0; k < DIM; ++k) { grad[k] += Gt(i,q,k) * xi; }
+         }
+         for (int k = 0; k < DIM; ++k)
+         {
+            for (int l = 0; l < DIM; ++l)
+            {
+               flux[k] += D(q,PADiffusionSymIdx(DIM,k,l),e) * grad[l];
+            }
+         }
+         for (int i = 0; i < ND; ++i)
+         {
+            double yi = 0.0;
+            for (int k = 0; k < DIM; ++k) { yi += Gt(i,q,k) * flux[k]; }
+            Y(i,e) += yi;
+         }
+      }
+   });
+}
+
 static void PADiffusionApply(const int dim,
                              const int D1D,
                              const int Q1D,
@@ -1654,6 +1825,16 @@ static void PADiffusionApply(const int dim,
                              const Vector &X,
                              Vector &Y)
 {
+   // Analytic counts of the sum-factorized kernels: X and the symmetric
+   // D are read, Y is read and written.
+   const double D1 = D1D, Q1 = Q1D;
+   const int symm = (dim == 2) ? 3 : 6;
+   const double bytes = NE*sizeof(double)*(3*pow(D1,dim) + symm*pow(Q1,dim));
+   const double flops =
+      NE*((dim == 2) ? 8*(D1*D1*Q1 + D1*Q1*Q1) + 6*Q1*Q1 :
+          4*(2*D1*D1*D1*Q1 + 3*D1*D1*Q1*Q1 + 3*D1*Q1*Q1*Q1) + 15*Q1*Q1*Q1);
+   KernelTimer timer("DiffusionIntegrator::AddMultPA", dim, D1D, Q1D,
+                     bytes, flops);
 #ifdef MFEM_USE_OCCA
    if (DeviceCanUseOcca())
    {
@@ -1684,7 +1865,9 @@ static void PADiffusionApply(const int dim,
          case 0x77: return SmemPADiffusionApply2D<7,7,4>(NE,B,G,D,X,Y);
          case 0x88: return SmemPADiffusionApply2D<8,8,2>(NE,B,G,D,X,Y);
          case 0x99: return SmemPADiffusionApply2D<9,9,2>(NE,B,G,D,X,Y);
-         default:   return PADiffusionApply2D(NE,B,G,Bt,Gt,D,X,Y,D1D,Q1D);
+         default:
+            timer.Fallback();
+            return PADiffusionApply2D(NE,B,G,Bt,Gt,D,X,Y,D1D,Q1D);
       }
    }
 
@@ -1701,15 +1884,36 @@ static void PADiffusionApply(const int dim,
          case 0x67: return SmemPADiffusionApply3D<6,7>(NE,B,G,D,X,Y);
          case 0x78: return SmemPADiffusionApply3D<7,8>(NE,B,G,D,X,Y);
          case 0x89: return SmemPADiffusionApply3D<8,9>(NE,B,G,D,X,Y);
-         default:   return PADiffusionApply3D(NE,B,G,Bt,Gt,D,X,Y,D1D,Q1D);
+         default:
+            timer.Fallback();
+            return PADiffusionApply3D(NE,B,G,Bt,Gt,D,X,Y,D1D,Q1D);
       }
    }
    MFEM_ABORT("Unknown kernel.");
 }
 
 // PA Diffusion Apply kernel
+// PA Diffusion Apply of NE elements of the same type, with the kernels of the
+// basis matrices in maps
+static void PADiffusionApply(const int dim, const int NE,
+                             const DofToQuad &maps,
+                             const Vector &D,
+                             const Vector &X,
+                             Vector &Y)
+{
+   if (maps.mode == DofToQuad::FULL)
+   {
+      auto apply = (dim == 2) ? PADiffusionApplyFull<2> :
+                   PADiffusionApplyFull<3>;
+      return apply(NE, maps.ndof, maps.nqpt, maps.Gt, D, X, Y);
+   }
+   PADiffusionApply(dim, maps.ndof, maps.nqpt, NE, maps.B, maps.G, maps.Bt,
+                    maps.Gt, D, X, Y);
+}
+
 void DiffusionIntegrator::AddMultPA(const Vector &x, Vector &y) const
 {
+   if (patch_pa) { patch_pa->AddMult(x, y); return; }
 #ifdef MFEM_USE_CEED
    if (DeviceCanUseCeed())
    {
@@ -1718,9 +1922,20 @@ void DiffusionIntegrator::AddMultPA(const Vector &x, Vector &y) const
    else
 #endif
    {
-      PADiffusionApply(dim, dofs1D, quad1D, ne,
-                       maps->B, maps->G, maps->Bt, maps->Gt,
-                       pa_data, x, y);
+      if (batches.Size() == 0)
+      {
+         PADiffusionApply(dim, ne, *maps, pa_data, x, y);
+      }
+      // One launch per element type, on the ranges of the E-vectors
+      for (int b = 0; b < batches.Size(); b++)
+      {
+         const PAGeometryBatch &batch = *batches[b];
+         const int NE = batch.elements.Size();
+         Vector x_b, y_b;
+         x_b.MakeRef(const_cast<Vector&>(x), batch.offset, batch.ndof*NE);
+         y_b.MakeRef(y, batch.offset, batch.ndof*NE);
+         PADiffusionApply(dim, NE, *batch.maps, batch.pa_data, x_b, y_b);
+      }
    }
 }
 
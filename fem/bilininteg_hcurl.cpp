@@ -557,6 +557,395 @@ void PAHcurlMassApply3D(const int D1D,
    }); // end of element loop
 }
 
+// Fused complex PA H(curl) Mass Apply 2D kernel: with the symmetric matrices
+// of the real and imaginary parts of the coefficient in opr and opi, add
+// Opr x_r - Opi x_i to y_r and Opr x_i + Opi x_r to y_i, interpolating both
+// parts of x in the same sweep.
+void PAHcurlMassApplyComplex2D(const int D1D,
+                               const int Q1D,
+                               const int NE,
+                               const Array<double> &_Bo,
+                               const Array<double> &_Bc,
+                               const Array<double> &_Bot,
+                               const Array<double> &_Bct,
+                               const Vector &_opr,
+                               const Vector &_opi,
+                               const Vector &_xr,
+                               const Vector &_xi,
+                               Vector &_yr,
+                               Vector &_yi)
+{
+   constexpr static int VDIM = 2;
+   constexpr static int MAX_D1D = HCURL_MAX_D1D;
+   constexpr static int MAX_Q1D = HCURL_MAX_Q1D;
+
+   MFEM_VERIFY(D1D <= MAX_D1D, "Error: D1D > MAX_D1D");
+   MFEM_VERIFY(Q1D <= MAX_Q1D, "Error: Q1D > MAX_Q1D");
+
+   auto Bo = Reshape(_Bo.Read(), Q1D, D1D-1);
+   auto Bc = Reshape(_Bc.Read(), Q1D, D1D);
+   auto Bot = Reshape(_Bot.Read(), D1D-1, Q1D);
+   auto Bct = Reshape(_Bct.Read(), D1D, Q1D);
+   auto opr = Reshape(_opr.Read(), Q1D, Q1D, 3, NE);
+   auto opi = Reshape(_opi.Read(), Q1D, Q1D, 3, NE);
+   auto xr = Reshape(_xr.Read(), 2*(D1D-1)*D1D, NE);
+   auto xi = Reshape(_xi.Read(), 2*(D1D-1)*D1D, NE);
+   auto yr = Reshape(_yr.ReadWrite(), 2*(D1D-1)*D1D, NE);
+   auto yi = Reshape(_yi.ReadWrite(), 2*(D1D-1)*D1D, NE);
+
+   MFEM_FORALL(e, NE,
+   {
+      // mass[qy][qx][c][0 or 1]: real or imaginary part of component c
+      double mass[MAX_Q1D][MAX_Q1D][VDIM][2];
+
+      for (int qy = 0; qy < Q1D; ++qy)
+      {
+         for (int qx = 0; qx < Q1D; ++qx)
+         {
+            for (int c = 0; c < VDIM; ++c)
+            {
+               mass[qy][qx][c][0] = 0.0;
+               mass[qy][qx][c][1] = 0.0;
+            }
+         }
+      }
+
+      int osc = 0;
+
+      for (int c = 0; c < VDIM; ++c)  // loop over x, y components
+      {
+         const int D1Dy = (c == 1) ? D1D - 1 : D1D;
+         const int D1Dx = (c == 0) ? D1D - 1 : D1D;
+
+         for (int dy = 0; dy < D1Dy; ++dy)
+         {
+            double massX[MAX_Q1D][2];
+            for (int qx = 0; qx < Q1D; ++qx)
+            {
+               massX[qx][0] = 0.0;
+               massX[qx][1] = 0.0;
+            }
+
+            for (int dx = 0; dx < D1Dx; ++dx)
+            {
+               const double tr = xr(dx + (dy * D1Dx) + osc, e);
+               const double ti = xi(dx + (dy * D1Dx) + osc, e);
+               for (int qx = 0; qx < Q1D; ++qx)
+               {
+                  const double wx = (c == 0) ? Bo(qx,dx) : Bc(qx,dx);
+                  massX[qx][0] += tr * wx;
+                  massX[qx][1] += ti * wx;
+               }
+            }
+
+            for (int qy = 0; qy < Q1D; ++qy)
+            {
+               const double wy = (c == 1) ? Bo(qy,dy) : Bc(qy,dy);
+               for (int qx = 0; qx < Q1D; ++qx)
+               {
+                  mass[qy][qx][c][0] += massX[qx][0] * wy;
+                  mass[qy][qx][c][1] += massX[qx][1] * wy;
+               }
+            }
+         }
+
+         osc += D1Dx * D1Dy;
+      }  // loop (c) over components
+
+      // Apply the complex D operator.
+      for (int qy = 0; qy < Q1D; ++qy)
+      {
+         for (int qx = 0; qx < Q1D; ++qx)
+         {
+            const double R11 = opr(qx,qy,0,e);
+            const double R12 = opr(qx,qy,1,e);
+            const double R22 = opr(qx,qy,2,e);
+            const double I11 = opi(qx,qy,0,e);
+            const double I12 = opi(qx,qy,1,e);
+            const double I22 = opi(qx,qy,2,e);
+            const double uXr = mass[qy][qx][0][0];
+            const double uXi = mass[qy][qx][0][1];
+            const double uYr = mass[qy][qx][1][0];
+            const double uYi = mass[qy][qx][1][1];
+            mass[qy][qx][0][0] = (R11*uXr)+(R12*uYr)-(I11*uXi)-(I12*uYi);
+            mass[qy][qx][0][1] = (R11*uXi)+(R12*uYi)+(I11*uXr)+(I12*uYr);
+            mass[qy][qx][1][0] = (R12*uXr)+(R22*uYr)-(I12*uXi)-(I22*uYi);
+            mass[qy][qx][1][1] = (R12*uXi)+(R22*uYi)+(I12*uXr)+(I22*uYr);
+         }
+      }
+
+      for (int qy = 0; qy < Q1D; ++qy)
+      {
+         osc = 0;
+
+         for (int c = 0; c < VDIM; ++c)  // loop over x, y components
+         {
+            const int D1Dy = (c == 1) ? D1D - 1 : D1D;
+            const int D1Dx = (c == 0) ? D1D - 1 : D1D;
+
+            double massX[MAX_D1D][2];
+            for (int dx = 0; dx < D1Dx; ++dx)
+            {
+               massX[dx][0] = 0.0;
+               massX[dx][1] = 0.0;
+            }
+            for (int qx = 0; qx < Q1D; ++qx)
+            {
+               for (int dx = 0; dx < D1Dx; ++dx)
+               {
+                  const double wx = (c == 0) ? Bot(dx,qx) : Bct(dx,qx);
+                  massX[dx][0] += mass[qy][qx][c][0] * wx;
+                  massX[dx][1] += mass[qy][qx][c][1] * wx;
+               }
+            }
+
+            for (int dy = 0; dy < D1Dy; ++dy)
+            {
+               const double wy = (c == 1) ? Bot(dy,qy) : Bct(dy,qy);
+
+               for (int dx = 0; dx < D1Dx; ++dx)
+               {
+                  yr(dx + (dy * D1Dx) + osc, e) += massX[dx][0] * wy;
+                  yi(dx + (dy * D1Dx) + osc, e) += massX[dx][1] * wy;
+               }
+            }
+
+            osc += D1Dx * D1Dy;
+         }  // loop c
+      }  // loop qy
+   }); // end of element loop
+}
+
+// Fused complex PA H(curl) Mass Apply 3D kernel, see
+// PAHcurlMassApplyComplex2D.
+void PAHcurlMassApplyComplex3D(const int D1D,
+                               const int Q1D,
+                               const int NE,
+                               const Array<double> &_Bo,
+                               const Array<double> &_Bc,
+                               const Array<double> &_Bot,
+                               const Array<double> &_Bct,
+                               const Vector &_opr,
+                               const Vector &_opi,
+                               const Vector &_xr,
+                               const Vector &_xi,
+                               Vector &_yr,
+                               Vector &_yi)
+{
+   constexpr static int MAX_D1D = HCURL_MAX_D1D;
+   constexpr static int MAX_Q1D = HCURL_MAX_Q1D;
+
+   MFEM_VERIFY(D1D <= MAX_D1D, "Error: D1D > MAX_D1D");
+   MFEM_VERIFY(Q1D <= MAX_Q1D, "Error: Q1D > MAX_Q1D");
+   constexpr static int VDIM = 3;
+
+   auto Bo = Reshape(_Bo.Read(), Q1D, D1D-1);
+   auto Bc = Reshape(_Bc.Read(), Q1D, D1D);
+   auto Bot = Reshape(_Bot.Read(), D1D-1, Q1D);
+   auto Bct = Reshape(_Bct.Read(), D1D, Q1D);
+   auto opr = Reshape(_opr.Read(), Q1D, Q1D, Q1D, 6, NE);
+   auto opi = Reshape(_opi.Read(), Q1D, Q1D, Q1D, 6, NE);
+   auto xr = Reshape(_xr.Read(), 3*(D1D-1)*D1D*D1D, NE);
+   auto xi = Reshape(_xi.Read(), 3*(D1D-1)*D1D*D1D, NE);
+   auto yr = Reshape(_yr.ReadWrite(), 3*(D1D-1)*D1D*D1D, NE);
+   auto yi = Reshape(_yi.ReadWrite(), 3*(D1D-1)*D1D*D1D, NE);
+
+   MFEM_FORALL(e, NE,
+   {
+      // mass[qz][qy][qx][c][0 or 1]: real or imaginary part of component c
+      double mass[MAX_Q1D][MAX_Q1D][MAX_Q1D][VDIM][2];
+
+      for (int qz = 0; qz < Q1D; ++qz)
+      {
+         for (int qy = 0; qy < Q1D; ++qy)
+         {
+            for (int qx = 0; qx < Q1D; ++qx)
+            {
+               for (int c = 0; c < VDIM; ++c)
+               {
+                  mass[qz][qy][qx][c][0] = 0.0;
+                  mass[qz][qy][qx][c][1] = 0.0;
+               }
+            }
+         }
+      }
+
+      int osc = 0;
+
+      for (int c = 0; c < VDIM; ++c)  // loop over x, y, z components
+      {
+         const int D1Dz = (c == 2) ? D1D - 1 : D1D;
+         const int D1Dy = (c == 1) ? D1D - 1 : D1D;
+         const int D1Dx = (c == 0) ? D1D - 1 : D1D;
+
+         for (int dz = 0; dz < D1Dz; ++dz)
+         {
+            double massXY[MAX_Q1D][MAX_Q1D][2];
+            for (int qy = 0; qy < Q1D; ++qy)
+            {
+               for (int qx = 0; qx < Q1D; ++qx)
+               {
+                  massXY[qy][qx][0] = 0.0;
+                  massXY[qy][qx][1] = 0.0;
+               }
+            }
+
+            for (int dy = 0; dy < D1Dy; ++dy)
+            {
+               double massX[MAX_Q1D][2];
+               for (int qx = 0; qx < Q1D; ++qx)
+               {
+                  massX[qx][0] = 0.0;
+                  massX[qx][1] = 0.0;
+               }
+
+               for (int dx = 0; dx < D1Dx; ++dx)
+               {
+                  const int d = dx + ((dy + (dz * D1Dy)) * D1Dx) + osc;
+                  const double tr = xr(d, e);
+                  const double ti = xi(d, e);
+                  for (int qx = 0; qx < Q1D; ++qx)
+                  {
+                     const double wx = (c == 0) ? Bo(qx,dx) : Bc(qx,dx);
+                     massX[qx][0] += tr * wx;
+                     massX[qx][1] += ti * wx;
+                  }
+               }
+
+               for (int qy = 0; qy < Q1D; ++qy)
+               {
+                  const double wy = (c == 1) ? Bo(qy,dy) : Bc(qy,dy);
+                  for (int qx = 0; qx < Q1D; ++qx)
+                  {
+                     massXY[qy][qx][0] += massX[qx][0] * wy;
+                     massXY[qy][qx][1] += massX[qx][1] * wy;
+                  }
+               }
+            }
+
+            for (int qz = 0; qz < Q1D; ++qz)
+            {
+               const double wz = (c == 2) ? Bo(qz,dz) : Bc(qz,dz);
+               for (int qy = 0; qy < Q1D; ++qy)
+               {
+                  for (int qx = 0; qx < Q1D; ++qx)
+                  {
+                     mass[qz][qy][qx][c][0] += massXY[qy][qx][0] * wz;
+                     mass[qz][qy][qx][c][1] += massXY[qy][qx][1] * wz;
+                  }
+               }
+            }
+         }
+
+         osc += D1Dx * D1Dy * D1Dz;
+      }  // loop (c) over components
+
+      // Apply the complex D operator: the symmetric 3x3 matrices are stored
+      // as (11, 12, 13, 22, 23, 33).
+      for (int qz = 0; qz < Q1D; ++qz)
+      {
+         for (int qy = 0; qy < Q1D; ++qy)
+         {
+            for (int qx = 0; qx < Q1D; ++qx)
+            {
+               double R[3][3], I[3][3];
+               for (int i = 0, k = 0; i < VDIM; ++i)
+               {
+                  for (int j = i; j < VDIM; ++j, ++k)
+                  {
+                     R[i][j] = R[j][i] = opr(qx,qy,qz,k,e);
+                     I[i][j] = I[j][i] = opi(qx,qy,qz,k,e);
+                  }
+               }
+               double ur[VDIM], ui[VDIM];
+               for (int c = 0; c < VDIM; ++c)
+               {
+                  ur[c] = mass[qz][qy][qx][c][0];
+                  ui[c] = mass[qz][qy][qx][c][1];
+               }
+               for (int c = 0; c < VDIM; ++c)
+               {
+                  double vr = 0.0, vi = 0.0;
+                  for (int j = 0; j < VDIM; ++j)
+                  {
+                     vr += R[c][j]*ur[j] - I[c][j]*ui[j];
+                     vi += R[c][j]*ui[j] + I[c][j]*ur[j];
+                  }
+                  mass[qz][qy][qx][c][0] = vr;
+                  mass[qz][qy][qx][c][1] = vi;
+               }
+            }
+         }
+      }
+
+      for (int qz = 0; qz < Q1D; ++qz)
+      {
+         double massXY[MAX_D1D][MAX_D1D][2];
+
+         osc = 0;
+
+         for (int c = 0; c < VDIM; ++c)  // loop over x, y, z components
+         {
+            const int D1Dz = (c == 2) ? D1D - 1 : D1D;
+            const int D1Dy = (c == 1) ? D1D - 1 : D1D;
+            const int D1Dx = (c == 0) ? D1D - 1 : D1D;
+
+            for (int dy = 0; dy < D1Dy; ++dy)
+            {
+               for (int dx = 0; dx < D1Dx; ++dx)
+               {
+                  massXY[dy][dx][0] = 0.0;
+                  massXY[dy][dx][1] = 0.0;
+               }
+            }
+            for (int qy = 0; qy < Q1D; ++qy)
+            {
+               double massX[MAX_D1D][2];
+               for (int dx = 0; dx < D1Dx; ++dx)
+               {
+                  massX[dx][0] = 0.0;
+                  massX[dx][1] = 0.0;
+               }
+               for (int qx = 0; qx < Q1D; ++qx)
+               {
+                  for (int dx = 0; dx < D1Dx; ++dx)
+                  {
+                     const double wx = (c == 0) ? Bot(dx,qx) : Bct(dx,qx);
+                     massX[dx][0] += mass[qz][qy][qx][c][0] * wx;
+                     massX[dx][1] += mass[qz][qy][qx][c][1] * wx;
+                  }
+               }
+               for (int dy = 0; dy < D1Dy; ++dy)
+               {
+                  const double wy = (c == 1) ? Bot(dy,qy) : Bct(dy,qy);
+                  for (int dx = 0; dx < D1Dx; ++dx)
+                  {
+                     massXY[dy][dx][0] += massX[dx][0] * wy;
+                     massXY[dy][dx][1] += massX[dx][1] * wy;
+                  }
+               }
+            }
+
+            for (int dz = 0; dz < D1Dz; ++dz)
+            {
+               const double wz = (c == 2) ? Bot(dz,qz) : Bct(dz,qz);
+               for (int dy = 0; dy < D1Dy; ++dy)
+               {
+                  for (int dx = 0; dx < D1Dx; ++dx)
+                  {
+                     const int d = dx + ((dy + (dz * D1Dy)) * D1Dx) + osc;
+                     yr(d, e) += massXY[dy][dx][0] * wz;
+                     yi(d, e) += massXY[dy][dx][1] * wz;
+                  }
+               }
+            }
+
+            osc += D1Dx * D1Dy * D1Dz;
+         }  // loop c
+      }  // loop qz
+   }); // end of element loop
+}
+
 // PA H(curl) curl-curl assemble 2D kernel
 static void PACurlCurlSetup2D(const int Q1D,
                               const int NE,
@@ -1593,13 +1982,23 @@ void CurlCurlIntegrator::AssembleDiagonalPA(Vector& diag)
 {
    if (dim == 3)
    {
-      // Reduce HCURL_MAX_D1D/Q1D to avoid using too much memory
-      constexpr int MAX_D1D = 4;
-      constexpr int MAX_Q1D = 5;
-      PACurlCurlAssembleDiagonal3D<MAX_D1D,MAX_Q1D>(dofs1D, quad1D, ne,
-                                                    mapsO->B, mapsC->B,
-                                                    mapsO->G, mapsC->G,
-                                                    pa_data, diag);
+      if (dofs1D <= 4 && quad1D <= 5)
+      {
+         // Reduce HCURL_MAX_D1D/Q1D to avoid using too much memory
+         constexpr int MAX_D1D = 4;
+         constexpr int MAX_Q1D = 5;
+         PACurlCurlAssembleDiagonal3D<MAX_D1D,MAX_Q1D>(dofs1D, quad1D, ne,
+                                                       mapsO->B, mapsC->B,
+                                                       mapsO->G, mapsC->G,
+                                                       pa_data, diag);
+      }
+      else
+      {
+         PACurlCurlAssembleDiagonal3D(dofs1D, quad1D, ne,
+                                      mapsO->B, mapsC->B,
+                                      mapsO->G, mapsC->G,
+                                      pa_data, diag);
+      }
    }
    else if (dim == 2)
    {
@@ -199,12 +199,45 @@ static void EAMassAssemble3D(const int NE,
    });
 }
 
+// Element matrices of non-tensor elements, with the full basis matrices:
+// M(i,j,e) = sum_q B(q,i) D(q,e) B(q,j).
+static void EAMassAssembleFull(const int NE, const int ND, const int NQ,
+                               const Array<double> &b,
+                               const Vector &padata,
+                               Vector &eadata)
+{
+   auto B = Reshape(b.Read(), NQ, ND);
+   auto D = Reshape(padata.Read(), NQ, NE);
+   auto M = Reshape(eadata.ReadWrite(), ND, ND, NE);
+   MFEM_FORALL(e, NE,
+   {
+      for (int j = 0; j < ND; ++j)
+      {
+         for (int i = 0; i < ND; ++i)
+         {
+            double val = 0.0;
+            for (int q = 0; q < NQ; ++q)
+            {
+               val += B(q,i) * D(q,e) * B(q,j);
+            }
+            M(i,j,e) += val;
+         }
+      }
+   });
+}
+
 void MassIntegrator::AssembleEA(const FiniteElementSpace &fes,
                                 Vector &ea_data)
 {
    AssemblePA(fes);
+   MFEM_VERIFY(batches.Size() == 0, "element assembly is not supported on"
+               " meshes with mixed element types");
    const int ne = fes.GetMesh()->GetNE();
    const Array<double> &B = maps->B;
+   if (maps->mode == DofToQuad::FULL)
+   {
+      return EAMassAssembleFull(ne, dofs1D, quad1D, B, pa_data, ea_data);
+   }
    if (dim == 1)
    {
       switch ((dofs1D << 4 ) | quad1D)
@@ -10,6 +10,7 @@
 // CONTRIBUTING.md for details.
 
 #include "../general/forall.hpp"
+#include "../general/kernel_stats.hpp"
 #include "bilininteg.hpp"
 #include "gridfunc.hpp"
 #include "libceed/mass.hpp"
@@ -22,13 +23,98 @@ namespace mfem
 // PA Mass Integrator
 
 // PA Mass Assemble kernel
+static void PAMassSetup(const int dim,
+                        const int NQ,
+                        const int NE,
+                        const Array<double> &w,
+                        const Vector &j,
+                        const Vector &coeff,
+                        Vector &op)
+{
+   if (dim==2)
+   {
+      const bool const_c = coeff.Size() == 1;
+      auto W = w.Read();
+      auto J = Reshape(j.Read(), NQ,2,2,NE);
+      auto C =
+         const_c ? Reshape(coeff.Read(), 1,1) : Reshape(coeff.Read(), NQ,NE);
+      auto v = Reshape(op.Write(), NQ, NE);
+      MFEM_FORALL(e, NE,
+      {
+         for (int q = 0; q < NQ; ++q)
+         {
+            const double J11 = J(q,0,0,e);
+            const double J12 = J(q,1,0,e);
+            const double J21 = J(q,0,1,e);
+            const double J22 = J(q,1,1,e);
+            const double detJ = (J11*J22)-(J21*J12);
+            const double coeff = const_c ? C(0,0) : C(q,e);
+            v(q,e) =  W[q] * coeff * detJ;
+         }
+      });
+   }
+   if (dim==3)
+   {
+      const bool const_c = coeff.Size() == 1;
+      auto W = w.Read();
+      auto J = Reshape(j.Read(), NQ,3,3,NE);
+      auto C =
+         const_c ? Reshape(coeff.Read(), 1,1) : Reshape(coeff.Read(), NQ,NE);
+      auto v = Reshape(op.Write(), NQ,NE);
+      MFEM_FORALL(e, NE,
+      {
+         for (int q = 0; q < NQ; ++q)
+         {
+            const double J11 = J(q,0,0,e), J12 = J(q,0,1,e), J13 = J(q,0,2,e);
+            const double J21 = J(q,1,0,e), J22 = J(q,1,1,e), J23 = J(q,1,2,e);
+            const double J31 = J(q,2,0,e), J32 = J(q,2,1,e), J33 = J(q,2,2,e);
+            const double detJ = J11 * (J22 * J33 - J32 * J23) -
+            /* */               J21 * (J12 * J33 - J32 * J13) +
+            /* */               J31 * (J12 * J23 - J22 * J13);
+            const double coeff = const_c ? C(0,0) : C(q,e);
+            v(q,e) = W[q] * coeff * detJ;
+         }
+      });
+   }
+}
 
 void MassIntegrator::SetupPA(const FiniteElementSpace &fes)
 {
-   // Assuming the same element type
+   // Assuming the same element type, unless the mesh has mixed element types
    fespace = &fes;
    Mesh *mesh = fes.GetMesh();
    if (mesh->GetNE() == 0) { return; }
+   dim = mesh->Dimension();
+   ne = mesh->GetNE();
+   PAGeometryBatch::DeleteBatches(batches);
+   if (mesh->GetNumGeometries(dim) > 1)
+   {
+      // One batch per element type, with the default rule of each geometry
+      MFEM_VERIFY(IntRule == NULL && !DeviceCanUseCeed(), "custom integration"
+                  " rules and libCEED are not supported on meshes with mixed"
+                  " element types");
+      PAGeometryBatch::MakeBatches(fes, batches);
+      for (int b = 0; b < batches.Size(); b++)
+      {
+         PAGeometryBatch &batch = *batches[b];
+         const int e0 = batch.elements[0];
+         const FiniteElement &el = *fes.GetFE(e0);
+         batch.ir = &GetRule(el, el, *mesh->GetElementTransformation(e0));
+         batch.maps = &el.GetDofToQuad(*batch.ir,
+                                       dynamic_cast<const TensorBasisElement*>
+                                       (&el) ? DofToQuad::TENSOR :
+                                       DofToQuad::FULL);
+         const int NE = batch.elements.Size();
+         const int NQ = batch.ir->GetNPoints();
+         Vector J, coeff;
+         batch.GetJacobians(*mesh, J);
+         batch.EvalCoefficient(*mesh, Q, coeff);
+         batch.pa_data.SetSize(NQ*NE, Device::GetDeviceMemoryType());
+         PAMassSetup(dim, NQ, NE, batch.ir->GetWeights(), J, coeff,
+                     batch.pa_data);
+      }
+      return;
+   }
    const FiniteElement &el = *fes.GetFE(0);
    ElementTransformation *T = mesh->GetElementTransformation(0);
    const IntegrationRule *ir = IntRule ? IntRule : &GetRule(el, el, *T);
@@ -42,12 +128,12 @@ void MassIntegrator::SetupPA(const FiniteElementSpace &fes)
       return CeedPAMassAssemble(fes, *ir, *ptr);
    }
 #endif
-   dim = mesh->Dimension();
-   ne = fes.GetMesh()->GetNE();
    nq = ir->GetNPoints();
    geom = mesh->GetGeometricFactors(*ir, GeometricFactors::COORDINATES |
                                     GeometricFactors::JACOBIANS);
-   maps = &el.GetDofToQuad(*ir, DofToQuad::TENSOR);
+   // Simplices use the full basis matrices, see PAMassApplyFull()
+   maps = &el.GetDofToQuad(*ir, UsesTensorBasis(fes) ? DofToQuad::TENSOR :
+                           DofToQuad::FULL);
    dofs1D = maps->ndof;
    quad1D = maps->nqpt;
    pa_data.SetSize(ne*nq, Device::GetDeviceMemoryType());
@@ -89,59 +175,25 @@ void MassIntegrator::SetupPA(const FiniteElementSpace &fes)
       }
    }
    if (dim==1) { MFEM_ABORT("Not supported yet... stay tuned!"); }
-   if (dim==2)
-   {
-      const int NE = ne;
-      const int NQ = nq;
-      const bool const_c = coeff.Size() == 1;
-      auto w = ir->GetWeights().Read();
-      auto J = Reshape(geom->J.Read(), NQ,2,2,NE);
-      auto C =
-         const_c ? Reshape(coeff.Read(), 1,1) : Reshape(coeff.Read(), NQ,NE);
-      auto v = Reshape(pa_data.Write(), NQ, NE);
-      MFEM_FORALL(e, NE,
-      {
-         for (int q = 0; q < NQ; ++q)
-         {
-            const double J11 = J(q,0,0,e);
-            const double J12 = J(q,1,0,e);
-            const double J21 = J(q,0,1,e);
-            const double J22 = J(q,1,1,e);
-            const double detJ = (J11*J22)-(J21*J12);
-            const double coeff = const_c ? C(0,0) : C(q,e);
-            v(q,e) =  w[q] * coeff * detJ;
-         }
-      });
-   }
-   if (dim==3)
-   {
-      const int NE = ne;
-      const int NQ = nq;
-      const bool const_c = coeff.Size() == 1;
-      auto W = ir->GetWeights().Read();
-      auto J = Reshape(geom->J.Read(), NQ,3,3,NE);
-      auto C =
-         const_c ? Reshape(coeff.Read(), 1,1) : Reshape(coeff.Read(), NQ,NE);
-      auto v = Reshape(pa_data.Write(), NQ,NE);
-      MFEM_FORALL(e, NE,
-      {
-         for (int q = 0; q < NQ; ++q)
-         {
-            const double J11 = J(q,0,0,e), J12 = J(q,0,1,e), J13 = J(q,0,2,e);
-            const double J21 = J(q,1,0,e), J22 = J(q,1,1,e), J23 = J(q,1,2,e);
-            const double J31 = J(q,2,0,e), J32 = J(q,2,1,e), J33 = J(q,2,2,e);
-            const double detJ = J11 * (J22 * J33 - J32 * J23) -
-            /* */               J21 * (J12 * J33 - J32 * J13) +
-            /* */               J31 * (J12 * J23 - J22 * J13);
-            const double coeff = const_c ? C(0,0) : C(q,e);
-            v(q,e) = W[q] * coeff * detJ;
-         }
-      });
-   }
+   PAMassSetup(dim, nq, ne, ir->GetWeights(), geom->J, coeff, pa_data);
 }
 
 void MassIntegrator::AssemblePA(const FiniteElementSpace &fes)
 {
+   delete patch_pa;
+   patch_pa = NULL;
+   if (fes.GetNURBSext() && fes.GetNE() > 0)
+   {
+      // Patch-wise assembly, acting on L-vectors
+      fespace = &fes;
+      const FiniteElement &el = *fes.GetFE(0);
+      ElementTransformation &T = *fes.GetElementTransformation(0);
+      const IntegrationRule *ir = IntRule ? IntRule : &GetRule(el, el, T);
+      patch_pa = new NURBSPatchPA(NURBSPatchPA::MASS);
+      patch_pa->SetPointsPerSpan(patch_q1d);
+      patch_pa->Assemble(fes, Q, ir->GetOrder());
+      return;
+   }
    SetupPA(fes);
 }
 
@@ -451,8 +503,48 @@ static void PAMassAssembleDiagonal(const int dim, const int D1D,
    MFEM_ABORT("Unknown kernel.");
 }
 
+// PA Mass Diagonal kernel for non-tensor elements, with the full basis
+// matrices: diag(i,e) = sum_q B(q,i)^2 D(q,e).
+static void PAMassAssembleDiagonalFull(const int NE, const int ND,
+                                       const int NQ,
+                                       const Array<double> &bt,
+                                       const Vector &d,
+                                       Vector &y)
+{
+   auto Bt = Reshape(bt.Read(), ND, NQ);
+   auto D = Reshape(d.Read(), NQ, NE);
+   auto Y = Reshape(y.ReadWrite(), ND, NE);
+   MFEM_FORALL(e, NE,
+   {
+      for (int q = 0; q < NQ; ++q)
+      {
+         const double Dq = D(q,e);
+         for (int i = 0; i < ND; ++i)
+         {
+            Y(i,e) += Bt(i,q) * Bt(i,q) * Dq;
+         }
+      }
+   });
+}
+
+// PA Mass Diagonal of NE elements of the same type, with the kernels of the
+// basis matrices in maps
+static void PAMassAssembleDiagonal(const int dim, const int NE,
+                                   const DofToQuad &maps,
+                                   const Vector &D,
+                                   Vector &Y)
+{
+   if (maps.mode == DofToQuad::FULL)
+   {
+      return PAMassAssembleDiagonalFull(NE, maps.ndof, maps.nqpt, maps.Bt, D,
+                                        Y);
+   }
+   PAMassAssembleDiagonal(dim, maps.ndof, maps.nqpt, NE, maps.B, D, Y);
+}
+
 void MassIntegrator::AssembleDiagonalPA(Vector &diag)
 {
+   if (patch_pa) { patch_pa->AssembleDiagonal(diag); return; }
 #ifdef MFEM_USE_CEED
    if (DeviceCanUseCeed())
    {
@@ -461,7 +553,18 @@ void MassIntegrator::AssembleDiagonalPA(Vector &diag)
    else
 #endif
    {
-      PAMassAssembleDiagonal(dim, dofs1D, quad1D, ne, maps->B, pa_data, diag);
+      if (batches.Size() == 0)
+      {
+         PAMassAssembleDiagonal(dim, ne, *maps, pa_data, diag);
+      }
+      for (int b = 0; b < batches.Size(); b++)
+      {
+         const PAGeometryBatch &batch = *batches[b];
+         const int NE = batch.elements.Size();
+         Vector diag_b;
+         diag_b.MakeRef(diag, batch.offset, batch.ndof*NE);
+         PAMassAssembleDiagonal(dim, NE, *batch.maps, batch.pa_data, diag_b);
+      }
    }
 }
 
@@ -1141,6 +1244,39 @@ static void SmemPAMassApply3D(const int NE,
    });
 }
 
+// PA Mass Apply kernel for non-tensor elements (triangles, tetrahedra, ...).
+// Without a tensor structure to factorize, the action is the batched product
+// B^T diag(D_e) B x_e over the elements. The quadrature points are traversed
+// in the outer loop, so that each step is a dot product with, and then a
+// rank-1 update by, the contiguous row Bt(:,q) shared by all elements.
+static void PAMassApplyFull(const int dim, const int NE, const int ND,
+                            const int NQ,
+                            const Array<double> &bt,
+                            const Vector &d,
+                            const Vector &x,
+                            Vector &y)
+{
+   const double bytes = NE*sizeof(double)*(3.0*ND + NQ);
+   const double flops = NE*(4.0*ND*NQ + NQ);
+   // the counts are recorded with the total numbers of dofs and points
+   KernelTimer timer("MassIntegrator::AddMultPA (full)", dim, ND, NQ, bytes,
+                     flops);
+   auto Bt = Reshape(bt.Read(), ND, NQ);
+   auto D = Reshape(d.Read(), NQ, NE);
+   auto X = Reshape(x.Read(), ND, NE);
+   auto Y = Reshape(y.ReadWrite(), ND, NE);
+   MFEM_FORALL(e, NE,
+   {
+      for (int q = 0; q < NQ; ++q)
+      {
+         double u = 0.0;
+         for (int i = 0; i < ND; ++i) { u += Bt(i,q) * X(i,e); }
+         u *= D(q,e);
+         for (int i = 0; i < ND; ++i) { Y(i,e) += Bt(i,q) * u; }
+      }
+   });
+}
+
 static void PAMassApply(const int dim,
                         const int D1D,
                         const int Q1D,
@@ -1151,6 +1287,14 @@ static void PAMassApply(const int dim,
                         const Vector &X,
                         Vector &Y)
 {
+   // Analytic counts of the sum-factorized kernels: X and D are read, Y is
+   // read and written.
+   const double D1 = D1D, Q1 = Q1D;
+   const double bytes = NE*sizeof(double)*(3*pow(D1,dim) + pow(Q1,dim));
+   const double flops = NE*((dim == 2) ? 4*(D1*D1*Q1 + D1*Q1*Q1) + Q1*Q1 :
+                            4*(D1*D1*D1*Q1 + D1*D1*Q1*Q1 + D1*Q1*Q1*Q1) +
+                            Q1*Q1*Q1);
+   KernelTimer timer("MassIntegrator::AddMultPA", dim, D1D, Q1D, bytes, flops);
 #ifdef MFEM_USE_OCCA
    if (DeviceCanUseOcca())
    {
@@ -1183,7 +1327,9 @@ static void PAMassApply(const int dim,
          case 0x77: return SmemPAMassApply2D<7,7,4>(NE,B,Bt,D,X,Y);
          case 0x88: return SmemPAMassApply2D<8,8,2>(NE,B,Bt,D,X,Y);
          case 0x99: return SmemPAMassApply2D<9,9,2>(NE,B,Bt,D,X,Y);
-         default:   return PAMassApply2D(NE,B,Bt,D,X,Y,D1D,Q1D);
+         default:
+            timer.Fallback();
+            return PAMassApply2D(NE,B,Bt,D,X,Y,D1D,Q1D);
       }
    }
    else if (dim == 3)
@@ -1203,15 +1349,33 @@ static void PAMassApply(const int dim,
          case 0x78: return SmemPAMassApply3D<7,8>(NE,B,Bt,D,X,Y);
          case 0x89: return SmemPAMassApply3D<8,9>(NE,B,Bt,D,X,Y);
          case 0x9A: return SmemPAMassApply3D<9,10>(NE,B,Bt,D,X,Y);
-         default:   return PAMassApply3D(NE,B,Bt,D,X,Y,D1D,Q1D);
+         default:
+            timer.Fallback();
+            return PAMassApply3D(NE,B,Bt,D,X,Y,D1D,Q1D);
       }
    }
    mfem::out << "Unknown kernel 0x" << std::hex << id << std::endl;
    MFEM_ABORT("Unknown kernel.");
 }
 
+// PA Mass Apply of NE elements of the same type, with the kernels of the
+// basis matrices in maps
+static void PAMassApply(const int dim, const int NE,
+                        const DofToQuad &maps,
+                        const Vector &D,
+                        const Vector &X,
+                        Vector &Y)
+{
+   if (maps.mode == DofToQuad::FULL)
+   {
+      return PAMassApplyFull(dim, NE, maps.ndof, maps.nqpt, maps.Bt, D, X, Y);
+   }
+   PAMassApply(dim, maps.ndof, maps.nqpt, NE, maps.B, maps.Bt, D, X, Y);
+}
+
 void MassIntegrator::AddMultPA(const Vector &x, Vector &y) const
 {
+   if (patch_pa) { patch_pa->AddMult(x, y); return; }
 #ifdef MFEM_USE_CEED
    if (DeviceCanUseCeed())
    {
@@ -1220,7 +1384,445 @@ void MassIntegrator::AddMultPA(const Vector &x, Vector &y) const
    else
 #endif
    {
-      PAMassApply(dim, dofs1D, quad1D, ne, maps->B, maps->Bt, pa_data, x, y);
+      if (batches.Size() == 0)
+      {
+         PAMassApply(dim, ne, *maps, pa_data, x, y);
+      }
+      // One launch per element type, on the ranges of the E-vectors
+      for (int b = 0; b < batches.Size(); b++)
+      {
+         const PAGeometryBatch &batch = *batches[b];
+         const int NE = batch.elements.Size();
+         Vector x_b, y_b;
+         x_b.MakeRef(const_cast<Vector&>(x), batch.offset, batch.ndof*NE);
+         y_b.MakeRef(y, batch.offset, batch.ndof*NE);
+         PAMassApply(dim, NE, *batch.maps, batch.pa_data, x_b, y_b);
+      }
+   }
+}
+
+// Fused complex PA Mass Apply 2D kernel: with the real and imaginary parts of
+// the coefficient in Dr and Di, add Dr x_r - Di x_i to y_r and Dr x_i + Di x_r
+// to y_i. Both parts of x are interpolated in the same sweep, so B and Bt are
+// read once per element for the two real operators.
+template<int T_D1D = 0, int T_Q1D = 0>
+static void PAMassApplyComplex2D(const int NE,
+                                 const Array<double> &b_,
+                                 const Array<double> &bt_,
+                                 const Vector &dr_,
+                                 const Vector &di_,
+                                 const Vector &xr_,
+                                 const Vector &xi_,
+                                 Vector &yr_,
+                                 Vector &yi_,
+                                 const int d1d = 0,
+                                 const int q1d = 0)
+{
+   const int D1D = T_D1D ? T_D1D : d1d;
+   const int Q1D = T_Q1D ? T_Q1D : q1d;
+   MFEM_VERIFY(D1D <= MAX_D1D, "");
+   MFEM_VERIFY(Q1D <= MAX_Q1D, "");
+   auto B = Reshape(b_.Read(), Q1D, D1D);
+   auto Bt = Reshape(bt_.Read(), D1D, Q1D);
+   auto Dr = Reshape(dr_.Read(), Q1D, Q1D, NE);
+   auto Di = Reshape(di_.Read(), Q1D, Q1D, NE);
+   auto Xr = Reshape(xr_.Read(), D1D, D1D, NE);
+   auto Xi = Reshape(xi_.Read(), D1D, D1D, NE);
+   auto Yr = Reshape(yr_.ReadWrite(), D1D, D1D, NE);
+   auto Yi = Reshape(yi_.ReadWrite(), D1D, D1D, NE);
+   MFEM_FORALL(e, NE,
+   {
+      const int D1D = T_D1D ? T_D1D : d1d; // nvcc workaround
+      const int Q1D = T_Q1D ? T_Q1D : q1d;
+      constexpr int max_D1D = T_D1D ? T_D1D : MAX_D1D;
+      constexpr int max_Q1D = T_Q1D ? T_Q1D : MAX_Q1D;
+      double sol_xy[2][max_Q1D][max_Q1D];
+      for (int qy = 0; qy < Q1D; ++qy)
+      {
+         for (int qx = 0; qx < Q1D; ++qx)
+         {
+            sol_xy[0][qy][qx] = 0.0;
+            sol_xy[1][qy][qx] = 0.0;
+         }
+      }
+      for (int dy = 0; dy < D1D; ++dy)
+      {
+         double sol_x[2][max_Q1D];
+         for (int qx = 0; qx < Q1D; ++qx)
+         {
+            sol_x[0][qx] = 0.0;
+            sol_x[1][qx] = 0.0;
+         }
+         for (int dx = 0; dx < D1D; ++dx)
+         {
+            const double sr = Xr(dx,dy,e);
+            const double si = Xi(dx,dy,e);
+            for (int qx = 0; qx < Q1D; ++qx)
+            {
+               sol_x[0][qx] += B(qx,dx) * sr;
+               sol_x[1][qx] += B(qx,dx) * si;
+            }
+         }
+         for (int qy = 0; qy < Q1D; ++qy)
+         {
+            const double d2q = B(qy,dy);
+            for (int qx = 0; qx < Q1D; ++qx)
+            {
+               sol_xy[0][qy][qx] += d2q * sol_x[0][qx];
+               sol_xy[1][qy][qx] += d2q * sol_x[1][qx];
+            }
+         }
+      }
+      for (int qy = 0; qy < Q1D; ++qy)
+      {
+         for (int qx = 0; qx < Q1D; ++qx)
+         {
+            const double dr = Dr(qx,qy,e);
+            const double di = Di(qx,qy,e);
+            const double ur = sol_xy[0][qy][qx];
+            const double ui = sol_xy[1][qy][qx];
+            sol_xy[0][qy][qx] = dr * ur - di * ui;
+            sol_xy[1][qy][qx] = dr * ui + di * ur;
+         }
+      }
+      for (int qy = 0; qy < Q1D; ++qy)
+      {
+         double sol_x[2][max_D1D];
+         for (int dx = 0; dx < D1D; ++dx)
+         {
+            sol_x[0][dx] = 0.0;
+            sol_x[1][dx] = 0.0;
+         }
+         for (int qx = 0; qx < Q1D; ++qx)
+         {
+            const double sr = sol_xy[0][qy][qx];
+            const double si = sol_xy[1][qy][qx];
+            for (int dx = 0; dx < D1D; ++dx)
+            {
+               sol_x[0][dx] += Bt(dx,qx) * sr;
+               sol_x[1][dx] += Bt(dx,qx) * si;
+            }
+         }
+         for (int dy = 0; dy < D1D; ++dy)
+         {
+            const double q2d = Bt(dy,qy);
+            for (int dx = 0; dx < D1D; ++dx)
+            {
+               Yr(dx,dy,e) += q2d * sol_x[0][dx];
+               Yi(dx,dy,e) += q2d * sol_x[1][dx];
+            }
+         }
+      }
+   });
+}
+
+// Fused complex PA Mass Apply 3D kernel, see PAMassApplyComplex2D.
+template<int T_D1D = 0, int T_Q1D = 0>
+static void PAMassApplyComplex3D(const int NE,
+                                 const Array<double> &b_,
+                                 const Array<double> &bt_,
+                                 const Vector &dr_,
+                                 const Vector &di_,
+                                 const Vector &xr_,
+                                 const Vector &xi_,
+                                 Vector &yr_,
+                                 Vector &yi_,
+                                 const int d1d = 0,
+                                 const int q1d = 0)
+{
+   const int D1D = T_D1D ? T_D1D : d1d;
+   const int Q1D = T_Q1D ? T_Q1D : q1d;
+   MFEM_VERIFY(D1D <= MAX_D1D, "");
+   MFEM_VERIFY(Q1D <= MAX_Q1D, "");
+   auto B = Reshape(b_.Read(), Q1D, D1D);
+   auto Bt = Reshape(bt_.Read(), D1D, Q1D);
+   auto Dr = Reshape(dr_.Read(), Q1D, Q1D, Q1D, NE);
+   auto Di = Reshape(di_.Read(), Q1D, Q1D, Q1D, NE);
+   auto Xr = Reshape(xr_.Read(), D1D, D1D, D1D, NE);
+   auto Xi = Reshape(xi_.Read(), D1D, D1D, D1D, NE);
+   auto Yr = Reshape(yr_.ReadWrite(), D1D, D1D, D1D, NE);
+   auto Yi = Reshape(yi_.ReadWrite(), D1D, D1D, D1D, NE);
+   MFEM_FORALL(e, NE,
+   {
+      const int D1D = T_D1D ? T_D1D : d1d;
+      const int Q1D = T_Q1D ? T_Q1D : q1d;
+      constexpr int max_D1D = T_D1D ? T_D1D : MAX_D1D;
+      constexpr int max_Q1D = T_Q1D ? T_Q1D : MAX_Q1D;
+      double sol_xyz[2][max_Q1D][max_Q1D][max_Q1D];
+      for (int qz = 0; qz < Q1D; ++qz)
+      {
+         for (int qy = 0; qy < Q1D; ++qy)
+         {
+            for (int qx = 0; qx < Q1D; ++qx)
+            {
+               sol_xyz[0][qz][qy][qx] = 0.0;
+               sol_xyz[1][qz][qy][qx] = 0.0;
+            }
+         }
+      }
+      for (int dz = 0; dz < D1D; ++dz)
+      {
+         double sol_xy[2][max_Q1D][max_Q1D];
+         for (int qy = 0; qy < Q1D; ++qy)
+         {
+            for (int qx = 0; qx < Q1D; ++qx)
+            {
+               sol_xy[0][qy][qx] = 0.0;
+               sol_xy[1][qy][qx] = 0.0;
+            }
+         }
+         for (int dy = 0; dy < D1D; ++dy)
+         {
+            double sol_x[2][max_Q1D];
+            for (int qx = 0; qx < Q1D; ++qx)
+            {
+               sol_x[0][qx] = 0.0;
+               sol_x[1][qx] = 0.0;
+            }
+            for (int dx = 0; dx < D1D; ++dx)
+            {
+               const double sr = Xr(dx,dy,dz,e);
+               const double si = Xi(dx,dy,dz,e);
+               for (int qx = 0; qx < Q1D; ++qx)
+               {
+                  sol_x[0][qx] += B(qx,dx) * sr;
+                  sol_x[1][qx] += B(qx,dx) * si;
+               }
+            }
+            for (int qy = 0; qy < Q1D; ++qy)
+            {
+               const double wy = B(qy,dy);
+               for (int qx = 0; qx < Q1D; ++qx)
+               {
+                  sol_xy[0][qy][qx] += wy * sol_x[0][qx];
+                  sol_xy[1][qy][qx] += wy * sol_x[1][qx];
+               }
+            }
+         }
+         for (int qz = 0; qz < Q1D; ++qz)
+         {
+            const double wz = B(qz,dz);
+            for (int qy = 0; qy < Q1D; ++qy)
+            {
+               for (int qx = 0; qx < Q1D; ++qx)
+               {
+                  sol_xyz[0][qz][qy][qx] += wz * sol_xy[0][qy][qx];
+                  sol_xyz[1][qz][qy][qx] += wz * sol_xy[1][qy][qx];
+               }
+            }
+         }
+      }
+      for (int qz = 0; qz < Q1D; ++qz)
+      {
+         for (int qy = 0; qy < Q1D; ++qy)
+         {
+            for (int qx = 0; qx < Q1D; ++qx)
+            {
+               const double dr = Dr(qx,qy,qz,e);
+               const double di = Di(qx,qy,qz,e);
+               const double ur = sol_xyz[0][qz][qy][qx];
+               const double ui = sol_xyz[1][qz][qy][qx];
+               sol_xyz[0][qz][qy][qx] = dr * ur - di * ui;
+               sol_xyz[1][qz][qy][qx] = dr * ui + di * ur;
+            }
+         }
+      }
+      for (int qz = 0; qz < Q1D; ++qz)
+      {
+         double sol_xy[2][max_D1D][max_D1D];
+         for (int dy = 0; dy < D1D; ++dy)
+         {
+            for (int dx = 0; dx < D1D; ++dx)
+            {
+               sol_xy[0][dy][dx] = 0.0;
+               sol_xy[1][dy][dx] = 0.0;
+            }
+         }
+         for (int qy = 0; qy < Q1D; ++qy)
+         {
+            double sol_x[2][max_D1D];
+            for (int dx = 0; dx < D1D; ++dx)
+            {
+               sol_x[0][dx] = 0.0;
+               sol_x[1][dx] = 0.0;
+            }
+            for (int qx = 0; qx < Q1D; ++qx)
+            {
+               const double sr = sol_xyz[0][qz][qy][qx];
+               const double si = sol_xyz[1][qz][qy][qx];
+               for (int dx = 0; dx < D1D; ++dx)
+               {
+                  sol_x[0][dx] += Bt(dx,qx) * sr;
+                  sol_x[1][dx] += Bt(dx,qx) * si;
+               }
+            }
+            for (int dy = 0; dy < D1D; ++dy)
+            {
+               const double wy = Bt(dy,qy);
+               for (int dx = 0; dx < D1D; ++dx)
+               {
+                  sol_xy[0][dy][dx] += wy * sol_x[0][dx];
+                  sol_xy[1][dy][dx] += wy * sol_x[1][dx];
+               }
+            }
+         }
+         for (int dz = 0; dz < D1D; ++dz)
+         {
+            const double wz = Bt(dz,qz);
+            for (int dy = 0; dy < D1D; ++dy)
+            {
+               for (int dx = 0; dx < D1D; ++dx)
+               {
+                  Yr(dx,dy,dz,e) += wz * sol_xy[0][dy][dx];
+                  Yi(dx,dy,dz,e) += wz * sol_xy[1][dy][dx];
+               }
+            }
+         }
+      }
+   });
+}
+
+// Fused complex PA Mass Apply for non-tensor elements, see PAMassApplyFull
+// and PAMassApplyComplex2D.
+static void PAMassApplyComplexFull(const int NE, const int ND, const int NQ,
+                                   const Array<double> &bt,
+                                   const Vector &dr_, const Vector &di_,
+                                   const Vector &xr_, const Vector &xi_,
+                                   Vector &yr_, Vector &yi_)
+{
+   auto Bt = Reshape(bt.Read(), ND, NQ);
+   auto Dr = Reshape(dr_.Read(), NQ, NE);
+   auto Di = Reshape(di_.Read(), NQ, NE);
+   auto Xr = Reshape(xr_.Read(), ND, NE);
+   auto Xi = Reshape(xi_.Read(), ND, NE);
+   auto Yr = Reshape(yr_.ReadWrite(), ND, NE);
+   auto Yi = Reshape(yi_.ReadWrite(), ND, NE);
+   MFEM_FORALL(e, NE,
+   {
+      for (int q = 0; q < NQ; ++q)
+      {
+         double ur = 0.0, ui = 0.0;
+         for (int i = 0; i < ND; ++i)
+         {
+            ur += Bt(i,q) * Xr(i,e);
+            ui += Bt(i,q) * Xi(i,e);
+         }
+         const double dr = Dr(q,e);
+         const double di = Di(q,e);
+         const double vr = dr * ur - di * ui;
+         const double vi = dr * ui + di * ur;
+         for (int i = 0; i < ND; ++i)
+         {
+            Yr(i,e) += Bt(i,q) * vr;
+            Yi(i,e) += Bt(i,q) * vi;
+         }
+      }
+   });
+}
+
+// Fused complex PA Mass Apply of NE elements of the same type
+static void PAMassApplyComplex(const int dim, const int NE,
+                               const DofToQuad &maps,
+                               const Vector &Dr, const Vector &Di,
+                               const Vector &Xr, const Vector &Xi,
+                               Vector &Yr, Vector &Yi)
+{
+   const int ND = maps.ndof, NQ = maps.nqpt;
+   if (maps.mode == DofToQuad::FULL)
+   {
+      const double bytes = NE*sizeof(double)*(6.0*ND + 2.0*NQ);
+      const double flops = NE*(8.0*ND*NQ + 6.0*NQ);
+      KernelTimer timer("MassIntegrator::AddMultComplexPA (full)", dim, ND, NQ,
+                        bytes, flops);
+      return PAMassApplyComplexFull(NE, ND, NQ, maps.Bt, Dr, Di, Xr, Xi,
+                                    Yr, Yi);
+   }
+   // Twice the traffic of the real kernel for the E-vectors, and twice its
+   // flops for the contractions, but B, Bt and the geometric data are read
+   // once.
+   const double D1 = ND, Q1 = NQ;
+   const double bytes = NE*sizeof(double)*(6*pow(D1,dim) + 2*pow(Q1,dim));
+   const double flops = NE*((dim == 2) ? 8*(D1*D1*Q1 + D1*Q1*Q1) + 6*Q1*Q1 :
+                            8*(D1*D1*D1*Q1 + D1*D1*Q1*Q1 + D1*Q1*Q1*Q1) +
+                            6*Q1*Q1*Q1);
+   KernelTimer timer("MassIntegrator::AddMultComplexPA", dim, ND, NQ, bytes,
+                     flops);
+   const Array<double> &B = maps.B, &Bt = maps.Bt;
+   const int id = (ND << 4) | NQ;
+   if (dim == 2)
+   {
+      switch (id)
+      {
+         case 0x22: return PAMassApplyComplex2D<2,2>(NE,B,Bt,Dr,Di,Xr,Xi,Yr,Yi);
+         case 0x33: return PAMassApplyComplex2D<3,3>(NE,B,Bt,Dr,Di,Xr,Xi,Yr,Yi);
+         case 0x44: return PAMassApplyComplex2D<4,4>(NE,B,Bt,Dr,Di,Xr,Xi,Yr,Yi);
+         case 0x55: return PAMassApplyComplex2D<5,5>(NE,B,Bt,Dr,Di,Xr,Xi,Yr,Yi);
+         case 0x66: return PAMassApplyComplex2D<6,6>(NE,B,Bt,Dr,Di,Xr,Xi,Yr,Yi);
+         default:
+            timer.Fallback();
+            return PAMassApplyComplex2D(NE,B,Bt,Dr,Di,Xr,Xi,Yr,Yi,ND,NQ);
+      }
+   }
+   else if (dim == 3)
+   {
+      switch (id)
+      {
+         case 0x23: return PAMassApplyComplex3D<2,3>(NE,B,Bt,Dr,Di,Xr,Xi,Yr,Yi);
+         case 0x34: return PAMassApplyComplex3D<3,4>(NE,B,Bt,Dr,Di,Xr,Xi,Yr,Yi);
+         case 0x45: return PAMassApplyComplex3D<4,5>(NE,B,Bt,Dr,Di,Xr,Xi,Yr,Yi);
+         case 0x56: return PAMassApplyComplex3D<5,6>(NE,B,Bt,Dr,Di,Xr,Xi,Yr,Yi);
+         default:
+            timer.Fallback();
+            return PAMassApplyComplex3D(NE,B,Bt,Dr,Di,Xr,Xi,Yr,Yi,ND,NQ);
+      }
+   }
+   mfem::out << "Unknown kernel 0x" << std::hex << id << std::endl;
+   MFEM_ABORT("Unknown kernel.");
+}
+
+bool MassIntegrator::SupportsComplexPA(const BilinearFormIntegrator &imag)
+const
+{
+   const MassIntegrator *mi = dynamic_cast<const MassIntegrator*>(&imag);
+   if (!mi || patch_pa || mi->patch_pa) { return false; }
+#ifdef MFEM_USE_CEED
+   if (DeviceCanUseCeed()) { return false; }
+#endif
+   if (batches.Size() != mi->batches.Size()) { return false; }
+   if (batches.Size() == 0)
+   {
+      return maps && maps == mi->maps && ne == mi->ne && (dim == 2 || dim == 3);
+   }
+   for (int b = 0; b < batches.Size(); b++)
+   {
+      if (batches[b]->maps != mi->batches[b]->maps ||
+          batches[b]->offset != mi->batches[b]->offset) { return false; }
+   }
+   return true;
+}
+
+void MassIntegrator::AddMultComplexPA(const BilinearFormIntegrator &imag,
+                                      const Vector &x_r, const Vector &x_i,
+                                      Vector &y_r, Vector &y_i) const
+{
+   MFEM_ASSERT(SupportsComplexPA(imag), "incompatible integrators");
+   const MassIntegrator &mi = static_cast<const MassIntegrator&>(imag);
+   if (batches.Size() == 0)
+   {
+      return PAMassApplyComplex(dim, ne, *maps, pa_data, mi.pa_data,
+                                x_r, x_i, y_r, y_i);
+   }
+   for (int b = 0; b < batches.Size(); b++)
+   {
+      const PAGeometryBatch &batch = *batches[b];
+      const int NE = batch.elements.Size(), size = batch.ndof*NE;
+      Vector xr_b, xi_b, yr_b, yi_b;
+      xr_b.MakeRef(const_cast<Vector&>(x_r), batch.offset, size);
+      xi_b.MakeRef(const_cast<Vector&>(x_i), batch.offset, size);
+      yr_b.MakeRef(y_r, batch.offset, size);
+      yi_b.MakeRef(y_i, batch.offset, size);
+      PAMassApplyComplex(dim, NE, *batch.maps, batch.pa_data,
+                         mi.batches[b]->pa_data, xr_b, xi_b, yr_b, yi_b);
    }
 }
 
@@ -69,6 +69,34 @@ void PAHcurlMassApply3D(const int D1D,
                         const Vector &_x,
                         Vector &_y);
 
+void PAHcurlMassApplyComplex2D(const int D1D,
+                               const int Q1D,
+                               const int NE,
+                               const Array<double> &_Bo,
+                               const Array<double> &_Bc,
+                               const Array<double> &_Bot,
+                               const Array<double> &_Bct,
+                               const Vector &_opr,
+                               const Vector &_opi,
+                               const Vector &_xr,
+                               const Vector &_xi,
+                               Vector &_yr,
+                               Vector &_yi);
+
+void PAHcurlMassApplyComplex3D(const int D1D,
+                               const int Q1D,
+                               const int NE,
+                               const Array<double> &_Bo,
+                               const Array<double> &_Bc,
+                               const Array<double> &_Bot,
+                               const Array<double> &_Bct,
+                               const Vector &_opr,
+                               const Vector &_opi,
+                               const Vector &_xr,
+                               const Vector &_xi,
+                               Vector &_yr,
+                               Vector &_yi);
+
 void PAHdivSetup2D(const int Q1D,
                    const int NE,
                    const Array<double> &w,
@@ -313,6 +341,37 @@ void VectorFEMassIntegrator::AddMultPA(const Vector &x, Vector &y) const
    }
 }
 
+bool VectorFEMassIntegrator::SupportsComplexPA(
+   const BilinearFormIntegrator &imag) const
+{
+   const VectorFEMassIntegrator *vi =
+      dynamic_cast<const VectorFEMassIntegrator*>(&imag);
+   return vi && fetype == mfem::FiniteElement::CURL && vi->fetype == fetype &&
+          mapsC && vi->mapsC == mapsC && vi->mapsO == mapsO && vi->ne == ne &&
+          vi->pa_data.Size() == pa_data.Size();
+}
+
+void VectorFEMassIntegrator::AddMultComplexPA(
+   const BilinearFormIntegrator &imag, const Vector &x_r, const Vector &x_i,
+   Vector &y_r, Vector &y_i) const
+{
+   MFEM_ASSERT(SupportsComplexPA(imag), "incompatible integrators");
+   const Vector &pa_data_i =
+      static_cast<const VectorFEMassIntegrator&>(imag).pa_data;
+   if (dim == 3)
+   {
+      PAHcurlMassApplyComplex3D(dofs1D, quad1D, ne, mapsO->B, mapsC->B,
+                                mapsO->Bt, mapsC->Bt, pa_data, pa_data_i,
+                                x_r, x_i, y_r, y_i);
+   }
+   else
+   {
+      PAHcurlMassApplyComplex2D(dofs1D, quad1D, ne, mapsO->B, mapsC->B,
+                                mapsO->Bt, mapsC->Bt, pa_data, pa_data_i,
+                                x_r, x_i, y_r, y_i);
+   }
+}
+
 void MixedVectorGradientIntegrator::AssemblePA(const FiniteElementSpace
                                                &trial_fes,
                                                const FiniteElementSpace &test_fes)
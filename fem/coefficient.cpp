@@ -21,6 +21,31 @@ namespace mfem
 
 using namespace std;
 
+void Coefficient::BatchEval(Vector &qvals, Mesh &mesh,
+                            const IntegrationRule &ir, const Vector &X)
+{
+   const int nq = ir.GetNPoints(), ne = mesh.GetNE();
+   qvals.SetSize(nq*ne);
+   qvals.HostWrite();
+   for (int e = 0; e < ne; e++)
+   {
+      ElementTransformation *T = mesh.GetElementTransformation(e);
+      for (int q = 0; q < nq; q++)
+      {
+         const IntegrationPoint &ip = ir.IntPoint(q);
+         T->SetIntPoint(&ip);
+         qvals(q + nq*e) = Eval(*T, ip);
+      }
+   }
+}
+
+void ConstantCoefficient::BatchEval(Vector &qvals, Mesh &mesh,
+                                    const IntegrationRule &ir, const Vector &X)
+{
+   qvals.SetSize(ir.GetNPoints()*mesh.GetNE());
+   qvals = constant;
+}
+
 double PWConstCoefficient::Eval(ElementTransformation & T,
                                 const IntegrationPoint & ip)
 {
@@ -46,6 +71,26 @@ double FunctionCoefficient::Eval(ElementTransformation & T,
    }
 }
 
+void FunctionCoefficient::BatchEval(Vector &qvals, Mesh &mesh,
+                                    const IntegrationRule &ir, const Vector &X)
+{
+   const int nq = ir.GetNPoints(), ne = mesh.GetNE();
+   const int sdim = mesh.SpaceDimension();
+   const double *d_X = X.HostRead();
+   qvals.SetSize(nq*ne);
+   double *d_q = qvals.HostWrite();
+   Vector x(sdim);
+   for (int e = 0; e < ne; e++)
+   {
+      for (int q = 0; q < nq; q++)
+      {
+         for (int d = 0; d < sdim; d++) { x(d) = d_X[q + nq*(d + sdim*e)]; }
+         d_q[q + nq*e] = Function ? (*Function)(x) :
+                         (*TDFunction)(x, GetTime());
+      }
+   }
+}
+
 double GridFunctionCoefficient::Eval (ElementTransformation &T,
                                       const IntegrationPoint &ip)
 {
@@ -124,6 +169,62 @@ void VectorFunctionCoefficient::Eval(Vector &V, ElementTransformation &T,
    }
 }
 
+void VectorCoefficient::BatchEval(Vector &qvals, Mesh &mesh,
+                                  const IntegrationRule &ir, const Vector &X)
+{
+   const int nq = ir.GetNPoints(), ne = mesh.GetNE();
+   qvals.SetSize(nq*vdim*ne);
+   qvals.HostWrite();
+   DenseMatrix M;
+   for (int e = 0; e < ne; e++)
+   {
+      ElementTransformation *T = mesh.GetElementTransformation(e);
+      Eval(M, *T, ir);
+      for (int d = 0; d < vdim; d++)
+      {
+         for (int q = 0; q < nq; q++) { qvals(q + nq*(d + vdim*e)) = M(d,q); }
+      }
+   }
+}
+
+void VectorFunctionCoefficient::BatchEval(Vector &qvals, Mesh &mesh,
+                                          const IntegrationRule &ir,
+                                          const Vector &X)
+{
+   const int nq = ir.GetNPoints(), ne = mesh.GetNE();
+   const int sdim = mesh.SpaceDimension();
+   const double *d_X = X.HostRead();
+   qvals.SetSize(nq*vdim*ne);
+   double *d_q = qvals.HostWrite();
+   Vector x(sdim), V(vdim);
+   for (int e = 0; e < ne; e++)
+   {
+      for (int q = 0; q < nq; q++)
+      {
+         for (int d = 0; d < sdim; d++) { x(d) = d_X[q + nq*(d + sdim*e)]; }
+         if (Function) { (*Function)(x, V); }
+         else { (*TDFunction)(x, GetTime(), V); }
+         for (int d = 0; d < vdim; d++) { d_q[q + nq*(d + vdim*e)] = V(d); }
+      }
+   }
+   if (Q)
+   {
+      Vector qq;
+      Q->SetTime(GetTime());
+      Q->BatchEval(qq, mesh, ir, X);
+      for (int e = 0; e < ne; e++)
+      {
+         for (int d = 0; d < vdim; d++)
+         {
+            for (int q = 0; q < nq; q++)
+            {
+               d_q[q + nq*(d + vdim*e)] *= qq(q + nq*e);
+            }
+         }
+      }
+   }
+}
+
 VectorArrayCoefficient::VectorArrayCoefficient (int dim)
    : VectorCoefficient(dim), Coeff(dim), ownCoeff(dim)
 {
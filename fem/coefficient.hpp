@@ -68,6 +68,16 @@ public:
       return Eval(T, ip);
    }
 
+   /** @brief Evaluate the coefficient at the points of @a ir in all elements
+       of @a mesh, storing the result in @a qvals (of size NQ x NE). */
+   /** The physical coordinates of the points are given in @a X, with the
+       layout of GeometricFactors::X. The general implementation provided by
+       the base class calls Eval() with the element transformations of
+       @a mesh, coefficients that only depend on the coordinates overload it
+       to avoid setting up the transformations. */
+   virtual void BatchEval(Vector &qvals, Mesh &mesh, const IntegrationRule &ir,
+                          const Vector &X);
+
    virtual ~Coefficient() { }
 };
 
@@ -85,6 +95,9 @@ public:
    virtual double Eval(ElementTransformation &T,
                        const IntegrationPoint &ip)
    { return (constant); }
+
+   virtual void BatchEval(Vector &qvals, Mesh &mesh, const IntegrationRule &ir,
+                          const Vector &X);
 };
 
 /** @brief A piecewise constant coefficient with the constants keyed
@@ -167,6 +180,10 @@ public:
    /// Evaluate the coefficient at @a ip.
    virtual double Eval(ElementTransformation &T,
                        const IntegrationPoint &ip);
+
+   /// Evaluate the function at the given physical coordinates, see Coefficient.
+   virtual void BatchEval(Vector &qvals, Mesh &mesh, const IntegrationRule &ir,
+                          const Vector &X);
 };
 
 class GridFunction;
@@ -382,6 +399,14 @@ public:
    virtual void Eval(DenseMatrix &M, ElementTransformation &T,
                      const IntegrationRule &ir);
 
+   /** @brief Evaluate the vector coefficient at the points of @a ir in all
+       elements of @a mesh, storing the result in @a qvals (of size NQ x VDIM
+       x NE). */
+   /** The physical coordinates of the points are given in @a X, with the
+       layout of GeometricFactors::X, see Coefficient::BatchEval(). */
+   virtual void BatchEval(Vector &qvals, Mesh &mesh, const IntegrationRule &ir,
+                          const Vector &X);
+
    virtual ~VectorCoefficient() { }
 };
 
@@ -438,6 +463,10 @@ public:
    virtual void Eval(Vector &V, ElementTransformation &T,
                      const IntegrationPoint &ip);
 
+   /// Evaluate the function at the given physical coordinates, see Coefficient.
+   virtual void BatchEval(Vector &qvals, Mesh &mesh, const IntegrationRule &ir,
+                          const Vector &X);
+
    virtual ~VectorFunctionCoefficient() { }
 };
 
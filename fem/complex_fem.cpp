@@ -10,6 +10,7 @@
 // CONTRIBUTING.md for details.
 
 #include "complex_fem.hpp"
+#include "../general/forall.hpp"
 
 using namespace std;
 
@@ -239,6 +240,199 @@ bool SesquilinearForm::ImagInteg()
    return (nint != 0);
 }
 
+bool PAComplexOperator::Supports(BilinearForm *bfr, BilinearForm *bfi)
+{
+   if ((!bfr && !bfi) || DeviceCanUseCeed()) { return false; }
+   if (bfr && bfi && bfr->FESpace() != bfi->FESpace()) { return false; }
+   for (BilinearForm *a : { bfr, bfi })
+   {
+      if (a && (a->GetAssemblyLevel() != AssemblyLevel::PARTIAL ||
+                a->GetBBFI()->Size() || a->GetFBFI()->Size() ||
+                a->GetBFBFI()->Size()))
+      {
+         return false;
+      }
+   }
+   return true;
+}
+
+PAComplexOperator::PAComplexOperator(BilinearForm *bfr, BilinearForm *bfi,
+                                     Operator *Op_Real, Operator *Op_Imag,
+                                     bool ownReal, bool ownImag,
+                                     Convention convention,
+                                     const Array<int> &ess_tdofs)
+   : ComplexOperator(Op_Real, Op_Imag, ownReal, ownImag, convention),
+     a_r(bfr), a_i(bfi), ess_tdof_list(ess_tdofs)
+{
+   MFEM_VERIFY(Supports(bfr, bfi), "unsupported forms");
+   FiniteElementSpace &fes = *(bfr ? bfr : bfi)->FESpace();
+
+   // Pair each real integrator with the first unused imaginary integrator
+   // that it can be fused with.
+   Array<BilinearFormIntegrator*> no_integs;
+   Array<BilinearFormIntegrator*> &integs_r = bfr ? *bfr->GetDBFI() : no_integs;
+   Array<BilinearFormIntegrator*> &integs_i = bfi ? *bfi->GetDBFI() : no_integs;
+   Array<bool> used_i(integs_i.Size());
+   used_i = false;
+   for (int k = 0; k < integs_r.Size(); k++)
+   {
+      int j = 0;
+      while (j < integs_i.Size() &&
+             (used_i[j] || !integs_r[k]->SupportsComplexPA(*integs_i[j])))
+      {
+         j++;
+      }
+      if (j < integs_i.Size())
+      {
+         fused_r.Append(k);
+         fused_i.Append(j);
+         used_i[j] = true;
+      }
+      else { single_r.Append(k); }
+   }
+   for (int j = 0; j < integs_i.Size(); j++)
+   {
+      if (!used_i[j]) { single_i.Append(j); }
+   }
+
+   // Same element restriction as in PABilinearFormExtension
+   const Mesh &mesh = *fes.GetMesh();
+   const bool mixed = mesh.GetNumGeometries(mesh.Dimension()) > 1;
+   ElementDofOrdering ordering = (mixed || UsesTensorBasis(fes)) ?
+                                 ElementDofOrdering::LEXICOGRAPHIC :
+                                 ElementDofOrdering::NATIVE;
+   elem_restrict = fes.GetNURBSext() ? NULL :
+                   fes.GetElementRestriction(ordering);
+
+   const MemoryType mt = Device::GetDeviceMemoryType();
+   const int lsize = fes.GetVSize();
+   const int esize = elem_restrict ? elem_restrict->Height() : lsize;
+   tx.SetSize(width / 2, mt);
+   for (Vector *v : { &lx_r, &lx_i, &ly_r, &ly_i }) { v->SetSize(lsize, mt); }
+   for (Vector *v : { &ex_r, &ex_i, &ey_r, &ey_i }) { v->SetSize(esize, mt); }
+   for (Vector *v : { &tx, &lx_r, &lx_i, &ex_r, &ex_i, &ey_r, &ey_i,
+                      &ly_r, &ly_i })
+   {
+      v->UseDevice(true);
+   }
+}
+
+void PAComplexOperator::Mult(const Vector &x, Vector &y) const
+{
+   // Entries of the constrained rows of the real and imaginary parts, see
+   // ConstrainedOperator::Mult(). Fall back to the generic action if they
+   // are not known.
+   double diag[2] = { 0.0, 0.0 };
+   const Operator *parts[2] = { Op_Real_, Op_Imag_ };
+   for (int p = 0; p < 2; p++)
+   {
+      if (!parts[p]) { continue; }
+      const ConstrainedOperator *c =
+         dynamic_cast<const ConstrainedOperator*>(parts[p]);
+      if (!c || c->GetDiagonalPolicy() == Operator::DIAG_KEEP)
+      {
+         return ComplexOperator::Mult(x, y);
+      }
+      diag[p] = (c->GetDiagonalPolicy() == Operator::DIAG_ONE) ? 1.0 : 0.0;
+   }
+
+   const int n = width / 2;
+   Vector x_r, x_i, y_r, y_i;
+   x_r.MakeRef(const_cast<Vector&>(x), 0, n);
+   x_i.MakeRef(const_cast<Vector&>(x), n, n);
+   y_r.MakeRef(y, 0, n);
+   y_i.MakeRef(y, n, n);
+
+   // Prolongate and restrict the real and imaginary parts, with the
+   // essential dofs set to zero.
+   const Operator *P = (a_r ? a_r : a_i)->GetProlongation();
+   const int csz = ess_tdof_list.Size();
+   auto idx = ess_tdof_list.Read();
+   const Vector *xs[2] = { &x_r, &x_i };
+   Vector *lxs[2] = { &lx_r, &lx_i }, *exs[2] = { &ex_r, &ex_i };
+   for (int p = 0; p < 2; p++)
+   {
+      tx = *xs[p];
+      auto d_tx = tx.ReadWrite();
+      MFEM_FORALL(i, csz, d_tx[idx[i]] = 0.0;);
+      const Vector &lx = IsIdentityProlongation(P) ? tx : *lxs[p];
+      if (!IsIdentityProlongation(P)) { P->Mult(tx, *lxs[p]); }
+      if (elem_restrict) { elem_restrict->Mult(lx, *exs[p]); }
+      else { *exs[p] = lx; }
+   }
+
+   ey_r = 0.0;
+   ey_i = 0.0;
+   for (int k = 0; k < fused_r.Size(); k++)
+   {
+      const BilinearFormIntegrator &integ_i = *(*a_i->GetDBFI())[fused_i[k]];
+      (*a_r->GetDBFI())[fused_r[k]]->AddMultComplexPA(integ_i, ex_r, ex_i,
+                                                       ey_r, ey_i);
+   }
+   for (int k = 0; k < single_r.Size(); k++)
+   {
+      BilinearFormIntegrator *integ = (*a_r->GetDBFI())[single_r[k]];
+      integ->AddMultPA(ex_r, ey_r);
+      integ->AddMultPA(ex_i, ey_i);
+   }
+   if (single_i.Size())
+   {
+      // y_r -= A_i x_i, with the additive AddMultPA() on -y_r
+      ey_r.Neg();
+      for (int k = 0; k < single_i.Size(); k++)
+      {
+         BilinearFormIntegrator *integ = (*a_i->GetDBFI())[single_i[k]];
+         integ->AddMultPA(ex_i, ey_r);
+         integ->AddMultPA(ex_r, ey_i);
+      }
+      ey_r.Neg();
+   }
+
+   Vector *eys[2] = { &ey_r, &ey_i }, *lys[2] = { &ly_r, &ly_i };
+   Vector *ys[2] = { &y_r, &y_i };
+   for (int p = 0; p < 2; p++)
+   {
+      Vector &ly = IsIdentityProlongation(P) ? *ys[p] : *lys[p];
+      if (elem_restrict) { elem_restrict->MultTranspose(*eys[p], ly); }
+      else { ly = *eys[p]; }
+      if (!IsIdentityProlongation(P)) { P->MultTranspose(ly, *ys[p]); }
+   }
+
+   // Constrained rows: y_r = d_r x_r - d_i x_i, y_i = d_r x_i + d_i x_r
+   const double d_r = diag[0], d_i = diag[1];
+   auto d_xr = x_r.Read();
+   auto d_xi = x_i.Read();
+   auto d_yr = y_r.ReadWrite();
+   auto d_yi = y_i.ReadWrite();
+   MFEM_FORALL(i, csz,
+   {
+      const int id = idx[i];
+      d_yr[id] = d_r * d_xr[id] - d_i * d_xi[id];
+      d_yi[id] = d_r * d_xi[id] + d_i * d_xr[id];
+   });
+   if (convention_ == BLOCK_SYMMETRIC) { y_i.Neg(); }
+}
+
+// Return the ComplexOperator of the constrained operators A_r and A_i of the
+// forms bfr and bfi, NULL for empty parts, with the fused partially assembled
+// action when it is supported.
+static ComplexOperator *NewComplexOperator(BilinearForm *bfr,
+                                           BilinearForm *bfi,
+                                           OperatorHandle &A_r,
+                                           OperatorHandle &A_i,
+                                           ComplexOperator::Convention conv,
+                                           const Array<int> &ess_tdof_list)
+{
+   if (PAComplexOperator::Supports(bfr, bfi))
+   {
+      return new PAComplexOperator(bfr, bfi, A_r.Ptr(), A_i.Ptr(),
+                                   A_r.OwnsOperator(), A_i.OwnsOperator(),
+                                   conv, ess_tdof_list);
+   }
+   return new ComplexOperator(A_r.Ptr(), A_i.Ptr(), A_r.OwnsOperator(),
+                              A_i.OwnsOperator(), conv);
+}
+
 SesquilinearForm::SesquilinearForm(FiniteElementSpace *f,
                                    ComplexOperator::Convention convention)
    : conv(convention),
@@ -452,11 +646,9 @@ SesquilinearForm::FormLinearSystem(const Array<int> &ess_tdof_list,
    else
    {
       ComplexOperator * A_op =
-         new ComplexOperator(A_r.Ptr(),
-                             A_i.Ptr(),
-                             A_r.OwnsOperator(),
-                             A_i.OwnsOperator(),
-                             conv);
+         NewComplexOperator(RealInteg() ? blfr : NULL,
+                            ImagInteg() ? blfi : NULL,
+                            A_r, A_i, conv, ess_tdof_list);
       A.Reset<ComplexOperator>(A_op, true);
    }
    A_r.SetOperatorOwner(false);
@@ -513,17 +705,30 @@ SesquilinearForm::FormSystemMatrix(const Array<int> &ess_tdof_list,
    else
    {
       ComplexOperator * A_op =
-         new ComplexOperator(A_r.Ptr(),
-                             A_i.Ptr(),
-                             A_r.OwnsOperator(),
-                             A_i.OwnsOperator(),
-                             conv);
+         NewComplexOperator(RealInteg() ? blfr : NULL,
+                            ImagInteg() ? blfi : NULL,
+                            A_r, A_i, conv, ess_tdof_list);
       A.Reset<ComplexOperator>(A_op, true);
    }
    A_r.SetOperatorOwner(false);
    A_i.SetOperatorOwner(false);
 }
 
+void
+SesquilinearForm::AssembleDiagonal(Vector &diag)
+{
+   const int tvsize = blfr->FESpace()->GetTrueVSize();
+   diag.SetSize(2 * tvsize);
+   diag.UseDevice(true);
+   Vector diag_r, diag_i;
+   diag_r.MakeRef(diag, 0, tvsize);
+   diag_i.MakeRef(diag, tvsize, tvsize);
+   if (RealInteg()) { blfr->AssembleDiagonal(diag_r); }
+   else { diag_r = 0.0; }
+   if (ImagInteg()) { blfi->AssembleDiagonal(diag_i); }
+   else { diag_i = 0.0; }
+}
+
 void
 SesquilinearForm::RecoverFEMSolution(const Vector &X, const Vector &b,
                                      Vector &x)
@@ -1092,11 +1297,9 @@ ParSesquilinearForm::FormLinearSystem(const Array<int> &ess_tdof_list,
    else
    {
       ComplexOperator * A_op =
-         new ComplexOperator(A_r.As<Operator>(),
-                             A_i.As<Operator>(),
-                             A_r.OwnsOperator(),
-                             A_i.OwnsOperator(),
-                             conv);
+         NewComplexOperator(RealInteg() ? pblfr : NULL,
+                            ImagInteg() ? pblfi : NULL,
+                            A_r, A_i, conv, ess_tdof_list);
       A.Reset<ComplexOperator>(A_op, true);
    }
    A_r.SetOperatorOwner(false);
@@ -1160,17 +1363,30 @@ ParSesquilinearForm::FormSystemMatrix(const Array<int> &ess_tdof_list,
    else
    {
       ComplexOperator * A_op =
-         new ComplexOperator(A_r.As<Operator>(),
-                             A_i.As<Operator>(),
-                             A_r.OwnsOperator(),
-                             A_i.OwnsOperator(),
-                             conv);
+         NewComplexOperator(RealInteg() ? pblfr : NULL,
+                            ImagInteg() ? pblfi : NULL,
+                            A_r, A_i, conv, ess_tdof_list);
       A.Reset<ComplexOperator>(A_op, true);
    }
    A_r.SetOperatorOwner(false);
    A_i.SetOperatorOwner(false);
 }
 
+void
+ParSesquilinearForm::AssembleDiagonal(Vector &diag)
+{
+   const int tvsize = pblfr->FESpace()->GetTrueVSize();
+   diag.SetSize(2 * tvsize);
+   diag.UseDevice(true);
+   Vector diag_r, diag_i;
+   diag_r.MakeRef(diag, 0, tvsize);
+   diag_i.MakeRef(diag, tvsize, tvsize);
+   if (RealInteg()) { pblfr->AssembleDiagonal(diag_r); }
+   else { diag_r = 0.0; }
+   if (ImagInteg()) { pblfi->AssembleDiagonal(diag_i); }
+   else { diag_i = 0.0; }
+}
+
 void
 ParSesquilinearForm::RecoverFEMSolution(const Vector &X, const Vector &b,
                                         Vector &x)
@@ -167,6 +167,48 @@ public:
 };
 
 
+/** @brief Partially assembled complex operator A_r + i A_i on the true dofs,
+    applied in a single pass over the elements.
+
+    The generic ComplexOperator applies the constrained real and imaginary
+    operators four times, restricting and prolongating each input twice. This
+    class restricts the real and imaginary parts of the input to E-vectors once
+    and then applies each integrator of the real part together with a matching
+    integrator of the imaginary part, see
+    BilinearFormIntegrator::AddMultComplexPA(), so that the geometric data and
+    the basis matrices are read once for both coefficients. The remaining
+    integrators are applied to both E-vectors.
+
+    The parts given to the constructor are the constrained operators returned
+    by BilinearForm::FormSystemMatrix(), which are owned as in ComplexOperator
+    and are still used by MultTranspose() and by the real() and imag()
+    accessors. The essential dofs are treated as in those operators. */
+class PAComplexOperator : public ComplexOperator
+{
+protected:
+   BilinearForm *a_r, *a_i;
+   Array<int> ess_tdof_list;
+   /// Pairs of (real, imaginary) integrators applied with AddMultComplexPA()
+   Array<int> fused_r, fused_i;
+   /// Integrators applied alone
+   Array<int> single_r, single_i;
+   const Operator *elem_restrict;
+   mutable Vector tx, lx_r, lx_i, ex_r, ex_i, ey_r, ey_i, ly_r, ly_i;
+
+public:
+   /** @brief Return true if the partially assembled forms @a bfr and @a bfi,
+       either of which may be NULL for an empty part, can be applied with a
+       PAComplexOperator. */
+   static bool Supports(BilinearForm *bfr, BilinearForm *bfi);
+
+   PAComplexOperator(BilinearForm *bfr, BilinearForm *bfi,
+                     Operator *Op_Real, Operator *Op_Imag,
+                     bool ownReal, bool ownImag, Convention convention,
+                     const Array<int> &ess_tdof_list);
+
+   virtual void Mult(const Vector &x, Vector &y) const;
+};
+
 /** Class for sesquilinear form
 
     A sesquilinear form is a generalization of a bilinear form to complex-valued
@@ -291,6 +333,11 @@ public:
    void FormSystemMatrix(const Array<int> &ess_tdof_list,
                          OperatorHandle &A);
 
+   /** @brief Assemble the diagonal of the operator on the true dofs: the
+       real parts of the diagonal followed by its imaginary parts, of total
+       size twice the true vector size, see ComplexJacobiSmoother. */
+   void AssembleDiagonal(Vector &diag);
+
    /** Call this method after solving a linear system constructed using the
        FormLinearSystem method to recover the solution as a ParGridFunction-size
        vector in x. Use the same arguments as in the FormLinearSystem call. */
@@ -617,6 +664,11 @@ public:
    void FormSystemMatrix(const Array<int> &ess_tdof_list,
                          OperatorHandle &A);
 
+   /** @brief Assemble the diagonal of the operator on the true dofs: the
+       real parts of the diagonal followed by its imaginary parts, of total
+       size twice the true vector size, see ComplexJacobiSmoother. */
+   void AssembleDiagonal(Vector &diag);
+
    /** Call this method after solving a linear system constructed using the
        FormLinearSystem method to recover the solution as a ParGridFunction-size
        vector in x. Use the same arguments as in the FormLinearSystem call. */
@@ -34,12 +34,16 @@
 #include "tmop.hpp"
 #include "tmop_tools.hpp"
 #include "gslib.hpp"
+#include "pointlocator.hpp"
 #include "restriction.hpp"
 #include "quadinterpolator.hpp"
 #include "quadinterpolator_face.hpp"
 #include "transfer.hpp"
 #include "fespacehierarchy.hpp"
 #include "multigrid.hpp"
+#include "lor.hpp"
+#include "auxiliary.hpp"
+#include "nurbs_pa.hpp"
 
 #ifdef MFEM_USE_MPI
 #include "pfespace.hpp"
@@ -18,6 +18,7 @@
 
 #include <cmath>
 #include <cstdarg>
+#include <cstring>
 #include <limits>
 
 using namespace std;
@@ -308,6 +309,65 @@ void FiniteElementSpace::ReorderElementToDofTable()
    }
 }
 
+void FiniteElementSpace::BuildDofPermutation()
+{
+   // Same numbering as in ReorderElementToDofTable(), computed from the
+   // default dofs returned by GetElementDofs() while dof_perm is empty.
+   MFEM_ASSERT(dof_perm.Size() == 0, "internal error");
+   Array<int> dofs, perm(ndofs);
+   perm = -1;
+   int dof_counter = 0;
+   for (int i = 0; i < mesh->GetNE(); i++)
+   {
+      GetElementDofs(i, dofs);
+      for (int j = 0; j < dofs.Size(); j++)
+      {
+         const int dof = DecodeDof(dofs[j]);
+         if (perm[dof] < 0) { perm[dof] = dof_counter++; }
+      }
+   }
+   // dofs not used by any element (if any) are numbered last
+   for (int dof = 0; dof < ndofs; dof++)
+   {
+      if (perm[dof] < 0) { perm[dof] = dof_counter++; }
+   }
+   mfem::Swap(dof_perm, perm);
+}
+
+void FiniteElementSpace::PermuteDofs(Array<int> &dofs) const
+{
+   if (dof_perm.Size() == 0) { return; }
+   for (int j = 0; j < dofs.Size(); j++)
+   {
+      const int sdof = dofs[j]; // signed dof
+      dofs[j] = (sdof < 0) ? -1-dof_perm[-1-sdof] : dof_perm[sdof];
+   }
+}
+
+void FiniteElementSpace::MapToOriginal(const FiniteElementSpace &orig_fes,
+                                       const Vector &x, Vector &x_orig) const
+{
+   const Array<int> &orig_element = mesh->GetOriginalElementIndices();
+   MFEM_VERIFY(orig_fes.GetNE() == GetNE() &&
+               (orig_element.Size() == 0 || orig_element.Size() == GetNE()),
+               "incompatible meshes");
+   MFEM_VERIFY(orig_fes.GetVDim() == vdim &&
+               !strcmp(orig_fes.FEColl()->Name(), fec->Name()),
+               "incompatible spaces");
+
+   x_orig.SetSize(orig_fes.GetVSize());
+   Array<int> vdofs, orig_vdofs;
+   Vector vals;
+   for (int i = 0; i < GetNE(); i++)
+   {
+      const int orig_i = orig_element.Size() ? orig_element[i] : i;
+      GetElementVDofs(i, vdofs);
+      orig_fes.GetElementVDofs(orig_i, orig_vdofs);
+      x.GetSubVector(vdofs, vals);
+      x_orig.SetSubVector(orig_vdofs, vals);
+   }
+}
+
 void FiniteElementSpace::BuildDofToArrays()
 {
    if (dof_elem_array.Size()) { return; }
@@ -1631,6 +1691,7 @@ void FiniteElementSpace::Construct()
    elem_dof = NULL;
    bdrElem_dof = NULL;
    face_dof = NULL;
+   dof_perm.DeleteAll();
 
    ndofs = 0;
    nedofs = nfdofs = nbdofs = 0;
@@ -1685,6 +1746,12 @@ void FiniteElementSpace::Construct()
 
    ndofs = nvdofs + nedofs + nfdofs + nbdofs;
 
+   if (mesh->GetLocalityOrdering() != LocalityOrdering::NONE &&
+       mesh->Conforming())
+   {
+      BuildDofPermutation();
+   }
+
    // Do not build elem_dof Table here: in parallel it has to be constructed
    // later.
 }
@@ -1788,6 +1855,7 @@ void FiniteElementSpace::GetElementDofs(int i, Array<int> &dofs) const
             dofs[ne+j] = k + j;
          }
       }
+      PermuteDofs(dofs);
    }
 }
 
@@ -1888,6 +1956,7 @@ void FiniteElementSpace::GetBdrElementDofs(int i, Array<int> &dofs) const
             }
          }
       }
+      PermuteDofs(dofs);
    }
 }
 
@@ -1956,6 +2025,7 @@ void FiniteElementSpace::GetFaceDofs(int i, Array<int> &dofs) const
             dofs[ne+k] = j;
          }
       }
+      PermuteDofs(dofs);
    }
 }
 
@@ -1986,6 +2056,7 @@ void FiniteElementSpace::GetEdgeDofs(int i, Array<int> &dofs) const
    {
       dofs[nv+j] = k;
    }
+   PermuteDofs(dofs);
 }
 
 void FiniteElementSpace::GetVertexDofs(int i, Array<int> &dofs) const
@@ -1998,6 +2069,7 @@ void FiniteElementSpace::GetVertexDofs(int i, Array<int> &dofs) const
    {
       dofs[j] = i*nv+j;
    }
+   PermuteDofs(dofs);
 }
 
 void FiniteElementSpace::GetElementInteriorDofs (int i, Array<int> &dofs) const
@@ -2011,6 +2083,7 @@ void FiniteElementSpace::GetElementInteriorDofs (int i, Array<int> &dofs) const
    {
       dofs[j] = k + j;
    }
+   PermuteDofs(dofs);
 }
 
 void FiniteElementSpace::GetEdgeInteriorDofs (int i, Array<int> &dofs) const
@@ -2023,6 +2096,7 @@ void FiniteElementSpace::GetEdgeInteriorDofs (int i, Array<int> &dofs) const
    {
       dofs[j] = k;
    }
+   PermuteDofs(dofs);
 }
 
 void FiniteElementSpace::GetFaceInteriorDofs (int i, Array<int> &dofs) const
@@ -2038,6 +2112,7 @@ void FiniteElementSpace::GetFaceInteriorDofs (int i, Array<int> &dofs) const
          dofs[j] = k;
       }
    }
+   PermuteDofs(dofs);
 }
 
 const FiniteElement *FiniteElementSpace::GetBE (int i) const
@@ -110,6 +110,13 @@ protected:
    int nvdofs, nedofs, nfdofs, nbdofs;
    int *fdofs, *bdofs;
 
+   /** Permutation from the default dof numbering (the vertex, edge, face and
+       element interior dofs, following the mesh numbering) to the dof
+       numbering in the order of first use by the elements. Used only on
+       locality-ordered meshes, see Mesh::ReorderForLocality(); empty
+       otherwise. */
+   Array<int> dof_perm;
+
    mutable Table *elem_dof; // if NURBS FE space, not owned; otherwise, owned.
    mutable Table *bdrElem_dof; // not owned only if NURBS FE space.
    mutable Table *face_dof; // owned
@@ -159,6 +166,11 @@ protected:
    void Construct();
    void Destroy();
 
+   /// Build #dof_perm, for spaces on locality-ordered meshes.
+   void BuildDofPermutation();
+   /// Apply #dof_perm (if not empty) to the signed dofs.
+   void PermuteDofs(Array<int> &dofs) const;
+
    void BuildElementToDofTable() const;
    void BuildBdrElementToDofTable() const;
    void BuildFaceToDofTable() const;
@@ -538,6 +550,29 @@ public:
        is preserved. */
    void ReorderElementToDofTable();
 
+   /** @brief Return the permutation from the default dof numbering, following
+       the vertex, edge and face numbering of the mesh, to the dof numbering of
+       the space.
+
+       The array is empty, i.e. the default numbering is used, unless the mesh
+       was reordered with Mesh::ReorderForLocality(), in which case the dofs
+       are numbered in the order in which they are first used by the elements,
+       as in ReorderElementToDofTable(), but consistently for all methods
+       returning dofs. */
+   const Array<int> &GetDofPermutation() const { return dof_perm; }
+
+   /** @brief Map the vector @a x on this space to the vector @a x_orig on the
+       space @a orig_fes, defined on the mesh before the call to
+       Mesh::ReorderForLocality().
+
+       The element @a e of this space is mapped to the element
+       Mesh::GetOriginalElementIndices()[e] of @a orig_fes. The two spaces must
+       use the same FiniteElementCollection and vector dimension; @a orig_fes
+       may use any dof numbering, e.g. it can be defined on a copy of the mesh
+       made before the reordering, for output in the original numbering. */
+   void MapToOriginal(const FiniteElementSpace &orig_fes, const Vector &x,
+                      Vector &x_orig) const;
+
    /** @brief Return a reference to the internal Table that stores the lists of
        scalar dofs, for each mesh element, as returned by GetElementDofs(). */
    const Table &GetElementToDofTable() const { return *elem_dof; }
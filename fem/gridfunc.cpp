@@ -12,6 +12,7 @@
 // Implementation of GridFunction
 
 #include "gridfunc.hpp"
+#include "quadinterpolator.hpp"
 #include "../mesh/nurbs.hpp"
 #include "../general/text.hpp"
 
@@ -91,6 +92,9 @@ GridFunction::GridFunction(Mesh *m, GridFunction *gf_array[], int num_pieces)
    for (int i = 0; i < num_pieces; i++)
    {
       FiniteElementSpace *l_fes = gf_array[i]->FESpace();
+      MFEM_VERIFY(l_fes->GetDofPermutation().Size() == 0 &&
+                  fes->GetDofPermutation().Size() == 0,
+                  "merging of locality-ordered spaces is not supported");
       int l_ndofs  = l_fes->GetNDofs();
       int l_nvdofs = l_fes->GetNVDofs();
       int l_nedofs = l_fes->GetNEDofs();
@@ -2552,6 +2556,160 @@ void GridFunction::ProjectBdrCoefficientTangent(
 #endif
 }
 
+// Evaluate the GridFunction 'gf' at the points of the integration rule 'ir'
+// in all elements, using QuadratureInterpolator (the values are ordered as
+// NQ x VDIM x NE), together with the physical coordinates 'X' and the weights
+// 'wdetJ' (quadrature weight times det(J)) of the points. Returns false if the
+// batched evaluation is not supported, in which case the element-by-element
+// evaluation should be used. The geometric factors are not cached in the mesh,
+// since its nodes may move between two calls.
+static bool GetBatchedQuadratureValues(const GridFunction &gf,
+                                       const IntegrationRule *irs[],
+                                       const IntegrationRule *&ir,
+                                       Vector &vals, Vector &X,
+                                       Vector &wdetJ)
+{
+   const FiniteElementSpace &fes = *gf.FESpace();
+   Mesh *mesh = fes.GetMesh();
+   const int dim = mesh->Dimension(), NE = mesh->GetNE();
+   if (NE == 0 || mesh->GetNodes() == NULL || mesh->NURBSext ||
+       fes.GetNURBSext() || mesh->SpaceDimension() != dim ||
+       mesh->GetNumGeometries(dim) != 1) { return false; }
+
+   const FiniteElement *fe = fes.GetFE(0);
+   const bool vector_fe = (fe->GetRangeType() == FiniteElement::VECTOR);
+   if (!vector_fe && fe->GetMapType() != FiniteElement::VALUE) { return false; }
+   const Geometry::Type geom = fe->GetGeomType();
+   ir = irs ? irs[geom] : &IntRules.Get(geom, 2*fe->GetOrder() + 3);
+
+   const FiniteElementSpace &nodes_fes = *mesh->GetNodes()->FESpace();
+   if (!QuadratureInterpolator::SupportsValues(fes, *ir) ||
+       !QuadratureInterpolator::SupportsValues(nodes_fes, *ir))
+   {
+      return false;
+   }
+
+   const Operator *R = fes.GetElementRestriction(
+                          vector_fe ? ElementDofOrdering::LEXICOGRAPHIC :
+                          ElementDofOrdering::NATIVE);
+   Vector e_vec(R->Height());
+   R->Mult(gf, e_vec);
+   const QuadratureInterpolator *qi = fes.GetQuadratureInterpolator(*ir);
+   qi->SetOutputLayout(QVectorLayout::byNODES);
+   const int NQ = ir->GetNPoints();
+   vals.SetSize(NQ*(vector_fe ? dim : fes.GetVDim())*NE);
+   qi->Values(e_vec, vals);
+
+   GeometricFactors geom_factors(mesh, *ir, GeometricFactors::COORDINATES |
+                                 GeometricFactors::DETERMINANTS);
+   X.Swap(geom_factors.X);
+   wdetJ.Swap(geom_factors.detJ);
+   const double *w = ir->GetWeights().HostRead();
+   double *d_wdetJ = wdetJ.HostReadWrite();
+   for (int e = 0; e < NE; e++)
+   {
+      for (int q = 0; q < NQ; q++) { d_wdetJ[q + NQ*e] *= w[q]; }
+   }
+   return true;
+}
+
+// Reduce the pointwise errors 'err' with the weights 'wdetJ' (and the
+// optional coefficient values 'weight') to the Lp error.
+static double ReduceLpError(const double p, const Vector &err,
+                            const Vector &wdetJ, const Vector *weight)
+{
+   const int n = err.Size();
+   const double *d_err = err.HostRead();
+   const double *d_w = wdetJ.HostRead();
+   const double *d_cw = weight ? weight->HostRead() : NULL;
+   double error = 0.0;
+   if (p < infinity())
+   {
+      for (int i = 0; i < n; i++)
+      {
+         const double e = (p == 2.0) ? d_err[i]*d_err[i] :
+                          ((p == 1.0) ? d_err[i] : pow(d_err[i], p));
+         error += d_w[i] * (d_cw ? e*d_cw[i] : e);
+      }
+      // negative quadrature weights may cause the error to be negative
+      return (error < 0.) ? -pow(-error, 1./p) : pow(error, 1./p);
+   }
+   for (int i = 0; i < n; i++)
+   {
+      error = std::max(error, d_cw ? d_err[i]*d_cw[i] : d_err[i]);
+   }
+   return error;
+}
+
+// Batched version of GridFunction::ComputeLpError() for scalar fields,
+// returns false if the batched evaluation is not supported.
+static bool ComputeBatchedLpError(const GridFunction &gf, const double p,
+                                  Coefficient &exsol, Coefficient *weight,
+                                  const IntegrationRule *irs[], double &error)
+{
+   const IntegrationRule *ir;
+   Vector vals, X, wdetJ;
+   if (gf.FESpace()->GetVDim() != 1 ||
+       !GetBatchedQuadratureValues(gf, irs, ir, vals, X, wdetJ))
+   {
+      return false;
+   }
+   Mesh &mesh = *gf.FESpace()->GetMesh();
+   Vector exact, w;
+   exsol.BatchEval(exact, mesh, *ir, X);
+   if (weight) { weight->BatchEval(w, mesh, *ir, X); }
+   vals -= exact;
+   vals.HostReadWrite();
+   for (int i = 0; i < vals.Size(); i++) { vals(i) = fabs(vals(i)); }
+   error = ReduceLpError(p, vals, wdetJ, weight ? &w : NULL);
+   return true;
+}
+
+// Batched version of GridFunction::ComputeLpError() for vector fields,
+// returns false if the batched evaluation is not supported.
+static bool ComputeBatchedLpError(const GridFunction &gf, const double p,
+                                  VectorCoefficient &exsol,
+                                  Coefficient *weight,
+                                  VectorCoefficient *v_weight,
+                                  const IntegrationRule *irs[], double &error)
+{
+   const IntegrationRule *ir;
+   Vector vals, X, wdetJ;
+   if (!GetBatchedQuadratureValues(gf, irs, ir, vals, X, wdetJ) ||
+       vals.Size() != exsol.GetVDim()*wdetJ.Size())
+   {
+      return false;
+   }
+   Mesh &mesh = *gf.FESpace()->GetMesh();
+   const int vdim = exsol.GetVDim(), NE = mesh.GetNE();
+   const int NQ = ir->GetNPoints();
+   Vector exact, vw, w, err(NQ*NE);
+   exsol.BatchEval(exact, mesh, *ir, X);
+   if (v_weight) { v_weight->BatchEval(vw, mesh, *ir, X); }
+   if (weight) { weight->BatchEval(w, mesh, *ir, X); }
+   vals -= exact;
+   const double *d_vals = vals.HostRead();
+   const double *d_vw = v_weight ? vw.HostRead() : NULL;
+   double *d_err = err.HostWrite();
+   for (int e = 0; e < NE; e++)
+   {
+      for (int q = 0; q < NQ; q++)
+      {
+         // the length of the error (rotationally invariant), or the absolute
+         // value of its dot product with the vector weight
+         double val = 0.0;
+         for (int d = 0; d < vdim; d++)
+         {
+            const int i = q + NQ*(d + vdim*e);
+            val += d_vals[i] * (d_vw ? d_vw[i] : d_vals[i]);
+         }
+         d_err[q + NQ*e] = d_vw ? fabs(val) : sqrt(val);
+      }
+   }
+   error = ReduceLpError(p, err, wdetJ, weight ? &w : NULL);
+   return true;
+}
+
 double GridFunction::ComputeL2Error(
    Coefficient *exsol[], const IntegrationRule *irs[]) const
 {
@@ -2614,6 +2772,12 @@ double GridFunction::ComputeL2Error(
    Array<int> *elems) const
 {
    double error = 0.0;
+   if (elems == NULL &&
+       ComputeBatchedLpError(*this, 2.0, exsol, NULL, NULL, irs, error))
+   {
+      return error;
+   }
+
    const FiniteElement *fe;
    ElementTransformation *T;
    DenseMatrix vals, exact_vals;
@@ -2970,6 +3134,11 @@ double GridFunction::ComputeLpError(const double p, Coefficient &exsol,
                                     const IntegrationRule *irs[]) const
 {
    double error = 0.0;
+   if (ComputeBatchedLpError(*this, p, exsol, weight, irs, error))
+   {
+      return error;
+   }
+
    const FiniteElement *fe;
    ElementTransformation *T;
    Vector vals;
@@ -3102,6 +3271,11 @@ double GridFunction::ComputeLpError(const double p, VectorCoefficient &exsol,
                                     const IntegrationRule *irs[]) const
 {
    double error = 0.0;
+   if (ComputeBatchedLpError(*this, p, exsol, weight, v_weight, irs, error))
+   {
+      return error;
+   }
+
    const FiniteElement *fe;
    ElementTransformation *T;
    DenseMatrix vals, exact_vals;
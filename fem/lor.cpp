@@ -0,0 +1,536 @@
+// Copyright (c) 2010-2020, Lawrence Livermore National Security, LLC. Produced
+// at the Lawrence Livermore National Laboratory. All Rights reserved. See files
+// LICENSE and NOTICE for details. LLNL-CODE-806117.
+//
+// This file is part of the MFEM library. For more information and source code
+// availability visit https://mfem.org.
+//
+// MFEM is free software; you can redistribute it and/or modify it under the
+// terms of the BSD-3 license. We welcome feedback and contributions, see file
+// CONTRIBUTING.md for details.
+
+#include "lor.hpp"
+#include "../general/forall.hpp"
+
+namespace mfem
+{
+
+LORBase::LORBase(FiniteElementSpace &fes_ho_)
+   : fes_ho(fes_ho_), mesh(NULL), fec(NULL), fes(NULL), a(NULL),
+     R_inv(NULL) { }
+
+LORBase::FESpaceType LORBase::GetFESpaceType() const
+{
+   const FiniteElementCollection *fec_ho = fes_ho.FEColl();
+   if (dynamic_cast<const H1_FECollection*>(fec_ho)) { return H1; }
+   else if (dynamic_cast<const ND_FECollection*>(fec_ho)) { return ND; }
+   else if (dynamic_cast<const RT_FECollection*>(fec_ho)) { return RT; }
+   else if (dynamic_cast<const L2_FECollection*>(fec_ho)) { return L2; }
+   return INVALID;
+}
+
+int LORBase::GetRefinementFactor() const
+{
+   // For H1, ND and RT the order of the FiniteElement is the number of
+   // intervals between the nodes of the (closed) basis in each direction; L2
+   // elements have one more node per direction than their order.
+   const int p = fes_ho.GetFE(0)->GetOrder();
+   return (GetFESpaceType() == L2) ? p + 1 : p;
+}
+
+void LORBase::SetupLORCollection()
+{
+   Mesh &mesh_ho = *fes_ho.GetMesh();
+   const int dim = mesh_ho.Dimension();
+
+   MFEM_VERIFY(!mesh_ho.Nonconforming() && mesh_ho.NURBSext == NULL,
+               "LOR discretizations require a conforming, non-NURBS mesh");
+   const Geometry::Type geom = (mesh_ho.GetNE() > 0) ?
+                               mesh_ho.GetElementBaseGeometry(0) :
+                               Geometry::INVALID;
+   MFEM_VERIFY(geom == Geometry::INVALID || geom == Geometry::SEGMENT ||
+               geom == Geometry::SQUARE || geom == Geometry::CUBE,
+               "LOR discretizations require tensor-product elements");
+
+   switch (GetFESpaceType())
+   {
+      case H1: fec = new H1_FECollection(1, dim); break;
+      case ND: fec = new ND_FECollection(1, dim); break;
+      case RT: fec = new RT_FECollection(0, dim); break;
+      case L2: fec = new L2_FECollection(0, dim); break;
+      default: MFEM_ABORT("unsupported finite element space type");
+   }
+}
+
+// Store the positions of the nodes of 'fe' mapped by 'T' in the columns of
+// 'pos'. For vector elements, column i of 'dir' is the direction (in the
+// coordinates of the range of T) of the dof functional i, i.e. the dof values
+// of the projection of a constant field v are given by v^t dir.
+static void GetLORNodeData(const FiniteElement &fe,
+                           IsoparametricTransformation &T,
+                           DenseMatrix &pos, DenseMatrix &dir)
+{
+   const int dim = fe.GetDim();
+   const int ndof = fe.GetDof();
+   const IntegrationRule &nodes = fe.GetNodes();
+
+   pos.SetSize(dim, ndof);
+   Vector x;
+   for (int i = 0; i < ndof; i++)
+   {
+      pos.GetColumnReference(i, x);
+      T.Transform(nodes.IntPoint(i), x);
+   }
+
+   if (fe.GetRangeType() != FiniteElement::VECTOR)
+   {
+      dir.SetSize(0);
+      return;
+   }
+   dir.SetSize(dim, ndof);
+   Vector e(dim), dofs(ndof);
+   for (int d = 0; d < dim; d++)
+   {
+      e = 0.0;
+      e(d) = 1.0;
+      VectorConstantCoefficient coeff(e);
+      fe.Project(coeff, T, dofs);
+      for (int i = 0; i < ndof; i++) { dir(d,i) = dofs(i); }
+   }
+}
+
+// Compute the row of the transformation to integral dofs corresponding to the
+// LOR dof with position 'p' and direction 'w' in the LOR element with bounding
+// box [bb_min, bb_max]: row(m) is the integral of the component of the
+// high-order basis function m along 'w' over the LOR edge/face, i.e. over the
+// coordinates where 'p' is not on the boundary of the LOR element. The
+// integral is normalized such that constant fields v give v^t w.
+static void GetIntegralDofRow(const FiniteElement &fe_ho, const Vector &p,
+                              const Vector &w, const Vector &bb_min,
+                              const Vector &bb_max, double tol, Vector &row)
+{
+   const int dim = p.Size();
+   Array<int> free_dims;
+   for (int d = 0; d < dim; d++)
+   {
+      if (std::abs(p(d) - bb_min(d)) > tol && std::abs(p(d) - bb_max(d)) > tol)
+      {
+         free_dims.Append(d);
+      }
+   }
+   const IntegrationRule &ir1d =
+      IntRules.Get(Geometry::SEGMENT, 2*fe_ho.GetOrder() + 2);
+   const int nq1d = ir1d.GetNPoints();
+   int nq = 1;
+   for (int f = 0; f < free_dims.Size(); f++) { nq *= nq1d; }
+
+   DenseMatrix vshape(fe_ho.GetDof(), dim);
+   Vector vshape_w(fe_ho.GetDof());
+   row.SetSize(fe_ho.GetDof());
+   row = 0.0;
+   for (int q = 0; q < nq; q++)
+   {
+      double x[3] = { 0.0, 0.0, 0.0 };
+      for (int d = 0; d < dim; d++) { x[d] = p(d); }
+      double weight = 1.0;
+      for (int f = 0, qq = q; f < free_dims.Size(); f++, qq /= nq1d)
+      {
+         const IntegrationPoint &ip1d = ir1d.IntPoint(qq % nq1d);
+         const int d = free_dims[f];
+         x[d] = bb_min(d) + ip1d.x*(bb_max(d) - bb_min(d));
+         weight *= ip1d.weight;
+      }
+      IntegrationPoint ip;
+      ip.Set3(x);
+      fe_ho.CalcVShape(ip, vshape);
+      vshape.Mult(w, vshape_w);
+      row.Add(weight, vshape_w);
+   }
+}
+
+void LORBase::ConstructLocalDofPermutation(Array<int> &perm_,
+                                           Array<int> &sign_,
+                                           SparseMatrix *&G_inv_) const
+{
+   Mesh &mesh_ho = *fes_ho.GetMesh();
+   const int dim = mesh_ho.Dimension();
+   const int vdim = fes_ho.GetVDim();
+   const bool vector_fe = (GetFESpaceType() == ND || GetFESpaceType() == RT);
+   const double tol = 1e-10;
+
+   perm_.SetSize(fes_ho.GetVSize());
+   sign_.SetSize(fes_ho.GetVSize());
+   perm_ = -1;
+   sign_ = 1;
+   G_inv_ = NULL;
+   if (mesh_ho.GetNE() == 0) { return; }
+
+   // All elements are refined in the same way, so the correspondence between
+   // the local dofs of the LOR elements and the local dofs of their parent
+   // high-order element is computed once, in the reference element of the
+   // high-order element: local_map(k, j) is the high-order dof matching the
+   // dof k of the LOR element j, and local_sign(k, j) the relative
+   // orientation of the two dofs.
+   const Geometry::Type geom = mesh_ho.GetElementBaseGeometry(0);
+   const FiniteElement &fe_ho = *fes_ho.GetFE(0);
+   const FiniteElement &fe_lor = *fes->GetFE(0);
+   const int ndof_ho = fe_ho.GetDof();
+   const int ndof_lor = fe_lor.GetDof();
+
+   const CoarseFineTransformations &cf_tr = mesh->GetRefinementTransforms();
+   const DenseTensor &pmats = cf_tr.point_matrices[geom];
+   const int nref = pmats.SizeK();
+
+   IsoparametricTransformation T;
+   T.SetFE(Mesh::GetTransformationFEforElementType(mesh->GetElementType(0)));
+
+   // Reference element of the high-order element: identity transformation.
+   DenseMatrix pos_ho, dir_ho;
+   {
+      const IntegrationRule &verts = *Geometries.GetVertices(geom);
+      DenseMatrix &pm = T.GetPointMat();
+      pm.SetSize(dim, verts.GetNPoints());
+      for (int v = 0; v < verts.GetNPoints(); v++)
+      {
+         const IntegrationPoint &ip = verts.IntPoint(v);
+         double coords[3] = { ip.x, ip.y, ip.z };
+         for (int d = 0; d < dim; d++) { pm(d,v) = coords[d]; }
+      }
+      GetLORNodeData(fe_ho, T, pos_ho, dir_ho);
+   }
+
+   // For vector elements, G_loc is the local transformation from the
+   // high-order dofs to the integral dofs.
+   Array2D<int> local_map(ndof_lor, nref);
+   Array2D<int> local_sign(ndof_lor, nref);
+   DenseMatrix G_loc(vector_fe ? ndof_ho : 0);
+   Array<int> ho_matched(ndof_ho);
+   ho_matched = 0;
+   DenseMatrix pos_lor, dir_lor;
+   Vector bb_min(dim), bb_max(dim), p_k(dim), w_k(dim), row;
+   for (int j = 0; j < nref; j++)
+   {
+      const DenseMatrix &pm = pmats(j);
+      T.GetPointMat() = pm;
+      GetLORNodeData(fe_lor, T, pos_lor, dir_lor);
+      for (int d = 0; d < dim; d++)
+      {
+         bb_min(d) = bb_max(d) = pm(d,0);
+         for (int v = 1; v < pm.Width(); v++)
+         {
+            bb_min(d) = std::min(bb_min(d), pm(d,v));
+            bb_max(d) = std::max(bb_max(d), pm(d,v));
+         }
+      }
+      for (int k = 0; k < ndof_lor; k++)
+      {
+         // The high-order node must lie in the (closed) LOR element, and must
+         // coincide with the LOR node in the directions where the LOR node is
+         // on the boundary of the LOR element. For vector elements, the dof
+         // functionals must also act in the same direction.
+         int match = -1, nmatch = 0, sign = 1;
+         for (int i = 0; i < ndof_ho; i++)
+         {
+            bool ok = true;
+            for (int d = 0; d < dim && ok; d++)
+            {
+               const double q = pos_ho(d,i), p = pos_lor(d,k);
+               const bool on_bdr = std::abs(p - bb_min(d)) < tol ||
+                                   std::abs(p - bb_max(d)) < tol;
+               ok = (q > bb_min(d) - tol && q < bb_max(d) + tol) &&
+                    (!on_bdr || std::abs(q - p) < tol);
+            }
+            if (ok && vector_fe)
+            {
+               double tw = 0.0, tt = 0.0, ww = 0.0;
+               for (int d = 0; d < dim; d++)
+               {
+                  tw += dir_ho(d,i)*dir_lor(d,k);
+                  tt += dir_ho(d,i)*dir_ho(d,i);
+                  ww += dir_lor(d,k)*dir_lor(d,k);
+               }
+               ok = std::abs(std::abs(tw) - std::sqrt(tt*ww)) <
+                    tol*std::sqrt(tt*ww);
+               sign = (tw < 0.0) ? -1 : 1;
+            }
+            if (ok) { match = i; nmatch++; }
+         }
+         MFEM_VERIFY(nmatch == 1, "unable to match the LOR dofs with the "
+                     "high-order dofs: the high-order basis and the LOR "
+                     "refinement type are not compatible");
+         local_map(k,j) = match;
+         local_sign(k,j) = sign;
+         if (vector_fe && ho_matched[match] == 0)
+         {
+            // Integral over the LOR edge/face, oriented as the high-order dof.
+            pos_lor.GetColumn(k, p_k);
+            dir_lor.GetColumn(k, w_k);
+            w_k *= sign;
+            GetIntegralDofRow(fe_ho, p_k, w_k, bb_min, bb_max, tol, row);
+            G_loc.SetRow(match, row);
+         }
+         ho_matched[match]++;
+      }
+   }
+   for (int i = 0; i < ndof_ho; i++)
+   {
+      MFEM_VERIFY(ho_matched[i] > 0, "high-order dof " << i
+                  << " has no matching LOR dof");
+   }
+
+   Array<int> vdofs_ho, vdofs_lor;
+   for (int el = 0; el < mesh->GetNE(); el++)
+   {
+      const Embedding &emb = cf_tr.embeddings[el];
+      fes_ho.GetElementVDofs(emb.parent, vdofs_ho);
+      fes->GetElementVDofs(el, vdofs_lor);
+      for (int vd = 0; vd < vdim; vd++)
+      {
+         for (int k = 0; k < ndof_lor; k++)
+         {
+            int dof_ho = vdofs_ho[local_map(k, emb.matrix) + vd*ndof_ho];
+            int dof_lor = vdofs_lor[k + vd*ndof_lor];
+            int s = local_sign(k, emb.matrix);
+            if (dof_ho < 0) { dof_ho = -1 - dof_ho; s = -s; }
+            if (dof_lor < 0) { dof_lor = -1 - dof_lor; s = -s; }
+            perm_[dof_ho] = dof_lor;
+            sign_[dof_ho] = s;
+         }
+      }
+   }
+
+   if (!vector_fe) { return; }
+
+   // The integral dofs on a line (ND) or plane (RT) of the high-order element
+   // only depend on the high-order dofs on the same line/plane, which belong
+   // to a single mesh entity, so G_loc is block-diagonal and its inverse can
+   // be assembled by setting (not adding) the element contributions.
+   G_loc.Invert();
+   const double zero_tol = 1e-12*G_loc.MaxMaxNorm();
+   G_inv_ = new SparseMatrix(fes_ho.GetVSize());
+   for (int e = 0; e < mesh_ho.GetNE(); e++)
+   {
+      fes_ho.GetElementVDofs(e, vdofs_ho);
+      for (int vd = 0; vd < vdim; vd++)
+      {
+         for (int m = 0; m < ndof_ho; m++)
+         {
+            int dof_m = vdofs_ho[m + vd*ndof_ho];
+            const double s_m = (dof_m < 0) ? -1.0 : 1.0;
+            dof_m = (dof_m < 0) ? -1 - dof_m : dof_m;
+            for (int i = 0; i < ndof_ho; i++)
+            {
+               const double val = G_loc(m,i);
+               if (std::abs(val) <= zero_tol) { continue; }
+               int dof_i = vdofs_ho[i + vd*ndof_ho];
+               const double s_i = (dof_i < 0) ? -1.0 : 1.0;
+               dof_i = (dof_i < 0) ? -1 - dof_i : dof_i;
+               G_inv_->Set(dof_m, dof_i, s_m*s_i*val);
+            }
+         }
+      }
+   }
+   G_inv_->Finalize();
+}
+
+void LORBase::SetupDofTransformation(const Array<int> &sign,
+                                     const SparseMatrix &G_inv)
+{
+   // R = S P G, where P is the permutation and S = diag(sign), so that
+   // R^{-1} = G^{-1} P^t S.
+   delete R_inv;
+   R_inv = new SparseMatrix(G_inv.Height(), fes->GetTrueVSize());
+   for (int m = 0; m < G_inv.Height(); m++)
+   {
+      const int *cols = G_inv.GetRowColumns(m);
+      const double *vals = G_inv.GetRowEntries(m);
+      for (int jj = 0; jj < G_inv.RowSize(m); jj++)
+      {
+         const int i = cols[jj];
+         R_inv->Set(m, perm[i], sign[i]*vals[jj]);
+      }
+   }
+   R_inv->Finalize();
+   R_inv->BuildTranspose();
+}
+
+void LORBase::MapEssentialDofs(const Array<int> &ess_dofs_ho,
+                               Array<int> &ess_dofs_lor) const
+{
+   ess_dofs_lor.SetSize(ess_dofs_ho.Size());
+   for (int i = 0; i < ess_dofs_ho.Size(); i++)
+   {
+      ess_dofs_lor[i] = perm[ess_dofs_ho[i]];
+   }
+}
+
+void LORBase::MapToLOR(const Vector &x, Vector &y) const
+{
+   if (R_inv)
+   {
+      y.SetSize(R_inv->Width());
+      R_inv->MultTranspose(x, y);
+      return;
+   }
+   const int n = perm.Size();
+   y.SetSize(n);
+   const auto d_perm = perm.Read();
+   const auto d_x = x.Read();
+   auto d_y = y.Write();
+   MFEM_FORALL(i, n, d_y[d_perm[i]] = d_x[i];);
+}
+
+void LORBase::MapFromLOR(const Vector &x, Vector &y) const
+{
+   if (R_inv)
+   {
+      y.SetSize(R_inv->Height());
+      R_inv->Mult(x, y);
+      return;
+   }
+   const int n = perm.Size();
+   y.SetSize(n);
+   const auto d_perm = perm.Read();
+   const auto d_x = x.Read();
+   auto d_y = y.Write();
+   MFEM_FORALL(i, n, d_y[i] = d_x[d_perm[i]];);
+}
+
+LORBase::~LORBase()
+{
+   delete R_inv;
+   delete a;
+   delete fes;
+   delete fec;
+   delete mesh;
+}
+
+LORDiscretization::LORDiscretization(BilinearForm &a_ho,
+                                     const Array<int> &ess_tdof_list,
+                                     int ref_type)
+   : LORBase(*a_ho.FESpace())
+{
+   MFEM_VERIFY(fes_ho.GetConformingProlongation() == NULL,
+               "LORDiscretization requires a conforming space");
+   SetupLORCollection();
+   mesh = new Mesh(fes_ho.GetMesh(), GetRefinementFactor(), ref_type);
+   fes = new FiniteElementSpace(mesh, fec, fes_ho.GetVDim(),
+                                fes_ho.GetOrdering());
+   Array<int> sign;
+   SparseMatrix *G_inv;
+   ConstructLocalDofPermutation(perm, sign, G_inv);
+   if (G_inv)
+   {
+      SetupDofTransformation(sign, *G_inv);
+      delete G_inv;
+   }
+   AssembleSystem(a_ho, ess_tdof_list);
+}
+
+void LORDiscretization::AssembleSystem(BilinearForm &a_ho,
+                                       const Array<int> &ess_tdof_list)
+{
+   MFEM_VERIFY(a_ho.FESpace() == &fes_ho, "incompatible BilinearForm");
+   delete a;
+   a = new BilinearForm(fes, &a_ho);
+   a->Assemble();
+   Array<int> ess_dofs_lor;
+   MapEssentialDofs(ess_tdof_list, ess_dofs_lor);
+   a->FormSystemMatrix(ess_dofs_lor, A);
+}
+
+SparseMatrix &LORDiscretization::GetAssembledMatrix() const
+{
+   MFEM_VERIFY(A.Ptr() != NULL, "LOR system not assembled");
+   return *A.As<SparseMatrix>();
+}
+
+#ifdef MFEM_USE_MPI
+
+ParLORDiscretization::ParLORDiscretization(ParBilinearForm &a_ho,
+                                           const Array<int> &ess_tdof_list,
+                                           int ref_type)
+   : LORBase(*a_ho.ParFESpace())
+{
+   ParFiniteElementSpace &pfes_ho = *a_ho.ParFESpace();
+   SetupLORCollection();
+   ParMesh *pmesh = new ParMesh(pfes_ho.GetParMesh(), GetRefinementFactor(),
+                                ref_type);
+   mesh = pmesh;
+   ParFiniteElementSpace *pfes =
+      new ParFiniteElementSpace(pmesh, fec, pfes_ho.GetVDim(),
+                                pfes_ho.GetOrdering());
+   fes = pfes;
+
+   // Convert the permutation of the local dofs into a permutation of the true
+   // dofs. The refined mesh inherits the communication groups of the
+   // high-order mesh, so matching dofs are owned by the same rank.
+   Array<int> perm_l, sign_l;
+   SparseMatrix *G_inv_l;
+   ConstructLocalDofPermutation(perm_l, sign_l, G_inv_l);
+   Array<int> sign(pfes_ho.GetTrueVSize());
+   perm.SetSize(pfes_ho.GetTrueVSize());
+   for (int ldof = 0; ldof < perm_l.Size(); ldof++)
+   {
+      const int tdof_ho = pfes_ho.GetLocalTDofNumber(ldof);
+      if (tdof_ho < 0) { continue; }
+      const int tdof_lor = pfes->GetLocalTDofNumber(perm_l[ldof]);
+      MFEM_VERIFY(tdof_lor >= 0, "inconsistent ownership of the LOR dofs");
+      perm[tdof_ho] = tdof_lor;
+      sign[tdof_ho] = sign_l[ldof];
+   }
+   if (G_inv_l)
+   {
+      // The rows of G^{-1} for a true dof only involve dofs of the same mesh
+      // entity, which are also true dofs.
+      SparseMatrix G_inv(pfes_ho.GetTrueVSize());
+      for (int ldof = 0; ldof < perm_l.Size(); ldof++)
+      {
+         const int tdof_m = pfes_ho.GetLocalTDofNumber(ldof);
+         if (tdof_m < 0) { continue; }
+         const int *cols = G_inv_l->GetRowColumns(ldof);
+         const double *vals = G_inv_l->GetRowEntries(ldof);
+         for (int jj = 0; jj < G_inv_l->RowSize(ldof); jj++)
+         {
+            const int tdof_i = pfes_ho.GetLocalTDofNumber(cols[jj]);
+            MFEM_VERIFY(tdof_i >= 0, "inconsistent ownership of the dofs");
+            G_inv.Set(tdof_m, tdof_i, vals[jj]);
+         }
+      }
+      G_inv.Finalize();
+      SetupDofTransformation(sign, G_inv);
+      delete G_inv_l;
+   }
+   AssembleSystem(a_ho, ess_tdof_list);
+}
+
+void ParLORDiscretization::AssembleSystem(BilinearForm &a_ho,
+                                          const Array<int> &ess_tdof_list)
+{
+   ParBilinearForm *pa_ho = dynamic_cast<ParBilinearForm*>(&a_ho);
+   MFEM_VERIFY(pa_ho != NULL && pa_ho->FESpace() == &fes_ho,
+               "incompatible BilinearForm");
+   delete a;
+   ParBilinearForm *pa = new ParBilinearForm(&GetParFESpace(), pa_ho);
+   a = pa;
+   pa->Assemble();
+   Array<int> ess_dofs_lor;
+   MapEssentialDofs(ess_tdof_list, ess_dofs_lor);
+   A.SetType(Operator::Hypre_ParCSR);
+   pa->FormSystemMatrix(ess_dofs_lor, A);
+}
+
+HypreParMatrix &ParLORDiscretization::GetAssembledMatrix() const
+{
+   MFEM_VERIFY(A.Ptr() != NULL, "LOR system not assembled");
+   return *A.As<HypreParMatrix>();
+}
+
+ParFiniteElementSpace &ParLORDiscretization::GetParFESpace() const
+{
+   return *static_cast<ParFiniteElementSpace*>(fes);
+}
+
+#endif // MFEM_USE_MPI
+
+} // namespace mfem
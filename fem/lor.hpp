@@ -0,0 +1,276 @@
+// Copyright (c) 2010-2020, Lawrence Livermore National Security, LLC. Produced
+// at the Lawrence Livermore National Laboratory. All Rights reserved. See files
+// LICENSE and NOTICE for details. LLNL-CODE-806117.
+//
+// This file is part of the MFEM library. For more information and source code
+// availability visit https://mfem.org.
+//
+// MFEM is free software; you can redistribute it and/or modify it under the
+// terms of the BSD-3 license. We welcome feedback and contributions, see file
+// CONTRIBUTING.md for details.
+
+#ifndef MFEM_LOR
+#define MFEM_LOR
+
+#include "bilinearform.hpp"
+#include "../linalg/handle.hpp"
+
+#ifdef MFEM_USE_MPI
+#include "pbilinearform.hpp"
+#endif
+
+namespace mfem
+{
+
+/** @brief Abstract base class for the low-order refined (LOR) discretizations
+    LORDiscretization and ParLORDiscretization.
+
+    Given a high-order finite element space of order p on a tensor-product
+    mesh, the LOR discretization is the low-order space (H1 of order 1, ND of
+    order 1, RT of order 0 or L2 of order 0) defined on the mesh obtained by
+    refining every element p times (p+1 times for RT and L2) at the nodes of
+    the high-order basis. The two spaces have the same number of degrees of
+    freedom, and the bilinear form discretized in the LOR space is spectrally
+    equivalent to the high-order one, so that the assembled LOR matrix can be
+    used to construct a preconditioner for a (matrix-free) high-order operator.
+
+    The degrees of freedom of the two spaces are identified through a
+    permutation, see GetDofPermutation(). For ND and RT spaces the high-order
+    dofs (point values of the tangential/normal components) are additionally
+    transformed into integrals over the edges/faces of the LOR mesh, which is
+    the identification that makes the two discretizations spectrally
+    equivalent, see GetDofTransformation(). */
+class LORBase
+{
+protected:
+   enum FESpaceType { H1, ND, RT, L2, INVALID };
+
+   FiniteElementSpace &fes_ho;
+   Mesh *mesh;
+   FiniteElementCollection *fec;
+   FiniteElementSpace *fes;
+   BilinearForm *a;
+   OperatorHandle A;
+   Array<int> perm;
+   SparseMatrix *R_inv;
+
+   LORBase(FiniteElementSpace &fes_ho_);
+
+   /// Return the type of the high-order space.
+   FESpaceType GetFESpaceType() const;
+
+   /// Return the refinement factor used to build the LOR mesh.
+   int GetRefinementFactor() const;
+
+   /// Create #fec for the low-order space corresponding to #fes_ho.
+   void SetupLORCollection();
+
+   /** @brief Compute the map from the (local) vector dofs of #fes_ho to the
+       vector dofs of #fes, see GetDofPermutation().
+
+       For ND and RT spaces, @a sign_ holds the relative orientation of the
+       matched dofs and @a G_inv_ is set to the (newly allocated) inverse of
+       the transformation from the high-order dofs to the integral dofs;
+       otherwise @a G_inv_ is set to NULL. */
+   void ConstructLocalDofPermutation(Array<int> &perm_, Array<int> &sign_,
+                                     SparseMatrix *&G_inv_) const;
+
+   /** @brief Set #R_inv from the permutation #perm, the orientations @a sign
+       and the inverse transformation @a G_inv, see GetDofTransformation(). */
+   void SetupDofTransformation(const Array<int> &sign,
+                               const SparseMatrix &G_inv);
+
+   /// Map the high-order essential dofs to the LOR essential dofs.
+   void MapEssentialDofs(const Array<int> &ess_dofs_ho,
+                         Array<int> &ess_dofs_lor) const;
+
+public:
+   /** @brief Assemble the LOR system using the integrators of @a a_ho and the
+       given high-order essential true dofs.
+
+       The LOR mesh and space are reused, so this method can be called again
+       after the coefficients of @a a_ho have changed. The integrators of
+       @a a_ho are not owned by the LOR form and must stay alive until the next
+       call to AssembleSystem(). */
+   virtual void AssembleSystem(BilinearForm &a_ho,
+                               const Array<int> &ess_tdof_list) = 0;
+
+   /// Return the assembled LOR system operator.
+   const OperatorHandle &GetAssembledSystem() const { return A; }
+
+   /** @brief Return the permutation that maps the high-order true dofs to the
+       LOR true dofs. */
+   /** The true dof @a i of the high-order space corresponds to the true dof
+       perm[i] of the LOR space. */
+   const Array<int> &GetDofPermutation() const { return perm; }
+
+   /** @brief Return the matrix R^{-1} mapping LOR true dofs to high-order
+       true dofs, or NULL if the map is the permutation given by
+       GetDofPermutation() (H1 and L2 spaces). */
+   /** A function with high-order coefficients x is represented in the LOR
+       space by the coefficients R x, and the high-order system matrix is
+       spectrally equivalent to R^t A_lor R. For ND and RT spaces, R is the
+       product of the (signed) permutation and of a block-diagonal matrix
+       computing the integrals of the tangential/normal components over the
+       LOR edges/faces. */
+   const SparseMatrix *GetDofTransformation() const { return R_inv; }
+
+   /** @brief Map a high-order (dual) vector @a x, e.g. a residual, to the LOR
+       space: y = R^{-t} x. */
+   void MapToLOR(const Vector &x, Vector &y) const;
+
+   /** @brief Map a LOR (primal) vector @a x, e.g. a correction, to the
+       high-order space: y = R^{-1} x. */
+   void MapFromLOR(const Vector &x, Vector &y) const;
+
+   /// Return the LOR mesh.
+   Mesh &GetLORMesh() const { return *mesh; }
+
+   /// Return the LOR finite element space.
+   FiniteElementSpace &GetFESpace() const { return *fes; }
+
+   /// Return the LOR bilinear form.
+   BilinearForm &GetBilinearForm() const { return *a; }
+
+   virtual ~LORBase();
+};
+
+/** @brief Create and assemble a low-order refined version of a BilinearForm
+    on a serial mesh, see LORBase. */
+class LORDiscretization : public LORBase
+{
+public:
+   /** @brief Create the LOR discretization of @a a_ho with the given
+       essential true dofs of the high-order space.
+
+       The refined mesh is created with the given @a ref_type, which must
+       match the node locations of the high-order basis (for H1 spaces) or of
+       its closed basis (for ND and RT spaces); valid options are
+       BasisType::GaussLobatto and BasisType::ClosedUniform. */
+   LORDiscretization(BilinearForm &a_ho, const Array<int> &ess_tdof_list,
+                     int ref_type=BasisType::GaussLobatto);
+
+   virtual void AssembleSystem(BilinearForm &a_ho,
+                               const Array<int> &ess_tdof_list);
+
+   /// Return the assembled LOR matrix.
+   SparseMatrix &GetAssembledMatrix() const;
+};
+
+#ifdef MFEM_USE_MPI
+
+/** @brief Create and assemble a low-order refined version of a
+    ParBilinearForm, see LORBase. The permutation returned by
+    GetDofPermutation() acts on the true dofs. */
+class ParLORDiscretization : public LORBase
+{
+public:
+   /** @brief Create the LOR discretization of @a a_ho with the given
+       essential true dofs of the high-order space, see
+       LORDiscretization::LORDiscretization(). */
+   ParLORDiscretization(ParBilinearForm &a_ho, const Array<int> &ess_tdof_list,
+                        int ref_type=BasisType::GaussLobatto);
+
+   virtual void AssembleSystem(BilinearForm &a_ho,
+                               const Array<int> &ess_tdof_list);
+
+   /// Return the assembled LOR matrix.
+   HypreParMatrix &GetAssembledMatrix() const;
+
+   /// Return the LOR parallel finite element space.
+   ParFiniteElementSpace &GetParFESpace() const;
+};
+
+#endif
+
+/** @brief Solver that uses a preconditioner or solver of type @a SolverType,
+    built from the assembled LOR matrix, to approximate the inverse of a
+    high-order operator.
+
+    The high-order operator (e.g. partially assembled) is never assembled:
+    SolverType is set up with the LOR matrix (SparseMatrix in serial,
+    HypreParMatrix in parallel, e.g. HypreBoomerAMG for H1 and L2 spaces,
+    HypreAMS for ND spaces and HypreADS for RT spaces), and its action is
+    composed with the dof permutation of the LOR discretization. */
+template <typename SolverType>
+class LORSolver : public Solver
+{
+protected:
+   LORBase *lor;
+   bool own_lor;
+   SolverType solver;
+   mutable Vector X_lor, Y_lor;
+
+public:
+   /// Create the LOR discretization of @a a_ho and set up the solver.
+   LORSolver(BilinearForm &a_ho, const Array<int> &ess_tdof_list,
+             int ref_type=BasisType::GaussLobatto)
+      : lor(new LORDiscretization(a_ho, ess_tdof_list, ref_type)),
+        own_lor(true)
+   {
+      SetOperatorLOR();
+   }
+
+#ifdef MFEM_USE_MPI
+   /// Create the LOR discretization of @a a_ho and set up the solver.
+   LORSolver(ParBilinearForm &a_ho, const Array<int> &ess_tdof_list,
+             int ref_type=BasisType::GaussLobatto)
+      : lor(new ParLORDiscretization(a_ho, ess_tdof_list, ref_type)),
+        own_lor(true)
+   {
+      SetOperatorLOR();
+   }
+#endif
+
+   /** @brief Set up the solver using an existing LOR discretization. The
+       discretization is not owned. */
+   LORSolver(LORBase &lor_) : lor(&lor_), own_lor(false)
+   {
+      SetOperatorLOR();
+   }
+
+   /** @brief Reassemble the LOR system, reusing the LOR mesh and space, and
+       set up the solver again. */
+   void Update(BilinearForm &a_ho, const Array<int> &ess_tdof_list)
+   {
+      lor->AssembleSystem(a_ho, ess_tdof_list);
+      SetOperatorLOR();
+   }
+
+   /** @brief The high-order operator @a op is only used to check the sizes;
+       the solver is always built from the LOR system. */
+   virtual void SetOperator(const Operator &op)
+   {
+      MFEM_VERIFY(op.Height() == height && op.Width() == width,
+                  "incompatible operator size");
+   }
+
+   virtual void Mult(const Vector &x, Vector &y) const
+   {
+      lor->MapToLOR(x, X_lor);
+      Y_lor.SetSize(X_lor.Size());
+      Y_lor = 0.0;
+      solver.Mult(X_lor, Y_lor);
+      lor->MapFromLOR(Y_lor, y);
+   }
+
+   /// Access the underlying solver.
+   SolverType &GetSolver() { return solver; }
+
+   /// Access the LOR discretization.
+   const LORBase &GetLOR() const { return *lor; }
+
+   ~LORSolver() { if (own_lor) { delete lor; } }
+
+protected:
+   void SetOperatorLOR()
+   {
+      const Operator &A_lor = *lor->GetAssembledSystem().Ptr();
+      height = width = A_lor.Height();
+      solver.SetOperator(A_lor);
+   }
+};
+
+} // namespace mfem
+
+#endif
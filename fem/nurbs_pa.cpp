@@ -0,0 +1,557 @@
+// Copyright (c) 2010-2020, Lawrence Livermore National Security, LLC. Produced
+// at the Lawrence Livermore National Laboratory. All Rights reserved. See files
+// LICENSE and NOTICE for details. LLNL-CODE-806117.
+//
+// This file is part of the MFEM library. For more information and source code
+// availability visit https://mfem.org.
+//
+// MFEM is free software; you can redistribute it and/or modify it under the
+// terms of the BSD-3 license. We welcome feedback and contributions, see file
+// CONTRIBUTING.md for details.
+
+// Implementation of class NURBSPatchPA
+
+#include "../general/forall.hpp"
+#include "nurbs_pa.hpp"
+#include "fespace.hpp"
+#include "coefficient.hpp"
+#include "../mesh/nurbs.hpp"
+
+namespace mfem
+{
+
+// Contract the axis 'a' of the tensor x, with sizes n[0] x n[1] x n[2] (first
+// index fastest), with a banded 1D matrix M whose row q has p1 entries that
+// start at column offset[q]:
+//    y(.., q, ..) = sum_k M(q,k) x(.., offset[q]+k, ..),
+// where y has the sizes of x with n[a] replaced by nq.
+static void PatchContract(const int a, const int *n, const int nq,
+                          const int p1, const Array<int> &offset,
+                          const Vector &M, const Vector &x, Vector &y)
+{
+   int s = 1, r = 1;
+   for (int b = 0; b < a; b++) { s *= n[b]; }
+   for (int b = a+1; b < 3; b++) { r *= n[b]; }
+   y.UseDevice(true);
+   y.SetSize(s*nq*r);
+   const int S = s, NA = n[a], NQ = nq, P1 = p1;
+   auto off = offset.Read();
+   auto m = M.Read();
+   auto X = x.Read();
+   auto Y = y.Write();
+   MFEM_FORALL(l, S*r,
+   {
+      const int i = l % S, o = l / S;
+      for (int q = 0; q < NQ; q++)
+      {
+         const double *xq = X + i + S*(off[q] + NA*o);
+         double sum = 0.0;
+         for (int k = 0; k < P1; k++) { sum += m[q*P1+k] * xq[S*k]; }
+         Y[i + S*(q + NQ*o)] = sum;
+      }
+   });
+}
+
+// The transpose of PatchContract(): x has the sizes n with n[a] replaced by nq
+// and y has the sizes n. The result is added to y when 'add' is true.
+static void PatchContractT(const int a, const int *n, const int nq,
+                           const int p1, const Array<int> &offset,
+                           const Vector &M, const Vector &x, Vector &y,
+                           const bool add)
+{
+   int s = 1, r = 1;
+   for (int b = 0; b < a; b++) { s *= n[b]; }
+   for (int b = a+1; b < 3; b++) { r *= n[b]; }
+   if (!add)
+   {
+      y.UseDevice(true);
+      y.SetSize(s*n[a]*r);
+   }
+   const int S = s, NA = n[a], NQ = nq, P1 = p1;
+   const bool ADD = add;
+   auto off = offset.Read();
+   auto m = M.Read();
+   auto X = x.Read();
+   auto Y = add ? y.ReadWrite() : y.Write();
+   MFEM_FORALL(l, S*r,
+   {
+      const int i = l % S, o = l / S;
+      double *yl = Y + i + S*NA*o;
+      if (!ADD)
+      {
+         for (int j = 0; j < NA; j++) { yl[S*j] = 0.0; }
+      }
+      for (int q = 0; q < NQ; q++)
+      {
+         const double xq = X[i + S*(q + NQ*o)];
+         double *yq = yl + S*off[q];
+         for (int k = 0; k < P1; k++) { yq[S*k] += m[q*P1+k] * xq; }
+      }
+   });
+}
+
+// Index of the entry (i,j), i <= j, of a symmetric dim x dim matrix stored by
+// rows of its upper triangle.
+MFEM_HOST_DEVICE static inline int SymIdx(const int dim, const int i,
+                                          const int j)
+{
+   return i*dim - i*(i-1)/2 + (j-i);
+}
+
+// Gather the weighted patch dofs, xw(i) = w(i) x(dofs(i)).
+static void PatchGather(const Array<int> &dofs, const Vector &w,
+                        const Vector &x, Vector &xw)
+{
+   const int N = dofs.Size();
+   xw.UseDevice(true);
+   xw.SetSize(N);
+   auto d = dofs.Read();
+   auto W = w.Read();
+   auto X = x.Read();
+   auto XW = xw.Write();
+   MFEM_FORALL(i, N, XW[i] = (d[i] >= 0) ? W[i] * X[d[i]] : 0.0;);
+}
+
+// Scatter-add the patch dofs, y(dofs(i)) += w(i)^e yw(i), with e = 1 or 2.
+// Patches that see a dof more than once (periodic patches) are added
+// sequentially.
+static void PatchScatter(const Array<int> &dofs, const Vector &w,
+                         const bool unique, const int e, const Vector &yw,
+                         Vector &y)
+{
+   const int N = dofs.Size();
+   const bool SQ = (e == 2);
+   auto d = dofs.Read();
+   auto W = w.Read();
+   auto YW = yw.Read();
+   auto Y = y.ReadWrite();
+   if (unique)
+   {
+      MFEM_FORALL(i, N,
+      {
+         if (d[i] >= 0) { Y[d[i]] += (SQ ? W[i]*W[i] : W[i]) * YW[i]; }
+      });
+   }
+   else
+   {
+      MFEM_FORALL(k, 1,
+      {
+         for (int i = 0; i < N; i++)
+         {
+            if (d[i] >= 0) { Y[d[i]] += (SQ ? W[i]*W[i] : W[i]) * YW[i]; }
+         }
+      });
+   }
+}
+
+void NURBSPatchPA::Assemble(const FiniteElementSpace &fes, Coefficient *Q,
+                            int order)
+{
+   const NURBSExtension *ext = fes.GetNURBSext();
+   MFEM_VERIFY(ext, "NURBSPatchPA requires a NURBS space");
+   MFEM_VERIFY(fes.GetVDim() == 1, "vector NURBS spaces are not supported");
+   dim = ext->Dimension();
+   MFEM_VERIFY(dim == 2 || dim == 3, "unsupported dimension " << dim);
+   MFEM_VERIFY(fes.GetMesh()->SpaceDimension() == dim,
+               "NURBS surfaces are not supported");
+
+   const int nq1d = (q1d > 0) ? q1d :
+                    IntRules.Get(Geometry::SEGMENT, order).GetNPoints();
+   std::vector<Array<int>> elems(ext->GetNP());
+   for (int e = 0; e < fes.GetNE(); e++)
+   {
+      elems[ext->GetElementPatch(e)].Append(e);
+   }
+
+   xw.UseDevice(true);
+   t_val.UseDevice(true);
+   t_tmp.UseDevice(true);
+   for (int a = 0; a < 3; a++) { t_grad[a].UseDevice(true); }
+
+   patches.clear();
+   patches.resize(ext->GetNP());
+   for (int p = 0; p < ext->GetNP(); p++)
+   {
+      SetupPatch(fes, p, Q, nq1d, elems[p]);
+   }
+}
+
+void NURBSPatchPA::SetupPatch(const FiniteElementSpace &fes, int p,
+                              Coefficient *Q, int nq1d,
+                              const Array<int> &elems)
+{
+   const NURBSExtension *ext = fes.GetNURBSext();
+   Patch &P = patches[p];
+   P.n[0] = P.n[1] = P.n[2] = P.nq[0] = P.nq[1] = P.nq[2] = 1;
+   // patches without local elements are skipped by AddMult()
+   if (elems.Size() == 0) { P.n[0] = 0; return; }
+
+   // 1. Tabulate the B-spline values and derivatives at the Gauss points of
+   //    the knot spans of each direction.
+   const IntegrationRule &ir1d = IntRules.Get(Geometry::SEGMENT, 2*nq1d - 1);
+   MFEM_ASSERT(ir1d.GetNPoints() == nq1d, "");
+   Array<const KnotVector *> kv;
+   ext->GetPatchKnotVectors(p, kv);
+   Array<int> span[3];
+   int ne = 1;
+   for (int a = 0; a < dim; a++)
+   {
+      const KnotVector &k = *kv[a];
+      Basis1D &b = P.basis[a];
+      span[a].SetSize(k.GetNKS());
+      int ns = 0;
+      for (int i = 0; i < k.GetNKS(); i++)
+      {
+         span[a][i] = k.isElement(i) ? ns++ : -1;
+      }
+      ne *= ns;
+
+      b.ndof = k.GetNCP();
+      b.nq = ns*nq1d;
+      b.p1 = k.GetOrder() + 1;
+      b.offset.SetSize(b.nq);
+      for (Vector *M : { &b.B, &b.G, &b.BB, &b.GG, &b.BG })
+      {
+         M->SetSize(b.nq*b.p1);
+      }
+      Vector shape(b.p1), dshape(b.p1);
+      for (int i = 0; i < k.GetNKS(); i++)
+      {
+         if (span[a][i] < 0) { continue; }
+         for (int q = 0; q < nq1d; q++)
+         {
+            const double xi = ir1d.IntPoint(q).x;
+            k.CalcShape(shape, i, xi);
+            k.CalcDShape(dshape, i, xi);
+            const int qi = span[a][i]*nq1d + q;
+            b.offset[qi] = i;
+            for (int j = 0; j < b.p1; j++)
+            {
+               const int o = qi*b.p1 + j;
+               b.B(o) = shape(j);
+               b.G(o) = dshape(j);
+               b.BB(o) = shape(j)*shape(j);
+               b.GG(o) = dshape(j)*dshape(j);
+               b.BG(o) = shape(j)*dshape(j);
+            }
+         }
+      }
+      P.n[a] = b.ndof;
+      P.nq[a] = b.nq;
+   }
+   MFEM_VERIFY(elems.Size() == ne, "patch " << p << " is not fully local: "
+               "patch-wise assembly requires whole patches");
+
+   // 2. Patch dofs and weights.
+   ext->GetPatchDofs(p, P.dofs);
+   const Vector &weights = ext->GetWeights();
+   P.weights.SetSize(P.dofs.Size());
+   Array<bool> seen(fes.GetNDofs());
+   seen = false;
+   P.unique = true;
+   for (int i = 0; i < P.dofs.Size(); i++)
+   {
+      const int d = P.dofs[i];
+      P.weights(i) = (d >= 0) ? weights(d) : 0.0;
+      if (d < 0) { continue; }
+      if (seen[d]) { P.unique = false; }
+      seen[d] = true;
+   }
+
+   // 3. The weight function W and its reference gradient at the points.
+   Interpolate(P, P.weights, type == DIFFUSION);
+   const double *W = t_val.HostRead();
+   const double *dW[3] = { NULL, NULL, NULL };
+   if (type == DIFFUSION)
+   {
+      for (int a = 0; a < dim; a++) { dW[a] = t_grad[a].HostRead(); }
+   }
+
+   // 4. Quadrature point data, computed element by element with the mesh
+   //    transformation at the tensor Gauss points of the element.
+   const int nqp = P.nq[0]*P.nq[1]*P.nq[2];
+   const int nd = (type == MASS) ? 1 : dim + dim*(dim+1)/2;
+   P.qdata.SetSize(nqp*nd);
+   double *qd = P.qdata.HostWrite();
+   const int nq3 = (dim == 3) ? nq1d : 1;
+   Array<int> ijk;
+   DenseMatrix adj(dim), D(dim);
+   IntegrationPoint ip;
+   for (int e = 0; e < elems.Size(); e++)
+   {
+      const int el = elems[e];
+      ext->GetElementIJK(el, ijk);
+      int s[3] = { 0, 0, 0 };
+      for (int a = 0; a < dim; a++) { s[a] = span[a][ijk[a]]*nq1d; }
+      ElementTransformation *T = fes.GetElementTransformation(el);
+      for (int qz = 0; qz < nq3; qz++)
+      {
+         for (int qy = 0; qy < nq1d; qy++)
+         {
+            for (int qx = 0; qx < nq1d; qx++)
+            {
+               const IntegrationPoint &ipx = ir1d.IntPoint(qx);
+               const IntegrationPoint &ipy = ir1d.IntPoint(qy);
+               const IntegrationPoint &ipz = ir1d.IntPoint(qz);
+               double wq = ipx.weight*ipy.weight;
+               if (dim == 3)
+               {
+                  wq *= ipz.weight;
+                  ip.Set(ipx.x, ipy.x, ipz.x, wq);
+               }
+               else
+               {
+                  ip.Set2w(ipx.x, ipy.x, wq);
+               }
+               T->SetIntPoint(&ip);
+               const double c = Q ? Q->Eval(*T, ip) : 1.0;
+               const DenseMatrix &J = T->Jacobian();
+               const int g = (s[0] + qx) +
+                             P.nq[0]*((s[1] + qy) + P.nq[1]*(s[2] + qz));
+               const double w = W[g];
+               if (type == MASS)
+               {
+                  qd[g] = wq * c * J.Det() / (w*w);
+                  continue;
+               }
+               // flux matrix adj(J) adj(J)^T / det(J), divided by W^2
+               CalcAdjugate(J, adj);
+               MultAAt(adj, D);
+               D *= wq * c / (J.Det() * w*w);
+               double *qg = qd + g*nd;
+               for (int i = 0; i < dim; i++)
+               {
+                  qg[i] = dW[i][g] / w;
+                  for (int j = i; j < dim; j++)
+                  {
+                     qg[dim + SymIdx(dim,i,j)] = D(i,j);
+                  }
+               }
+            }
+         }
+      }
+   }
+}
+
+void NURBSPatchPA::Interpolate(const Patch &P, const Vector &u,
+                               bool grad) const
+{
+   // The values are contracted with B along each axis; the derivative along
+   // axis a is contracted with G along a and with B along the other axes, so
+   // the partial results along the first axes are shared.
+   int n[3] = { P.n[0], P.n[1], P.n[2] };
+   const Vector *val = &u;
+   for (int a = 0; a < dim; a++)
+   {
+      const Basis1D &b = P.basis[a];
+      if (grad)
+      {
+         for (int j = 0; j < a; j++)
+         {
+            PatchContract(a, n, b.nq, b.p1, b.offset, b.B, t_grad[j], t_tmp);
+            t_grad[j].Swap(t_tmp);
+         }
+         PatchContract(a, n, b.nq, b.p1, b.offset, b.G, *val, t_grad[a]);
+      }
+      PatchContract(a, n, b.nq, b.p1, b.offset, b.B, *val, t_tmp);
+      t_val.Swap(t_tmp);
+      val = &t_val;
+      n[a] = b.nq;
+   }
+}
+
+void NURBSPatchPA::InterpolateT(const Patch &P, bool grad, Vector &u) const
+{
+   int n[3] = { P.nq[0], P.nq[1], P.nq[2] };
+   for (int a = dim-1; a >= 0; a--)
+   {
+      const Basis1D &b = P.basis[a];
+      n[a] = b.ndof;
+      if (grad)
+      {
+         for (int j = 0; j < a; j++)
+         {
+            PatchContractT(a, n, b.nq, b.p1, b.offset, b.B, t_grad[j], t_tmp,
+                           false);
+            t_grad[j].Swap(t_tmp);
+         }
+      }
+      Vector &out = (a == 0) ? u : t_tmp;
+      PatchContractT(a, n, b.nq, b.p1, b.offset, b.B, t_val, out, false);
+      if (grad)
+      {
+         PatchContractT(a, n, b.nq, b.p1, b.offset, b.G, t_grad[a], out, true);
+      }
+      if (a > 0) { t_val.Swap(t_tmp); }
+   }
+}
+
+void NURBSPatchPA::AddMult(const Vector &x, Vector &y) const
+{
+   const bool grad = (type == DIFFUSION);
+   for (const Patch &P : patches)
+   {
+      if (P.n[0] == 0) { continue; }
+      PatchGather(P.dofs, P.weights, x, xw);
+      Interpolate(P, xw, grad);
+
+      const int NQ = P.nq[0]*P.nq[1]*P.nq[2];
+      auto D = P.qdata.Read();
+      auto U = t_val.ReadWrite();
+      if (!grad)
+      {
+         MFEM_FORALL(q, NQ, U[q] *= D[q];);
+      }
+      else if (dim == 2)
+      {
+         auto Ux = t_grad[0].ReadWrite();
+         auto Uy = t_grad[1].ReadWrite();
+         MFEM_FORALL(q, NQ,
+         {
+            const double *d = D + 5*q;
+            // gradient of u = U/W, times W
+            const double gx = Ux[q] - U[q]*d[0];
+            const double gy = Uy[q] - U[q]*d[1];
+            const double fx = d[2]*gx + d[3]*gy;
+            const double fy = d[3]*gx + d[4]*gy;
+            U[q] = -(d[0]*fx + d[1]*fy);
+            Ux[q] = fx;
+            Uy[q] = fy;
+         });
+      }
+      else
+      {
+         auto Ux = t_grad[0].ReadWrite();
+         auto Uy = t_grad[1].ReadWrite();
+         auto Uz = t_grad[2].ReadWrite();
+         MFEM_FORALL(q, NQ,
+         {
+            const double *d = D + 9*q;
+            const double gx = Ux[q] - U[q]*d[0];
+            const double gy = Uy[q] - U[q]*d[1];
+            const double gz = Uz[q] - U[q]*d[2];
+            const double fx = d[3]*gx + d[4]*gy + d[5]*gz;
+            const double fy = d[4]*gx + d[6]*gy + d[7]*gz;
+            const double fz = d[5]*gx + d[7]*gy + d[8]*gz;
+            U[q] = -(d[0]*fx + d[1]*fy + d[2]*fz);
+            Ux[q] = fx;
+            Uy[q] = fy;
+            Uz[q] = fz;
+         });
+      }
+
+      InterpolateT(P, grad, xw);
+      PatchScatter(P.dofs, P.weights, P.unique, 1, xw, y);
+   }
+}
+
+void NURBSPatchPA::AssembleDiagonal(Vector &diag) const
+{
+   // The diagonal entry of the dof i = (i_0,...) is a sum over the points of
+   // products of 1D factors, e.g. B(q_0,i_0)^2 B(q_1,i_1)^2 ... for the mass.
+   // For the diffusion, the squared rational gradient
+   //    (grad N_i - N_i c)^T D (grad N_i - N_i c),  c = grad(W)/W,
+   // expands into terms whose 1D factors are BB, GG or BG along each axis.
+   Vector dpatch, coef;
+   dpatch.UseDevice(true);
+   coef.UseDevice(true);
+   for (const Patch &P : patches)
+   {
+      if (P.n[0] == 0) { continue; }
+      const int NQ = P.nq[0]*P.nq[1]*P.nq[2];
+      dpatch.SetSize(P.dofs.Size());
+      dpatch = 0.0;
+      coef.SetSize(NQ);
+
+      // Add the term with the given factors along each axis.
+      auto add_term = [&](const int *factor)
+      {
+         int n[3] = { P.nq[0], P.nq[1], P.nq[2] };
+         const Vector *in = &coef;
+         for (int a = dim-1; a >= 0; a--)
+         {
+            const Basis1D &b = P.basis[a];
+            const Vector &M = factor[a] == 0 ? b.BB :
+                              factor[a] == 1 ? b.BG : b.GG;
+            n[a] = b.ndof;
+            Vector &out = (a == 0) ? dpatch : t_tmp;
+            PatchContractT(a, n, b.nq, b.p1, b.offset, M, *in, out, a == 0);
+            if (a > 0) { t_val.Swap(t_tmp); in = &t_val; }
+         }
+      };
+
+      auto D = P.qdata.Read();
+      const int DIM = dim;
+      if (type == MASS)
+      {
+         coef = P.qdata;
+         const int f[3] = { 0, 0, 0 };
+         add_term(f);
+      }
+      else
+      {
+         const int ND = dim + dim*(dim+1)/2;
+         // kind 0: c^T D c, all BB; kind 1: D_ii, GG along i; kind 2:
+         // -2 (D c)_i, BG along i; kind 3: 2 D_ij, BG along i and j.
+         for (int kind = 0; kind < 4; kind++)
+         {
+            for (int i = 0; i < (kind ? dim : 1); i++)
+            {
+               for (int j = (kind == 3) ? i+1 : i; j < (kind == 3 ? dim : i+1);
+                    j++)
+               {
+                  const int KIND = kind, I = i, J = j;
+                  auto C = coef.Write();
+                  MFEM_FORALL(q, NQ,
+                  {
+                     const double *c = D + ND*q, *d = c + DIM;
+                     double v = 0.0;
+                     if (KIND == 0)
+                     {
+                        for (int k = 0; k < DIM; k++)
+                        {
+                           for (int l = 0; l < DIM; l++)
+                           {
+                              const int kl = k <= l ? SymIdx(DIM,k,l) :
+                                             SymIdx(DIM,l,k);
+                              v += c[k]*d[kl]*c[l];
+                           }
+                        }
+                     }
+                     else if (KIND == 1) { v = d[SymIdx(DIM,I,I)]; }
+                     else if (KIND == 2)
+                     {
+                        for (int k = 0; k < DIM; k++)
+                        {
+                           const int ik = I <= k ? SymIdx(DIM,I,k) :
+                                          SymIdx(DIM,k,I);
+                           v -= 2.0*d[ik]*c[k];
+                        }
+                     }
+                     else { v = 2.0*d[SymIdx(DIM,I,J)]; }
+                     C[q] = v;
+                  });
+                  int f[3] = { 0, 0, 0 };
+                  if (kind == 1) { f[i] = 2; }
+                  if (kind == 2) { f[i] = 1; }
+                  if (kind == 3) { f[i] = f[j] = 1; }
+                  add_term(f);
+               }
+            }
+         }
+      }
+      PatchScatter(P.dofs, P.weights, P.unique, 2, dpatch, diag);
+   }
+}
+
+int NURBSPatchPA::GetNPoints() const
+{
+   int nqp = 0;
+   for (const Patch &P : patches)
+   {
+      if (P.n[0] > 0) { nqp += P.nq[0]*P.nq[1]*P.nq[2]; }
+   }
+   return nqp;
+}
+
+} // namespace mfem
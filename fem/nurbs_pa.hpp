@@ -0,0 +1,110 @@
+// Copyright (c) 2010-2020, Lawrence Livermore National Security, LLC. Produced
+// at the Lawrence Livermore National Laboratory. All Rights reserved. See files
+// LICENSE and NOTICE for details. LLNL-CODE-806117.
+//
+// This file is part of the MFEM library. For more information and source code
+// availability visit https://mfem.org.
+//
+// MFEM is free software; you can redistribute it and/or modify it under the
+// terms of the BSD-3 license. We welcome feedback and contributions, see file
+// CONTRIBUTING.md for details.
+
+#ifndef MFEM_NURBS_PA
+#define MFEM_NURBS_PA
+
+#include "../config/config.hpp"
+#include "../general/array.hpp"
+#include "../linalg/vector.hpp"
+#include <vector>
+
+namespace mfem
+{
+
+class FiniteElementSpace;
+class Coefficient;
+
+/** @brief Patch-wise partial assembly of the mass and diffusion operators on
+    NURBS finite element spaces.
+
+    The basis of a NURBSPatch is the tensor product of 1D B-spline bases,
+    weighted by the control point weights. Instead of evaluating the rational
+    shape functions element by element, this class tabulates once per patch
+    and direction the B-spline values and derivatives at the quadrature points
+    of all knot spans, and applies the operator with sum factorization over the
+    whole patch. The rational basis R_i = w_i N_i / W, with W = sum_j w_j N_j,
+    is handled exactly by scaling the dofs with the weights and folding W and
+    its gradient into the quadrature point data.
+
+    The quadrature is a tensor Gauss rule in every knot span. By default it has
+    the order of the element-wise assembly, so that both agree to rounding;
+    SetPointsPerSpan() selects a different (e.g. reduced) number of points.
+
+    The operator acts on L-vectors of the space, i.e. it is used by
+    PABilinearFormExtension without an element restriction. Only serial spaces
+    (or parallel ones where each rank owns whole patches) with vdim = 1 are
+    supported. */
+class NURBSPatchPA
+{
+public:
+   enum Type { MASS, DIFFUSION };
+
+   /// Construct an empty operator of the given @a type, see Assemble().
+   NURBSPatchPA(Type type) : type(type), q1d(0), dim(0) { }
+
+   /** @brief Use @a q Gauss points per knot span and direction, e.g. fewer
+       than the degree plus one for a reduced quadrature. The default, 0, uses
+       the order of the element-wise rule. Call before Assemble(). */
+   void SetPointsPerSpan(int q) { q1d = q; }
+
+   /** @brief Tabulate the 1D bases and compute the quadrature point data of
+       all patches of @a fes, with the coefficient @a Q (1 if NULL). The
+       number of points per span is taken from @a order, the order of the 1D
+       Gauss rule, unless set with SetPointsPerSpan(). */
+   void Assemble(const FiniteElementSpace &fes, Coefficient *Q, int order);
+
+   /// Add the action of the operator on the L-vector @a x to @a y.
+   void AddMult(const Vector &x, Vector &y) const;
+
+   /// Add the diagonal of the operator to the L-vector @a diag.
+   void AssembleDiagonal(Vector &diag) const;
+
+   /// Return the total number of quadrature points of all patches.
+   int GetNPoints() const;
+
+protected:
+   /// B-spline values (B) and derivatives (G) of one patch direction at its
+   /// quadrature points, stored as rows of p+1 entries that start at the
+   /// control point 'offset'. BB, GG, BG hold the entrywise products.
+   struct Basis1D
+   {
+      int ndof, nq, p1;
+      Array<int> offset;
+      Vector B, G, BB, GG, BG;
+   };
+
+   struct Patch
+   {
+      int n[3], nq[3];
+      Array<int> dofs;   ///< Lexicographic patch dofs -> L-vector dofs.
+      bool unique;       ///< True if no L-vector dof appears twice.
+      Vector weights;    ///< Control point weights of the patch dofs.
+      Basis1D basis[3];
+      /// Mass: one value per point; diffusion: grad(W)/W (dim values) and the
+      /// symmetric matrix of the flux (dim*(dim+1)/2 values) per point.
+      Vector qdata;
+   };
+
+   Type type;
+   int q1d, dim;
+   std::vector<Patch> patches;
+   mutable Vector xw, t_val, t_tmp, t_grad[3];
+
+   void SetupPatch(const FiniteElementSpace &fes, int p, Coefficient *Q,
+                   int nq1d, const Array<int> &elems);
+   void Interpolate(const Patch &P, const Vector &u, bool grad) const;
+   void InterpolateT(const Patch &P, bool grad, Vector &u) const;
+};
+
+} // namespace mfem
+
+#endif
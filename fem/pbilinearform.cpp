@@ -121,6 +121,16 @@ void ParBilinearForm::pAllocMat()
    dof_dof.LoseData();
 }
 
+SparseMatrix *ParBilinearForm::LocalMatrix()
+{
+   if (assembly != AssemblyLevel::FULL) { return mat; }
+   MFEM_VERIFY(fbfi.Size() == 0, "interior face integrators are not supported"
+               " with AssemblyLevel::FULL");
+   // The rows of the local matrix have their diagonal entry first, so it can
+   // be used as the diagonal block of a hypre matrix without reordering.
+   return &static_cast<FABilinearFormExtension*>(ext)->GetMatrix();
+}
+
 void ParBilinearForm::ParallelAssemble(OperatorHandle &A, SparseMatrix *A_local)
 {
    A.Clear();
@@ -299,7 +309,7 @@ void ParBilinearForm::FormLinearSystem(
    const Array<int> &ess_tdof_list, Vector &x, Vector &b,
    OperatorHandle &A, Vector &X, Vector &B, int copy_interior)
 {
-   if (ext)
+   if (ext && !static_cond && !hybridization)
    {
       ext->FormLinearSystem(ess_tdof_list, x, b, A, X, B, copy_interior);
       return;
@@ -348,7 +358,7 @@ void ParBilinearForm::FormLinearSystem(
 void ParBilinearForm::FormSystemMatrix(const Array<int> &ess_tdof_list,
                                        OperatorHandle &A)
 {
-   if (ext)
+   if (ext && !static_cond && !hybridization)
    {
       ext->FormSystemMatrix(ess_tdof_list, A);
       return;
@@ -396,7 +406,7 @@ void ParBilinearForm::FormSystemMatrix(const Array<int> &ess_tdof_list,
 void ParBilinearForm::RecoverFEMSolution(
    const Vector &X, const Vector &b, Vector &x)
 {
-   if (ext)
+   if (ext && !static_cond && !hybridization)
    {
       ext->RecoverFEMSolution(X, b, x);
       return;
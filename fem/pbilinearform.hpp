@@ -42,6 +42,10 @@ protected:
 
    void AssembleSharedFaces(int skip_zeros = 1);
 
+   /** Return #mat or, with AssemblyLevel::FULL, the local matrix assembled by
+       the FABilinearFormExtension. */
+   SparseMatrix *LocalMatrix();
+
 private:
    /// Copy construction is not supported; body is undefined.
    ParBilinearForm(const ParBilinearForm &);
@@ -91,7 +95,8 @@ public:
 
    /// Returns the matrix assembled on the true dofs, i.e. P^t A P.
    /** The returned matrix has to be deleted by the caller. */
-   HypreParMatrix *ParallelAssemble() { return ParallelAssemble(mat); }
+   HypreParMatrix *ParallelAssemble()
+   { return ParallelAssemble(LocalMatrix()); }
 
    /// Returns the eliminated matrix assembled on the true dofs, i.e. P^t A_e P.
    /** The returned matrix has to be deleted by the caller. */
@@ -103,7 +108,8 @@ public:
 
    /** @brief Returns the matrix assembled on the true dofs, i.e.
        @a A = P^t A_local P, in the format (type id) specified by @a A. */
-   void ParallelAssemble(OperatorHandle &A) { ParallelAssemble(A, mat); }
+   void ParallelAssemble(OperatorHandle &A)
+   { ParallelAssemble(A, LocalMatrix()); }
 
    /** Returns the eliminated matrix assembled on the true dofs, i.e.
        @a A_elim = P^t A_elim_local P in the format (type id) specified by @a A.
@@ -0,0 +1,581 @@
+// Copyright (c) 2010-2020, Lawrence Livermore National Security, LLC. Produced
+// at the Lawrence Livermore National Laboratory. All Rights reserved. See files
+// LICENSE and NOTICE for details. LLNL-CODE-806117.
+//
+// This file is part of the MFEM library. For more information and source code
+// availability visit https://mfem.org.
+//
+// MFEM is free software; you can redistribute it and/or modify it under the
+// terms of the BSD-3 license. We welcome feedback and contributions, see file
+// CONTRIBUTING.md for details.
+
+#include "pointlocator.hpp"
+#include "../general/communication.hpp"
+
+#include <cmath>
+#include <limits>
+
+namespace mfem
+{
+
+// Tolerance (in reference space) used to distinguish the points inside an
+// element from the points on its boundary.
+static const double bdr_tol = 1e-8;
+
+// Set up a uniform grid covering the union of the 'nbox' boxes stored in
+// 'boxes' (2*sdim entries per box: the minimum, then the maximum corner) with
+// approximately 'ncells' cells, and the table of the boxes intersecting each
+// cell. Empty boxes (min > max) are ignored.
+static void BuildBoxHash(const Vector &boxes, int nbox, int sdim, int ncells,
+                         Array<int> &n, Vector &hmin, Vector &h, Table &table)
+{
+   const double inf = std::numeric_limits<double>::infinity();
+   Vector hmax(sdim);
+   hmin.SetSize(sdim);
+   hmin = inf;
+   hmax = -inf;
+   for (int b = 0; b < nbox; b++)
+   {
+      const double *bb = boxes.GetData() + 2*sdim*b;
+      if (bb[0] > bb[sdim]) { continue; }
+      for (int d = 0; d < sdim; d++)
+      {
+         hmin(d) = std::min(hmin(d), bb[d]);
+         hmax(d) = std::max(hmax(d), bb[sdim+d]);
+      }
+   }
+
+   const int n1d = std::max(1, (int) std::floor(std::pow(double(ncells),
+                                                          1.0/sdim)));
+   n.SetSize(sdim);
+   h.SetSize(sdim);
+   int total = 1;
+   for (int d = 0; d < sdim; d++)
+   {
+      if (!(hmax(d) > hmin(d)))
+      {
+         // Empty or degenerate extent: use a single cell.
+         if (hmin(d) > hmax(d)) { hmin(d) = hmax(d) = 0.0; }
+         n[d] = 1;
+         h(d) = 1.0;
+      }
+      else
+      {
+         n[d] = n1d;
+         h(d) = (hmax(d) - hmin(d))/n1d;
+      }
+      total *= n[d];
+   }
+
+   table.MakeI(total);
+   for (int pass = 0; pass < 2; pass++)
+   {
+      for (int b = 0; b < nbox; b++)
+      {
+         const double *bb = boxes.GetData() + 2*sdim*b;
+         if (bb[0] > bb[sdim]) { continue; }
+         int lo[3] = { 0, 0, 0 }, hi[3] = { 0, 0, 0 };
+         for (int d = 0; d < sdim; d++)
+         {
+            lo[d] = (int) std::floor((bb[d] - hmin(d))/h(d));
+            hi[d] = (int) std::floor((bb[sdim+d] - hmin(d))/h(d));
+            lo[d] = std::min(std::max(lo[d], 0), n[d]-1);
+            hi[d] = std::min(std::max(hi[d], 0), n[d]-1);
+         }
+         for (int k = lo[2]; k <= hi[2]; k++)
+         {
+            for (int j = lo[1]; j <= hi[1]; j++)
+            {
+               for (int i = lo[0]; i <= hi[0]; i++)
+               {
+                  int cell = i;
+                  if (sdim > 1) { cell += n[0]*j; }
+                  if (sdim > 2) { cell += n[0]*n[1]*k; }
+                  if (pass == 0) { table.AddAColumnInRow(cell); }
+                  else { table.AddConnection(cell, b); }
+               }
+            }
+         }
+      }
+      if (pass == 0) { table.MakeJ(); }
+   }
+   table.ShiftUpI();
+}
+
+// Return the cell of the uniform grid (n, hmin, h) containing the point x, or
+// -1 if x is outside of the grid.
+static int GetHashCell(const double *x, const Array<int> &n,
+                       const Vector &hmin, const Vector &h)
+{
+   int cell = 0, stride = 1;
+   for (int d = 0; d < n.Size(); d++)
+   {
+      const double t = (x[d] - hmin(d))/h(d);
+      if (t < 0.0 || t > n[d]) { return -1; }
+      const int i = std::min((int) t, n[d]-1);
+      cell += stride*i;
+      stride *= n[d];
+   }
+   return cell;
+}
+
+static bool BoxContains(const double *bb, const double *x, int sdim)
+{
+   for (int d = 0; d < sdim; d++)
+   {
+      if (x[d] < bb[d] || x[d] > bb[sdim+d]) { return false; }
+   }
+   return true;
+}
+
+void PointLocator::ExchangeCounts(const Array<int> &send_cnt,
+                                  Array<int> &recv_cnt) const
+{
+   recv_cnt.SetSize(nranks);
+#ifdef MFEM_USE_MPI
+   MPI_Alltoall(const_cast<int*>(send_cnt.GetData()), 1, MPI_INT,
+                recv_cnt.GetData(), 1, MPI_INT, comm);
+#else
+   recv_cnt = send_cnt;
+#endif
+}
+
+template <typename T>
+void PointLocator::ExchangeData(const Array<int> &send_cnt,
+                                const Array<T> &send,
+                                const Array<int> &recv_cnt, Array<T> &recv,
+                                int unit) const
+{
+#ifdef MFEM_USE_MPI
+   Array<int> sc(nranks), sd(nranks), rc(nranks), rd(nranks);
+   int s_off = 0, r_off = 0;
+   for (int r = 0; r < nranks; r++)
+   {
+      sc[r] = unit*send_cnt[r];
+      sd[r] = s_off;
+      s_off += sc[r];
+      rc[r] = unit*recv_cnt[r];
+      rd[r] = r_off;
+      r_off += rc[r];
+   }
+   recv.SetSize(r_off);
+   MPI_Alltoallv(const_cast<T*>(send.GetData()), sc.GetData(), sd.GetData(),
+                 MPITypeMap<T>::mpi_type, recv.GetData(), rc.GetData(),
+                 rd.GetData(), MPITypeMap<T>::mpi_type, comm);
+#else
+   MFEM_CONTRACT_VAR(send_cnt);
+   MFEM_CONTRACT_VAR(recv_cnt);
+   MFEM_CONTRACT_VAR(unit);
+   recv = send;
+#endif
+}
+
+PointLocator::PointLocator()
+   : mesh(NULL), dim(0), sdim(0), newt_tol(1e-12), myid(0), nranks(1)
+{
+#ifdef MFEM_USE_MPI
+   comm = MPI_COMM_SELF;
+#endif
+}
+
+#ifdef MFEM_USE_MPI
+PointLocator::PointLocator(MPI_Comm comm_)
+   : mesh(NULL), dim(0), sdim(0), newt_tol(1e-12), comm(comm_)
+{
+   MPI_Comm_rank(comm, &myid);
+   MPI_Comm_size(comm, &nranks);
+}
+#endif
+
+void PointLocator::Setup(Mesh &m, const double bb_t, const double newt_tol_)
+{
+   mesh = &m;
+   dim = m.Dimension();
+   sdim = m.SpaceDimension();
+   newt_tol = newt_tol_;
+
+   // Element bounding boxes, computed from the mesh nodes (or vertices) and
+   // enlarged by the factor bb_t to account for curved elements.
+   const int NE = m.GetNE();
+   const GridFunction *nodes = m.GetNodes();
+   if (nodes) { nodes->HostRead(); }
+   elem_bb.SetSize(2*sdim*NE);
+   Array<int> vdofs, verts;
+   Vector el_x;
+   for (int e = 0; e < NE; e++)
+   {
+      double *bb = elem_bb.GetData() + 2*sdim*e;
+      int npts;
+      if (nodes)
+      {
+         nodes->FESpace()->GetElementVDofs(e, vdofs);
+         nodes->GetSubVector(vdofs, el_x);
+         npts = el_x.Size()/sdim;
+      }
+      else
+      {
+         m.GetElementVertices(e, verts);
+         npts = verts.Size();
+         el_x.SetSize(npts*sdim);
+         for (int i = 0; i < npts; i++)
+         {
+            const double *v = m.GetVertex(verts[i]);
+            for (int d = 0; d < sdim; d++) { el_x(i + d*npts) = v[d]; }
+         }
+      }
+      double size = 0.0;
+      for (int d = 0; d < sdim; d++)
+      {
+         bb[d] = bb[sdim+d] = el_x(d*npts);
+         for (int i = 1; i < npts; i++)
+         {
+            bb[d] = std::min(bb[d], el_x(i + d*npts));
+            bb[sdim+d] = std::max(bb[sdim+d], el_x(i + d*npts));
+         }
+         size = std::max(size, bb[sdim+d] - bb[d]);
+      }
+      for (int d = 0; d < sdim; d++)
+      {
+         bb[d] -= bb_t*size;
+         bb[sdim+d] += bb_t*size;
+      }
+   }
+   BuildBoxHash(elem_bb, NE, sdim, NE, hash_n, hash_min, hash_h, hash_table);
+
+   // Bounding box of the local mesh (empty if there are no local elements)
+   // and the global coarse map of the rank bounding boxes.
+   Vector local_bb(2*sdim);
+   for (int d = 0; d < sdim; d++)
+   {
+      local_bb(d) = std::numeric_limits<double>::infinity();
+      local_bb(sdim+d) = -std::numeric_limits<double>::infinity();
+      for (int e = 0; e < NE; e++)
+      {
+         local_bb(d) = std::min(local_bb(d), elem_bb(2*sdim*e + d));
+         local_bb(sdim+d) = std::max(local_bb(sdim+d),
+                                     elem_bb(2*sdim*e + sdim + d));
+      }
+   }
+   rank_bb.SetSize(2*sdim*nranks);
+#ifdef MFEM_USE_MPI
+   MPI_Allgather(local_bb.GetData(), 2*sdim, MPI_DOUBLE, rank_bb.GetData(),
+                 2*sdim, MPI_DOUBLE, comm);
+#else
+   rank_bb = local_bb;
+#endif
+   BuildBoxHash(rank_bb, nranks, sdim, nranks, ghash_n, ghash_min, ghash_h,
+                ghash_table);
+}
+
+void PointLocator::FindLocalPoints(const double *pts, int npts,
+                                   Array<int> &codes, Array<int> &elems,
+                                   Vector &refs, Vector &dists) const
+{
+   codes.SetSize(npts);
+   elems.SetSize(npts);
+   refs.SetSize(npts*dim);
+   dists.SetSize(npts);
+   codes = NOT_FOUND;
+   elems = -1;
+   refs = 0.0;
+   dists = std::numeric_limits<double>::infinity();
+
+   // Group the candidate (point, element) pairs by element.
+   const int NE = mesh->GetNE();
+   Table el_pts;
+   el_pts.MakeI(NE);
+   for (int pass = 0; pass < 2; pass++)
+   {
+      for (int p = 0; p < npts; p++)
+      {
+         const double *x = pts + p*sdim;
+         const int cell = GetHashCell(x, hash_n, hash_min, hash_h);
+         if (cell < 0) { continue; }
+         const int *cand = hash_table.GetRow(cell);
+         for (int c = 0; c < hash_table.RowSize(cell); c++)
+         {
+            const int e = cand[c];
+            if (!BoxContains(elem_bb.GetData() + 2*sdim*e, x, sdim))
+            {
+               continue;
+            }
+            if (pass == 0) { el_pts.AddAColumnInRow(e); }
+            else { el_pts.AddConnection(e, p); }
+         }
+      }
+      if (pass == 0) { el_pts.MakeJ(); }
+   }
+   el_pts.ShiftUpI();
+
+   // Invert the element transformations, element by element.
+   InverseElementTransformation inv_tr;
+   inv_tr.SetReferenceTol(newt_tol);
+   if (mesh->GetNodes())
+   {
+      inv_tr.SetInitialGuessType(
+         InverseElementTransformation::ClosestPhysNode);
+   }
+   Vector x(sdim);
+   IntegrationPoint ip;
+   for (int e = 0; e < NE; e++)
+   {
+      const int n = el_pts.RowSize(e);
+      if (n == 0) { continue; }
+      const int *row = el_pts.GetRow(e);
+      const Geometry::Type geom = mesh->GetElementBaseGeometry(e);
+      ElementTransformation *T = mesh->GetElementTransformation(e);
+      inv_tr.SetTransformation(*T);
+      for (int k = 0; k < n; k++)
+      {
+         const int p = row[k];
+         if (codes[p] == INSIDE) { continue; }
+         Vector pt(const_cast<double*>(pts + p*sdim), sdim);
+         const int res = inv_tr.Transform(pt, ip);
+         int code = NOT_FOUND;
+         if (res == InverseElementTransformation::Inside)
+         {
+            code = Geometry::CheckPoint(geom, ip, -bdr_tol) ?
+                   INSIDE : ON_BOUNDARY;
+         }
+         T->SetIntPoint(&ip);
+         T->Transform(ip, x);
+         const double dist = x.DistanceTo(pt);
+         if (code < codes[p] || (code == codes[p] && dist < dists(p)))
+         {
+            codes[p] = code;
+            elems[p] = e;
+            dists(p) = dist;
+            double ref[3] = { ip.x, ip.y, ip.z };
+            for (int d = 0; d < dim; d++) { refs(p*dim + d) = ref[d]; }
+         }
+      }
+   }
+}
+
+void PointLocator::InterpolateLocal(const GridFunction &field,
+                                    const Array<int> &elems,
+                                    const double *refs, Vector &vals) const
+{
+   const int npts = elems.Size();
+   const int vdim = field.VectorDim();
+   vals.SetSize(npts*vdim);
+   vals = 0.0;
+   field.HostRead();
+
+   // Group the points by element, so that the element dofs are gathered once
+   // for all the points in the element.
+   const int NE = mesh->GetNE();
+   Table el_pts;
+   Transpose(elems, el_pts, NE);
+
+   const FiniteElementSpace *fes = field.FESpace();
+   Array<int> vdofs;
+   Vector loc_dofs, shape, val;
+   IntegrationPoint ip;
+   for (int e = 0; e < NE; e++)
+   {
+      const int n = el_pts.RowSize(e);
+      if (n == 0) { continue; }
+      const int *row = el_pts.GetRow(e);
+      const FiniteElement *fe = fes->GetFE(e);
+      ElementTransformation *T = mesh->GetElementTransformation(e);
+      if (fe->GetRangeType() == FiniteElement::SCALAR)
+      {
+         const int dof = fe->GetDof();
+         fes->GetElementVDofs(e, vdofs);
+         field.GetSubVector(vdofs, loc_dofs);
+         DenseMatrix loc_mat(loc_dofs.GetData(), dof, vdim);
+         shape.SetSize(dof);
+         for (int k = 0; k < n; k++)
+         {
+            const int p = row[k];
+            ip.Set(refs + p*dim, dim);
+            T->SetIntPoint(&ip);
+            fe->CalcPhysShape(*T, shape);
+            val.SetDataAndSize(vals.GetData() + p*vdim, vdim);
+            loc_mat.MultTranspose(shape, val);
+         }
+      }
+      else
+      {
+         for (int k = 0; k < n; k++)
+         {
+            const int p = row[k];
+            ip.Set(refs + p*dim, dim);
+            T->SetIntPoint(&ip);
+            val.SetDataAndSize(vals.GetData() + p*vdim, vdim);
+            field.GetVectorValue(*T, ip, val);
+         }
+      }
+   }
+}
+
+void PointLocator::FindPoints(const Vector &point_pos)
+{
+   MFEM_VERIFY(mesh != NULL, "Setup() must be called first");
+   const int npt = point_pos.Size()/sdim;
+   MFEM_VERIFY(point_pos.Size() == npt*sdim, "invalid point_pos size");
+   const double *pos = point_pos.HostRead();
+
+   // Route each point to the ranks whose bounding box contains it.
+   Table pt_ranks;
+   pt_ranks.MakeI(npt);
+   Vector x(sdim);
+   for (int pass = 0; pass < 2; pass++)
+   {
+      for (int p = 0; p < npt; p++)
+      {
+         for (int d = 0; d < sdim; d++) { x(d) = pos[p + d*npt]; }
+         const int cell = GetHashCell(x.GetData(), ghash_n, ghash_min, ghash_h);
+         if (cell < 0) { continue; }
+         const int *cand = ghash_table.GetRow(cell);
+         for (int c = 0; c < ghash_table.RowSize(cell); c++)
+         {
+            const int r = cand[c];
+            if (!BoxContains(rank_bb.GetData() + 2*sdim*r, x.GetData(), sdim))
+            {
+               continue;
+            }
+            if (pass == 0) { pt_ranks.AddAColumnInRow(p); }
+            else { pt_ranks.AddConnection(p, r); }
+         }
+      }
+      if (pass == 0) { pt_ranks.MakeJ(); }
+   }
+   pt_ranks.ShiftUpI();
+   Table rank_pts;
+   Transpose(pt_ranks, rank_pts, nranks);
+
+   Array<int> send_cnt(nranks), recv_cnt;
+   for (int r = 0; r < nranks; r++) { send_cnt[r] = rank_pts.RowSize(r); }
+   ExchangeCounts(send_cnt, recv_cnt);
+
+   Array<double> send_x(rank_pts.Size_of_connections()*sdim), recv_x;
+   for (int i = 0; i < rank_pts.Size_of_connections(); i++)
+   {
+      const int p = rank_pts.GetJ()[i];
+      for (int d = 0; d < sdim; d++) { send_x[i*sdim + d] = pos[p + d*npt]; }
+   }
+   ExchangeData(send_cnt, send_x, recv_cnt, recv_x, sdim);
+
+   // Search the received points in the local mesh and send the results back.
+   const int nrecv = recv_x.Size()/sdim;
+   Array<int> codes, elems;
+   Vector refs, dists;
+   FindLocalPoints(recv_x.GetData(), nrecv, codes, elems, refs, dists);
+
+   Array<int> res_i(2*nrecv), ret_i;
+   Array<double> res_d((dim+1)*nrecv), ret_d;
+   for (int i = 0; i < nrecv; i++)
+   {
+      res_i[2*i] = codes[i];
+      res_i[2*i+1] = elems[i];
+      for (int d = 0; d < dim; d++) { res_d[(dim+1)*i + d] = refs(i*dim + d); }
+      res_d[(dim+1)*i + dim] = dists(i);
+   }
+   ExchangeData(recv_cnt, res_i, send_cnt, ret_i, 2);
+   ExchangeData(recv_cnt, res_d, send_cnt, ret_d, dim+1);
+
+   // Keep the best result over all ranks.
+   pt_code.SetSize(npt);
+   pt_proc.SetSize(npt);
+   pt_elem.SetSize(npt);
+   pt_ref.SetSize(npt*dim);
+   pt_dist.SetSize(npt);
+   pt_code = NOT_FOUND;
+   pt_proc = -1;
+   pt_elem = -1;
+   pt_ref = 0.0;
+   pt_dist = std::numeric_limits<double>::infinity();
+   for (int r = 0, i = 0; r < nranks; r++)
+   {
+      for (int k = 0; k < rank_pts.RowSize(r); k++, i++)
+      {
+         const int p = rank_pts.GetRow(r)[k];
+         const int code = ret_i[2*i], elem = ret_i[2*i+1];
+         const double dist = ret_d[(dim+1)*i + dim];
+         if (elem < 0) { continue; }
+         if (code < pt_code[p] || (code == pt_code[p] && dist < pt_dist(p)))
+         {
+            pt_code[p] = code;
+            pt_proc[p] = r;
+            pt_elem[p] = elem;
+            pt_dist(p) = dist;
+            for (int d = 0; d < dim; d++)
+            {
+               pt_ref(p*dim + d) = ret_d[(dim+1)*i + d];
+            }
+         }
+      }
+   }
+}
+
+void PointLocator::FindPoints(Mesh &m, const Vector &point_pos,
+                              const double bb_t, const double newt_tol_)
+{
+   Setup(m, bb_t, newt_tol_);
+   FindPoints(point_pos);
+}
+
+void PointLocator::Interpolate(const GridFunction &field_in, Vector &field_out)
+{
+   MFEM_VERIFY(field_in.FESpace()->GetMesh() == mesh,
+               "the field must be defined on the mesh given to Setup()");
+   const int npt = pt_code.Size();
+   const int vdim = field_in.VectorDim();
+
+   // Send the interpolation requests to the ranks owning the elements.
+   Table pt_rank;
+   pt_rank.MakeI(npt);
+   for (int p = 0; p < npt; p++)
+   {
+      if (pt_elem[p] >= 0) { pt_rank.AddAColumnInRow(p); }
+   }
+   pt_rank.MakeJ();
+   for (int p = 0; p < npt; p++)
+   {
+      if (pt_elem[p] >= 0) { pt_rank.AddConnection(p, pt_proc[p]); }
+   }
+   pt_rank.ShiftUpI();
+   Table rank_pts;
+   Transpose(pt_rank, rank_pts, nranks);
+
+   Array<int> send_cnt(nranks), recv_cnt;
+   for (int r = 0; r < nranks; r++) { send_cnt[r] = rank_pts.RowSize(r); }
+   ExchangeCounts(send_cnt, recv_cnt);
+
+   const int nsend = rank_pts.Size_of_connections();
+   Array<int> send_el(nsend), recv_el;
+   Array<double> send_ref(nsend*dim), recv_ref;
+   for (int i = 0; i < nsend; i++)
+   {
+      const int p = rank_pts.GetJ()[i];
+      send_el[i] = pt_elem[p];
+      for (int d = 0; d < dim; d++) { send_ref[i*dim + d] = pt_ref(p*dim + d); }
+   }
+   ExchangeData(send_cnt, send_el, recv_cnt, recv_el, 1);
+   ExchangeData(send_cnt, send_ref, recv_cnt, recv_ref, dim);
+
+   Vector vals;
+   InterpolateLocal(field_in, recv_el, recv_ref.GetData(), vals);
+   Array<double> res(vals.GetData(), vals.Size()), ret;
+   ExchangeData(recv_cnt, res, send_cnt, ret, vdim);
+
+   field_out.SetSize(npt*vdim);
+   field_out.HostWrite();
+   field_out = 0.0;
+   for (int i = 0; i < nsend; i++)
+   {
+      const int p = rank_pts.GetJ()[i];
+      for (int c = 0; c < vdim; c++) { field_out(p + c*npt) = ret[i*vdim + c]; }
+   }
+}
+
+void PointLocator::Interpolate(const Vector &point_pos,
+                               const GridFunction &field_in, Vector &field_out)
+{
+   FindPoints(point_pos);
+   Interpolate(field_in, field_out);
+}
+
+} // namespace mfem
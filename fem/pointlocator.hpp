@@ -0,0 +1,169 @@
+// Copyright (c) 2010-2020, Lawrence Livermore National Security, LLC. Produced
+// at the Lawrence Livermore National Laboratory. All Rights reserved. See files
+// LICENSE and NOTICE for details. LLNL-CODE-806117.
+//
+// This file is part of the MFEM library. For more information and source code
+// availability visit https://mfem.org.
+//
+// MFEM is free software; you can redistribute it and/or modify it under the
+// terms of the BSD-3 license. We welcome feedback and contributions, see file
+// CONTRIBUTING.md for details.
+
+#ifndef MFEM_POINTLOCATOR
+#define MFEM_POINTLOCATOR
+
+#include "../config/config.hpp"
+#include "../general/table.hpp"
+#include "gridfunc.hpp"
+
+#ifdef MFEM_USE_MPI
+#include <mpi.h>
+#endif
+
+namespace mfem
+{
+
+/** @brief Locate arbitrary points in a (possibly distributed, high-order) mesh
+    and interpolate GridFunction%s at these points.
+
+    This class provides the functionality of FindPointsGSLIB without requiring
+    the GSLIB library, for all element types supported by
+    InverseElementTransformation:
+
+    - The element bounding boxes (computed from the mesh nodes and enlarged by
+      a relative factor) are sorted into a uniform grid (spatial hash) on each
+      rank, and the bounding boxes of the ranks are sorted into a global coarse
+      grid, used to route the points to the ranks that may contain them.
+    - The candidate (point, element) pairs are processed element by element, so
+      that every ElementTransformation is set up once for all of its points,
+      and are inverted with InverseElementTransformation.
+    - The results are sent back to the ranks that requested them, which keep
+      the best match over all ranks.
+
+    Interpolation uses the same communication pattern: the requests are sent
+    to the ranks owning the elements, which evaluate the field element by
+    element and return the values.
+
+    In contrast to FindPointsGSLIB, the reference coordinates are given in the
+    MFEM reference elements, e.g. [0,1]^d for tensor-product elements. */
+class PointLocator
+{
+public:
+   /// Return codes of FindPoints(), matching the codes of FindPointsGSLIB.
+   enum Code
+   {
+      INSIDE = 0,      ///< The point is inside an element.
+      ON_BOUNDARY = 1, ///< The point is on the boundary of an element.
+      NOT_FOUND = 2    ///< The point was not found.
+   };
+
+protected:
+   Mesh *mesh;
+   int dim, sdim;
+   double newt_tol;
+
+   // Bounding boxes of the local elements (min/max for each element, 2*sdim
+   // entries per element) and their spatial hash.
+   Vector elem_bb;
+   Array<int> hash_n;
+   Vector hash_min, hash_h;
+   Table hash_table;
+
+   // Bounding boxes of all ranks and their spatial hash.
+   Vector rank_bb;
+   Array<int> ghash_n;
+   Vector ghash_min, ghash_h;
+   Table ghash_table;
+
+   int myid, nranks;
+#ifdef MFEM_USE_MPI
+   MPI_Comm comm;
+#endif
+
+   // Results of the last call to FindPoints().
+   Array<int> pt_code, pt_proc, pt_elem;
+   Vector pt_ref, pt_dist;
+
+   /** @brief Locate the @a npts points with coordinates @a pts (ordered by
+       vdim) in the local mesh. */
+   void FindLocalPoints(const double *pts, int npts, Array<int> &codes,
+                        Array<int> &elems, Vector &refs, Vector &dists) const;
+
+   /** @brief Evaluate @a field at the points with reference coordinates
+       @a refs (ordered by vdim) in the local elements @a elems. The values
+       are ordered by vdim. */
+   void InterpolateLocal(const GridFunction &field, const Array<int> &elems,
+                         const double *refs, Vector &vals) const;
+
+   /// Send @a send_cnt[r] to rank r and receive @a recv_cnt[r] from rank r.
+   void ExchangeCounts(const Array<int> &send_cnt, Array<int> &recv_cnt) const;
+
+   /** @brief Send @a send_cnt[r] blocks of @a unit entries of @a send to rank
+       r and receive @a recv_cnt[r] blocks from rank r in @a recv. */
+   template <typename T>
+   void ExchangeData(const Array<int> &send_cnt, const Array<T> &send,
+                     const Array<int> &recv_cnt, Array<T> &recv,
+                     int unit) const;
+
+public:
+   /// Construct a serial point locator.
+   PointLocator();
+
+#ifdef MFEM_USE_MPI
+   /// Construct a parallel point locator on the communicator @a comm.
+   PointLocator(MPI_Comm comm_);
+#endif
+
+   /** @brief Set up the spatial search structures for the Mesh @a m (the
+       local part of the mesh in parallel).
+
+       @param[in] m         Input mesh.
+       @param[in] bb_t      Relative size increase of the bounding box around
+                            each element, accounting for curved elements.
+       @param[in] newt_tol  Reference-space tolerance of the Newton solver. */
+   void Setup(Mesh &m, const double bb_t = 0.1,
+              const double newt_tol = 1.0e-12);
+
+   /** @brief Search the positions @a point_pos (ordered by nodes, XXX...YYY...
+       ZZZ) in the mesh given to Setup().
+
+       Every rank can search different points. The results are accessible
+       through GetCode(), GetProc(), GetElem(), GetReferencePosition() and
+       GetDist(). Points that are not found are assigned the closest element
+       point (code NOT_FOUND) among the candidate elements, or the element -1
+       if no element bounding box contains them. */
+   void FindPoints(const Vector &point_pos);
+
+   /// Set up the search structures for @a m and search @a point_pos.
+   void FindPoints(Mesh &m, const Vector &point_pos, const double bb_t = 0.1,
+                   const double newt_tol = 1.0e-12);
+
+   /** @brief Interpolate @a field_in, defined on the mesh given to Setup(), at
+       the points found in the last call to FindPoints().
+
+       The output @a field_out is ordered by nodes (all values of the first
+       component, then all values of the second, etc.). Points with element -1
+       get the value zero. */
+   void Interpolate(const GridFunction &field_in, Vector &field_out);
+
+   /// Search the positions @a point_pos and interpolate @a field_in.
+   void Interpolate(const Vector &point_pos, const GridFunction &field_in,
+                    Vector &field_out);
+
+   /// Return the code of each point searched by FindPoints(), see Code.
+   const Array<int> &GetCode() const { return pt_code; }
+   /// Return the (local) element number of each point found by FindPoints().
+   const Array<int> &GetElem() const { return pt_elem; }
+   /// Return the MPI rank on which each point was found by FindPoints().
+   const Array<int> &GetProc() const { return pt_proc; }
+   /** @brief Return the reference coordinates of each point found by
+       FindPoints(), ordered by vdim (XYZ,XYZ,...). */
+   const Vector &GetReferencePosition() const { return pt_ref; }
+   /** @brief Return the distance in physical space between each sought point
+       and the point found by FindPoints(). */
+   const Vector &GetDist() const { return pt_dist; }
+};
+
+} // namespace mfem
+
+#endif // MFEM_POINTLOCATOR
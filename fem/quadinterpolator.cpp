@@ -26,10 +26,16 @@ QuadratureInterpolator::QuadratureInterpolator(const FiniteElementSpace &fes,
    q_layout = QVectorLayout::byNODES;
    use_tensor_products = true; // not implemented yet (not used)
 
+   vector_fe = false;
+
    if (fespace->GetNE() == 0) { return; }
    const FiniteElement *fe = fespace->GetFE(0);
-   MFEM_VERIFY(dynamic_cast<const ScalarFiniteElement*>(fe) != NULL,
-               "Only scalar finite elements are supported");
+   vector_fe = dynamic_cast<const VectorTensorFiniteElement*>(fe) != NULL;
+   MFEM_VERIFY(dynamic_cast<const ScalarFiniteElement*>(fe) != NULL ||
+               vector_fe, "Only scalar and tensor-product vector finite"
+               " elements are supported");
+   MFEM_VERIFY(!vector_fe || fespace->GetVDim() == 1,
+               "vector finite elements with vdim > 1 are not supported");
 }
 
 QuadratureInterpolator::QuadratureInterpolator(const FiniteElementSpace &fes,
@@ -41,10 +47,45 @@ QuadratureInterpolator::QuadratureInterpolator(const FiniteElementSpace &fes,
    q_layout = QVectorLayout::byNODES;
    use_tensor_products = true; // not implemented yet (not used)
 
+   vector_fe = false;
+
    if (fespace->GetNE() == 0) { return; }
    const FiniteElement *fe = fespace->GetFE(0);
-   MFEM_VERIFY(dynamic_cast<const ScalarFiniteElement*>(fe) != NULL,
-               "Only scalar finite elements are supported");
+   vector_fe = dynamic_cast<const VectorTensorFiniteElement*>(fe) != NULL;
+   MFEM_VERIFY(dynamic_cast<const ScalarFiniteElement*>(fe) != NULL ||
+               vector_fe, "Only scalar and tensor-product vector finite"
+               " elements are supported");
+   MFEM_VERIFY(!vector_fe || fespace->GetVDim() == 1,
+               "vector finite elements with vdim > 1 are not supported");
+}
+
+// Maximum 1D sizes supported by the H(curl) and H(div) kernels.
+constexpr int VFE_MAX_D1D = 8;
+constexpr int VFE_MAX_Q1D = 8;
+
+bool QuadratureInterpolator::SupportsValues(const FiniteElementSpace &fes,
+                                            const IntegrationRule &ir)
+{
+   const Mesh *mesh = fes.GetMesh();
+   const int dim = mesh->Dimension();
+   if (fes.GetNE() == 0 || (dim != 2 && dim != 3)) { return false; }
+   const FiniteElement *fe = fes.GetFE(0);
+   const int nq = ir.GetNPoints();
+   const VectorTensorFiniteElement *vfe =
+      dynamic_cast<const VectorTensorFiniteElement*>(fe);
+   if (vfe)
+   {
+      if (fes.GetVDim() != 1 || mesh->SpaceDimension() != dim) { return false; }
+      const DofToQuad &maps = vfe->GetDofToQuad(ir, DofToQuad::TENSOR);
+      return maps.ndof <= VFE_MAX_D1D && maps.nqpt <= VFE_MAX_Q1D &&
+             nq == ((dim == 2) ? maps.nqpt*maps.nqpt :
+                    maps.nqpt*maps.nqpt*maps.nqpt);
+   }
+   if (dynamic_cast<const ScalarFiniteElement*>(fe) == NULL) { return false; }
+   const int vdim = fes.GetVDim(), nd = fe->GetDof();
+   if (vdim != 1 && vdim != dim && !(vdim == 3 && dim == 2)) { return false; }
+   return (dim == 2) ? (nd <= MAX_ND2D && nq <= MAX_NQ2D) :
+          (nd <= MAX_ND3D && nq <= MAX_NQ3D);
 }
 
 template<const int T_VDIM, const int T_ND, const int T_NQ>
@@ -230,6 +271,11 @@ void QuadratureInterpolator::Mult(
    const Vector &e_vec, unsigned eval_flags,
    Vector &q_val, Vector &q_der, Vector &q_det) const
 {
+   MFEM_VERIFY(!vector_fe || eval_flags == VALUES, "only the evaluation of"
+               " values is supported for vector finite elements, see Curl()"
+               " and Divergence()");
+   if (vector_fe) { Values(e_vec, q_val); return; }
+
    if (q_layout == QVectorLayout::byVDIM)
    {
       if (eval_flags & VALUES) { Values(e_vec, q_val); }
@@ -673,8 +719,382 @@ static void D2QValues(const FiniteElementSpace &fes,
    MFEM_ABORT("Unknown kernel");
 }
 
+// Quantities computed by the sum-factorized H(curl) and H(div) kernels.
+enum VectorFEEval { VFE_VALUES, VFE_CURL, VFE_DIV };
+
+// Return the 1D basis function 'd' at the point 'q' of the open basis Bo
+// (type 0), the closed basis Bc (type 1) or the derivative Gc of the closed
+// basis (type 2).
+MFEM_HOST_DEVICE inline
+double VFEBasis1D(const int type, const int q, const int d,
+                  const DeviceTensor<2,const double> &Bo,
+                  const DeviceTensor<2,const double> &Bc,
+                  const DeviceTensor<2,const double> &Gc)
+{
+   return (type == 0) ? Bo(q,d) : ((type == 1) ? Bc(q,d) : Gc(q,d));
+}
+
+// In the ND (is_nd = true) and RT (is_nd = false) elements on quads/hexes, the
+// 1D basis in direction t of the vector component c is the open basis if
+// (t == c) == is_nd, and the closed basis otherwise. The E-vector stores the
+// dofs of the components one after the other, each in lexicographic order.
+// The output contains 'ncomp' values at each point, ordered by nodes or by
+// vdim, as in D2QValues and D2QGrad.
+static void D2QVectorFE2D(const int NE,
+                          const bool is_nd,
+                          const VectorFEEval eval,
+                          const bool byvdim,
+                          const int D1D,
+                          const int Q1D,
+                          const Array<double> &bo,
+                          const Array<double> &bc,
+                          const Array<double> &gc,
+                          const Vector &j_,
+                          const Vector &x_,
+                          Vector &y_)
+{
+   constexpr int MAX_D1D = VFE_MAX_D1D;
+   constexpr int MAX_Q1D = VFE_MAX_Q1D;
+   MFEM_VERIFY(D1D <= MAX_D1D, "Orders higher than " << MAX_D1D-1
+               << " are not supported!");
+   MFEM_VERIFY(Q1D <= MAX_Q1D, "Quadrature rules with more than "
+               << MAX_Q1D << " 1D points are not supported!");
+
+   const int NQ = Q1D*Q1D;
+   const int ncomp = (eval == VFE_VALUES) ? 2 : 1;
+   const auto Bo = Reshape(bo.Read(), Q1D, D1D-1);
+   const auto Bc = Reshape(bc.Read(), Q1D, D1D);
+   const auto Gc = Reshape(gc.Read(), Q1D, D1D);
+   const auto J = Reshape(j_.Read(), NQ, 2, 2, NE);
+   const auto x = Reshape(x_.Read(), 2*(D1D-1)*D1D, NE);
+   double *y = y_.Write();
+
+   MFEM_FORALL(e, NE,
+   {
+      double ref[2][MAX_Q1D][MAX_Q1D];
+      for (int c = 0; c < 2; ++c)
+      {
+         for (int qy = 0; qy < Q1D; ++qy)
+         {
+            for (int qx = 0; qx < Q1D; ++qx) { ref[c][qy][qx] = 0.0; }
+         }
+      }
+
+      int osc = 0;
+      for (int c = 0; c < 2; ++c)  // loop over x, y components
+      {
+         const bool open_x = (c == 0) == is_nd;
+         const bool open_y = (c == 1) == is_nd;
+         const int D1Dx = open_x ? D1D - 1 : D1D;
+         const int D1Dy = open_y ? D1D - 1 : D1D;
+
+         // Values: u_c. Curl: du_y/dx - du_x/dy. Divergence: du_x/dx + du_y/dy.
+         int tx = open_x ? 0 : 1, ty = open_y ? 0 : 1, tgt = 0;
+         double sign = 1.0;
+         if (eval == VFE_VALUES) { tgt = c; }
+         else if (eval == VFE_CURL)
+         {
+            if (c == 0) { ty = 2; sign = -1.0; }
+            else { tx = 2; }
+         }
+         else
+         {
+            if (c == 0) { tx = 2; }
+            else { ty = 2; }
+         }
+
+         for (int dy = 0; dy < D1Dy; ++dy)
+         {
+            double aX[MAX_Q1D];
+            for (int qx = 0; qx < Q1D; ++qx) { aX[qx] = 0.0; }
+            for (int dx = 0; dx < D1Dx; ++dx)
+            {
+               const double t = x(dx + (dy * D1Dx) + osc, e);
+               for (int qx = 0; qx < Q1D; ++qx)
+               {
+                  aX[qx] += t * VFEBasis1D(tx, qx, dx, Bo, Bc, Gc);
+               }
+            }
+            for (int qy = 0; qy < Q1D; ++qy)
+            {
+               const double wy = sign * VFEBasis1D(ty, qy, dy, Bo, Bc, Gc);
+               for (int qx = 0; qx < Q1D; ++qx)
+               {
+                  ref[tgt][qy][qx] += aX[qx] * wy;
+               }
+            }
+         }
+         osc += D1Dx * D1Dy;
+      }
+
+      // Map the reference quantities to physical space.
+      for (int qy = 0; qy < Q1D; ++qy)
+      {
+         for (int qx = 0; qx < Q1D; ++qx)
+         {
+            const int q = qx + Q1D*qy;
+            double Jloc[4], Jinv[4], val[2];
+            Jloc[0] = J(q,0,0,e);
+            Jloc[1] = J(q,1,0,e);
+            Jloc[2] = J(q,0,1,e);
+            Jloc[3] = J(q,1,1,e);
+            const double detJ = kernels::Det<2>(Jloc);
+            const double u0 = ref[0][qy][qx], u1 = ref[1][qy][qx];
+            if (eval != VFE_VALUES)
+            {
+               val[0] = u0 / detJ;
+            }
+            else if (is_nd)
+            {
+               // Covariant Piola transformation: J^{-T} u.
+               kernels::CalcInverse<2>(Jloc, Jinv);
+               val[0] = Jinv[0]*u0 + Jinv[1]*u1;
+               val[1] = Jinv[2]*u0 + Jinv[3]*u1;
+            }
+            else
+            {
+               // Contravariant Piola transformation: J u / det(J).
+               val[0] = (Jloc[0]*u0 + Jloc[2]*u1) / detJ;
+               val[1] = (Jloc[1]*u0 + Jloc[3]*u1) / detJ;
+            }
+            for (int c = 0; c < ncomp; ++c)
+            {
+               y[byvdim ? c + ncomp*(q + NQ*e) : q + NQ*(c + ncomp*e)] = val[c];
+            }
+         }
+      }
+   });
+}
+
+static void D2QVectorFE3D(const int NE,
+                          const bool is_nd,
+                          const VectorFEEval eval,
+                          const bool byvdim,
+                          const int D1D,
+                          const int Q1D,
+                          const Array<double> &bo,
+                          const Array<double> &bc,
+                          const Array<double> &gc,
+                          const Vector &j_,
+                          const Vector &x_,
+                          Vector &y_)
+{
+   constexpr int MAX_D1D = VFE_MAX_D1D;
+   constexpr int MAX_Q1D = VFE_MAX_Q1D;
+   MFEM_VERIFY(D1D <= MAX_D1D, "Orders higher than " << MAX_D1D-1
+               << " are not supported!");
+   MFEM_VERIFY(Q1D <= MAX_Q1D, "Quadrature rules with more than "
+               << MAX_Q1D << " 1D points are not supported!");
+
+   const int NQ = Q1D*Q1D*Q1D;
+   const int ncomp = (eval == VFE_DIV) ? 1 : 3;
+   const auto Bo = Reshape(bo.Read(), Q1D, D1D-1);
+   const auto Bc = Reshape(bc.Read(), Q1D, D1D);
+   const auto Gc = Reshape(gc.Read(), Q1D, D1D);
+   const auto J = Reshape(j_.Read(), NQ, 3, 3, NE);
+   const int ND = is_nd ? 3*(D1D-1)*D1D*D1D : 3*(D1D-1)*(D1D-1)*D1D;
+   const auto x = Reshape(x_.Read(), ND, NE);
+   double *y = y_.Write();
+
+   MFEM_FORALL(e, NE,
+   {
+      double ref[3][MAX_Q1D][MAX_Q1D][MAX_Q1D];
+      for (int c = 0; c < 3; ++c)
+      {
+         for (int qz = 0; qz < Q1D; ++qz)
+         {
+            for (int qy = 0; qy < Q1D; ++qy)
+            {
+               for (int qx = 0; qx < Q1D; ++qx) { ref[c][qz][qy][qx] = 0.0; }
+            }
+         }
+      }
+
+      int osc = 0;
+      for (int c = 0; c < 3; ++c)  // loop over x, y, z components
+      {
+         int D1Dt[3], tb[3];
+         for (int t = 0; t < 3; ++t)
+         {
+            const bool open = (t == c) == is_nd;
+            D1Dt[t] = open ? D1D - 1 : D1D;
+            tb[t] = open ? 0 : 1;
+         }
+
+         // The curl involves two derivatives of each component:
+         // (curl u)_k = eps_{kdc} du_c/dx_d, with d != c and k = 3 - c - d.
+         const int nterms = (eval == VFE_CURL) ? 2 : 1;
+         for (int term = 0; term < nterms; ++term)
+         {
+            int type[3] = { tb[0], tb[1], tb[2] };
+            int tgt = 0;
+            double sign = 1.0;
+            if (eval == VFE_VALUES) { tgt = c; }
+            else if (eval == VFE_DIV) { type[c] = 2; }
+            else
+            {
+               const int d = (c + 1 + term) % 3;
+               type[d] = 2;
+               tgt = 3 - c - d;
+               sign = (d == (tgt + 1) % 3) ? 1.0 : -1.0;
+            }
+
+            for (int dz = 0; dz < D1Dt[2]; ++dz)
+            {
+               double aXY[MAX_Q1D][MAX_Q1D];
+               for (int qy = 0; qy < Q1D; ++qy)
+               {
+                  for (int qx = 0; qx < Q1D; ++qx) { aXY[qy][qx] = 0.0; }
+               }
+               for (int dy = 0; dy < D1Dt[1]; ++dy)
+               {
+                  double aX[MAX_Q1D];
+                  for (int qx = 0; qx < Q1D; ++qx) { aX[qx] = 0.0; }
+                  for (int dx = 0; dx < D1Dt[0]; ++dx)
+                  {
+                     const int dof = dx + D1Dt[0]*(dy + D1Dt[1]*dz) + osc;
+                     const double t = x(dof, e);
+                     for (int qx = 0; qx < Q1D; ++qx)
+                     {
+                        aX[qx] += t * VFEBasis1D(type[0], qx, dx, Bo, Bc, Gc);
+                     }
+                  }
+                  for (int qy = 0; qy < Q1D; ++qy)
+                  {
+                     const double wy = VFEBasis1D(type[1], qy, dy, Bo, Bc, Gc);
+                     for (int qx = 0; qx < Q1D; ++qx)
+                     {
+                        aXY[qy][qx] += aX[qx] * wy;
+                     }
+                  }
+               }
+               for (int qz = 0; qz < Q1D; ++qz)
+               {
+                  const double wz =
+                     sign * VFEBasis1D(type[2], qz, dz, Bo, Bc, Gc);
+                  for (int qy = 0; qy < Q1D; ++qy)
+                  {
+                     for (int qx = 0; qx < Q1D; ++qx)
+                     {
+                        ref[tgt][qz][qy][qx] += aXY[qy][qx] * wz;
+                     }
+                  }
+               }
+            }
+         }
+         osc += D1Dt[0] * D1Dt[1] * D1Dt[2];
+      }
+
+      // Map the reference quantities to physical space.
+      for (int qz = 0; qz < Q1D; ++qz)
+      {
+         for (int qy = 0; qy < Q1D; ++qy)
+         {
+            for (int qx = 0; qx < Q1D; ++qx)
+            {
+               const int q = qx + Q1D*(qy + Q1D*qz);
+               double Jloc[9], Jinv[9], u[3], val[3];
+               for (int i = 0; i < 3; ++i)
+               {
+                  u[i] = ref[i][qz][qy][qx];
+                  for (int j = 0; j < 3; ++j) { Jloc[i + 3*j] = J(q,i,j,e); }
+               }
+               const double detJ = kernels::Det<3>(Jloc);
+               if (eval == VFE_DIV)
+               {
+                  val[0] = u[0] / detJ;
+               }
+               else if (eval == VFE_VALUES && is_nd)
+               {
+                  // Covariant Piola transformation: J^{-T} u.
+                  kernels::CalcInverse<3>(Jloc, Jinv);
+                  for (int i = 0; i < 3; ++i)
+                  {
+                     val[i] = Jinv[3*i]*u[0] + Jinv[1+3*i]*u[1] +
+                              Jinv[2+3*i]*u[2];
+                  }
+               }
+               else
+               {
+                  // Contravariant Piola transformation: J u / det(J), for the
+                  // values of RT fields and for the curl of ND fields.
+                  for (int i = 0; i < 3; ++i)
+                  {
+                     val[i] = (Jloc[i]*u[0] + Jloc[i+3]*u[1] +
+                               Jloc[i+6]*u[2]) / detJ;
+                  }
+               }
+               for (int c = 0; c < ncomp; ++c)
+               {
+                  const int idx = byvdim ? c + ncomp*(q + NQ*e) :
+                                  q + NQ*(c + ncomp*e);
+                  y[idx] = val[c];
+               }
+            }
+         }
+      }
+   });
+}
+
+static void D2QVectorFE(const FiniteElementSpace &fes,
+                        const IntegrationRule &ir,
+                        const VectorFEEval eval,
+                        const bool byvdim,
+                        const Vector &e_vec,
+                        Vector &q_vec)
+{
+   Mesh *mesh = fes.GetMesh();
+   const int NE = fes.GetNE();
+   if (NE == 0) { return; }
+   const int dim = mesh->Dimension();
+   MFEM_VERIFY(dim == 2 || dim == 3, "only 2D and 3D meshes are supported");
+   MFEM_VERIFY(mesh->SpaceDimension() == dim, "surface meshes are not"
+               " supported");
+
+   const FiniteElement *fe = fes.GetFE(0);
+   const VectorTensorFiniteElement *el =
+      dynamic_cast<const VectorTensorFiniteElement*>(fe);
+   MFEM_VERIFY(el != NULL, "Only VectorTensorFiniteElement is supported!");
+   const bool is_nd = (fe->GetMapType() == FiniteElement::H_CURL);
+   MFEM_VERIFY(eval != VFE_CURL || is_nd, "the curl requires an H(curl) space");
+   MFEM_VERIFY(eval != VFE_DIV || !is_nd, "the divergence requires an H(div)"
+               " space");
+
+   const DofToQuad &mapsC = el->GetDofToQuad(ir, DofToQuad::TENSOR);
+   const DofToQuad &mapsO = el->GetDofToQuadOpen(ir, DofToQuad::TENSOR);
+   const int D1D = mapsC.ndof;
+   const int Q1D = mapsC.nqpt;
+   MFEM_VERIFY(D1D == mapsO.ndof + 1 && Q1D == mapsO.nqpt, "");
+   MFEM_VERIFY(ir.GetNPoints() == (dim == 2 ? Q1D*Q1D : Q1D*Q1D*Q1D),
+               "a tensor-product integration rule is required");
+
+   const GeometricFactors *geom =
+      mesh->GetGeometricFactors(ir, GeometricFactors::JACOBIANS);
+   const int ncomp = (eval == VFE_VALUES) ? dim :
+                     ((eval == VFE_CURL && dim == 3) ? 3 : 1);
+   q_vec.SetSize(ncomp*ir.GetNPoints()*NE);
+
+   if (dim == 2)
+   {
+      D2QVectorFE2D(NE, is_nd, eval, byvdim, D1D, Q1D, mapsO.B, mapsC.B,
+                    mapsC.G, geom->J, e_vec, q_vec);
+   }
+   else
+   {
+      D2QVectorFE3D(NE, is_nd, eval, byvdim, D1D, Q1D, mapsO.B, mapsC.B,
+                    mapsC.G, geom->J, e_vec, q_vec);
+   }
+}
+
 void QuadratureInterpolator::Values(const Vector &e_vec, Vector &q_val) const
 {
+   if (vector_fe)
+   {
+      D2QVectorFE(*fespace, IntRule ? *IntRule : qspace->GetElementIntRule(0),
+                  VFE_VALUES, q_layout == QVectorLayout::byVDIM, e_vec, q_val);
+      return;
+   }
+
    if (q_layout == QVectorLayout::byNODES)
    {
       Vector empty;
@@ -1348,4 +1768,19 @@ void QuadratureInterpolator::PhysDerivatives(const Vector &e_vec,
    D2QPhysGrad(*fespace, geom, &d2q, e_vec, q_der);
 }
 
+void QuadratureInterpolator::Curl(const Vector &e_vec, Vector &q_curl) const
+{
+   MFEM_VERIFY(vector_fe, "the curl requires an H(curl) space");
+   D2QVectorFE(*fespace, IntRule ? *IntRule : qspace->GetElementIntRule(0),
+               VFE_CURL, q_layout == QVectorLayout::byVDIM, e_vec, q_curl);
+}
+
+void QuadratureInterpolator::Divergence(const Vector &e_vec,
+                                        Vector &q_div) const
+{
+   MFEM_VERIFY(vector_fe, "the divergence requires an H(div) space");
+   D2QVectorFE(*fespace, IntRule ? *IntRule : qspace->GetElementIntRule(0),
+               VFE_DIV, q_layout == QVectorLayout::byVDIM, e_vec, q_div);
+}
+
 } // namespace mfem
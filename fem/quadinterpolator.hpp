@@ -32,7 +32,15 @@ enum class QVectorLayout
 
     The target quadrature points in the elements can be described either by an
     IntegrationRule (all mesh elements must be of the same type in this case) or
-    by a QuadratureSpace. */
+    by a QuadratureSpace.
+
+    In addition to scalar (H1 and L2) spaces, the H(curl) and H(div) spaces on
+    quadrilateral and hexahedral meshes (ND_QuadrilateralElement,
+    ND_HexahedronElement, RT_QuadrilateralElement and RT_HexahedronElement) are
+    supported by Values(), Curl() and Divergence(), which use sum factorization
+    with the open and closed 1D bases of the elements. The E-vector must use
+    the lexicographic ordering, ElementDofOrdering::LEXICOGRAPHIC, in this
+    case, and the values are computed in physical space. */
 class QuadratureInterpolator
 {
 protected:
@@ -44,6 +52,7 @@ protected:
    mutable QVectorLayout q_layout;     ///< Output Q-vector layout
 
    mutable bool use_tensor_products;
+   bool vector_fe; ///< H(curl) or H(div) space, see Values()
 
    static const int MAX_NQ2D = 100;
    static const int MAX_ND2D = 100;
@@ -70,6 +79,11 @@ public:
    QuadratureInterpolator(const FiniteElementSpace &fes,
                           const QuadratureSpace &qs);
 
+   /** @brief Return true if Values() supports the space @a fes with the
+       integration rule @a ir, e.g. to select a batched evaluation path. */
+   static bool SupportsValues(const FiniteElementSpace &fes,
+                              const IntegrationRule &ir);
+
    /** @brief Disable the use of tensor product evaluations, for tensor-product
        elements, e.g. quads and hexes. */
    /** Currently, tensor product evaluations are not implemented and this method
@@ -99,8 +113,20 @@ public:
              Vector &q_val, Vector &q_der, Vector &q_det) const;
 
    /// Interpolate the values of the E-vector @a e_vec at quadrature points.
+   /** For H(curl) and H(div) spaces, the values are mapped to physical space
+       with the covariant and contravariant Piola transformations, and have
+       dim components. */
    void Values(const Vector &e_vec, Vector &q_val) const;
 
+   /** @brief Interpolate the (physical) curl of the H(curl) E-vector @a e_vec
+       at quadrature points. */
+   /** The curl has one component in 2D and three components in 3D. */
+   void Curl(const Vector &e_vec, Vector &q_curl) const;
+
+   /** @brief Interpolate the (physical) divergence of the H(div) E-vector
+       @a e_vec at quadrature points. */
+   void Divergence(const Vector &e_vec, Vector &q_div) const;
+
    /** @brief Interpolate the derivatives of the E-vector @a e_vec at quadrature
        points. */
    void Derivatives(const Vector &e_vec, Vector &q_der) const;
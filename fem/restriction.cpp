@@ -14,6 +14,9 @@
 #include "fespace.hpp"
 #include "../general/forall.hpp"
 
+#include <algorithm>
+#include <cstdlib>
+
 namespace mfem
 {
 
@@ -25,48 +28,54 @@ ElementRestriction::ElementRestriction(const FiniteElementSpace &f,
      byvdim(fes.GetOrdering() == Ordering::byVDIM),
      ndofs(fes.GetNDofs()),
      dof(ne > 0 ? fes.GetFE(0)->GetDof() : 0),
-     nedofs(ne*dof),
+     nedofs(fes.GetElementToDofTable().Size_of_connections()),
      offsets(ndofs+1),
-     indices(ne*dof),
-     gatherMap(ne*dof)
+     indices(nedofs),
+     gatherMap(nedofs)
 {
-   // Assuming all finite elements are the same.
-   height = vdim*ne*dof;
+   // All the elements are the same, unless the mesh has mixed element types.
+   const Mesh &mesh = *fes.GetMesh();
+   const bool mixed = mesh.GetNumGeometries(mesh.Dimension()) > 1;
+   height = vdim*nedofs;
    width = fes.GetVSize();
    const bool dof_reorder = (e_ordering == ElementDofOrdering::LEXICOGRAPHIC);
-   const int *dof_map = NULL;
-   if (dof_reorder && ne > 0)
+   // The order of the elements in the E-vector
+   Array<int> elements(ne);
+   if (mixed)
    {
-      for (int e = 0; e < ne; ++e)
+      Array<Geometry::Type> geoms;
+      mesh.GetGeometries(mesh.Dimension(), geoms);
+      elements.SetSize(0);
+      for (int g = 0; g < geoms.Size(); g++)
       {
-         const FiniteElement *fe = fes.GetFE(e);
-         const TensorBasisElement* el =
-            dynamic_cast<const TensorBasisElement*>(fe);
-         if (el) { continue; }
-         mfem_error("Finite element not suitable for lexicographic ordering");
+         for (int e = 0; e < ne; ++e)
+         {
+            if (mesh.GetElementBaseGeometry(e) == geoms[g])
+            {
+               elements.Append(e);
+            }
+         }
       }
-      const FiniteElement *fe = fes.GetFE(0);
-      const TensorBasisElement* el =
-         dynamic_cast<const TensorBasisElement*>(fe);
-      const Array<int> &fe_dof_map = el->GetDofMap();
-      MFEM_VERIFY(fe_dof_map.Size() > 0, "invalid dof map");
-      dof_map = fe_dof_map.GetData();
+      eoffset.SetSize(nedofs);
+      edof.SetSize(nedofs);
+   }
+   else
+   {
+      for (int e = 0; e < ne; ++e) { elements[e] = e; }
    }
    const Table& e2dTable = fes.GetElementToDofTable();
+   const int* elementPtr = e2dTable.GetI();
    const int* elementMap = e2dTable.GetJ();
    // We will be keeping a count of how many local nodes point to its global dof
    for (int i = 0; i <= ndofs; ++i)
    {
       offsets[i] = 0;
    }
-   for (int e = 0; e < ne; ++e)
+   for (int i = 0; i < nedofs; ++i)
    {
-      for (int d = 0; d < dof; ++d)
-      {
-         const int sgid = elementMap[dof*e + d];  // signed
-         const int gid = (sgid >= 0) ? sgid : -1 - sgid;
-         ++offsets[gid + 1];
-      }
+      const int sgid = elementMap[i];  // signed
+      const int gid = (sgid >= 0) ? sgid : -1 - sgid;
+      ++offsets[gid + 1];
    }
    // Aggregate to find offsets for each global dof
    for (int i = 1; i <= ndofs; ++i)
@@ -74,18 +83,42 @@ ElementRestriction::ElementRestriction(const FiniteElementSpace &f,
       offsets[i] += offsets[i - 1];
    }
    // For each global dof, fill in all local nodes that point to it
-   for (int e = 0; e < ne; ++e)
+   int lid = 0;
+   for (int k = 0; k < ne; ++k)
    {
-      for (int d = 0; d < dof; ++d)
+      const int e = elements[k];
+      const int nd = elementPtr[e+1] - elementPtr[e];
+      const int *dof_map = NULL;
+      if (dof_reorder)
       {
-         const int sdid = dof_reorder ? dof_map[d] : 0;  // signed
-         const int did = (!dof_reorder)?d:(sdid >= 0 ? sdid : -1-sdid);
-         const int sgid = elementMap[dof*e + did];  // signed
+         const TensorBasisElement* el =
+            dynamic_cast<const TensorBasisElement*>(fes.GetFE(e));
+         if (el)
+         {
+            const Array<int> &fe_dof_map = el->GetDofMap();
+            MFEM_VERIFY(fe_dof_map.Size() > 0, "invalid dof map");
+            dof_map = fe_dof_map.GetData();
+         }
+         else if (!mixed)
+         {
+            mfem_error("Finite element not suitable for lexicographic"
+                       " ordering");
+         }
+      }
+      for (int d = 0; d < nd; ++d, ++lid)
+      {
+         const int sdid = dof_map ? dof_map[d] : 0;  // signed
+         const int did = (!dof_map)?d:(sdid >= 0 ? sdid : -1-sdid);
+         const int sgid = elementMap[elementPtr[e] + did];  // signed
          const int gid = (sgid >= 0) ? sgid : -1-sgid;
-         const int lid = dof*e + d;
          const bool plus = (sgid >= 0 && sdid >= 0) || (sgid < 0 && sdid < 0);
          gatherMap[lid] = plus ? gid : -1-gid;
          indices[offsets[gid]++] = plus ? lid : -1-lid;
+         if (mixed)
+         {
+            eoffset[lid] = vdim*(lid - d) + d;
+            edof[lid] = nd;
+         }
       }
    }
    // We shifted the offsets vector by 1 by using it as a counter.
@@ -99,6 +132,7 @@ ElementRestriction::ElementRestriction(const FiniteElementSpace &f,
 
 void ElementRestriction::Mult(const Vector& x, Vector& y) const
 {
+   if (eoffset.Size() > 0) { return MixedMult(x, y, true); }
    // Assumes all elements have the same number of dofs
    const int nd = dof;
    const int vd = vdim;
@@ -121,6 +155,7 @@ void ElementRestriction::Mult(const Vector& x, Vector& y) const
 
 void ElementRestriction::MultUnsigned(const Vector& x, Vector& y) const
 {
+   if (eoffset.Size() > 0) { return MixedMult(x, y, false); }
    // Assumes all elements have the same number of dofs
    const int nd = dof;
    const int vd = vdim;
@@ -142,6 +177,7 @@ void ElementRestriction::MultUnsigned(const Vector& x, Vector& y) const
 
 void ElementRestriction::MultTranspose(const Vector& x, Vector& y) const
 {
+   if (eoffset.Size() > 0) { return MixedMultTranspose(x, y, true); }
    // Assumes all elements have the same number of dofs
    const int nd = dof;
    const int vd = vdim;
@@ -170,6 +206,7 @@ void ElementRestriction::MultTranspose(const Vector& x, Vector& y) const
 
 void ElementRestriction::MultTransposeUnsigned(const Vector& x, Vector& y) const
 {
+   if (eoffset.Size() > 0) { return MixedMultTranspose(x, y, false); }
    // Assumes all elements have the same number of dofs
    const int nd = dof;
    const int vd = vdim;
@@ -195,8 +232,120 @@ void ElementRestriction::MultTransposeUnsigned(const Vector& x, Vector& y) const
    });
 }
 
+void ElementRestriction::MixedMult(const Vector& x, Vector& y,
+                                   const bool use_signs) const
+{
+   const int vd = vdim;
+   const bool t = byvdim;
+   auto d_x = Reshape(x.Read(), t?vd:ndofs, t?ndofs:vd);
+   auto d_y = y.Write();
+   auto d_gatherMap = gatherMap.Read();
+   auto d_eoffset = eoffset.Read();
+   auto d_edof = edof.Read();
+   MFEM_FORALL(i, nedofs,
+   {
+      const int gid = d_gatherMap[i];
+      const bool plus = gid >= 0 || !use_signs;
+      const int j = gid >= 0 ? gid : -1-gid;
+      for (int c = 0; c < vd; ++c)
+      {
+         const double dofValue = d_x(t?c:j, t?j:c);
+         d_y[d_eoffset[i] + c*d_edof[i]] = plus ? dofValue : -dofValue;
+      }
+   });
+}
+
+void ElementRestriction::MixedMultTranspose(const Vector& x, Vector& y,
+                                            const bool use_signs) const
+{
+   const int vd = vdim;
+   const bool t = byvdim;
+   auto d_offsets = offsets.Read();
+   auto d_indices = indices.Read();
+   auto d_eoffset = eoffset.Read();
+   auto d_edof = edof.Read();
+   auto d_x = x.Read();
+   auto d_y = Reshape(y.Write(), t?vd:ndofs, t?ndofs:vd);
+   MFEM_FORALL(i, ndofs,
+   {
+      const int offset = d_offsets[i];
+      const int nextOffset = d_offsets[i + 1];
+      for (int c = 0; c < vd; ++c)
+      {
+         double dofValue = 0;
+         for (int j = offset; j < nextOffset; ++j)
+         {
+            const int idx_j = d_indices[j];
+            const bool plus = idx_j >= 0 || !use_signs;
+            const int lid = (idx_j >= 0) ? idx_j : -1-idx_j;
+            const double value = d_x[d_eoffset[lid] + c*d_edof[lid]];
+            dofValue += plus ? value : -value;
+         }
+         d_y(t?c:i,t?i:c) = dofValue;
+      }
+   });
+}
+
+void ElementRestriction::GetStrideStatistics(StrideStatistics &stats) const
+{
+   MFEM_VERIFY(eoffset.Size() == 0, "not supported on meshes with mixed"
+               " element types");
+   const int *map = gatherMap.HostRead();
+   const int dofs_per_line = 64/sizeof(double);
+   const int line_stride = byvdim ? vdim : 1;
+   long sum_stride = 0, sum_span = 0, sum_lines = 0;
+   int max_stride = 0, num_unit = 0;
+   Array<int> lines(dof);
+   for (int e = 0; e < ne; e++)
+   {
+      int min_dof = ndofs, max_dof = -1, prev = -1;
+      for (int d = 0; d < dof; d++)
+      {
+         const int sgid = map[e*dof + d];  // signed
+         const int gid = (sgid >= 0) ? sgid : -1-sgid;
+         if (d > 0)
+         {
+            const int stride = std::abs(gid - prev);
+            sum_stride += stride;
+            max_stride = std::max(max_stride, stride);
+            num_unit += (stride == 1);
+         }
+         prev = gid;
+         min_dof = std::min(min_dof, gid);
+         max_dof = std::max(max_dof, gid);
+         lines[d] = (int)(((long)gid*line_stride)/dofs_per_line);
+      }
+      lines.Sort();
+      lines.Unique();
+      sum_lines += lines.Size();
+      lines.SetSize(dof);
+      sum_span += (dof > 0) ? max_dof - min_dof + 1 : 0;
+   }
+   const long num_strides = (long)ne*(dof-1);
+   stats.mean_stride = num_strides > 0 ? double(sum_stride)/num_strides : 0.0;
+   stats.max_stride = max_stride;
+   stats.unit_fraction = num_strides > 0 ? double(num_unit)/num_strides : 0.0;
+   stats.mean_span = ne > 0 ? double(sum_span)/ne : 0.0;
+   stats.mean_cache_lines = ne > 0 ? double(sum_lines)/ne : 0.0;
+}
+
+void ElementRestriction::PrintStrideStatistics(std::ostream &out) const
+{
+   StrideStatistics stats;
+   GetStrideStatistics(stats);
+   out << "Element restriction: " << ne << " elements, " << dof
+       << " dofs per element, " << ndofs << " dofs\n"
+       << "   mean |stride|          : " << stats.mean_stride << '\n'
+       << "   max |stride|           : " << stats.max_stride << '\n'
+       << "   unit strides           : " << 100*stats.unit_fraction << " %\n"
+       << "   mean dof span          : " << stats.mean_span << '\n'
+       << "   mean cache lines/elem. : " << stats.mean_cache_lines << '\n';
+}
+
 void ElementRestriction::BooleanMask(Vector& y) const
 {
+   MFEM_VERIFY(eoffset.Size() == 0, "not supported on meshes with mixed"
+               " element types");
    // Assumes all elements have the same number of dofs
    const int nd = dof;
    const int vd = vdim;
@@ -235,215 +384,193 @@ void ElementRestriction::BooleanMask(Vector& y) const
 void ElementRestriction::FillSparseMatrix(const Vector &mat_ea,
                                           SparseMatrix &mat) const
 {
-   mat.GetMemoryI().New(mat.Height()+1, mat.GetMemoryI().GetMemoryType());
-   const int nnz = FillI(mat);
-   mat.GetMemoryJ().New(nnz, mat.GetMemoryJ().GetMemoryType());
-   mat.GetMemoryData().New(nnz, mat.GetMemoryData().GetMemoryType());
-   FillJAndData(mat_ea, mat);
+   Array<int> ea_map;
+   FillSparsityPattern(mat, ea_map);
+   FillData(mat_ea, ea_map, mat);
 }
 
-template <int MaxNbNbr>
-static MFEM_HOST_DEVICE int GetMinElt(const int *my_elts, const int nbElts,
-                                      const int *nbr_elts, const int nbrNbElts)
+/** Returns true if the column @a c of the row of the E-vector entries
+    @a r_idx[k_begin..k] is met for the first time in the element of entry k,
+    i.e. if no element of the previous entries of the row contains @a c. */
+static MFEM_HOST_DEVICE bool IsFirstElement(const int *r_idx, const int k_begin,
+                                            const int k, const int *c_idx,
+                                            const int c_begin, const int c_end,
+                                            const int elt_dofs)
 {
-   // Building the intersection
-   int inter[MaxNbNbr];
-   int cpt = 0;
-   for (int i = 0; i < nbElts; i++)
-   {
-      const int e_i = my_elts[i];
-      for (int j = 0; j < nbrNbElts; j++)
-      {
-         if (e_i==nbr_elts[j])
-         {
-            inter[cpt] = e_i;
-            cpt++;
-         }
-      }
-   }
-   // Finding the minimum
-   int min = inter[0];
-   for (int i = 1; i < cpt; i++)
+   for (int k_prev = k_begin; k_prev < k; k_prev++)
    {
-      if (inter[i] < min)
+      const int i_E = r_idx[k_prev];
+      const int e_prev = (i_E >= 0 ? i_E : -1-i_E)/elt_dofs;
+      for (int k_c = c_begin; k_c < c_end; k_c++)
       {
-         min = inter[i];
+         const int j_E = c_idx[k_c];
+         if ((j_E >= 0 ? j_E : -1-j_E)/elt_dofs == e_prev) { return false; }
       }
    }
-   return min;
+   return true;
 }
 
-/** Returns the index where a non-zero entry should be added and increment the
-    number of non-zeros for the row i_L. */
-static MFEM_HOST_DEVICE int GetAndIncrementNnzIndex(const int i_L, int* I)
+void ElementRestriction::FillSparsityPattern(SparseMatrix &mat,
+                                             Array<int> &ea_map) const
 {
-   int ind = AtomicAdd(I[i_L],1);
-   return ind;
-}
-
-int ElementRestriction::FillI(SparseMatrix &mat) const
-{
-   static constexpr int Max = MaxNbNbr;
+   MFEM_VERIFY(eoffset.Size() == 0, "not supported on meshes with mixed"
+               " element types");
+   MFEM_VERIFY(vdim == 1, "not supported for vector spaces");
    const int all_dofs = ndofs;
-   const int vd = vdim;
    const int elt_dofs = dof;
-   auto I = mat.ReadWriteI();
+   const int NE = ne;
+   MFEM_VERIFY(mat.Height() == all_dofs && mat.Width() == all_dofs,
+               "invalid matrix size");
    auto d_offsets = offsets.Read();
    auto d_indices = indices.Read();
    auto d_gatherMap = gatherMap.Read();
-   MFEM_FORALL(i_L, vd*all_dofs+1,
-   {
-      I[i_L] = 0;
-   });
-   MFEM_FORALL(e, ne,
+
+   // 1. Count the distinct columns of each row. A row gathers the columns of
+   //    all the elements containing its dof, and a column shared by several of
+   //    these elements is counted only in the first one.
+   const MemoryType mt_I = mat.GetMemoryI().GetMemoryType();
+   mat.GetMemoryI().Delete();
+   mat.GetMemoryI().New(all_dofs+1, mt_I);
+   auto I = mat.WriteI();
+   MFEM_FORALL(r, all_dofs,
    {
-      for (int i = 0; i < elt_dofs; i++)
+      const int r_begin = d_offsets[r];
+      const int r_end = d_offsets[r+1];
+      int nnz = 0;
+      for (int k = r_begin; k < r_end; k++)
       {
-         int i_elts[Max];
-         const int i_E = e*elt_dofs + i;
-         const int i_L = d_gatherMap[i_E];
-         const int i_offset = d_offsets[i_L];
-         const int i_nextOffset = d_offsets[i_L+1];
-         const int i_nbElts = i_nextOffset - i_offset;
-         for (int e_i = 0; e_i < i_nbElts; ++e_i)
-         {
-            const int i_E = d_indices[i_offset+e_i];
-            i_elts[e_i] = i_E/elt_dofs;
-         }
+         const int i_E = d_indices[k];
+         const int e = (i_E >= 0 ? i_E : -1-i_E)/elt_dofs;
          for (int j = 0; j < elt_dofs; j++)
          {
-            const int j_E = e*elt_dofs + j;
-            const int j_L = d_gatherMap[j_E];
-            const int j_offset = d_offsets[j_L];
-            const int j_nextOffset = d_offsets[j_L+1];
-            const int j_nbElts = j_nextOffset - j_offset;
-            if (i_nbElts == 1 || j_nbElts == 1) // no assembly required
+            const int j_L = d_gatherMap[e*elt_dofs + j];
+            const int c = (j_L >= 0) ? j_L : -1-j_L;
+            if (IsFirstElement(d_indices, r_begin, k, d_indices,
+                               d_offsets[c], d_offsets[c+1], elt_dofs))
             {
-               GetAndIncrementNnzIndex(i_L, I);
-            }
-            else // assembly required
-            {
-               int j_elts[Max];
-               for (int e_j = 0; e_j < j_nbElts; ++e_j)
-               {
-                  const int j_E = d_indices[j_offset+e_j];
-                  const int elt = j_E/elt_dofs;
-                  j_elts[e_j] = elt;
-               }
-               int min_e = GetMinElt<Max>(i_elts, i_nbElts, j_elts, j_nbElts);
-               if (e == min_e) // add the nnz only once
-               {
-                  GetAndIncrementNnzIndex(i_L, I);
-               }
+               nnz++;
             }
          }
       }
+      I[r] = nnz;
    });
    // We need to sum the entries of I, we do it on CPU as it is very sequential.
    auto h_I = mat.HostReadWriteI();
-   const int nTdofs = vd*all_dofs;
    int sum = 0;
-   for (int i = 0; i < nTdofs; i++)
+   for (int r = 0; r < all_dofs; r++)
    {
-      const int nnz = h_I[i];
-      h_I[i] = sum;
-      sum+=nnz;
+      const int nnz = h_I[r];
+      h_I[r] = sum;
+      sum += nnz;
    }
-   h_I[nTdofs] = sum;
-   // We return the number of nnz
-   return h_I[nTdofs];
-}
+   h_I[all_dofs] = sum;
+   const int nnz = sum;
 
-void ElementRestriction::FillJAndData(const Vector &ea_data,
-                                      SparseMatrix &mat) const
-{
-   static constexpr int Max = MaxNbNbr;
-   const int all_dofs = ndofs;
-   const int vd = vdim;
-   const int elt_dofs = dof;
-   auto I = mat.ReadWriteI();
+   // 2. Fill the columns of each row, with the diagonal entry first followed
+   //    by the other columns in increasing order, as in the diagonal blocks of
+   //    hypre matrices, and find the position of each entry of the element
+   //    matrices, with the layout of mat_ea(j,i,e) in FillData().
+   const MemoryType mt_J = mat.GetMemoryJ().GetMemoryType();
+   const MemoryType mt_A = mat.GetMemoryData().GetMemoryType();
+   mat.GetMemoryJ().Delete();
+   mat.GetMemoryJ().New(nnz, mt_J);
+   mat.GetMemoryData().Delete();
+   mat.GetMemoryData().New(nnz, mt_A);
+   ea_map.SetSize(NE*elt_dofs*elt_dofs);
+   auto d_I = mat.ReadI();
    auto J = mat.WriteJ();
-   auto Data = mat.WriteData();
-   auto d_offsets = offsets.Read();
-   auto d_indices = indices.Read();
-   auto d_gatherMap = gatherMap.Read();
-   auto mat_ea = Reshape(ea_data.Read(), elt_dofs, elt_dofs, ne);
-   MFEM_FORALL(e, ne,
+   auto map = Reshape(ea_map.Write(), elt_dofs, elt_dofs, NE);
+   MFEM_FORALL(r, all_dofs,
    {
-      for (int i = 0; i < elt_dofs; i++)
+      const int r_begin = d_offsets[r];
+      const int r_end = d_offsets[r+1];
+      const int row_begin = d_I[r];
+      const int row_end = d_I[r+1];
+      if (row_begin < row_end) { J[row_begin] = r; }
+      int pos = row_begin + 1;
+      for (int k = r_begin; k < r_end; k++)
       {
-         int i_elts[Max];
-         int i_B[Max];
-         const int i_E = e*elt_dofs + i;
-         const int i_L = d_gatherMap[i_E];
-         const int i_offset = d_offsets[i_L];
-         const int i_nextOffset = d_offsets[i_L+1];
-         const int i_nbElts = i_nextOffset - i_offset;
-         for (int e_i = 0; e_i < i_nbElts; ++e_i)
-         {
-            const int i_E = d_indices[i_offset+e_i];
-            i_elts[e_i] = i_E/elt_dofs;
-            i_B[e_i]    = i_E%elt_dofs;
-         }
+         const int i_E = d_indices[k];
+         const int e = (i_E >= 0 ? i_E : -1-i_E)/elt_dofs;
          for (int j = 0; j < elt_dofs; j++)
          {
-            const int j_E = e*elt_dofs + j;
-            const int j_L = d_gatherMap[j_E];
-            const int j_offset = d_offsets[j_L];
-            const int j_nextOffset = d_offsets[j_L+1];
-            const int j_nbElts = j_nextOffset - j_offset;
-            if (i_nbElts == 1 || j_nbElts == 1) // no assembly required
+            const int j_L = d_gatherMap[e*elt_dofs + j];
+            const int c = (j_L >= 0) ? j_L : -1-j_L;
+            if (c != r && IsFirstElement(d_indices, r_begin, k, d_indices,
+                                         d_offsets[c], d_offsets[c+1],
+                                         elt_dofs))
             {
-               const int nnz = GetAndIncrementNnzIndex(i_L, I);
-               J[nnz] = j_L;
-               Data[nnz] = mat_ea(j,i,e);
+               // insertion in the sorted part of the row
+               int p = pos++;
+               while (p > row_begin + 1 && J[p-1] > c) { J[p] = J[p-1]; p--; }
+               J[p] = c;
             }
-            else // assembly required
+         }
+      }
+      for (int k = r_begin; k < r_end; k++)
+      {
+         const int i_E = d_indices[k];
+         const int i_El = (i_E >= 0) ? i_E : -1-i_E;
+         const int e = i_El/elt_dofs;
+         const int i = i_El%elt_dofs;
+         for (int j = 0; j < elt_dofs; j++)
+         {
+            const int j_L = d_gatherMap[e*elt_dofs + j];
+            const int c = (j_L >= 0) ? j_L : -1-j_L;
+            int p = row_begin;
+            if (c != r)
             {
-               int j_elts[Max];
-               int j_B[Max];
-               for (int e_j = 0; e_j < j_nbElts; ++e_j)
+               // binary search in the sorted part of the row
+               int lo = row_begin + 1, hi = row_end - 1;
+               while (lo < hi)
                {
-                  const int j_E = d_indices[j_offset+e_j];
-                  const int elt = j_E/elt_dofs;
-                  j_elts[e_j] = elt;
-                  j_B[e_j]    = j_E%elt_dofs;
-               }
-               int min_e = GetMinElt<Max>(i_elts, i_nbElts, j_elts, j_nbElts);
-               if (e == min_e) // add the nnz only once
-               {
-                  double val = 0.0;
-                  for (int i = 0; i < i_nbElts; i++)
-                  {
-                     const int e_i = i_elts[i];
-                     const int i_Bloc = i_B[i];
-                     for (int j = 0; j < j_nbElts; j++)
-                     {
-                        const int e_j = j_elts[j];
-                        const int j_Bloc = j_B[j];
-                        if (e_i == e_j)
-                        {
-                           val += mat_ea(j_Bloc, i_Bloc, e_i);
-                        }
-                     }
-                  }
-                  const int nnz = GetAndIncrementNnzIndex(i_L, I);
-                  J[nnz] = j_L;
-                  Data[nnz] = val;
+                  const int mid = (lo + hi)/2;
+                  if (J[mid] < c) { lo = mid + 1; }
+                  else { hi = mid; }
                }
+               p = lo;
             }
+            map(j,i,e) = p;
          }
       }
    });
-   // We need to shift again the entries of I, we do it on CPU as it is very
-   // sequential.
-   auto h_I = mat.HostReadWriteI();
-   const int size = vd*all_dofs;
-   for (int i = 0; i < size; i++)
+}
+
+void ElementRestriction::FillData(const Vector &mat_ea,
+                                  const Array<int> &ea_map,
+                                  SparseMatrix &mat) const
+{
+   const int all_dofs = ndofs;
+   const int elt_dofs = dof;
+   const int NE = ne;
+   MFEM_VERIFY(ea_map.Size() == NE*elt_dofs*elt_dofs &&
+               mat_ea.Size() == ea_map.Size(), "invalid element matrices");
+   auto d_offsets = offsets.Read();
+   auto d_indices = indices.Read();
+   auto d_gatherMap = gatherMap.Read();
+   auto map = Reshape(ea_map.Read(), elt_dofs, elt_dofs, NE);
+   auto A = Reshape(mat_ea.Read(), elt_dofs, elt_dofs, NE);
+   auto I = mat.ReadI();
+   auto Data = mat.WriteData();
+   // Each row gathers the entries of the elements containing its dof, so the
+   // rows can be filled independently.
+   MFEM_FORALL(r, all_dofs,
    {
-      h_I[size-i] = h_I[size-(i+1)];
-   }
-   h_I[0] = 0;
+      for (int p = I[r]; p < I[r+1]; p++) { Data[p] = 0.0; }
+      for (int k = d_offsets[r]; k < d_offsets[r+1]; k++)
+      {
+         const int i_E = d_indices[k];
+         const int i_El = (i_E >= 0) ? i_E : -1-i_E;
+         const int e = i_El/elt_dofs;
+         const int i = i_El%elt_dofs;
+         for (int j = 0; j < elt_dofs; j++)
+         {
+            const int j_L = d_gatherMap[e*elt_dofs + j];
+            const double a = A(j,i,e);
+            Data[map(j,i,e)] += ((i_E >= 0) == (j_L >= 0)) ? a : -a;
+         }
+      }
+   });
 }
 
 L2ElementRestriction::L2ElementRestriction(const FiniteElementSpace &fes)
@@ -27,14 +27,15 @@ enum class L2FaceValues : bool {SingleValued, DoubleValued};
 
 /// Operator that converts FiniteElementSpace L-vectors to E-vectors.
 /** Objects of this type are typically created and owned by FiniteElementSpace
-    objects, see FiniteElementSpace::GetElementRestriction(). */
+    objects, see FiniteElementSpace::GetElementRestriction().
+
+    On meshes with mixed element types, the E-vector is ordered by geometry: the
+    elements of each geometry returned by Mesh::GetGeometries() follow each
+    other in increasing order, each element holding its (ndof, vdim) block. In
+    this case, the lexicographic ordering applies only to the elements with a
+    tensor basis, the other elements keep their native ordering. */
 class ElementRestriction : public Operator
 {
-private:
-   /** This number defines the maximum number of elements any dof can belong to
-       for the FillSparseMatrix method. */
-   static const int MaxNbNbr = 16;
-
 protected:
    const FiniteElementSpace &fes;
    const int ne;
@@ -46,6 +47,14 @@ protected:
    Array<int> offsets;
    Array<int> indices;
    Array<int> gatherMap;
+   /** On meshes with mixed element types: the E-vector index of the first
+       component of each local dof, and the number of dofs of its element,
+       i.e. the stride between its components. Empty otherwise. */
+   Array<int> eoffset, edof;
+
+   void MixedMult(const Vector &x, Vector &y, const bool use_signs) const;
+   void MixedMultTranspose(const Vector &x, Vector &y,
+                           const bool use_signs) const;
 
 public:
    ElementRestriction(const FiniteElementSpace&, ElementDofOrdering);
@@ -65,15 +74,55 @@ public:
        the host, since the `processed` array requires a large shared memory. */
    void BooleanMask(Vector& y) const;
 
-   /// Fill a Sparse Matrix with Element Matrices.
+   /// Statistics of the L-vector access pattern, see GetStrideStatistics().
+   struct StrideStatistics
+   {
+      /// Mean absolute difference of consecutive dofs within the elements.
+      double mean_stride;
+      /// Maximum absolute difference of consecutive dofs within the elements.
+      int max_stride;
+      /// Fraction of consecutive dofs within the elements with difference 1.
+      double unit_fraction;
+      /// Mean range (max - min + 1) of the dofs of the elements.
+      double mean_span;
+      /// Mean number of distinct 64-byte cache lines read by the elements.
+      double mean_cache_lines;
+   };
+
+   /** @brief Compute the statistics of the scalar dofs accessed by the gather
+       (Mult) and the scatter (MultTranspose), in the E-vector order.
+
+       The statistics measure the memory locality of the element restriction,
+       which depends on the element and the dof ordering, see
+       Mesh::ReorderForLocality(). The cache lines are counted for the first
+       vector component. */
+   void GetStrideStatistics(StrideStatistics &stats) const;
+
+   /// Print the statistics returned by GetStrideStatistics().
+   void PrintStrideStatistics(std::ostream &out = mfem::out) const;
+
+   /** @brief Fill a Sparse Matrix with Element Matrices, stored row major in
+       the E-vector ordering.
+
+       This is FillSparsityPattern() followed by FillData(). */
    void FillSparseMatrix(const Vector &mat_ea, SparseMatrix &mat) const;
 
-   /** Fill the I array of SparseMatrix corresponding to the sparsity pattern
-       given by this ElementRestriction. */
-   int FillI(SparseMatrix &mat) const;
-   /** Fill the J and Data arrays of SparseMatrix corresponding to the sparsity
-       pattern given by this ElementRestriction, and the values of ea_data. */
-   void FillJAndData(const Vector &ea_data, SparseMatrix &mat) const;
+   /** @brief Compute the sparsity pattern of the matrix assembled from the
+       element matrices in @a mat, and the position in the data array of @a mat
+       of each entry of the element matrices in @a ea_map.
+
+       Each row is processed independently, from the elements containing its
+       dof, so there is no bound on the number of elements a dof can belong
+       to. The diagonal entry of each row comes first, followed by the other
+       columns in increasing order, as in the diagonal blocks of hypre
+       matrices. The pattern and @a ea_map can be reused by FillData() for new
+       element matrices on the same mesh. */
+   void FillSparsityPattern(SparseMatrix &mat, Array<int> &ea_map) const;
+
+   /** @brief Set the entries of @a mat, with the pattern computed by
+       FillSparsityPattern(), from the element matrices @a mat_ea. */
+   void FillData(const Vector &mat_ea, const Array<int> &ea_map,
+                 SparseMatrix &mat) const;
 };
 
 /// Operator that converts L2 FiniteElementSpace L-vectors to E-vectors.
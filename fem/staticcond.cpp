@@ -10,6 +10,7 @@
 // CONTRIBUTING.md for details.
 
 #include "staticcond.hpp"
+#include "../general/forall.hpp"
 
 namespace mfem
 {
@@ -224,6 +225,287 @@ void StaticCondensation::AssembleMatrix(int el, const DenseMatrix &elmat)
    S->AddSubMatrix(rvdofs, rvdofs, A_ee, skip_zeros);
 }
 
+void StaticCondensation::AssembleMatrices(const DenseTensor &elmats)
+{
+   const int NE = fes->GetNE();
+   MFEM_VERIFY(elmats.SizeK() == NE, "invalid number of element matrices");
+   if (NE == 0) { return; }
+
+   const int vdim = fes->GetVDim();
+   Array<int> rvdofs;
+   tr_fes->GetElementVDofs(0, rvdofs);
+   const int nvpd = elem_pdof.RowSize(0);
+   const int nved = rvdofs.Size();
+   const int npd = nvpd/vdim;
+   const int ned = nved/vdim;
+   const int nd = npd + ned;
+   const int A_size = nvpd*(nvpd + 2*nved);
+   MFEM_VERIFY(elmats.SizeI() == vdim*nd && elmats.SizeJ() == vdim*nd,
+               "invalid size of the element matrices");
+   for (int i = 0; i < NE; i++)
+   {
+      MFEM_VERIFY(A_offsets[i+1] - A_offsets[i] == A_size &&
+                  A_ipiv_offsets[i+1] - A_ipiv_offsets[i] == nvpd,
+                  "the batched assembly requires all elements to have the"
+                  " same number of private and exposed dofs");
+   }
+
+   // Positions of the private and exposed vdofs in the element matrices
+   Array<int> p_idx(nvpd), e_idx(nved);
+   for (int vd = 0; vd < vdim; vd++)
+   {
+      for (int k = 0; k < npd; k++) { p_idx[vd*npd+k] = vd*nd+ned+k; }
+      for (int k = 0; k < ned; k++) { e_idx[vd*ned+k] = vd*nd+k; }
+   }
+
+   const int NVD = vdim*nd;
+   auto M = Reshape(elmats.Read(), NVD, NVD, NE);
+   auto P_IDX = p_idx.Read();
+   auto E_IDX = e_idx.Read();
+
+   // Gather the private blocks A_pp and check if they are all symmetric
+   DenseTensor A_pp(nvpd, nvpd, NE);
+   auto App = Reshape(A_pp.Write(), nvpd, nvpd, NE);
+   Array<bool> symm_flag(1);
+   symm_flag[0] = true;
+   bool *d_symm_flag = symm_flag.ReadWrite();
+   MFEM_FORALL(e, NE,
+   {
+      for (int j = 0; j < nvpd; j++)
+      {
+         for (int i = 0; i < nvpd; i++)
+         {
+            App(i,j,e) = M(P_IDX[i],P_IDX[j],e);
+         }
+      }
+      for (int j = 0; j < nvpd; j++)
+      {
+         for (int i = 0; i < j; i++)
+         {
+            const double a_ij = App(i,j,e), a_ji = App(j,i,e);
+            if (fabs(a_ij - a_ji) > 1e-12*(fabs(a_ij) + fabs(a_ji)))
+            {
+               d_symm_flag[0] = false;
+            }
+         }
+      }
+   });
+
+   // Factor the private blocks: with Cholesky if they are symmetric positive
+   // definite, falling back to LU with partial pivoting otherwise.
+   Array<int> piv;
+   bool chol = symm_flag.HostRead()[0] && BatchCholeskyFactor(A_pp);
+   if (!chol)
+   {
+      if (symm_flag.HostRead()[0])
+      {
+         auto App_rw = Reshape(A_pp.Write(), nvpd, nvpd, NE);
+         MFEM_FORALL(e, NE,
+         {
+            for (int j = 0; j < nvpd; j++)
+            {
+               for (int i = 0; i < nvpd; i++)
+               {
+                  App_rw(i,j,e) = M(P_IDX[i],P_IDX[j],e);
+               }
+            }
+         });
+      }
+      BatchLUFactor(A_pp, piv);
+   }
+   else
+   {
+      piv.SetSize(nvpd*NE);
+      piv = 0;
+   }
+
+   // Store the factors in the LU form used by LUFactors, with identity pivots
+   // in the Cholesky case, followed by the blocks A_pe and A_ep after
+   // LUFactors::BlockFactor(), and compute the element Schur complements:
+   //    A_pe <- L^{-1} P A_pe,   A_ep <- A_ep U^{-1},   S_e = A_ee - A_ep A_pe.
+   DenseTensor S_el(nved, nved, NE);
+   const int ipiv_base = LUFactors::ipiv_base;
+   auto LU = Reshape(A_pp.Read(), nvpd, nvpd, NE);
+   auto PIV = Reshape(piv.Read(), nvpd, NE);
+   auto A = Reshape(mfem::Write(A_data, NE*A_size), A_size, NE);
+   auto IPIV = Reshape(mfem::Write(A_ipiv, NE*nvpd), nvpd, NE);
+   auto S_E = Reshape(S_el.Write(), nved, nved, NE);
+   MFEM_FORALL(e, NE,
+   {
+      double *lu = &A(0,e);
+      double *A_pe = lu + nvpd*nvpd;
+      double *A_ep = A_pe + nvpd*nved;
+      for (int j = 0; j < nvpd; j++)
+      {
+         for (int i = 0; i < nvpd; i++)
+         {
+            lu[i+j*nvpd] = LU(i,j,e);
+         }
+      }
+      if (chol)
+      {
+         // L.L^t = (L D^{-1}).(D L^t) with D = diag(L)
+         for (int j = 0; j < nvpd; j++)
+         {
+            for (int i = 0; i < j; i++)
+            {
+               lu[i+j*nvpd] = LU(i,i,e)*LU(j,i,e);
+            }
+         }
+         for (int j = 0; j < nvpd; j++)
+         {
+            const double l_jj = LU(j,j,e);
+            for (int i = j+1; i < nvpd; i++)
+            {
+               lu[i+j*nvpd] /= l_jj;
+            }
+            lu[j+j*nvpd] = l_jj*l_jj;
+            IPIV(j,e) = j + ipiv_base;
+         }
+      }
+      else
+      {
+         for (int i = 0; i < nvpd; i++)
+         {
+            IPIV(i,e) = PIV(i,e) + ipiv_base;
+         }
+      }
+      for (int j = 0; j < nved; j++)
+      {
+         for (int i = 0; i < nvpd; i++)
+         {
+            A_pe[i+j*nvpd] = M(P_IDX[i],E_IDX[j],e);
+            A_ep[j+i*nved] = M(E_IDX[j],P_IDX[i],e);
+         }
+         for (int i = 0; i < nved; i++)
+         {
+            S_E(i,j,e) = M(E_IDX[i],E_IDX[j],e);
+         }
+      }
+      // A_pe <- L^{-1} P A_pe
+      for (int i = 0; i < nvpd; i++)
+      {
+         const int p = IPIV(i,e) - ipiv_base;
+         if (p == i) { continue; }
+         for (int j = 0; j < nved; j++)
+         {
+            const double t = A_pe[i+j*nvpd];
+            A_pe[i+j*nvpd] = A_pe[p+j*nvpd];
+            A_pe[p+j*nvpd] = t;
+         }
+      }
+      for (int j = 0; j < nved; j++)
+      {
+         double *x = A_pe + j*nvpd;
+         for (int k = 0; k < nvpd; k++)
+         {
+            const double x_k = x[k];
+            for (int i = k+1; i < nvpd; i++)
+            {
+               x[i] -= lu[i+k*nvpd]*x_k;
+            }
+         }
+      }
+      // A_ep <- A_ep U^{-1}
+      for (int k = 0; k < nvpd; k++)
+      {
+         const double u_kk_inv = 1.0/lu[k+k*nvpd];
+         for (int i = 0; i < nved; i++)
+         {
+            A_ep[i+k*nved] *= u_kk_inv;
+         }
+         for (int j = k+1; j < nvpd; j++)
+         {
+            const double u_kj = lu[k+j*nvpd];
+            for (int i = 0; i < nved; i++)
+            {
+               A_ep[i+j*nved] -= A_ep[i+k*nved]*u_kj;
+            }
+         }
+      }
+      // S_e = A_ee - A_ep A_pe
+      for (int j = 0; j < nved; j++)
+      {
+         for (int k = 0; k < nvpd; k++)
+         {
+            const double a_kj = A_pe[k+j*nvpd];
+            for (int i = 0; i < nved; i++)
+            {
+               S_E(i,j,e) -= A_ep[i+k*nved]*a_kj;
+            }
+         }
+      }
+   });
+   // The per-element methods, e.g. ReduceRHS(), use the host data
+   mfem::HostRead(A_data, NE*A_size);
+   mfem::HostRead(A_ipiv, NE*nvpd);
+
+   // Assemble the Schur complement
+   if (!S->Finalized())
+   {
+      // Dynamically allocated sparsity pattern, see Init()
+      const int skip_zeros = 0;
+      S_el.HostRead();
+      for (int el = 0; el < NE; el++)
+      {
+         tr_fes->GetElementVDofs(el, rvdofs);
+         S->AddSubMatrix(rvdofs, rvdofs, S_el(el), skip_zeros);
+      }
+      return;
+   }
+   // Add the element contributions to each row of S independently, using the
+   // map from the reduced dofs to their (element, local index) pairs.
+   const int nrdofs = tr_fes->GetVSize();
+   Array<int> elem_rdof(NE*nved), rdof_offsets(nrdofs+1), rdof_indices;
+   rdof_offsets = 0;
+   for (int el = 0; el < NE; el++)
+   {
+      tr_fes->GetElementVDofs(el, rvdofs);
+      for (int j = 0; j < nved; j++)
+      {
+         const int rd = rvdofs[j];
+         elem_rdof[el*nved+j] = rd;
+         rdof_offsets[(rd >= 0 ? rd : -1-rd) + 1]++;
+      }
+   }
+   rdof_offsets.PartialSum();
+   rdof_indices.SetSize(NE*nved);
+   for (int k = 0; k < NE*nved; k++)
+   {
+      const int rd = elem_rdof[k];
+      rdof_indices[rdof_offsets[rd >= 0 ? rd : -1-rd]++] = k;
+   }
+   for (int r = nrdofs; r > 0; r--) { rdof_offsets[r] = rdof_offsets[r-1]; }
+   rdof_offsets[0] = 0;
+
+   auto E_RDOF = Reshape(elem_rdof.Read(), nved, NE);
+   auto R_OFFSETS = rdof_offsets.Read();
+   auto R_INDICES = rdof_indices.Read();
+   auto S_E_R = Reshape(S_el.Read(), nved, nved, NE);
+   auto I = S->ReadI();
+   auto J = S->ReadJ();
+   auto S_data = S->ReadWriteData();
+   MFEM_FORALL(r, nrdofs,
+   {
+      for (int k = R_OFFSETS[r]; k < R_OFFSETS[r+1]; k++)
+      {
+         const int e = R_INDICES[k] / nved;
+         const int i = R_INDICES[k] % nved;
+         const double s_i = (E_RDOF(i,e) >= 0) ? 1.0 : -1.0;
+         for (int j = 0; j < nved; j++)
+         {
+            const int c_j = E_RDOF(j,e);
+            const int c = (c_j >= 0) ? c_j : -1-c_j;
+            const double s = (c_j >= 0) ? s_i : -s_i;
+            int pos = I[r];
+            while (J[pos] != c) { pos++; }
+            S_data[pos] += s*S_E_R(i,j,e);
+         }
+      }
+   });
+   S->HostReadData();
+}
+
 void StaticCondensation::AssembleBdrMatrix(int el, const DenseMatrix &elmat)
 {
    Array<int> rvdofs;
@@ -117,6 +117,18 @@ public:
        and A_ep. */
    void AssembleMatrix(int el, const DenseMatrix &elmat);
 
+   /** @brief Assemble the contributions to the Schur complement from the
+       element matrices of all elements, given as a batch in 'elmats' and
+       ordered like the element vdofs; save the other blocks internally.
+
+       The private blocks of all elements are factored together, with
+       BatchCholeskyFactor() when they are symmetric positive definite and with
+       BatchLUFactor() otherwise, and the element Schur complements are added
+       to the rows of S in parallel. All elements must have the same number of
+       private and exposed dofs, which is the case for meshes with one element
+       type and a uniform order. */
+   void AssembleMatrices(const DenseTensor &elmats);
+
    /** Assemble the contribution to the Schur complement from the given boundary
        element matrix 'elmat'. */
    void AssembleBdrMatrix(int el, const DenseMatrix &elmat);
@@ -51,5 +51,39 @@ void WriteBase64(std::ostream &out, const void *bytes, size_t nbytes)
    }
 }
 
+size_t DecodeBase64(const char *src, size_t length, std::vector<char> &bytes)
+{
+   unsigned int bits = 0;
+   int nbits = 0;
+   size_t i = 0;
+   for ( ; i < length; i++)
+   {
+      const char c = src[i];
+      int val;
+      if (c >= 'A' && c <= 'Z') { val = c - 'A'; }
+      else if (c >= 'a' && c <= 'z') { val = c - 'a' + 26; }
+      else if (c >= '0' && c <= '9') { val = c - '0' + 52; }
+      else if (c == '+') { val = 62; }
+      else if (c == '/') { val = 63; }
+      else if (c == '=') { break; }
+      else if (c == ' ' || c == '\n' || c == '\r' || c == '\t') { continue; }
+      else
+      {
+         MFEM_ABORT("invalid base 64 character: " << c);
+         val = 0;
+      }
+      bits = (bits << 6) | val;
+      nbits += 6;
+      if (nbits >= 8)
+      {
+         nbits -= 8;
+         bytes.push_back(static_cast<char>((bits >> nbits) & 0xff));
+      }
+   }
+   // consume the padding
+   while (i < length && src[i] == '=') { i++; }
+   return i;
+}
+
 } // namespace mfem::bin_io
 } // namespace mfem
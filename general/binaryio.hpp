@@ -50,6 +50,15 @@ void AppendBytes(std::vector<char> &vec, const T &val)
 
 void WriteBase64(std::ostream &out, const void *bytes, size_t length);
 
+/** @brief Decode the @a length base 64 characters in @a src, appending the
+    decoded bytes to @a bytes. White space is ignored, and the decoding stops
+    at the first padding character '='. Returns the number of characters
+    consumed, including the padding. */
+size_t DecodeBase64(const char *src, size_t length, std::vector<char> &bytes);
+
+/// Return the number of base 64 characters encoding @a nbytes bytes.
+inline size_t NumBase64Chars(size_t nbytes) { return ((nbytes + 2)/3)*4; }
+
 } // namespace mfem::bin_io
 
 } // namespace mfem
@@ -11,12 +11,20 @@
 
 #include "forall.hpp"
 #include "occa.hpp"
+#include "kernel_stats.hpp"
 #ifdef MFEM_USE_CEED
 #include <ceed.h>
 #endif
 
 #include <string>
 #include <map>
+#include <vector>
+
+#if defined(MFEM_USE_OPENMP) && defined(__linux__)
+#include <omp.h>
+#include <sched.h>
+#include <pthread.h>
+#endif
 
 namespace mfem
 {
@@ -101,6 +109,21 @@ Device::Device() : mode(Device::SEQUENTIAL),
          // Device::UpdateMemoryTypeAndClass().
          device_mem_type = MemoryType::HOST_UMPIRE;
       }
+      else if (mem_backend == "pool")
+      {
+         mem_host_env = true;
+         host_mem_type = MemoryType::HOST_POOL;
+         // Note: device_mem_type will be set to MemoryType::DEVICE_POOL only
+         // when an actual device is configured -- this is done later in
+         // Device::UpdateMemoryTypeAndClass().
+         device_mem_type = MemoryType::HOST_POOL;
+      }
+      else if (mem_backend == "numa")
+      {
+         mem_host_env = true;
+         host_mem_type = MemoryType::HOST_NUMA;
+         device_mem_type = MemoryType::HOST_NUMA;
+      }
       else if (mem_backend == "debug")
       {
          mem_host_env = true;
@@ -144,11 +167,20 @@ Device::Device() : mode(Device::SEQUENTIAL),
       Configure(device);
       device_env = true;
    }
+
+   if (getenv("MFEM_KERNEL_STATS"))
+   {
+      std::string stats(getenv("MFEM_KERNEL_STATS"));
+      const bool json = (stats.find("json") != std::string::npos);
+      const bool perf = (stats.find("perf") != std::string::npos);
+      KernelStats::Enable(json ? KernelStats::JSON : KernelStats::TABLE, perf);
+   }
 }
 
 
 Device::~Device()
 {
+   KernelStats::Report();
    if ( device_env && !destroy_mm) { return; }
    if (!device_env &&  destroy_mm && !mem_host_env)
    {
@@ -290,6 +322,9 @@ void Device::UpdateMemoryTypeAndClass()
                case MemoryType::HOST_DEBUG:
                   device_mem_type = MemoryType::DEVICE_DEBUG;
                   break;
+               case MemoryType::HOST_POOL:
+                  device_mem_type = MemoryType::DEVICE_POOL;
+                  break;
                default:
                   device_mem_type = MemoryType::DEVICE;
             }
@@ -313,6 +348,21 @@ void Device::UpdateMemoryTypeAndClass()
       device_mem_type = MemoryType::MANAGED;
    }
 
+   // Enable the memory pools when requested, e.g. with 'cpu:pool'
+   if (device_option && !strcmp(device_option, "pool"))
+   {
+      host_mem_type = MemoryType::HOST_POOL;
+      device_mem_type = device ? MemoryType::DEVICE_POOL :
+                        MemoryType::HOST_POOL;
+   }
+
+   // Enable the first-touch placement when requested, e.g. with 'omp:numa'
+   if (device_option && !strcmp(device_option, "numa"))
+   {
+      host_mem_type = MemoryType::HOST_NUMA;
+      device_mem_type = device ? MemoryType::DEVICE : MemoryType::HOST_NUMA;
+   }
+
    // Enable the DEBUG mode when requested
    if (debug)
    {
@@ -446,6 +496,49 @@ static void CeedDeviceSetup(const char* ceed_spec)
 #endif
 }
 
+static void OmpDeviceSetup(const char *option)
+{
+   // The options 'pin' and 'numa' bind each OpenMP thread to one CPU, so that
+   // the static schedule of OmpWrap() always maps the same iterations, and
+   // hence the same first-touched pages, to the same core.
+   if (!option || (strcmp(option, "pin") && strcmp(option, "numa")))
+   {
+      return;
+   }
+#if defined(MFEM_USE_OPENMP) && defined(__linux__)
+   cpu_set_t allowed;
+   CPU_ZERO(&allowed);
+   if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0)
+   {
+      MFEM_WARNING("unable to query the CPU affinity, threads are not pinned");
+      return;
+   }
+   std::vector<int> cpus;
+   for (int c = 0; c < CPU_SETSIZE; c++)
+   {
+      if (CPU_ISSET(c, &allowed)) { cpus.push_back(c); }
+   }
+   if (cpus.empty()) { return; }
+   int failed = 0;
+   #pragma omp parallel reduction(+:failed)
+   {
+      // thread t is pinned to the t-th allowed CPU, wrapping around when
+      // there are more threads than CPUs
+      const int t = omp_get_thread_num();
+      cpu_set_t mask;
+      CPU_ZERO(&mask);
+      CPU_SET(cpus[t % cpus.size()], &mask);
+      failed += pthread_setaffinity_np(pthread_self(), sizeof(mask), &mask);
+   }
+   if (failed)
+   {
+      MFEM_WARNING("unable to pin all OpenMP threads");
+   }
+#else
+   MFEM_WARNING("thread pinning requires MFEM_USE_OPENMP=YES on Linux");
+#endif
+}
+
 void Device::Setup(const int device)
 {
    MFEM_VERIFY(ngpu == -1, "the mfem::Device is already configured!");
@@ -476,6 +569,10 @@ void Device::Setup(const int device)
    MFEM_VERIFY(!Allows(Backend::CEED_CPU) || !Allows(Backend::CEED_CUDA),
                "Only one CEED backend can be enabled at a time!");
 #endif
+   if (Allows(Backend::OMP|Backend::RAJA_OMP))
+   {
+      OmpDeviceSetup(device_option);
+   }
    if (Allows(Backend::CUDA)) { CudaDeviceSetup(dev, ngpu); }
    if (Allows(Backend::HIP)) { HipDeviceSetup(dev, ngpu); }
    if (Allows(Backend::RAJA_CUDA)) { RajaDeviceSetup(dev, ngpu); }
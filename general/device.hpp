@@ -209,6 +209,19 @@ public:
          and evaluation of the operator and enables the 'cuda' backend to avoid
          transfer between host and device.
        * The 'debug' backend should not be combined with other device backends.
+       * The option ':pool' of a backend, e.g. 'cpu:pool' or 'cuda:pool',
+         allocates the host and device memory from the size-class pools of
+         MemoryType::HOST_POOL and MemoryType::DEVICE_POOL, which reuse freed
+         blocks instead of calling the system allocator. This can also be
+         selected by setting the environment variable MFEM_MEMORY=pool.
+       * The option ':pin' of the 'omp' and 'raja-omp' backends, e.g.
+         'omp:pin', binds each OpenMP thread to one of the CPUs the process is
+         allowed to run on (Linux only).
+       * The option ':numa' of the 'omp' and 'raja-omp' backends pins the
+         threads as ':pin' and allocates the host memory with
+         MemoryType::HOST_NUMA, whose pages are first touched with the static
+         OpenMP schedule of the 'omp' kernels. The memory type can also be
+         selected by setting the environment variable MFEM_MEMORY=numa.
    */
    void Configure(const std::string &device, const int dev = 0);
 
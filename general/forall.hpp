@@ -69,11 +69,13 @@ const int MAX_Q1D = 14;
 
 
 /// OpenMP backend
+/** The iterations are split with the static schedule, which is also used by
+    MemoryType::HOST_NUMA to place the pages of its allocations. */
 template <typename HBODY>
 void OmpWrap(const int N, HBODY &&h_body)
 {
 #ifdef MFEM_USE_OPENMP
-   #pragma omp parallel for
+   #pragma omp parallel for schedule(static)
    for (int k = 0; k < N; k++)
    {
       h_body(k);
@@ -0,0 +1,284 @@
+// Copyright (c) 2010-2020, Lawrence Livermore National Security, LLC. Produced
+// at the Lawrence Livermore National Laboratory. All Rights reserved. See files
+// LICENSE and NOTICE for details. LLNL-CODE-806117.
+//
+// This file is part of the MFEM library. For more information and source code
+// availability visit https://mfem.org.
+//
+// MFEM is free software; you can redistribute it and/or modify it under the
+// terms of the BSD-3 license. We welcome feedback and contributions, see file
+// CONTRIBUTING.md for details.
+
+#include "kernel_stats.hpp"
+#include "forall.hpp"
+
+#include <map>
+#include <string>
+#include <sstream>
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cstring>
+#endif
+
+namespace mfem
+{
+
+bool KernelStats::enabled = false;
+bool KernelStats::perf = false;
+KernelStats::Format KernelStats::format = KernelStats::TABLE;
+double KernelStats::peak_bw = 0.0;
+double KernelStats::peak_flops = 0.0;
+
+namespace internal
+{
+
+struct KernelKey
+{
+   std::string name;
+   int dim, D1D, Q1D;
+
+   bool operator<(const KernelKey &k) const
+   {
+      if (name != k.name) { return name < k.name; }
+      if (dim != k.dim) { return dim < k.dim; }
+      if (D1D != k.D1D) { return D1D < k.D1D; }
+      return Q1D < k.Q1D;
+   }
+};
+
+struct KernelData
+{
+   long calls = 0, fallback_calls = 0;
+   double time = 0.0, bytes = 0.0, flops = 0.0;
+   long long cycles = 0, instr = 0;
+};
+
+typedef std::map<KernelKey, KernelData> KernelMap;
+
+// The map is allocated on first use and deleted by KernelStats::Clear(), so
+// that it is still valid when the global Device object is destroyed.
+static KernelMap *kernel_map = NULL;
+
+// File descriptors of the perf_event counters (cycles, instructions).
+static int perf_fd[2] = { -1, -1 };
+
+static double WallTime()
+{
+   using namespace std::chrono;
+   return duration<double>(steady_clock::now().time_since_epoch()).count();
+}
+
+#ifdef __linux__
+static int OpenPerfCounter(unsigned long long config)
+{
+   perf_event_attr attr;
+   std::memset(&attr, 0, sizeof(attr));
+   attr.type = PERF_TYPE_HARDWARE;
+   attr.size = sizeof(attr);
+   attr.config = config;
+   attr.exclude_kernel = 1;
+   attr.exclude_hv = 1;
+   return (int)syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+}
+#endif
+
+static bool OpenPerfCounters()
+{
+#ifdef __linux__
+   if (perf_fd[0] >= 0) { return true; }
+   perf_fd[0] = OpenPerfCounter(PERF_COUNT_HW_CPU_CYCLES);
+   perf_fd[1] = OpenPerfCounter(PERF_COUNT_HW_INSTRUCTIONS);
+   if (perf_fd[0] >= 0 && perf_fd[1] >= 0) { return true; }
+   for (int i = 0; i < 2; i++)
+   {
+      if (perf_fd[i] >= 0) { close(perf_fd[i]); }
+      perf_fd[i] = -1;
+   }
+#endif
+   return false;
+}
+
+// Fixed-width formatting of the table entries.
+static std::string Fmt(double val, int prec)
+{
+   std::ostringstream os;
+   os << std::fixed << std::setprecision(prec) << val;
+   return os.str();
+}
+
+} // namespace mfem::internal
+
+void KernelStats::Enable(Format format_, bool perf_)
+{
+   enabled = true;
+   format = format_;
+   perf = perf_ && internal::OpenPerfCounters();
+   if (perf_ && !perf)
+   {
+      MFEM_WARNING("the perf_event counters are not available");
+   }
+}
+
+void KernelStats::Disable()
+{
+   enabled = false;
+}
+
+void KernelStats::SetPeaks(double bandwidth, double flop_rate)
+{
+   peak_bw = bandwidth;
+   peak_flops = flop_rate;
+}
+
+void KernelStats::Record(const char *name, int dim, int D1D, int Q1D,
+                         double time, double bytes, double flops,
+                         bool fallback, long long cycles, long long instr)
+{
+   using namespace internal;
+   if (!kernel_map) { kernel_map = new KernelMap; }
+   KernelKey key = { name, dim, D1D, Q1D };
+   KernelData &data = (*kernel_map)[key];
+   data.calls++;
+   if (fallback) { data.fallback_calls++; }
+   data.time += time;
+   data.bytes += bytes;
+   data.flops += flops;
+   data.cycles += cycles;
+   data.instr += instr;
+}
+
+void KernelStats::Print(std::ostream &out)
+{
+   if (!internal::kernel_map) { return; }
+   const bool roofline = (peak_bw > 0.0 && peak_flops > 0.0);
+   out << "\nPA kernel statistics ('*': generic fallback kernel)\n";
+   out << std::left << std::setw(36) << "kernel" << std::right
+       << std::setw(4) << "dim" << std::setw(5) << "D1D" << std::setw(5)
+       << "Q1D" << std::setw(9) << "calls" << std::setw(12) << "time [s]"
+       << std::setw(10) << "GB/s" << std::setw(10) << "GFLOP/s"
+       << std::setw(9) << "FLOP/B";
+   if (roofline) { out << std::setw(10) << "roofline"; }
+   if (perf) { out << std::setw(8) << "IPC"; }
+   out << '\n';
+   internal::KernelMap::const_iterator it;
+   for (it = internal::kernel_map->begin();
+        it != internal::kernel_map->end(); ++it)
+   {
+      const internal::KernelKey &key = it->first;
+      const internal::KernelData &data = it->second;
+      const double t = (data.time > 0.0) ? data.time : 1.0;
+      const double bw = 1e-9*data.bytes/t, fr = 1e-9*data.flops/t;
+      const double ai = (data.bytes > 0.0) ? data.flops/data.bytes : 0.0;
+      std::string name = key.name;
+      if (data.fallback_calls > 0) { name += " *"; }
+      out << std::left << std::setw(36) << name << std::right
+          << std::setw(4) << key.dim << std::setw(5) << key.D1D
+          << std::setw(5) << key.Q1D << std::setw(9) << data.calls
+          << std::setw(12) << internal::Fmt(data.time, 6)
+          << std::setw(10) << internal::Fmt(bw, 2)
+          << std::setw(10) << internal::Fmt(fr, 2)
+          << std::setw(9) << internal::Fmt(ai, 2);
+      if (roofline)
+      {
+         // fraction of the attainable FLOP rate min(peak, ai*bandwidth)
+         const double bound = std::min(peak_flops, ai*peak_bw);
+         const double frac = (bound > 0.0) ? fr/bound : 0.0;
+         out << std::setw(9) << internal::Fmt(100.0*frac, 1) << '%';
+      }
+      if (perf)
+      {
+         const double ipc = data.cycles ? double(data.instr)/data.cycles : 0.0;
+         out << std::setw(8) << internal::Fmt(ipc, 2);
+      }
+      out << '\n';
+   }
+   out << std::flush;
+}
+
+void KernelStats::PrintJSON(std::ostream &out)
+{
+   if (!internal::kernel_map) { return; }
+   out << "[\n";
+   internal::KernelMap::const_iterator it;
+   for (it = internal::kernel_map->begin();
+        it != internal::kernel_map->end(); ++it)
+   {
+      const internal::KernelKey &key = it->first;
+      const internal::KernelData &data = it->second;
+      if (it != internal::kernel_map->begin()) { out << ",\n"; }
+      out << "  { \"kernel\": \"" << key.name << "\", \"dim\": " << key.dim
+          << ", \"D1D\": " << key.D1D << ", \"Q1D\": " << key.Q1D
+          << ", \"calls\": " << data.calls
+          << ", \"fallback_calls\": " << data.fallback_calls
+          << ", \"time\": " << data.time << ", \"bytes\": " << data.bytes
+          << ", \"flops\": " << data.flops;
+      if (perf)
+      {
+         out << ", \"cycles\": " << data.cycles
+             << ", \"instructions\": " << data.instr;
+      }
+      out << " }";
+   }
+   out << "\n]" << std::endl;
+}
+
+void KernelStats::Report(std::ostream &out)
+{
+   if (!internal::kernel_map) { return; }
+   if (format == JSON) { PrintJSON(out); }
+   else { Print(out); }
+   Clear();
+}
+
+void KernelStats::Clear()
+{
+   delete internal::kernel_map;
+   internal::kernel_map = NULL;
+}
+
+bool KernelStats::ReadCounters(long long &cycles, long long &instr)
+{
+   cycles = instr = 0;
+#ifdef __linux__
+   if (!perf) { return false; }
+   long long val[2];
+   for (int i = 0; i < 2; i++)
+   {
+      if (read(internal::perf_fd[i], &val[i], sizeof(long long)) !=
+          sizeof(long long)) { return false; }
+   }
+   cycles = val[0];
+   instr = val[1];
+   return true;
+#else
+   return false;
+#endif
+}
+
+void KernelTimer::Start()
+{
+   KernelStats::ReadCounters(cycles, instr);
+   start = internal::WallTime();
+}
+
+void KernelTimer::Stop()
+{
+   if (Device::Allows(Backend::DEVICE_MASK)) { MFEM_DEVICE_SYNC; }
+   const double time = internal::WallTime() - start;
+   long long c, i;
+   if (KernelStats::ReadCounters(c, i))
+   {
+      c -= cycles;
+      i -= instr;
+   }
+   KernelStats::Record(name, dim, D1D, Q1D, time, bytes, flops, fallback,
+                       c, i);
+}
+
+} // namespace mfem
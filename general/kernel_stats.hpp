@@ -0,0 +1,149 @@
+// Copyright (c) 2010-2020, Lawrence Livermore National Security, LLC. Produced
+// at the Lawrence Livermore National Laboratory. All Rights reserved. See files
+// LICENSE and NOTICE for details. LLNL-CODE-806117.
+//
+// This file is part of the MFEM library. For more information and source code
+// availability visit https://mfem.org.
+//
+// MFEM is free software; you can redistribute it and/or modify it under the
+// terms of the BSD-3 license. We welcome feedback and contributions, see file
+// CONTRIBUTING.md for details.
+
+#ifndef MFEM_KERNEL_STATS
+#define MFEM_KERNEL_STATS
+
+#include "../config/config.hpp"
+#include "globals.hpp"
+
+namespace mfem
+{
+
+/** @brief Opt-in instrumentation of the partial assembly kernels.
+
+    When enabled, every instrumented kernel launch records its invocation
+    count, wall time, and analytic counts of the bytes moved to/from memory and
+    of the floating-point operations, accumulated per kernel name, dimension
+    and (D1D,Q1D) pair. The launches that use the generic (non-specialized)
+    version of a kernel are flagged, and on Linux the CPU cycles and
+    instructions can also be measured with perf_event counters.
+
+    The statistics are reported, as a table or in JSON format, when the Device
+    object is destroyed or when Report() is called. They can be enabled with
+    Enable() or with the environment variable MFEM_KERNEL_STATS, which is a
+    comma-separated list containing "table" or "json", and optionally "perf",
+    e.g. MFEM_KERNEL_STATS=table,perf.
+
+    The achieved bandwidth and FLOP rate, together with the arithmetic
+    intensity (FLOPs per byte), allow to place each kernel in a roofline plot.
+    If the peak bandwidth and FLOP rate of the machine are given with
+    SetPeaks(), the table also reports the fraction of the roofline bound
+    reached by each kernel. */
+class KernelStats
+{
+public:
+   /// Output formats of Report().
+   enum Format
+   {
+      TABLE, ///< Human readable table.
+      JSON   ///< JSON array with one object per kernel configuration.
+   };
+
+   /** @brief Enable the recording of the kernel statistics, reported in the
+       given @a format. If @a perf is true, also measure the CPU cycles and
+       instructions with the Linux perf_event counters, if available. */
+   static void Enable(Format format = TABLE, bool perf = false);
+
+   /// Disable the recording of the kernel statistics.
+   static void Disable();
+
+   /// Return true if the recording of the kernel statistics is enabled.
+   static bool IsEnabled() { return enabled; }
+
+   /** @brief Set the peak memory bandwidth (in GB/s) and FLOP rate (in
+       GFLOP/s) used to compute the fraction of the roofline bound. */
+   static void SetPeaks(double bandwidth, double flop_rate);
+
+   /** @brief Record one launch of the kernel @a name in dimension @a dim with
+       @a D1D dofs and @a Q1D quadrature points in 1D.
+
+       @param[in] time      Wall time of the launch, in seconds.
+       @param[in] bytes     Bytes moved to/from memory.
+       @param[in] flops     Floating-point operations.
+       @param[in] fallback  True if the generic kernel was used.
+       @param[in] cycles    CPU cycles (zero if not measured).
+       @param[in] instr     CPU instructions (zero if not measured). */
+   static void Record(const char *name, int dim, int D1D, int Q1D,
+                      double time, double bytes, double flops, bool fallback,
+                      long long cycles = 0, long long instr = 0);
+
+   /// Print the statistics recorded so far as a table.
+   static void Print(std::ostream &out = mfem::out);
+
+   /// Print the statistics recorded so far in JSON format.
+   static void PrintJSON(std::ostream &out = mfem::out);
+
+   /** @brief Print the statistics recorded so far, if any, in the format
+       given to Enable(), and clear them. Called by the Device destructor. */
+   static void Report(std::ostream &out = mfem::out);
+
+   /// Clear the statistics recorded so far.
+   static void Clear();
+
+   /** @brief Read the perf_event counters of the calling thread. Returns false
+       (and sets the counters to zero) if they are not measured. */
+   static bool ReadCounters(long long &cycles, long long &instr);
+
+private:
+   static bool enabled, perf;
+   static Format format;
+   static double peak_bw, peak_flops;
+};
+
+/** @brief Scoped recording of a kernel launch in KernelStats.
+
+    The object measures the time (and the perf_event counters) between its
+    construction and its destruction, so it is constructed at the beginning of
+    the function that dispatches a kernel, e.g.
+    @code
+       KernelTimer timer("MassIntegrator::AddMultPA", dim, D1D, Q1D,
+                         bytes, flops);
+       switch (id)
+       {
+          case 0x22: return SmemPAMassApply2D<2,2,16>(...);
+          ...
+          default: timer.Fallback(); return PAMassApply2D(...);
+       }
+    @endcode
+    When KernelStats is disabled, the overhead is a single test. */
+class KernelTimer
+{
+private:
+   const char *name;
+   int dim, D1D, Q1D;
+   double bytes, flops;
+   bool active, fallback;
+   long long cycles, instr;
+   double start;
+
+   void Start();
+   void Stop();
+
+public:
+   /** @brief Start recording the launch of the kernel @a name, see
+       KernelStats::Record(). */
+   KernelTimer(const char *name_, int dim_, int D1D_, int Q1D_,
+               double bytes_, double flops_)
+      : name(name_), dim(dim_), D1D(D1D_), Q1D(Q1D_), bytes(bytes_),
+        flops(flops_), active(KernelStats::IsEnabled()), fallback(false)
+   { if (active) { Start(); } }
+
+   /// Flag the launch as using the generic version of the kernel.
+   void Fallback() { fallback = true; }
+
+   /// Synchronize the device, if enabled, and record the launch.
+   ~KernelTimer() { if (active) { Stop(); } }
+};
+
+} // namespace mfem
+
+#endif // MFEM_KERNEL_STATS
@@ -15,8 +15,13 @@
 #include <list>
 #include <cstring> // std::memcpy, std::memcmp
 #include <unordered_map>
+#include <vector>
 #include <algorithm> // std::max
 
+#ifdef MFEM_USE_OPENMP
+#include <omp.h>
+#endif
+
 // Uncomment to try _WIN32 platform
 //#define _WIN32
 //#define _aligned_malloc(s,a) malloc(s)
@@ -72,10 +77,13 @@ MemoryType MemoryManager::GetDualMemoryType_(MemoryType mt)
       case MemoryType::HOST_64:        return MemoryType::DEVICE;
       case MemoryType::HOST_DEBUG:     return MemoryType::DEVICE_DEBUG;
       case MemoryType::HOST_UMPIRE:    return MemoryType::DEVICE_UMPIRE;
+      case MemoryType::HOST_POOL:      return MemoryType::DEVICE_POOL;
+      case MemoryType::HOST_NUMA:      return MemoryType::DEVICE;
       case MemoryType::MANAGED:        return MemoryType::MANAGED;
       case MemoryType::DEVICE:         return MemoryType::HOST;
       case MemoryType::DEVICE_DEBUG:   return MemoryType::HOST_DEBUG;
       case MemoryType::DEVICE_UMPIRE:  return MemoryType::HOST_UMPIRE;
+      case MemoryType::DEVICE_POOL:    return MemoryType::HOST_POOL;
       default: mfem_error("Unknown memory type!");
    }
    MFEM_VERIFY(false,"");
@@ -89,7 +97,9 @@ static void MFEM_VERIFY_TYPES(const MemoryType h_mt, const MemoryType d_mt)
    const bool sync =
       (h_mt == MemoryType::HOST_UMPIRE && d_mt == MemoryType::DEVICE_UMPIRE) ||
       (h_mt == MemoryType::HOST_DEBUG && d_mt == MemoryType::DEVICE_DEBUG) ||
+      (h_mt == MemoryType::HOST_POOL && d_mt == MemoryType::DEVICE_POOL) ||
       (h_mt == MemoryType::MANAGED && d_mt == MemoryType::MANAGED) ||
+      (h_mt == MemoryType::HOST_NUMA && d_mt == MemoryType::DEVICE) ||
       (h_mt == MemoryType::HOST_64 && d_mt == MemoryType::DEVICE) ||
       (h_mt == MemoryType::HOST_32 && d_mt == MemoryType::DEVICE) ||
       (h_mt == MemoryType::HOST && d_mt == MemoryType::DEVICE);
@@ -227,6 +237,61 @@ public:
    void Dealloc(void *ptr) { mfem_aligned_free(ptr); }
 };
 
+/// The NUMA-aware host memory space: the pages of large allocations are first
+/// touched by the OpenMP threads, with the static schedule used by OmpWrap(),
+/// so that the OS places them close to the thread that will work on them.
+class NumaHostMemorySpace : public HostMemorySpace
+{
+private:
+   const size_t page;
+
+   static size_t PageSize()
+   {
+#ifndef _WIN32
+      const long size = sysconf(_SC_PAGE_SIZE);
+      return size > 0 ? (size_t) size : 4096;
+#else
+      return 4096;
+#endif
+   }
+
+   /// Write one byte in each page, where the page starting at byte i is
+   /// touched by the thread whose static-schedule range contains i.
+   void FirstTouch(char *data, size_t bytes)
+   {
+#ifdef MFEM_USE_OPENMP
+      #pragma omp parallel
+      {
+         const size_t nt = omp_get_num_threads(), t = omp_get_thread_num();
+         const size_t q = bytes / nt, r = bytes % nt;
+         const size_t begin = t*q + std::min(t, r);
+         const size_t end = begin + q + (t < r ? 1 : 0);
+         for (size_t i = (begin + page - 1) / page * page; i < end; i += page)
+         {
+            data[i] = 0;
+         }
+      }
+#else
+      MFEM_CONTRACT_VAR(data);
+      MFEM_CONTRACT_VAR(bytes);
+#endif
+   }
+
+public:
+   NumaHostMemorySpace(): HostMemorySpace(), page(PageSize()) { }
+   void Alloc(void **ptr, size_t bytes)
+   {
+      // small allocations fit in a page or two: keep them 64-byte aligned
+      const bool touch = bytes >= 4*page;
+      if (mfem_memalign(ptr, touch ? page : 64, bytes) != 0)
+      {
+         throw ::std::bad_alloc();
+      }
+      if (touch) { FirstTouch(static_cast<char*>(*ptr), bytes); }
+   }
+   void Dealloc(void *ptr) { mfem_aligned_free(ptr); }
+};
+
 #ifndef _WIN32
 static uintptr_t pagesize = 0;
 static uintptr_t pagemask = 0;
@@ -458,6 +523,141 @@ public:
    { return std::memcpy(dst, src, bytes); }
 };
 
+/// Cache of freed memory blocks, sorted into size classes. Used by the
+/// HOST_POOL and DEVICE_POOL memory spaces on top of an upstream allocator.
+class MemoryPool
+{
+private:
+   typedef std::unordered_map<size_t, std::vector<void*>> FreeLists;
+   FreeLists free_blocks;
+
+public:
+   MemoryPoolStats stats;
+
+   /** Round up the given size to its size class: multiples of 64 bytes up to
+       512 bytes, then four classes per power of two. The rounding wastes at
+       most 25% of the block, and leaves all blocks aligned at 64 bytes. */
+   static size_t SizeClass(size_t bytes)
+   {
+      if (bytes <= 512)
+      {
+         return std::max<size_t>(64, (bytes + 63) & ~size_t(63));
+      }
+      size_t pow2 = 512;
+      while (2*pow2 < bytes) { pow2 *= 2; }
+      const size_t step = pow2/4;
+      return (bytes + step - 1) / step * step;
+   }
+
+   /// Return a cached block of the given size class, or nullptr if there is
+   /// none; in that case the caller allocates a new block.
+   void *Get(size_t cls)
+   {
+      void *ptr = nullptr;
+      stats.allocs++;
+      FreeLists::iterator it = free_blocks.find(cls);
+      if (it != free_blocks.end() && it->second.size())
+      {
+         ptr = it->second.back();
+         it->second.pop_back();
+         stats.hits++;
+      }
+      else
+      {
+         stats.pool_bytes += cls;
+      }
+      stats.live_bytes += cls;
+      stats.peak_bytes = std::max(stats.peak_bytes, stats.live_bytes);
+      return ptr;
+   }
+
+   /// Return a block of the given size class to the cache.
+   void Put(void *ptr, size_t cls)
+   {
+      MFEM_ASSERT(stats.live_bytes >= cls, "invalid memory pool state");
+      free_blocks[cls].push_back(ptr);
+      stats.live_bytes -= cls;
+   }
+
+   /// Free all cached blocks using the upstream deallocator @a dealloc.
+   template <typename Dealloc> void Release(Dealloc dealloc)
+   {
+      for (auto &list : free_blocks)
+      {
+         for (void *ptr : list.second) { dealloc(ptr, list.first); }
+         stats.pool_bytes -= list.first * list.second.size();
+      }
+      free_blocks.clear();
+   }
+};
+
+/// The pooled host memory space, allocations are aligned at 64 bytes
+class PoolHostMemorySpace : public HostMemorySpace
+{
+public:
+   MemoryPool pool;
+
+   ~PoolHostMemorySpace() { Release(); }
+   void Alloc(void **ptr, size_t bytes)
+   {
+      const size_t cls = MemoryPool::SizeClass(bytes);
+      *ptr = pool.Get(cls);
+      if (*ptr) { return; }
+      if (mfem_memalign(ptr, 64, cls) != 0) { throw ::std::bad_alloc(); }
+   }
+   void Dealloc(void *ptr)
+   {
+      pool.Put(ptr, MemoryPool::SizeClass(maps->memories.at(ptr).bytes));
+   }
+   void Release()
+   {
+      pool.Release([](void *ptr, size_t) { mfem_aligned_free(ptr); });
+   }
+};
+
+/// The pooled device memory space on top of the given upstream device space
+class PoolDeviceMemorySpace : public DeviceMemorySpace
+{
+private:
+   DeviceMemorySpace *upstream;
+
+public:
+   MemoryPool pool;
+
+   PoolDeviceMemorySpace(DeviceMemorySpace *upstream): upstream(upstream) { }
+   ~PoolDeviceMemorySpace() { Release(); delete upstream; }
+   void Alloc(Memory &base)
+   {
+      const size_t cls = MemoryPool::SizeClass(base.bytes);
+      base.d_ptr = pool.Get(cls);
+      if (base.d_ptr) { return; }
+      Memory block(nullptr, cls, base.h_mt, base.d_mt);
+      upstream->Alloc(block);
+      base.d_ptr = block.d_ptr;
+   }
+   void Dealloc(Memory &base)
+   {
+      pool.Put(base.d_ptr, MemoryPool::SizeClass(base.bytes));
+   }
+   void Release()
+   {
+      DeviceMemorySpace *up = upstream;
+      pool.Release([up](void *ptr, size_t cls)
+      {
+         Memory block(nullptr, cls, MemoryType::HOST_POOL,
+                      MemoryType::DEVICE_POOL);
+         block.d_ptr = ptr;
+         up->Dealloc(block);
+      });
+   }
+   void *HtoD(void *dst, const void *src, size_t bytes)
+   { return upstream->HtoD(dst, src, bytes); }
+   void *DtoD(void* dst, const void* src, size_t bytes)
+   { return upstream->DtoD(dst, src, bytes); }
+   void *DtoH(void *dst, const void *src, size_t bytes)
+   { return upstream->DtoH(dst, src, bytes); }
+};
+
 #ifndef MFEM_USE_UMPIRE
 class UmpireHostMemorySpace : public NoHostMemorySpace { };
 class UmpireDeviceMemorySpace : public NoDeviceMemorySpace { };
@@ -569,6 +769,8 @@ public:
       // HOST_DEBUG is delayed, as it reroutes signals
       host[static_cast<int>(MT::HOST_DEBUG)] = nullptr;
       host[static_cast<int>(MT::HOST_UMPIRE)] = new UmpireHostMemorySpace();
+      host[static_cast<int>(MT::HOST_POOL)] = new PoolHostMemorySpace();
+      host[static_cast<int>(MT::HOST_NUMA)] = new NumaHostMemorySpace();
       host[static_cast<int>(MT::MANAGED)] = new UvmHostMemorySpace();
 
       // Filling the device memory backends, shifting with the device size
@@ -578,6 +780,7 @@ public:
       device[static_cast<int>(MemoryType::DEVICE)-shift] = nullptr;
       device[static_cast<int>(MT::DEVICE_DEBUG)-shift] = nullptr;
       device[static_cast<int>(MT::DEVICE_UMPIRE)-shift] = nullptr;
+      device[static_cast<int>(MT::DEVICE_POOL)-shift] = nullptr;
    }
 
    HostMemorySpace* Host(const MemoryType mt)
@@ -599,6 +802,19 @@ public:
       return device[mt_i];
    }
 
+   /// Return the HOST_POOL memory space.
+   PoolHostMemorySpace *HostPool()
+   {
+      return static_cast<PoolHostMemorySpace*>(Host(MT::HOST_POOL));
+   }
+
+   /// Return the DEVICE_POOL memory space, or nullptr if it was not used yet.
+   PoolDeviceMemorySpace *DevicePool()
+   {
+      const int mt_i = static_cast<int>(MT::DEVICE_POOL) - DeviceMemoryType;
+      return static_cast<PoolDeviceMemorySpace*>(device[mt_i]);
+   }
+
    ~Ctrl()
    {
       constexpr int mt_h = HostMemoryType;
@@ -621,6 +837,17 @@ private:
       {
          case MT::DEVICE_UMPIRE: return new UmpireDeviceMemorySpace();
          case MT::DEVICE_DEBUG: return new MmuDeviceMemorySpace();
+         case MT::DEVICE_POOL:
+         {
+#if defined(MFEM_USE_CUDA)
+            return new PoolDeviceMemorySpace(new CudaDeviceMemorySpace());
+#elif defined(MFEM_USE_HIP)
+            return new PoolDeviceMemorySpace(new HipDeviceMemorySpace());
+#else
+            // without a device, pool pseudo-device memory from the host
+            return new PoolDeviceMemorySpace(new StdDeviceMemorySpace());
+#endif
+         }
          case MT::DEVICE:
          {
 #if defined(MFEM_USE_CUDA)
@@ -770,12 +997,14 @@ bool MemoryManager::MemoryClassCheck_(MemoryClass mc, void *h_ptr,
       case MemoryClass::HOST_32:
       {
          MFEM_VERIFY(h_mt == MemoryType::HOST_32 ||
-                     h_mt == MemoryType::HOST_64,"");
+                     h_mt == MemoryType::HOST_64 ||
+                     h_mt == MemoryType::HOST_NUMA,"");
          return true;
       }
       case MemoryClass::HOST_64:
       {
-         MFEM_VERIFY(h_mt == MemoryType::HOST_64,"");
+         MFEM_VERIFY(h_mt == MemoryType::HOST_64 ||
+                     h_mt == MemoryType::HOST_NUMA,"");
          return true;
       }
       case MemoryClass::DEVICE:
@@ -783,6 +1012,7 @@ bool MemoryManager::MemoryClassCheck_(MemoryClass mc, void *h_ptr,
          MFEM_VERIFY(d_mt == MemoryType::DEVICE ||
                      d_mt == MemoryType::DEVICE_DEBUG ||
                      d_mt == MemoryType::DEVICE_UMPIRE ||
+                     d_mt == MemoryType::DEVICE_POOL ||
                      d_mt == MemoryType::MANAGED,"");
          return true;
       }
@@ -1029,7 +1259,9 @@ void MemoryManager::CopyToHost_(void *dest_h_ptr, const void *src_h_ptr,
       const void *src_d_ptr = (src_flags & Mem::ALIAS) ?
                               mm.GetAliasDevicePtr(src_h_ptr, bytes, false) :
                               mm.GetDevicePtr(src_h_ptr, bytes, false);
-      const internal::Memory &base = maps->memories.at(dest_h_ptr);
+      const internal::Memory &base = (src_flags & Mem::ALIAS) ?
+                                     *maps->aliases.at(src_h_ptr).mem :
+                                     maps->memories.at(src_h_ptr);
       const MemoryType d_mt = base.d_mt;
       ctrl->Device(d_mt)->DtoH(dest_h_ptr, src_d_ptr, bytes);
    }
@@ -1054,7 +1286,9 @@ void MemoryManager::CopyFromHost_(void *dest_h_ptr, const void *src_h_ptr,
       void *dest_d_ptr = (dest_flags & Mem::ALIAS) ?
                          mm.GetAliasDevicePtr(dest_h_ptr, bytes, false) :
                          mm.GetDevicePtr(dest_h_ptr, bytes, false);
-      const internal::Memory &base = maps->memories.at(dest_h_ptr);
+      const internal::Memory &base = (dest_flags & Mem::ALIAS) ?
+                                     *maps->aliases.at(dest_h_ptr).mem :
+                                     maps->memories.at(dest_h_ptr);
       const MemoryType d_mt = base.d_mt;
       ctrl->Device(d_mt)->HtoD(dest_d_ptr, src_h_ptr, bytes);
    }
@@ -1338,6 +1572,42 @@ int MemoryManager::PrintAliases(std::ostream &out)
    return n_out;
 }
 
+MemoryPoolStats MemoryManager::GetPoolStats(MemoryType mt)
+{
+   MFEM_VERIFY(mt == MemoryType::HOST_POOL || mt == MemoryType::DEVICE_POOL,
+               "invalid memory type: " << MemoryTypeName[(int)mt]);
+   if (!exists) { return MemoryPoolStats(); }
+   if (mt == MemoryType::HOST_POOL) { return ctrl->HostPool()->pool.stats; }
+   internal::PoolDeviceMemorySpace *d_pool = ctrl->DevicePool();
+   return d_pool ? d_pool->pool.stats : MemoryPoolStats();
+}
+
+void MemoryManager::PrintPoolStats(std::ostream &out)
+{
+   const MemoryType pools[2] =
+   { MemoryType::HOST_POOL, MemoryType::DEVICE_POOL };
+   for (int i = 0; i < 2; i++)
+   {
+      const MemoryPoolStats stats = GetPoolStats(pools[i]);
+      if (stats.allocs == 0) { continue; }
+      out << MemoryTypeName[static_cast<int>(pools[i])] << ": "
+          << stats.allocs << " allocations, "
+          << 100.0*stats.HitRate() << "% hit rate, "
+          << "live " << stats.live_bytes << " bytes, "
+          << "peak " << stats.peak_bytes << " bytes, "
+          << "pool " << stats.pool_bytes << " bytes" << std::endl;
+   }
+}
+
+void MemoryManager::ReleasePool(MemoryType mt)
+{
+   MFEM_VERIFY(mt == MemoryType::HOST_POOL || mt == MemoryType::DEVICE_POOL,
+               "invalid memory type: " << MemoryTypeName[(int)mt]);
+   if (!exists) { return; }
+   if (mt == MemoryType::HOST_POOL) { ctrl->HostPool()->Release(); }
+   else if (ctrl->DevicePool()) { ctrl->DevicePool()->Release(); }
+}
+
 int MemoryManager::CompareHostAndDevice_(void *h_ptr, size_t size,
                                          unsigned flags)
 {
@@ -1390,7 +1660,8 @@ MemoryType MemoryManager::device_mem_type = MemoryType::HOST;
 
 const char *MemoryTypeName[MemoryTypeSize] =
 {
-   "host-std", "host-32", "host-64", "host-debug", "host-umpire",
+   "host-std", "host-32", "host-64", "host-debug", "host-umpire", "host-pool",
+   "host-numa",
 #if defined(MFEM_USE_CUDA)
    "cuda-uvm",
    "cuda",
@@ -1403,11 +1674,14 @@ const char *MemoryTypeName[MemoryTypeSize] =
 #endif
    "device-debug",
 #if defined(MFEM_USE_CUDA)
-   "cuda-umpire"
+   "cuda-umpire",
+   "cuda-pool"
 #elif defined(MFEM_USE_HIP)
-   "hip-umpire"
+   "hip-umpire",
+   "hip-pool"
 #else
-   "device-umpire"
+   "device-umpire",
+   "device-pool"
 #endif
 };
 
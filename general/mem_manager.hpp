@@ -32,12 +32,18 @@ enum class MemoryType
    HOST_64,        ///< Host memory; aligned at 64 bytes
    HOST_DEBUG,     ///< Host memory; allocated from a "host-debug" pool
    HOST_UMPIRE,    ///< Host memory; using Umpire
+   HOST_POOL,      /**< Host memory; aligned at 64 bytes, cached in a size-class
+                        pool, see MemoryManager::GetPoolStats() */
+   HOST_NUMA,      /**< Host memory; aligned at 64 bytes, with the pages first
+                        touched by the OpenMP threads, see OmpWrap() */
    MANAGED,        /**< Managed memory; using CUDA or HIP *MallocManaged
                         and *Free */
    DEVICE,         ///< Device memory; using CUDA or HIP *Malloc and *Free
    DEVICE_DEBUG,   /**< Pseudo-device memory; allocated on host from a
                         "device-debug" pool */
    DEVICE_UMPIRE,  ///< Device memory; using Umpire
+   DEVICE_POOL,    /**< Device memory; cached in a size-class pool, falls back
+                        to host memory when no device is available */
    SIZE            ///< Number of host and device memory types
 };
 
@@ -58,10 +64,12 @@ extern const char *MemoryTypeName[MemoryTypeSize];
 enum class MemoryClass
 {
    HOST,    /**< Memory types: { HOST, HOST_32, HOST_64, HOST_DEBUG,
-                                 HOST_UMPIRE, MANAGED } */
-   HOST_32, ///< Memory types: { HOST_32, HOST_64, HOST_DEBUG }
-   HOST_64, ///< Memory types: { HOST_64, HOST_DEBUG }
-   DEVICE,  ///< Memory types: { DEVICE, DEVICE_DEBUG, DEVICE_UMPIRE, MANAGED }
+                                 HOST_UMPIRE, HOST_POOL, HOST_NUMA,
+                                 MANAGED } */
+   HOST_32, ///< Memory types: { HOST_32, HOST_64, HOST_DEBUG, HOST_NUMA }
+   HOST_64, ///< Memory types: { HOST_64, HOST_DEBUG, HOST_NUMA }
+   DEVICE,  /**< Memory types: { DEVICE, DEVICE_DEBUG, DEVICE_UMPIRE,
+                                 DEVICE_POOL, MANAGED } */
    MANAGED  ///< Memory types: { MANAGED }
 };
 
@@ -82,6 +90,23 @@ MemoryType GetMemoryType(MemoryClass mc);
     HOST < HOST_32 < HOST_64 < DEVICE < MANAGED. */
 MemoryClass operator*(MemoryClass mc1, MemoryClass mc2);
 
+/// Statistics of the memory pools used by MemoryType::HOST_POOL and
+/// MemoryType::DEVICE_POOL, see MemoryManager::GetPoolStats().
+struct MemoryPoolStats
+{
+   size_t allocs;      ///< Number of allocations requested from the pool.
+   size_t hits;        ///< Number of allocations served by a cached block.
+   size_t live_bytes;  ///< Size of the blocks currently in use.
+   size_t peak_bytes;  ///< Maximum of live_bytes.
+   size_t pool_bytes;  ///< Size of all blocks held by the pool (used or free).
+
+   MemoryPoolStats()
+      : allocs(0), hits(0), live_bytes(0), peak_bytes(0), pool_bytes(0) { }
+
+   /// Fraction of the allocations served without calling the system allocator.
+   double HitRate() const { return allocs ? double(hits)/allocs : 0.0; }
+};
+
 /// Class used by MFEM to store pointers to host and/or device memory.
 /** The template class parameter, T, must be a plain-old-data (POD) type.
 
@@ -293,7 +318,8 @@ public:
           - MANAGED => MANAGED,
           - HOST_DEBUG => DEVICE_DEBUG,
           - HOST_UMPIRE => DEVICE_UMPIRE,
-          - HOST, HOST_32, HOST_64 => DEVICE.
+          - HOST_POOL => DEVICE_POOL,
+          - HOST, HOST_32, HOST_64, HOST_NUMA => DEVICE.
 
        The parameter @a own determines whether both @a h_ptr and @a d_ptr will
        be deleted when the method Delete() is called.
@@ -652,6 +678,17 @@ public:
    /// returning the number of printed pointers
    int PrintAliases(std::ostream &out = mfem::out);
 
+   /// Return the statistics of the pool of the given MemoryType, which must be
+   /// MemoryType::HOST_POOL or MemoryType::DEVICE_POOL.
+   MemoryPoolStats GetPoolStats(MemoryType mt);
+
+   /// Print the statistics of the host and device memory pools.
+   void PrintPoolStats(std::ostream &out = mfem::out);
+
+   /** @brief Free the blocks that are cached, but currently unused, by the pool
+       of the given MemoryType (MemoryType::HOST_POOL or DEVICE_POOL). */
+   void ReleasePool(MemoryType mt);
+
    static MemoryType GetHostMemoryType() { return host_mem_type; }
    static MemoryType GetDeviceMemoryType() { return device_mem_type; }
 };
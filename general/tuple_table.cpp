@@ -0,0 +1,271 @@
+// Copyright (c) 2010-2020, Lawrence Livermore National Security, LLC. Produced
+// at the Lawrence Livermore National Laboratory. All Rights reserved. See files
+// LICENSE and NOTICE for details. LLNL-CODE-806117.
+//
+// This file is part of the MFEM library. For more information and source code
+// availability visit https://mfem.org.
+//
+// MFEM is free software; you can redistribute it and/or modify it under the
+// terms of the BSD-3 license. We welcome feedback and contributions, see file
+// CONTRIBUTING.md for details.
+
+#include "tuple_table.hpp"
+
+#include <algorithm>
+
+#ifdef MFEM_USE_OPENMP
+#include <omp.h>
+#define MFEM_TT_OMP(X) _Pragma(#X)
+#else
+#define MFEM_TT_OMP(X)
+#endif
+
+namespace mfem
+{
+
+namespace internal
+{
+
+static inline int MaxThreads()
+{
+#ifdef MFEM_USE_OPENMP
+   return omp_get_max_threads();
+#else
+   return 1;
+#endif
+}
+
+static inline int NumThreads()
+{
+#ifdef MFEM_USE_OPENMP
+   return omp_get_num_threads();
+#else
+   return 1;
+#endif
+}
+
+static inline int ThreadNum()
+{
+#ifdef MFEM_USE_OPENMP
+   return omp_get_thread_num();
+#else
+   return 0;
+#endif
+}
+
+// Range [begin, end) of the n entries processed by the calling thread.
+static inline void ThreadRange(int n, int &begin, int &end)
+{
+   const int nt = NumThreads(), t = ThreadNum();
+   begin = (int)(((long)n*t)/nt);
+   end = (int)(((long)n*(t+1))/nt);
+}
+
+// Exclusive prefix sum of the n entries of in, written to out (which may be
+// equal to in). Returns the total sum.
+static int ExclusiveScan(const int *in, int *out, int n)
+{
+   Array<int> part(MaxThreads() + 1);
+   int total = 0;
+   MFEM_TT_OMP(omp parallel)
+   {
+      int begin, end, sum = 0;
+      ThreadRange(n, begin, end);
+      for (int i = begin; i < end; i++) { sum += in[i]; }
+      part[ThreadNum()+1] = sum;
+      MFEM_TT_OMP(omp barrier)
+      MFEM_TT_OMP(omp single)
+      {
+         part[0] = 0;
+         for (int t = 0; t < NumThreads(); t++) { part[t+1] += part[t]; }
+         total = part[NumThreads()];
+      }
+      sum = part[ThreadNum()];
+      for (int i = begin; i < end; i++)
+      {
+         const int val = in[i];
+         out[i] = sum;
+         sum += val;
+      }
+   }
+   return total;
+}
+
+// Compare the entries at positions a and b of the tuples by their columns 1 to
+// width-1, then by their positions.
+struct TupleLess
+{
+   const int *tuples;
+   int width;
+
+   bool operator()(int a, int b) const
+   {
+      for (int j = 1; j < width; j++)
+      {
+         const int ta = tuples[(size_t)a*width + j];
+         const int tb = tuples[(size_t)b*width + j];
+         if (ta != tb) { return ta < tb; }
+      }
+      return a < b;
+   }
+};
+
+// Sort the n positions p with the comparison less. The buckets are small, so
+// insertion sort is used unless n is large.
+static void SortBucket(int *p, int n, const TupleLess &less)
+{
+   if (n > 32) { std::sort(p, p + n, less); return; }
+   for (int i = 1; i < n; i++)
+   {
+      const int val = p[i];
+      int j = i;
+      for ( ; j > 0 && less(val, p[j-1]); j--) { p[j] = p[j-1]; }
+      p[j] = val;
+   }
+}
+
+} // namespace mfem::internal
+
+void TupleTable::Make(const int *tuples, int n, int width_, int max_val)
+{
+   MFEM_VERIFY(width_ >= 1 && width_ <= 3, "invalid tuple width: " << width_);
+   width = width_;
+   SortAndGroup(tuples, n, max_val);
+   Number(n);
+}
+
+void TupleTable::SortAndGroup(const int *tuples, int n, int max_val)
+{
+   using namespace internal;
+
+   // Counting sort of the positions by the first column, i.e. a single radix
+   // pass with one bucket per value. With multiple threads, the order of the
+   // positions within the buckets is not deterministic, so it is restored by
+   // the sort of the buckets.
+   Array<int> bucket(max_val + 1), next(max_val + 1);
+   int *cnt = bucket.GetData(), *nxt = next.GetData();
+   MFEM_TT_OMP(omp parallel for)
+   for (int b = 0; b <= max_val; b++) { cnt[b] = 0; }
+   MFEM_TT_OMP(omp parallel for)
+   for (int i = 0; i < n; i++)
+   {
+      const int b = tuples[(size_t)i*width];
+      MFEM_ASSERT(0 <= b && b < max_val, "invalid tuple entry: " << b);
+      MFEM_TT_OMP(omp atomic)
+      cnt[b]++;
+   }
+   ExclusiveScan(cnt, cnt, max_val + 1);
+   MFEM_TT_OMP(omp parallel for)
+   for (int b = 0; b <= max_val; b++) { nxt[b] = cnt[b]; }
+
+   perm.SetSize(n);
+   MFEM_TT_OMP(omp parallel for)
+   for (int i = 0; i < n; i++)
+   {
+      const int b = tuples[(size_t)i*width];
+      int k;
+      MFEM_TT_OMP(omp atomic capture)
+      k = nxt[b]++;
+      perm[k] = i;
+   }
+
+   // Sort every bucket by the remaining columns and the positions, mark the
+   // first entry of every group of equal tuples and count the groups in the
+   // bucket (stored in next).
+   const TupleLess less = { tuples, width };
+   Array<char> start(n);
+   MFEM_TT_OMP(omp parallel for schedule(dynamic, 1024))
+   for (int b = 0; b < max_val; b++)
+   {
+      int *p = perm.GetData() + cnt[b];
+      const int size = cnt[b+1] - cnt[b];
+      SortBucket(p, size, less);
+      int ngroups = 0;
+      for (int k = 0; k < size; k++)
+      {
+         bool first = (k == 0);
+         for (int j = 1; !first && j < width; j++)
+         {
+            first = (tuples[(size_t)p[k]*width + j] !=
+                     tuples[(size_t)p[k-1]*width + j]);
+         }
+         start[cnt[b] + k] = first;
+         ngroups += first;
+      }
+      nxt[b] = ngroups;
+   }
+   nxt[max_val] = 0;
+   const int ngroups = ExclusiveScan(nxt, nxt, max_val + 1);
+
+   offsets.SetSize(ngroups + 1);
+   offsets[ngroups] = n;
+   keys.SetSize(ngroups*width);
+   MFEM_TT_OMP(omp parallel for schedule(dynamic, 1024))
+   for (int b = 0; b < max_val; b++)
+   {
+      int g = nxt[b];
+      for (int k = cnt[b]; k < cnt[b+1]; k++)
+      {
+         if (!start[k]) { continue; }
+         offsets[g] = k;
+         const int *t = tuples + (size_t)perm[k]*width;
+         for (int j = 0; j < width; j++) { keys[g*width + j] = t[j]; }
+         g++;
+      }
+   }
+}
+
+void TupleTable::Number(int n)
+{
+   using namespace internal;
+
+   // Since the sort is stable, the first position of every group is the
+   // first occurrence of its tuple. Number the groups in the order of their
+   // first occurrences.
+   const int ngroups = offsets.Size() - 1;
+   Array<int> first(n);
+   MFEM_TT_OMP(omp parallel for)
+   for (int i = 0; i < n; i++) { first[i] = 0; }
+   MFEM_TT_OMP(omp parallel for)
+   for (int g = 0; g < ngroups; g++) { first[perm[offsets[g]]] = 1; }
+   ExclusiveScan(first, first, n);
+
+   group_num.SetSize(ngroups);
+   numbers.SetSize(n);
+   MFEM_TT_OMP(omp parallel for)
+   for (int g = 0; g < ngroups; g++)
+   {
+      const int num = first[perm[offsets[g]]];
+      group_num[g] = num;
+      for (int k = offsets[g]; k < offsets[g+1]; k++)
+      {
+         numbers[perm[k]] = num;
+      }
+   }
+}
+
+int TupleTable::Index(const int *t) const
+{
+   // binary search for the first group with a key not less than t
+   int lo = 0, hi = NumberOfEntries();
+   while (lo < hi)
+   {
+      const int mid = lo + (hi - lo)/2;
+      const int *key = keys.GetData() + mid*width;
+      int j = 0;
+      while (j < width && key[j] == t[j]) { j++; }
+      if (j < width && key[j] < t[j]) { lo = mid + 1; }
+      else { hi = mid; }
+   }
+   if (lo == NumberOfEntries()) { return -1; }
+   const int *key = keys.GetData() + lo*width;
+   for (int j = 0; j < width; j++)
+   {
+      if (key[j] != t[j]) { return -1; }
+   }
+   return group_num[lo];
+}
+
+} // namespace mfem
+
+#undef MFEM_TT_OMP
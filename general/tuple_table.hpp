@@ -0,0 +1,94 @@
+// Copyright (c) 2010-2020, Lawrence Livermore National Security, LLC. Produced
+// at the Lawrence Livermore National Laboratory. All Rights reserved. See files
+// LICENSE and NOTICE for details. LLNL-CODE-806117.
+//
+// This file is part of the MFEM library. For more information and source code
+// availability visit https://mfem.org.
+//
+// MFEM is free software; you can redistribute it and/or modify it under the
+// terms of the BSD-3 license. We welcome feedback and contributions, see file
+// CONTRIBUTING.md for details.
+
+#ifndef MFEM_TUPLE_TABLE
+#define MFEM_TUPLE_TABLE
+
+#include "../config/config.hpp"
+#include "array.hpp"
+
+namespace mfem
+{
+
+/** @brief Sort-based table of integer tuples, an alternative to DSTable and
+    STable3D for building the mesh topology in parallel.
+
+    The table is constructed at once from a list of n tuples of the same width
+    (1, 2 or 3), e.g. the sorted vertex indices of all edges or faces of all
+    elements. The positions of the tuples are sorted by a counting sort on the
+    first entry of the tuples (a radix pass with one bucket per value),
+    followed by a sort of each bucket by the remaining entries and the
+    positions, and the equal tuples are grouped. Every distinct tuple is
+    assigned a number; as in DSTable and STable3D, the numbers are assigned in
+    the order of the first occurrence of the tuples in the input list, so the
+    two approaches produce the same numbering.
+
+    The sort, the grouping and the numbering are multithreaded with OpenMP,
+    when MFEM_USE_OPENMP is enabled. */
+class TupleTable
+{
+protected:
+   int width;
+   Array<int> perm;       // input positions, sorted by (tuple, position)
+   Array<int> offsets;    // start of every group in perm
+   Array<int> group_num;  // number of every group
+   Array<int> numbers;    // number of every input tuple
+   Array<int> keys;       // the distinct tuples, sorted
+
+   void SortAndGroup(const int *tuples, int n, int max_val);
+   void Number(int n);
+
+public:
+   /// Create an empty table.
+   TupleTable() : width(0) { }
+
+   /** @brief Create the table from the @a n tuples of width @a width stored
+       contiguously in @a tuples, with entries in [0, @a max_val). */
+   TupleTable(const int *tuples, int n, int width, int max_val)
+   { Make(tuples, n, width, max_val); }
+
+   /// Replace the content of the table, see TupleTable(const int*, ...).
+   void Make(const int *tuples, int n, int width, int max_val);
+
+   /// Return the number of distinct tuples.
+   int NumberOfEntries() const { return group_num.Size(); }
+
+   /// Return the numbers assigned to all input tuples.
+   const Array<int> &GetNumbers() const { return numbers; }
+
+   /** @brief Return the number assigned to the tuple @a t, which must be sorted
+       in the same way as the input tuples, or -1 if it is not in the table. */
+   int Index(const int *t) const;
+
+   /** @name Groups of equal tuples
+
+       The groups are ordered by their tuples. The positions of the tuples of
+       group g in the input list are GetGroup(g)[0..GetGroupSize(g)-1], in
+       increasing order, and GetGroupTuple(g) is their common tuple. */
+   ///@{
+   int GetGroupSize(int g) const { return offsets[g+1] - offsets[g]; }
+   const int *GetGroup(int g) const { return perm.GetData() + offsets[g]; }
+   int GetGroupNumber(int g) const { return group_num[g]; }
+   const int *GetGroupTuple(int g) const { return keys.GetData() + g*width; }
+   ///@}
+
+   /// Return the number of bytes used by the table.
+   long MemoryUsage() const
+   {
+      return perm.MemoryUsage() + offsets.MemoryUsage() +
+             group_num.MemoryUsage() + numbers.MemoryUsage() +
+             keys.MemoryUsage();
+   }
+};
+
+} // namespace mfem
+
+#endif // MFEM_TUPLE_TABLE
@@ -10,6 +10,7 @@
 // CONTRIBUTING.md for details.
 
 #include "complex_operator.hpp"
+#include "../general/forall.hpp"
 #include <set>
 #include <map>
 
@@ -236,6 +237,69 @@ SparseMatrix * ComplexSparseMatrix::GetSystemMatrix() const
 }
 
 
+ComplexJacobiSmoother::ComplexJacobiSmoother(
+   const Vector &diag, const Array<int> &ess_tdof_list,
+   ComplexOperator::Convention conv, const double damping)
+   : Solver(diag.Size()),
+     N(diag.Size() / 2),
+     convention(conv),
+     dinv(diag.Size()),
+     residual(diag.Size()),
+     oper(NULL)
+{
+   residual.UseDevice(true);
+   const int n = N;
+   const double delta = damping;
+   auto D = diag.Read();
+   auto DI = dinv.Write();
+   MFEM_FORALL(i, n,
+   {
+      const double d_r = D[i], d_i = D[n + i];
+      const double s = delta / (d_r*d_r + d_i*d_i);
+      DI[i] = s * d_r;
+      DI[n + i] = s * d_i;
+   });
+   auto I = ess_tdof_list.Read();
+   MFEM_FORALL(i, ess_tdof_list.Size(),
+   {
+      DI[I[i]] = delta;
+      DI[n + I[i]] = 0.0;
+   });
+}
+
+void ComplexJacobiSmoother::Mult(const Vector &x, Vector &y) const
+{
+   MFEM_ASSERT(x.Size() == 2*N, "invalid input vector");
+   MFEM_ASSERT(y.Size() == 2*N, "invalid output vector");
+
+   if (iterative_mode && oper)
+   {
+      oper->Mult(y, residual);  // r = A x
+      subtract(x, residual, residual); // r = b - A x
+   }
+   else
+   {
+      residual = x;
+      y.UseDevice(true);
+      y = 0.0;
+   }
+   // With the inverse c_r + i c_i of the diagonal, the blocks are
+   // [c_r, c_i; -c_i, c_r] for HERMITIAN, and [c_r, -c_i; -c_i, -c_r] for
+   // BLOCK_SYMMETRIC, where the second block row of the operator is negated.
+   const int n = N;
+   const double sign = (convention == ComplexOperator::HERMITIAN) ? 1.0 : -1.0;
+   auto DI = dinv.Read();
+   auto R = residual.Read();
+   auto Y = y.ReadWrite();
+   MFEM_FORALL(i, n,
+   {
+      const double c_r = DI[i], c_i = DI[n + i];
+      const double r_r = R[i], r_i = R[n + i];
+      Y[i] += c_r * r_r + sign * c_i * r_i;
+      Y[n + i] += sign * c_r * r_i - c_i * r_r;
+   });
+}
+
 #ifdef MFEM_USE_SUITESPARSE
 
 void ComplexUMFPackSolver::Init()
@@ -174,6 +174,40 @@ public:
    virtual Type GetType() const { return MFEM_ComplexSparseMat; }
 };
 
+/** @brief Jacobi smoother for a ComplexOperator, given the real and imaginary
+    parts of its diagonal.
+
+    Each dof is smoothed with the inverse of the 2x2 block, coupling its real
+    and imaginary parts, of the diagonal d_r + i d_i in the block form of the
+    operator, see ComplexOperator::Convention. This is a complex division by
+    d_r + i d_i, which keeps the smoother effective when the imaginary part of
+    the diagonal is not small compared to its real part. It is assumed that
+    the operator acts as the identity on the essential dofs, as the operators
+    returned by SesquilinearForm::FormSystemMatrix() with the DIAG_ONE policy.
+    For tolerances, iteration control, etc. wrap with SLISolver. */
+class ComplexJacobiSmoother : public Solver
+{
+public:
+   /** The vector @a diag of size 2N holds the real parts of the diagonal
+       followed by its imaginary parts, as returned by
+       SesquilinearForm::AssembleDiagonal(). */
+   ComplexJacobiSmoother(const Vector &diag, const Array<int> &ess_tdof_list,
+                         ComplexOperator::Convention convention =
+                            ComplexOperator::HERMITIAN,
+                         const double damping = 1.0);
+
+   virtual void Mult(const Vector &x, Vector &y) const;
+   virtual void SetOperator(const Operator &op) { oper = &op; }
+
+private:
+   const int N;
+   const ComplexOperator::Convention convention;
+   /// Real and imaginary parts of the damped inverse of the diagonal
+   Vector dinv;
+   mutable Vector residual;
+   const Operator *oper;
+};
+
 #ifdef MFEM_USE_SUITESPARSE
 /** @brief Interface with UMFPack solver specialized for ComplexSparseMatrix
     This approach avoids forming a monolithic SparseMatrix which leads
@@ -3595,4 +3595,60 @@ void BatchLUSolve(const DenseTensor &Mlu, const Array<int> &P, Vector &X)
 
 }
 
+bool BatchCholeskyFactor(DenseTensor &Mc, const double TOL)
+{
+   const int m = Mc.SizeI();
+   const int NE = Mc.SizeK();
+
+   auto data_all = mfem::Reshape(Mc.ReadWrite(), m, m, NE);
+   Array<bool> pivot_flag(1);
+   pivot_flag[0] = true;
+   bool *d_pivot_flag = pivot_flag.ReadWrite();
+
+   MFEM_FORALL(e, NE,
+   {
+      for (int j = 0; j < m; j++)
+      {
+         double a_jj = data_all(j,j,e);
+         for (int k = 0; k < j; k++)
+         {
+            a_jj -= data_all(j,k,e) * data_all(j,k,e);
+         }
+         if (a_jj <= TOL)
+         {
+            d_pivot_flag[0] = false;
+            break;
+         }
+         const double l_jj = sqrt(a_jj);
+         data_all(j,j,e) = l_jj;
+
+         for (int i = j+1; i < m; i++)
+         {
+            double a_ij = data_all(i,j,e);
+            for (int k = 0; k < j; k++)
+            {
+               a_ij -= data_all(i,k,e) * data_all(j,k,e);
+            }
+            data_all(i,j,e) = a_ij / l_jj;
+         }
+      } // m loop
+   });
+
+   return pivot_flag.HostRead()[0];
+}
+
+void BatchCholeskySolve(const DenseTensor &Mc, Vector &X)
+{
+   const int m = Mc.SizeI();
+   const int NE = Mc.SizeK();
+
+   auto data_all = mfem::Reshape(Mc.Read(), m, m, NE);
+   auto x_all = mfem::Reshape(X.ReadWrite(), m, NE);
+
+   MFEM_FORALL(e, NE,
+   {
+      kernels::CholeskySolve(&data_all(0,0,e), m, &x_all(0,e));
+   });
+}
+
 } // namespace mfem
@@ -884,6 +884,32 @@ void BatchLUFactor(DenseTensor &Mlu, Array<int> &P, const double TOL = 0.0);
     dimension m x n. */
 void BatchLUSolve(const DenseTensor &Mlu, const Array<int> &P, Vector &X);
 
+/** @brief Compute the Cholesky factorization of a batch of symmetric positive
+    definite matrices
+
+    Factorize n matrices of size (m x m) stored in a dense tensor overwriting
+    their lower triangular parts with the Cholesky factors L, such that
+    L.L^t = A. The strictly upper triangular parts are not referenced.
+
+    @param [in, out] Mc batch of square matrices - dimension m x m x n.
+    @param [in] TOL optional tolerance for the pivots. Defaults to 0.0.
+
+    @return false if a pivot is not greater than TOL in any of the matrices,
+    i.e. if one of them is not (numerically) positive definite, true
+    otherwise. */
+bool BatchCholeskyFactor(DenseTensor &Mc, const double TOL = 0.0);
+
+/** @brief Solve batch linear systems
+
+    Assuming L.L^t = A for n factored matrices (m x m), compute x <- A^{-1} x,
+    for n companion vectors.
+
+    @param [in] Mc batch of Cholesky factors for matrix M - dimension
+    m x m x n.
+    @param [in, out] X vector storing right-hand side and then solution -
+    dimension m x n. */
+void BatchCholeskySolve(const DenseTensor &Mc, Vector &X);
+
 
 // Inline methods
 
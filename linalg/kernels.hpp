@@ -1415,6 +1415,37 @@ inline void LUSolve(const double *data, const int m, const int *ipiv,
    }
 }
 
+/// Assuming L.L^t = A for a factored matrix (m x m),
+//  compute x <- A^{-1} x
+//
+// @param [in] data Cholesky factor L of A, stored in the lower triangular part
+// @param [in] m square matrix height
+// @param [in, out] x vector storing right-hand side and then solution
+MFEM_HOST_DEVICE
+inline void CholeskySolve(const double *data, const int m, double *x)
+{
+   // X <- L^{-1} X
+   for (int j = 0; j < m; j++)
+   {
+      const double x_j = (x[j] /= data[j + j * m]);
+      for (int i = j + 1; i < m; i++)
+      {
+         x[i] -= data[i + j * m] * x_j;
+      }
+   }
+
+   // X <- L^{-t} X
+   for (int i = m - 1; i >= 0; i--)
+   {
+      double x_i = x[i];
+      for (int j = i + 1; j < m; j++)
+      {
+         x_i -= data[j + i * m] * x[j];
+      }
+      x[i] = x_i / data[i + i * m];
+   }
+}
+
 } // namespace kernels
 
 } // namespace mfem
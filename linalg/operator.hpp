@@ -826,6 +826,9 @@ public:
    void SetDiagonalPolicy(const DiagonalPolicy _diag_policy)
    { diag_policy = _diag_policy; }
 
+   /// Return the diagonal policy for the constrained operator.
+   DiagonalPolicy GetDiagonalPolicy() const { return diag_policy; }
+
    /** @brief Eliminate "essential boundary condition" values specified in @a x
        from the given right-hand side @a b.
 
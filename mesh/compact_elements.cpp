@@ -0,0 +1,87 @@
+// Copyright (c) 2010-2020, Lawrence Livermore National Security, LLC. Produced
+// at the Lawrence Livermore National Laboratory. All Rights reserved. See files
+// LICENSE and NOTICE for details. LLNL-CODE-806117.
+//
+// This file is part of the MFEM library. For more information and source code
+// availability visit https://mfem.org.
+//
+// MFEM is free software; you can redistribute it and/or modify it under the
+// terms of the BSD-3 license. We welcome feedback and contributions, see file
+// CONTRIBUTING.md for details.
+
+// Implementation of class CompactElementArray
+
+#include "compact_elements.hpp"
+
+namespace mfem
+{
+
+void CompactElementArray::MakeMixed()
+{
+   offsets.SetSize(size + 1);
+   geoms.SetSize(size);
+   for (int i = 0; i <= size; i++) { offsets[i] = i*stride; }
+   for (int i = 0; i < size; i++) { geoms[i] = (char) uniform_geom; }
+   stride = -1;
+   uniform_geom = Geometry::INVALID;
+}
+
+void CompactElementArray::MakeFrom(const Array<Element*> &elems, int n)
+{
+   Clear();
+   int nidx = 0;
+   for (int i = 0; i < n; i++) { nidx += elems[i]->GetNVertices(); }
+   Reserve(n, nidx);
+   for (int i = 0; i < n; i++)
+   {
+      const Element *el = elems[i];
+      Append(el->GetGeometryType(), el->GetVertices(), el->GetAttribute());
+   }
+}
+
+void CompactElementArray::Reserve(int n, int nidx)
+{
+   indices.Reserve(nidx);
+   attributes.Reserve(n);
+   if (!IsUniform())
+   {
+      offsets.Reserve(n + 1);
+      geoms.Reserve(n);
+   }
+}
+
+void CompactElementArray::Append(Geometry::Type geom, const int *v, int attr)
+{
+   const int nv = Geometry::NumVerts[geom];
+   if (size == 0 && IsUniform())
+   {
+      stride = nv;
+      uniform_geom = geom;
+   }
+   else if (IsUniform() && geom != uniform_geom)
+   {
+      MakeMixed();
+   }
+   if (!IsUniform())
+   {
+      if (offsets.Size() == 0) { offsets.Append(0); }
+      offsets.Append(offsets.Last() + nv);
+      geoms.Append((char) geom);
+   }
+   indices.Append(v, nv);
+   attributes.Append(attr);
+   size++;
+}
+
+void CompactElementArray::Clear()
+{
+   size = 0;
+   stride = 0;
+   uniform_geom = Geometry::INVALID;
+   offsets.DeleteAll();
+   indices.DeleteAll();
+   attributes.DeleteAll();
+   geoms.DeleteAll();
+}
+
+} // namespace mfem
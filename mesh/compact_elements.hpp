@@ -0,0 +1,159 @@
+// Copyright (c) 2010-2020, Lawrence Livermore National Security, LLC. Produced
+// at the Lawrence Livermore National Laboratory. All Rights reserved. See files
+// LICENSE and NOTICE for details. LLNL-CODE-806117.
+//
+// This file is part of the MFEM library. For more information and source code
+// availability visit https://mfem.org.
+//
+// MFEM is free software; you can redistribute it and/or modify it under the
+// terms of the BSD-3 license. We welcome feedback and contributions, see file
+// CONTRIBUTING.md for details.
+
+#ifndef MFEM_COMPACT_ELEMENTS
+#define MFEM_COMPACT_ELEMENTS
+
+#include "../config/config.hpp"
+#include "../general/array.hpp"
+#include "../fem/geom.hpp"
+#include "element.hpp"
+
+namespace mfem
+{
+
+/** @brief Compact storage of the vertex connectivity, attributes and geometry
+    types of a set of mesh entities (elements, boundary elements or faces).
+
+    In contrast to the Array<Element*> used by Mesh, where every entity is a
+    separately allocated polymorphic object, the entities are stored in flat
+    arrays: the vertex indices of all entities are contiguous, followed by an
+    array of attributes. If all entities have the same geometry, the vertex
+    indices are accessed with a fixed stride; otherwise (mixed meshes) the
+    offsets of the entities and their geometry types are stored as well, as in
+    a CSR matrix. The entities are accessed through lightweight View objects,
+    providing the read-only part of the Element interface.
+
+    The storage uses about 4*(nv+1) bytes per entity with nv vertices (plus 5
+    bytes for mixed meshes), compared to the object, the heap allocation and
+    the pointer of an Element. It can be obtained from a Mesh with
+    Mesh::GetCompactElements() and friends, and a Mesh can be constructed from
+    it, see Mesh::Mesh(double*, int, const CompactElementArray&, const
+    CompactElementArray&, int, int). */
+class CompactElementArray
+{
+public:
+   /// Read-only view of one entity of a CompactElementArray.
+   class View
+   {
+   private:
+      const int *v;
+      int nv, attr;
+      Geometry::Type geom;
+
+   public:
+      View(const int *v_, int nv_, int attr_, Geometry::Type geom_)
+         : v(v_), nv(nv_), attr(attr_), geom(geom_) { }
+
+      /// Return the geometry type of the entity.
+      Geometry::Type GetGeometryType() const { return geom; }
+
+      /// Return the attribute of the entity.
+      int GetAttribute() const { return attr; }
+
+      /// Return the number of vertices of the entity.
+      int GetNVertices() const { return nv; }
+
+      /// Return a pointer to the vertex indices of the entity.
+      const int *GetVertices() const { return v; }
+
+      /// Copy the vertex indices of the entity to @a verts.
+      void GetVertices(Array<int> &verts) const
+      { verts.SetSize(nv); verts.Assign(v); }
+   };
+
+protected:
+   int size;
+   int stride; // vertices per entity if uniform (0 if empty), -1 if mixed
+   Geometry::Type uniform_geom;
+   Array<int> offsets; // size+1 entries if mixed, empty if uniform
+   Array<int> indices;
+   Array<int> attributes;
+   Array<char> geoms; // size entries if mixed, empty if uniform
+
+   /// Convert the uniform storage to the mixed (CSR) storage.
+   void MakeMixed();
+
+public:
+   /// Create an empty array.
+   CompactElementArray() : size(0), stride(0),
+      uniform_geom(Geometry::INVALID) { }
+
+   /// Create an array with the first @a n entities of @a elems.
+   CompactElementArray(const Array<Element*> &elems, int n)
+      : CompactElementArray() { MakeFrom(elems, n); }
+
+   /// Replace the content of the array with the first @a n entities of @a elems
+   void MakeFrom(const Array<Element*> &elems, int n);
+
+   /** @brief Reserve the memory for @a n entities with a total of @a nidx
+       vertex indices. */
+   void Reserve(int n, int nidx);
+
+   /** @brief Append an entity with geometry @a geom, vertex indices @a v and
+       attribute @a attr. */
+   void Append(Geometry::Type geom, const int *v, int attr);
+
+   /// Remove all entities.
+   void Clear();
+
+   /// Return the number of entities.
+   int Size() const { return size; }
+
+   /// Return true if all entities have the same geometry type.
+   bool IsUniform() const { return stride >= 0; }
+
+   /// Return the view of entity @a i.
+   View operator[](int i) const
+   {
+      return View(GetVertices(i), GetNVertices(i), attributes[i],
+                  GetGeometryType(i));
+   }
+
+   /// Return the geometry type of entity @a i.
+   Geometry::Type GetGeometryType(int i) const
+   { return IsUniform() ? uniform_geom : Geometry::Type(geoms[i]); }
+
+   /// Return the number of vertices of entity @a i.
+   int GetNVertices(int i) const
+   { return IsUniform() ? stride : offsets[i+1] - offsets[i]; }
+
+   /// Return a pointer to the vertex indices of entity @a i.
+   const int *GetVertices(int i) const
+   { return indices.GetData() + (IsUniform() ? i*stride : offsets[i]); }
+
+   /// Return the attribute of entity @a i.
+   int GetAttribute(int i) const { return attributes[i]; }
+
+   /// Set the attribute of entity @a i.
+   void SetAttribute(int i, int attr) { attributes[i] = attr; }
+
+   /// Return the vertex indices of all entities.
+   const Array<int> &GetIndices() const { return indices; }
+
+   /// Return the attributes of all entities.
+   const Array<int> &GetAttributes() const { return attributes; }
+
+   /** @brief Return the offsets of the entities in GetIndices(). The array is
+       empty if IsUniform() is true. */
+   const Array<int> &GetOffsets() const { return offsets; }
+
+   /// Return the number of bytes used by the array.
+   long MemoryUsage() const
+   {
+      return offsets.MemoryUsage() + indices.MemoryUsage() +
+             attributes.MemoryUsage() + geoms.MemoryUsage();
+   }
+};
+
+} // namespace mfem
+
+#endif // MFEM_COMPACT_ELEMENTS
@@ -27,4 +27,19 @@ void Element::SetVertices(const int *ind)
    }
 }
 
+long Element::MemoryUsage() const
+{
+   switch (GetType())
+   {
+      case POINT:         return sizeof(Point);
+      case SEGMENT:       return sizeof(Segment);
+      case TRIANGLE:      return sizeof(Triangle);
+      case QUADRILATERAL: return sizeof(Quadrilateral);
+      case TETRAHEDRON:   return sizeof(Tetrahedron);
+      case HEXAHEDRON:    return sizeof(Hexahedron);
+      case WEDGE:         return sizeof(Wedge);
+   }
+   return sizeof(Element);
+}
+
 }
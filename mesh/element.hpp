@@ -100,6 +100,10 @@ public:
 
    virtual Element *Duplicate(Mesh *m) const = 0;
 
+   /** @brief Return the number of bytes used by the element object (not
+       counting the overhead of its heap allocation). */
+   long MemoryUsage() const;
+
    /// Destroys element.
    virtual ~Element() { }
 };
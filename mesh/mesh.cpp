@@ -30,6 +30,13 @@
 #include <ctime>
 #include <functional>
 
+#ifdef MFEM_USE_OPENMP
+#include <omp.h>
+#define MFEM_MESH_OMP(X) _Pragma(#X)
+#else
+#define MFEM_MESH_OMP(X)
+#endif
+
 // Include the METIS header, if using version 5. If using METIS 4, the needed
 // declarations are inlined below, i.e. no header is needed.
 #if defined(MFEM_USE_METIS) && defined(MFEM_USE_METIS_5)
@@ -55,6 +62,12 @@ using namespace std;
 namespace mfem
 {
 
+#ifdef MFEM_USE_OPENMP
+bool Mesh::sorted_topology = true;
+#else
+bool Mesh::sorted_topology = false;
+#endif
+
 void Mesh::GetElementJacobian(int i, DenseMatrix &J)
 {
    Geometry::Type geom = GetElementBaseGeometry(i);
@@ -313,6 +326,65 @@ void Mesh::PrintCharacteristics(Vector *Vh, Vector *Vk, std::ostream &out)
    out << '\n' << std::flush;
 }
 
+// Return the number of bytes used by the first n Element objects in elems and
+// by the array of pointers.
+static long ElementsMemoryUsage(const Array<Element*> &elems, int n)
+{
+   long mem = elems.MemoryUsage();
+   for (int i = 0; i < n; i++)
+   {
+      if (elems[i]) { mem += elems[i]->MemoryUsage(); }
+   }
+   return mem;
+}
+
+static long TableMemoryUsage(const Table *table)
+{
+   return table ? table->MemoryUsage() : 0;
+}
+
+long Mesh::MemoryUsage() const
+{
+   return (ElementsMemoryUsage(elements, NumOfElements) +
+           ElementsMemoryUsage(boundary, NumOfBdrElements) +
+           ElementsMemoryUsage(faces, faces.Size()) +
+           vertices.MemoryUsage() +
+           faces_info.MemoryUsage() +
+           nc_faces_info.MemoryUsage() +
+           TableMemoryUsage(el_to_edge) +
+           TableMemoryUsage(el_to_face) +
+           TableMemoryUsage(el_to_el) +
+           be_to_edge.MemoryUsage() +
+           TableMemoryUsage(bel_to_edge) +
+           be_to_face.MemoryUsage() +
+           TableMemoryUsage(face_edge) +
+           TableMemoryUsage(edge_vertex) +
+           attributes.MemoryUsage() +
+           bdr_attributes.MemoryUsage() +
+           (ncmesh ? ncmesh->MemoryUsage() : 0) +
+           sizeof(*this));
+}
+
+void Mesh::PrintMemoryDetail(std::ostream &out) const
+{
+   out << ElementsMemoryUsage(elements, NumOfElements) << " elements\n"
+       << ElementsMemoryUsage(boundary, NumOfBdrElements) << " boundary\n"
+       << ElementsMemoryUsage(faces, faces.Size()) << " faces\n"
+       << vertices.MemoryUsage() << " vertices\n"
+       << faces_info.MemoryUsage() << " faces_info\n"
+       << nc_faces_info.MemoryUsage() << " nc_faces_info\n"
+       << TableMemoryUsage(el_to_edge) << " el_to_edge\n"
+       << TableMemoryUsage(el_to_face) << " el_to_face\n"
+       << TableMemoryUsage(el_to_el) << " el_to_el\n"
+       << be_to_edge.MemoryUsage() << " be_to_edge\n"
+       << TableMemoryUsage(bel_to_edge) << " bel_to_edge\n"
+       << be_to_face.MemoryUsage() << " be_to_face\n"
+       << TableMemoryUsage(face_edge) << " face_edge\n"
+       << TableMemoryUsage(edge_vertex) << " edge_vertex\n"
+       << (ncmesh ? ncmesh->MemoryUsage() : 0) << " ncmesh\n"
+       << sizeof(*this) << " Mesh" << std::endl;
+}
+
 FiniteElement *Mesh::GetTransformationFEforElementType(Element::Type ElemType)
 {
    switch (ElemType)
@@ -1063,6 +1135,7 @@ void Mesh::Init()
    nbBoundaryFaces = -1;
    meshgen = mesh_geoms = 0;
    sequence = 0;
+   locality_ordering = LocalityOrdering::NONE;
    Nodes = NULL;
    own_nodes = 1;
    NURBSext = NULL;
@@ -1693,6 +1766,246 @@ void Mesh::GetHilbertElementOrdering(Array<int> &ordering)
    }
 }
 
+// Integer coordinates in [0, 2^bits) of the point x in the box [min, max].
+static void SFCCoordinates(int dim, int bits, const double *x,
+                           const double *min, const double *max,
+                           unsigned long long *X)
+{
+   typedef unsigned long long ull;
+   for (int d = 0; d < dim; d++)
+   {
+      const double len = max[d] - min[d];
+      double t = (len > 0.0) ? (x[d] - min[d]) / len : 0.0;
+      t = std::min(std::max(t, 0.0), 1.0);
+      X[d] = std::min(ull(t * double(ull(1) << bits)),
+                      (ull(1) << bits) - 1);
+   }
+}
+
+// Interleave the bits of the coordinates X, the most significant first.
+static unsigned long long InterleaveBits(int dim, int bits,
+                                         const unsigned long long *X)
+{
+   unsigned long long index = 0;
+   for (int b = bits - 1; b >= 0; b--)
+   {
+      for (int d = 0; d < dim; d++)
+      {
+         index = (index << 1) | ((X[d] >> b) & 1);
+      }
+   }
+   return index;
+}
+
+unsigned long long Mesh::HilbertIndex(int dim, const double *x,
+                                      const double *min, const double *max)
+{
+   MFEM_ASSERT(1 <= dim && dim <= 3, "invalid dimension: " << dim);
+
+   typedef unsigned long long ull;
+   const int bits = 63 / dim;
+   const ull top = ull(1) << (bits - 1);
+
+   ull X[3];
+   SFCCoordinates(dim, bits, x, min, max, X);
+   if (dim == 1) { return X[0]; }
+
+   // Transform the coordinates into the "transposed" Hilbert index, see
+   // J. Skilling, "Programming the Hilbert curve", AIP Conf. Proc. 707, 2004.
+   for (ull q = top; q > 1; q >>= 1)
+   {
+      const ull p = q - 1;
+      for (int d = 0; d < dim; d++)
+      {
+         if (X[d] & q) { X[0] ^= p; }
+         else
+         {
+            const ull t = (X[0] ^ X[d]) & p;
+            X[0] ^= t;
+            X[d] ^= t;
+         }
+      }
+   }
+   for (int d = 1; d < dim; d++) { X[d] ^= X[d-1]; }
+   ull t = 0;
+   for (ull q = top; q > 1; q >>= 1)
+   {
+      if (X[dim-1] & q) { t ^= q - 1; }
+   }
+   for (int d = 0; d < dim; d++) { X[d] ^= t; }
+
+   return InterleaveBits(dim, bits, X);
+}
+
+unsigned long long Mesh::MortonIndex(int dim, const double *x,
+                                     const double *min, const double *max)
+{
+   MFEM_ASSERT(1 <= dim && dim <= 3, "invalid dimension: " << dim);
+
+   const int bits = 63 / dim;
+   unsigned long long X[3];
+   SFCCoordinates(dim, bits, x, min, max, X);
+   return InterleaveBits(dim, bits, X);
+}
+
+// Breadth-first search of the graph from root over the nodes i with
+// mark[i] < 0. The visited nodes are appended to queue and their mark is set
+// to their distance from root. If sort is true, the neighbors of every node
+// are visited in the order of increasing degree, as in Cuthill-McKee.
+static void BreadthFirstSearch(const Table &graph, int root, Array<int> &mark,
+                               Array<int> &queue, bool sort)
+{
+   Array<int> nbr;
+   int head = queue.Size();
+   queue.Append(root);
+   mark[root] = 0;
+   for ( ; head < queue.Size(); head++)
+   {
+      const int i = queue[head];
+      const int *row = graph.GetRow(i);
+      nbr.SetSize(0);
+      for (int k = 0; k < graph.RowSize(i); k++)
+      {
+         const int j = row[k];
+         if (mark[j] < 0)
+         {
+            mark[j] = mark[i] + 1;
+            nbr.Append(j);
+         }
+      }
+      if (sort)
+      {
+         nbr.Sort([&](int a, int b)
+         {
+            const int da = graph.RowSize(a), db = graph.RowSize(b);
+            return (da != db) ? (da < db) : (a < b);
+         });
+      }
+      queue.Append(nbr);
+   }
+}
+
+void Mesh::GetRCMElementOrdering(Array<int> &ordering)
+{
+   const Table &el_el = ElementToElementTable();
+   const int ne = GetNE();
+
+   Array<int> mark(ne), level, cm_order;
+   mark = -1;
+   cm_order.Reserve(ne);
+   for (int start = 0; start < ne; start++)
+   {
+      if (mark[start] >= 0) { continue; }
+
+      // Find a pseudo-peripheral element of the component of 'start': restart
+      // the search from an element of minimum degree in the last level, as
+      // long as the number of levels increases.
+      int root = start, depth = -1;
+      while (true)
+      {
+         level.SetSize(0);
+         BreadthFirstSearch(el_el, root, mark, level, false);
+         const int last = mark[level.Last()];
+         int next = root;
+         for (int k = level.Size()-1; k >= 0 && mark[level[k]] == last; k--)
+         {
+            if (next == root ||
+                el_el.RowSize(level[k]) < el_el.RowSize(next))
+            {
+               next = level[k];
+            }
+         }
+         for (int k = 0; k < level.Size(); k++) { mark[level[k]] = -1; }
+         if (last <= depth) { break; }
+         depth = last;
+         root = next;
+      }
+
+      BreadthFirstSearch(el_el, root, mark, cm_order, true);
+   }
+
+   // reverse the Cuthill-McKee sequence
+   ordering.SetSize(ne);
+   for (int k = 0; k < ne; k++)
+   {
+      ordering[cm_order[k]] = ne-1-k;
+   }
+}
+
+void Mesh::ReorderForLocality(LocalityOrdering::Type type)
+{
+   if (NURBSext || ncmesh)
+   {
+      MFEM_WARNING("locality reordering of NURBS and non-conforming meshes is"
+                   " not supported.");
+      return;
+   }
+#ifdef MFEM_USE_MPI
+   MFEM_VERIFY(dynamic_cast<ParMesh*>(this) == NULL,
+               "locality reordering of parallel meshes is not supported");
+#endif
+
+   Array<int> ordering;
+   switch (type)
+   {
+      case LocalityOrdering::NONE:
+         return;
+      case LocalityOrdering::HILBERT:
+         GetHilbertElementOrdering(ordering);
+         break;
+      case LocalityOrdering::GECKO:
+         GetGeckoElementOrdering(ordering);
+         break;
+      case LocalityOrdering::RCM:
+         GetRCMElementOrdering(ordering);
+         break;
+      default:
+         MFEM_ABORT("invalid locality ordering: " << type);
+   }
+
+   // Record the original indices of the elements and the vertices. The new
+   // vertex numbering is the one computed by ReorderElements(): the vertices
+   // are numbered in the order in which they are used by the new elements.
+   if (orig_element.Size() == 0)
+   {
+      orig_element.SetSize(GetNE());
+      for (int i = 0; i < GetNE(); i++) { orig_element[i] = i; }
+      orig_vertex.SetSize(GetNV());
+      for (int i = 0; i < GetNV(); i++) { orig_vertex[i] = i; }
+   }
+   MFEM_VERIFY(orig_element.Size() == GetNE() && orig_vertex.Size() == GetNV(),
+               "the mesh was modified after the previous reordering");
+
+   Array<int> old_elem(GetNE()), new_orig_element(GetNE());
+   for (int i = 0; i < GetNE(); i++)
+   {
+      old_elem[ordering[i]] = i;
+      new_orig_element[ordering[i]] = orig_element[i];
+   }
+   Array<int> vert_used(GetNV()), new_orig_vertex(GetNV());
+   vert_used = 0;
+   new_orig_vertex = -1;
+   for (int i = 0, nv = 0; i < GetNE(); i++)
+   {
+      const Element *el = elements[old_elem[i]];
+      const int *v = el->GetVertices();
+      for (int j = 0; j < el->GetNVertices(); j++)
+      {
+         if (!vert_used[v[j]])
+         {
+            vert_used[v[j]] = 1;
+            new_orig_vertex[nv++] = orig_vertex[v[j]];
+         }
+      }
+   }
+   mfem::Swap(orig_element, new_orig_element);
+   mfem::Swap(orig_vertex, new_orig_vertex);
+
+   // Set the ordering first, so that the nodal space is updated with the
+   // locality dof numbering.
+   locality_ordering = type;
+   ReorderElements(ordering, true);
+}
 
 void Mesh::ReorderElements(const Array<int> &ordering, bool reorder_vertices)
 {
@@ -1995,6 +2308,8 @@ void Mesh::PrepareNodeReorder(DSTable **old_v_to_v, Table **old_elem_vert)
 void Mesh::DoNodeReorder(DSTable *old_v_to_v, Table *old_elem_vert)
 {
    FiniteElementSpace *fes = Nodes->FESpace();
+   MFEM_VERIFY(fes->GetDofPermutation().Size() == 0,
+               "node reordering of locality-ordered nodes is not supported");
    const FiniteElementCollection *fec = fes->FEColl();
    Array<int> old_dofs, new_dofs;
 
@@ -2458,7 +2773,11 @@ void Mesh::Finalize(bool refine, bool fix_orientation)
       }
       else
       {
-         FinalizeTopology(); // Re-computes some data unnecessarily.
+         // Re-computes some data unnecessarily. Missing boundary elements
+         // are not generated here: they were generated (if requested) when
+         // the topology was first finalized, and a parallel mesh may have no
+         // boundary elements on some ranks.
+         FinalizeTopology(false);
       }
 
       // TODO: maybe introduce Mesh::NODE_REORDER operation and FESpace::
@@ -3018,6 +3337,12 @@ Mesh::Mesh(const Mesh &mesh, bool copy_nodes)
    mesh.attributes.Copy(attributes);
    mesh.bdr_attributes.Copy(bdr_attributes);
 
+   // Copy the locality ordering data; it determines the dof numbering of the
+   // nodal FiniteElementSpace copied below.
+   locality_ordering = mesh.locality_ordering;
+   mesh.orig_element.Copy(orig_element);
+   mesh.orig_vertex.Copy(orig_vertex);
+
    // Deep copy the NURBSExtension.
 #ifdef MFEM_USE_MPI
    ParNURBSExtension *pNURBSext =
@@ -3157,6 +3482,42 @@ Mesh::Mesh(double *_vertices, int num_vertices,
    FinalizeTopology();
 }
 
+Mesh::Mesh(double *_vertices, int num_vertices,
+           const CompactElementArray &elems,
+           const CompactElementArray &bdr_elems,
+           int dimension, int space_dimension)
+{
+   if (space_dimension == -1)
+   {
+      space_dimension = dimension;
+   }
+
+   InitMesh(dimension, space_dimension, /*num_vertices*/ 0, elems.Size(),
+            bdr_elems.Size());
+
+   // assuming Vertex is POD
+   vertices.MakeRef(reinterpret_cast<Vertex*>(_vertices), num_vertices);
+   NumOfVertices = num_vertices;
+
+   for (int i = 0; i < elems.Size(); i++)
+   {
+      elements[i] = NewElement(elems.GetGeometryType(i));
+      elements[i]->SetVertices(elems.GetVertices(i));
+      elements[i]->SetAttribute(elems.GetAttribute(i));
+   }
+   NumOfElements = elems.Size();
+
+   for (int i = 0; i < bdr_elems.Size(); i++)
+   {
+      boundary[i] = NewElement(bdr_elems.GetGeometryType(i));
+      boundary[i]->SetVertices(bdr_elems.GetVertices(i));
+      boundary[i]->SetAttribute(bdr_elems.GetAttribute(i));
+   }
+   NumOfBdrElements = bdr_elems.Size();
+
+   FinalizeTopology();
+}
+
 Element *Mesh::NewElement(int geom)
 {
    switch (geom)
@@ -3331,6 +3692,11 @@ void Mesh::Loader(std::istream &input, int generate_edges,
    {
       ReadVTKMesh(input, curved, read_gf, finalize_topo);
    }
+   else if (mesh_type.compare(0, 5, "<?xml") == 0 ||
+            mesh_type.compare(0, 8, "<VTKFile") == 0) // VTK XML (.vtu)
+   {
+      ReadXML_VTKMesh(input, curved, read_gf, finalize_topo, mesh_type);
+   }
    else if (mesh_type == "MFEM NURBS mesh v1.0")
    {
       ReadNURBSMesh(input, curved, read_gf);
@@ -4997,6 +5363,12 @@ int Mesh::GetElementToEdgeTable(Table & e_to_f, Array<int> &be_to_f)
 {
    int i, NumberOfEdges;
 
+   // the edge numbering given by edge_vertex is kept by the hash table
+   if (sorted_topology && !edge_vertex)
+   {
+      return GetElementToEdgeTableSorted(e_to_f, be_to_f);
+   }
+
    DSTable v_to_v(NumOfVertices);
    GetVertexToVertexTable(v_to_v);
 
@@ -5032,6 +5404,127 @@ int Mesh::GetElementToEdgeTable(Table & e_to_f, Array<int> &be_to_f)
    return NumberOfEdges;
 }
 
+// Write to key the sorted vertex indices v of an edge (nv = 2) or a face (nv =
+// 3 or 4), as used by DSTable and STable3D: for quadrilateral faces, the
+// largest index is dropped and the remaining three indices are sorted.
+static inline void GetTopologyKey(const int *v, int nv, int *key)
+{
+   if (nv == 2)
+   {
+      key[0] = std::min(v[0], v[1]);
+      key[1] = std::max(v[0], v[1]);
+      return;
+   }
+   int k[4] = { v[0], v[1], v[2], (nv == 4) ? v[3] : -1 };
+   if (nv == 4)
+   {
+      int m = 0;
+      for (int j = 1; j < 4; j++) { if (k[j] > k[m]) { m = j; } }
+      k[m] = k[3];
+   }
+   if (k[0] > k[1]) { std::swap(k[0], k[1]); }
+   if (k[1] > k[2]) { std::swap(k[1], k[2]); }
+   if (k[0] > k[1]) { std::swap(k[0], k[1]); }
+   for (int j = 0; j < 3; j++) { key[j] = k[j]; }
+}
+
+// Return in fv the vertex indices of the local edge (dim = 2) or face (dim =
+// 3) lf of the element el, and return their number.
+static inline int GetLocalFaceVertices(const Element *el, int dim, int lf,
+                                       int *fv)
+{
+   const int *v = el->GetVertices();
+   const int nfv = (dim == 2) ? 2 : el->GetNFaceVertices(lf);
+   const int *lv = (dim == 2) ? el->GetEdgeVertices(lf) :
+                   el->GetFaceVertices(lf);
+   for (int j = 0; j < nfv; j++) { fv[j] = v[lv[j]]; }
+   return nfv;
+}
+
+// Create the rows of the table el_to_ent, one for each of the first n entries
+// of elems, with as many entries as the edges (edges = true) or the faces of
+// the element, and return the keys (see GetTopologyKey) of all edges/faces in
+// the order of the table entries. The columns of the table are not set.
+static void GetTopologyKeys(const Array<Element*> &elems, int n, bool edges,
+                            Table &el_to_ent, Array<int> &keys)
+{
+   const int width = edges ? 2 : 3;
+   Array<int> I(n+1);
+   I[0] = 0;
+   for (int i = 0; i < n; i++)
+   {
+      I[i+1] = I[i] + (edges ? elems[i]->GetNEdges() : elems[i]->GetNFaces());
+   }
+   el_to_ent.SetDims(n, I[n]);
+   std::copy(I.begin(), I.end(), el_to_ent.GetI());
+
+   keys.SetSize(width*I[n]);
+#ifdef MFEM_USE_OPENMP
+   #pragma omp parallel for
+#endif
+   for (int i = 0; i < n; i++)
+   {
+      const int *v = elems[i]->GetVertices();
+      for (int j = 0; j < I[i+1] - I[i]; j++)
+      {
+         int *key = keys.GetData() + width*(I[i] + j);
+         if (edges)
+         {
+            const int *e = elems[i]->GetEdgeVertices(j);
+            const int ev[2] = { v[e[0]], v[e[1]] };
+            GetTopologyKey(ev, 2, key);
+         }
+         else
+         {
+            int fv[4];
+            GetTopologyKey(fv, GetLocalFaceVertices(elems[i], 3, j, fv), key);
+         }
+      }
+   }
+}
+
+int Mesh::GetElementToEdgeTableSorted(Table &e_to_f, Array<int> &be_to_f)
+{
+   MFEM_VERIFY(Dim == 2 || Dim == 3,
+               "1D GetElementToEdgeTable is not yet implemented.");
+
+   Array<int> keys;
+   GetTopologyKeys(elements, NumOfElements, true, e_to_f, keys);
+   const TupleTable edge_tbl(keys, keys.Size()/2, 2, NumOfVertices);
+   const Array<int> &num = edge_tbl.GetNumbers();
+   std::copy(num.begin(), num.end(), e_to_f.GetJ());
+
+   if (Dim == 2)
+   {
+      be_to_f.SetSize(NumOfBdrElements);
+#ifdef MFEM_USE_OPENMP
+      #pragma omp parallel for
+#endif
+      for (int i = 0; i < NumOfBdrElements; i++)
+      {
+         int key[2];
+         GetTopologyKey(boundary[i]->GetVertices(), 2, key);
+         be_to_f[i] = edge_tbl.Index(key);
+      }
+   }
+   else
+   {
+      if (bel_to_edge == NULL)
+      {
+         bel_to_edge = new Table;
+      }
+      GetTopologyKeys(boundary, NumOfBdrElements, true, *bel_to_edge, keys);
+      int *J = bel_to_edge->GetJ();
+      const int nbe = keys.Size()/2;
+#ifdef MFEM_USE_OPENMP
+      #pragma omp parallel for
+#endif
+      for (int k = 0; k < nbe; k++) { J[k] = edge_tbl.Index(&keys[2*k]); }
+   }
+
+   return edge_tbl.NumberOfEntries();
+}
+
 const Table & Mesh::ElementToElementTable()
 {
    if (el_to_el)
@@ -5185,6 +5678,8 @@ void Mesh::AddQuadFaceElement(int lf, int gf, int el,
 
 void Mesh::GenerateFaces()
 {
+   if (sorted_topology && Dim > 1) { GenerateFacesSorted(); return; }
+
    int i, nfaces = GetNumFaces();
 
    for (i = 0; i < faces.Size(); i++)
@@ -5268,6 +5763,89 @@ void Mesh::GenerateFaces()
    }
 }
 
+void Mesh::GenerateFacesSorted()
+{
+   const int nfaces = GetNumFaces();
+
+   for (int i = 0; i < faces.Size(); i++)
+   {
+      FreeElement(faces[i]);
+   }
+   faces.SetSize(nfaces);
+   faces_info.SetSize(nfaces);
+#ifdef MFEM_USE_OPENMP
+   #pragma omp parallel for
+#endif
+   for (int i = 0; i < nfaces; i++)
+   {
+      faces[i] = NULL;
+      faces_info[i].Elem1No = -1;
+      faces_info[i].NCFace = -1;
+   }
+
+   // group the entries of the element-to-face table by face
+   const Table &el_to_ent = (Dim == 2) ? *el_to_edge : *el_to_face;
+   const int *I = el_to_ent.GetI();
+   const int nent = I[NumOfElements];
+   Array<int> ent_el(nent);
+#ifdef MFEM_USE_OPENMP
+   #pragma omp parallel for
+#endif
+   for (int i = 0; i < NumOfElements; i++)
+   {
+      for (int k = I[i]; k < I[i+1]; k++) { ent_el[k] = i; }
+   }
+   const TupleTable face_groups(el_to_ent.GetJ(), nent, 1, nfaces);
+
+   // As in GenerateFaces(), the face is created from the first element that
+   // contains it, and its second element is the last one.
+#ifdef MFEM_USE_OPENMP
+   #pragma omp parallel for
+#endif
+   for (int g = 0; g < face_groups.NumberOfEntries(); g++)
+   {
+      const int gf = face_groups.GetGroupTuple(g)[0];
+      const int *group = face_groups.GetGroup(g);
+      const int size = face_groups.GetGroupSize(g);
+      FaceInfo &fi = faces_info[gf];
+      int fv[4];
+
+      int el = ent_el[group[0]], lf = group[0] - I[el];
+      const int nfv = GetLocalFaceVertices(elements[el], Dim, lf, fv);
+      switch (nfv)
+      {
+         case 2: faces[gf] = new Segment(fv[0], fv[1]); break;
+         case 3: faces[gf] = new Triangle(fv[0], fv[1], fv[2]); break;
+         case 4: faces[gf] = new Quadrilateral(fv); break;
+         default: MFEM_ABORT("Unexpected type of Element.");
+      }
+      fi.Elem1No  = el;
+      fi.Elem1Inf = 64 * lf; // face lf with orientation 0
+      fi.Elem2No  = -1; // in case there's no other side
+      fi.Elem2Inf = -1; // face is not shared
+      if (size == 1) { continue; }
+
+      el = ent_el[group[size-1]];
+      lf = group[size-1] - I[el];
+      GetLocalFaceVertices(elements[el], Dim, lf, fv);
+      const int *v = faces[gf]->GetVertices();
+      int orientation = 0;
+      if (nfv == 2)
+      {
+         // see AddSegmentFaceElement()
+         if (v[1] == fv[0] && v[0] == fv[1]) { orientation = 1; }
+         else if (v[0] != fv[0] || v[1] != fv[1])
+         {
+            MFEM_ABORT("internal error");
+         }
+      }
+      else if (nfv == 3) { orientation = GetTriOrientation(v, fv); }
+      else { orientation = GetQuadOrientation(v, fv); }
+      fi.Elem2No  = el;
+      fi.Elem2Inf = 64 * lf + orientation;
+   }
+}
+
 void Mesh::GenerateNCFaceInfo()
 {
    MFEM_VERIFY(ncmesh, "missing NCMesh.");
@@ -5378,6 +5956,12 @@ STable3D *Mesh::GetElementToFaceTable(int ret_ftbl)
    int i, *v;
    STable3D *faces_tbl;
 
+   if (sorted_topology && !ret_ftbl)
+   {
+      GetElementToFaceTableSorted();
+      return NULL;
+   }
+
    if (el_to_face != NULL)
    {
       delete el_to_face;
@@ -5462,6 +6046,39 @@ STable3D *Mesh::GetElementToFaceTable(int ret_ftbl)
    return NULL;
 }
 
+void Mesh::GetElementToFaceTableSorted()
+{
+   delete el_to_face;
+   el_to_face = new Table;
+
+   Array<int> keys;
+   GetTopologyKeys(elements, NumOfElements, false, *el_to_face, keys);
+   const TupleTable face_tbl(keys, keys.Size()/3, 3, NumOfVertices);
+   const Array<int> &num = face_tbl.GetNumbers();
+   std::copy(num.begin(), num.end(), el_to_face->GetJ());
+   NumOfFaces = face_tbl.NumberOfEntries();
+
+   be_to_face.SetSize(NumOfBdrElements);
+   int missing = 0;
+#ifdef MFEM_USE_OPENMP
+   #pragma omp parallel for reduction(+:missing)
+#endif
+   for (int i = 0; i < NumOfBdrElements; i++)
+   {
+      const Element *be = boundary[i];
+      const Element::Type type = be->GetType();
+      MFEM_VERIFY(type == Element::TRIANGLE ||
+                  type == Element::QUADRILATERAL,
+                  "Unexpected type of boundary Element.");
+      int key[3];
+      GetTopologyKey(be->GetVertices(), be->GetNVertices(), key);
+      be_to_face[i] = face_tbl.Index(key);
+      if (be_to_face[i] < 0) { missing++; }
+   }
+   MFEM_VERIFY(missing == 0, missing << " boundary elements are not faces of "
+               "the mesh");
+}
+
 // shift cyclically 3 integers so that the smallest is first
 static inline
 void Rotate3(int &a, int &b, int &c)
@@ -5589,6 +6206,11 @@ int *Mesh::CartesianPartitioning(int nxyz[])
 
 int *Mesh::GeneratePartitioning(int nparts, int part_method)
 {
+   if (part_method == 6 || part_method == 7)
+   {
+      return GenerateSFCPartitioning(nparts, NULL, part_method == 6);
+   }
+
 #ifdef MFEM_USE_METIS
 
    int print_messages = 1;
@@ -6037,6 +6659,308 @@ void Mesh::CheckPartitioning(int *partitioning)
    el_to_el = NULL;
 }
 
+// Sort the indices 0..n-1 of the keys by (key, index). The threads sort
+// contiguous chunks of the indices, which are then merged pairwise.
+static void SortByKeys(const Array<unsigned long long> &keys,
+                       Array<int> &order)
+{
+   const int n = keys.Size();
+   order.SetSize(n);
+   for (int i = 0; i < n; i++) { order[i] = i; }
+   auto less = [&](int a, int b)
+   { return keys[a] < keys[b] || (keys[a] == keys[b] && a < b); };
+
+#ifdef MFEM_USE_OPENMP
+   const int nchunks = omp_get_max_threads();
+#else
+   const int nchunks = 1;
+#endif
+   Array<int> bounds(nchunks+1);
+   for (int c = 0; c <= nchunks; c++) { bounds[c] = (int)((long)n*c/nchunks); }
+
+   int *o = order.GetData();
+   MFEM_MESH_OMP(omp parallel for)
+   for (int c = 0; c < nchunks; c++)
+   {
+      std::sort(o + bounds[c], o + bounds[c+1], less);
+   }
+   for (int width = 1; width < nchunks; width *= 2)
+   {
+      MFEM_MESH_OMP(omp parallel for)
+      for (int c = 0; c < nchunks - width; c += 2*width)
+      {
+         const int end = std::min(c + 2*width, nchunks);
+         std::inplace_merge(o + bounds[c], o + bounds[c+width], o + bounds[end],
+                            less);
+      }
+   }
+}
+
+// Move the small connected components of the parts of the partitioning to the
+// lightest of their neighboring parts. The largest (by weight) component of
+// every part stays in it, so no part becomes empty, and the components heavier
+// than a quarter of the average part weight are kept as well, as moving them
+// would increase the imbalance too much.
+static void MergeDisconnectedParts(Table &elem_elem, Array<int> &partitioning,
+                                   const double *weights)
+{
+   const int n = partitioning.Size();
+   Array<int> component, num_comp, comp_offset, main_comp, target;
+   Array<double> comp_weight, part_weight;
+   Array<Pair<int,int> > comp_nbr;
+
+   // a few passes, as a moved component may be disconnected in its new part
+   for (int pass = 0; pass < 3; pass++)
+   {
+      FindPartitioningComponents(elem_elem, partitioning, component, num_comp);
+      const int nparts = num_comp.Size();
+      comp_offset.SetSize(nparts+1);
+      comp_offset[0] = 0;
+      for (int p = 0; p < nparts; p++)
+      {
+         comp_offset[p+1] = comp_offset[p] + num_comp[p];
+      }
+      if (comp_offset[nparts] == nparts) { break; }
+
+      // the global index of the component of element i is
+      // comp_offset[partitioning[i]] + component[i]
+      comp_weight.SetSize(comp_offset[nparts]);
+      comp_weight = 0.0;
+      for (int i = 0; i < n; i++)
+      {
+         comp_weight[comp_offset[partitioning[i]] + component[i]] +=
+            weights ? weights[i] : 1.0;
+      }
+      double total = 0.0;
+      for (int c = 0; c < comp_offset[nparts]; c++) { total += comp_weight[c]; }
+      const double max_weight = 0.25*total/nparts;
+      main_comp.SetSize(nparts);
+      for (int p = 0; p < nparts; p++)
+      {
+         main_comp[p] = comp_offset[p];
+         for (int c = comp_offset[p]+1; c < comp_offset[p+1]; c++)
+         {
+            if (comp_weight[c] > comp_weight[main_comp[p]])
+            {
+               main_comp[p] = c;
+            }
+         }
+      }
+
+      // the neighboring parts of the small components
+      comp_nbr.SetSize(0);
+      for (int i = 0; i < n; i++)
+      {
+         const int p = partitioning[i], c = comp_offset[p] + component[i];
+         if (c == main_comp[p] || comp_weight[c] > max_weight) { continue; }
+         const int *row = elem_elem.GetRow(i);
+         for (int j = 0; j < elem_elem.RowSize(i); j++)
+         {
+            const int k = row[j];
+            if (k < n && partitioning[k] != p)
+            {
+               comp_nbr.Append(Pair<int,int>(c, partitioning[k]));
+            }
+         }
+      }
+      comp_nbr.Sort([](const Pair<int,int> &a, const Pair<int,int> &b)
+      { return a.one < b.one || (a.one == b.one && a.two < b.two); });
+
+      // move every component to its lightest neighboring part
+      part_weight.SetSize(nparts);
+      part_weight = 0.0;
+      for (int c = 0, p = 0; c < comp_offset[nparts]; c++)
+      {
+         while (c >= comp_offset[p+1]) { p++; }
+         part_weight[p] += comp_weight[c];
+      }
+      target.SetSize(comp_offset[nparts]);
+      target = -1;
+      for (int a = 0, b; a < comp_nbr.Size(); a = b)
+      {
+         const int c = comp_nbr[a].one;
+         int best = comp_nbr[a].two;
+         for (b = a+1; b < comp_nbr.Size() && comp_nbr[b].one == c; b++)
+         {
+            if (part_weight[comp_nbr[b].two] < part_weight[best])
+            {
+               best = comp_nbr[b].two;
+            }
+         }
+         int p = 0;
+         while (c >= comp_offset[p+1]) { p++; }
+         target[c] = best;
+         part_weight[p] -= comp_weight[c];
+         part_weight[best] += comp_weight[c];
+      }
+
+      bool changed = false;
+      for (int i = 0; i < n; i++)
+      {
+         const int c = comp_offset[partitioning[i]] + component[i];
+         if (target[c] >= 0)
+         {
+            partitioning[i] = target[c];
+            changed = true;
+         }
+      }
+      if (!changed) { break; }
+   }
+}
+
+int *Mesh::GenerateSFCPartitioning(int nparts, const double *weights,
+                                   bool hilbert, bool connected)
+{
+   MFEM_VERIFY(nparts >= 1, "invalid number of parts: " << nparts);
+   MFEM_VERIFY(spaceDim <= 3, "");
+
+   const int n = NumOfElements, sdim = spaceDim;
+   int *partitioning = new int[n];
+   if (nparts == 1 || n <= nparts)
+   {
+      for (int i = 0; i < n; i++) { partitioning[i] = (nparts == 1) ? 0 : i; }
+      return partitioning;
+   }
+
+   // element centers: the centers of the reference elements mapped by the
+   // Nodes, or the averages of the vertices
+   Array<double> centers(sdim*n);
+   if (Nodes)
+   {
+      Vector center;
+      for (int i = 0; i < n; i++)
+      {
+         GetElementCenter(i, center);
+         for (int d = 0; d < sdim; d++) { centers[sdim*i + d] = center(d); }
+      }
+   }
+   else
+   {
+      MFEM_MESH_OMP(omp parallel for)
+      for (int i = 0; i < n; i++)
+      {
+         const int nv = elements[i]->GetNVertices();
+         const int *v = elements[i]->GetVertices();
+         for (int d = 0; d < sdim; d++)
+         {
+            double c = 0.0;
+            for (int j = 0; j < nv; j++) { c += vertices[v[j]]()[d]; }
+            centers[sdim*i + d] = c/nv;
+         }
+      }
+   }
+   double min[3], max[3];
+   for (int d = 0; d < sdim; d++)
+   {
+      min[d] = infinity();
+      max[d] = -infinity();
+   }
+   for (int i = 0; i < n; i++)
+   {
+      for (int d = 0; d < sdim; d++)
+      {
+         min[d] = std::min(min[d], centers[sdim*i + d]);
+         max[d] = std::max(max[d], centers[sdim*i + d]);
+      }
+   }
+
+   // order the elements along the curve
+   Array<unsigned long long> keys(n);
+   MFEM_MESH_OMP(omp parallel for)
+   for (int i = 0; i < n; i++)
+   {
+      const double *x = &centers[sdim*i];
+      keys[i] = hilbert ? HilbertIndex(sdim, x, min, max) :
+                MortonIndex(sdim, x, min, max);
+   }
+   centers.DeleteAll();
+   Array<int> order;
+   SortByKeys(keys, order);
+   keys.DeleteAll();
+
+   // Split the curve into parts of equal weight: every element goes to the
+   // part containing the middle of its weight interval. The parts are
+   // consecutive along the curve and none of them is empty.
+   double total = 0.0;
+   for (int i = 0; i < n; i++) { total += weights ? weights[i] : 1.0; }
+   MFEM_VERIFY(total > 0.0, "the total weight of the elements must be > 0");
+   double sum = 0.0;
+   for (int k = 0, prev = 0; k < n; k++)
+   {
+      const int i = order[k];
+      const double w = weights ? weights[i] : 1.0;
+      int p = (int)floor((sum + 0.5*w)*nparts/total);
+      sum += w;
+      p = std::max(p, std::max(prev, nparts - n + k));
+      p = std::min(p, std::min(k > 0 ? prev + 1 : 0, nparts - 1));
+      partitioning[i] = prev = p;
+   }
+
+   if (connected)
+   {
+      const bool had_el_to_el = (el_to_el != NULL);
+      ElementToElementTable();
+      Array<int> part(partitioning, n);
+      MergeDisconnectedParts(*el_to_el, part, weights);
+      if (!had_el_to_el)
+      {
+         delete el_to_el;
+         el_to_el = NULL;
+      }
+   }
+
+   return partitioning;
+}
+
+void Mesh::GetPartitioningStats(const int *partitioning, int nparts,
+                                int &edge_cut, double &imbalance,
+                                int &disconnected, const double *weights)
+{
+   const int n = NumOfElements;
+   const bool had_el_to_el = (el_to_el != NULL);
+   ElementToElementTable();
+
+   edge_cut = 0;
+   for (int i = 0; i < n; i++)
+   {
+      const int *row = el_to_el->GetRow(i);
+      for (int j = 0; j < el_to_el->RowSize(i); j++)
+      {
+         const int k = row[j];
+         if (i < k && k < n && partitioning[i] != partitioning[k])
+         {
+            edge_cut++;
+         }
+      }
+   }
+
+   Array<double> part_weight(nparts);
+   part_weight = 0.0;
+   double total = 0.0;
+   for (int i = 0; i < n; i++)
+   {
+      const double w = weights ? weights[i] : 1.0;
+      part_weight[partitioning[i]] += w;
+      total += w;
+   }
+   imbalance = (total > 0.0) ? part_weight.Max()*nparts/total : 1.0;
+
+   Array<int> component, num_comp;
+   const Array<int> part(const_cast<int*>(partitioning), n);
+   FindPartitioningComponents(*el_to_el, part, component, num_comp);
+   disconnected = 0;
+   for (int p = 0; p < num_comp.Size(); p++)
+   {
+      if (num_comp[p] > 1) { disconnected++; }
+   }
+
+   if (!had_el_to_el)
+   {
+      delete el_to_el;
+      el_to_el = NULL;
+   }
+}
+
 // compute the coefficients of the polynomial in t:
 //   c(0)+c(1)*t+...+c(d)*t^d = det(A+t*B)
 // where A, B are (d x d), d=2,3
@@ -7754,6 +8678,10 @@ void Mesh::Swap(Mesh& other, bool non_geometry)
 
    mfem::Swap(geom_factors, other.geom_factors);
 
+   mfem::Swap(locality_ordering, other.locality_ordering);
+   mfem::Swap(orig_element, other.orig_element);
+   mfem::Swap(orig_vertex, other.orig_vertex);
+
 #ifdef MFEM_USE_MEMALLOC
    TetMemory.Swap(other.TetMemory);
 #endif
@@ -14,12 +14,14 @@
 
 #include "../config/config.hpp"
 #include "../general/stable3d.hpp"
+#include "../general/tuple_table.hpp"
 #include "../general/globals.hpp"
 #include "triangle.hpp"
 #include "tetrahedron.hpp"
 #include "vertex.hpp"
 #include "vtk.hpp"
 #include "ncmesh.hpp"
+#include "compact_elements.hpp"
 #include "../fem/eltrans.hpp"
 #include "../fem/coefficient.hpp"
 #include "../general/zstr.hpp"
@@ -44,6 +46,19 @@ struct Refinement;
 /** An enum type to specify if interior or boundary faces are desired. */
 enum class FaceType : bool {Interior, Boundary};
 
+/** @brief Element orderings used by Mesh::ReorderForLocality() to improve the
+    memory locality of the mesh and of the finite element spaces on it. */
+struct LocalityOrdering
+{
+   enum Type
+   {
+      NONE,    ///< Keep the current ordering.
+      HILBERT, ///< See Mesh::GetHilbertElementOrdering().
+      GECKO,   ///< See Mesh::GetGeckoElementOrdering().
+      RCM      ///< See Mesh::GetRCMElementOrdering().
+   };
+};
+
 #ifdef MFEM_USE_MPI
 class ParMesh;
 class ParNCMesh;
@@ -82,6 +97,11 @@ protected:
    // Mesh, such as FiniteElementSpace, GridFunction, etc.
    long sequence;
 
+   // Ordering applied by ReorderForLocality() and, for every element and
+   // vertex, its index before the first call to ReorderForLocality().
+   LocalityOrdering::Type locality_ordering;
+   Array<int> orig_element, orig_vertex;
+
    Array<Element *> elements;
    // Vertices are only at the corners of elements, where you would expect them
    // in the lowest-order mesh. In some cases, e.g. in a Mesh that defines the
@@ -211,6 +231,15 @@ public:
    // (true) is set in mesh_readers.cpp.
    static bool remove_unused_vertices;
 
+   /** @brief Global parameter that selects the sort-based construction of the
+       mesh topology (element-to-edge and element-to-face tables, faces and
+       face info) with TupleTable, which is multithreaded with OpenMP, instead
+       of the hash tables DSTable and STable3D. Both methods produce the same
+       numbering of the edges and faces. With a single thread, the hash tables
+       are faster, so the default value is true when MFEM_USE_OPENMP is
+       enabled, and false otherwise. */
+   static bool sorted_topology;
+
 protected:
    Operation last_operation;
 
@@ -238,9 +267,20 @@ protected:
    void ReadTrueGridMesh(std::istream &input);
    void ReadVTKMesh(std::istream &input, int &curved, int &read_gf,
                     bool &finalize_topo);
+   void ReadXML_VTKMesh(std::istream &input, int &curved, int &read_gf,
+                        bool &finalize_topo, const std::string &xml_tag);
    void ReadNURBSMesh(std::istream &input, int &curved, int &read_gf);
    void ReadInlineMesh(std::istream &input, bool generate_edges = false);
    void ReadGmshMesh(std::istream &input, int &curved, int &read_gf);
+   /** Create the elements and vertices of a VTK mesh from its points (3
+       coordinates per point) and its cells, given in compressed row format
+       (the vertices of cell i are cell_data[cell_offsets[i]...]) with their
+       VTK types and attributes. Used by the VTK readers. */
+   void CreateVTKMesh(const Vector &points, const Array<int> &cell_data,
+                      const Array<int> &cell_offsets,
+                      const Array<int> &cell_types,
+                      const Array<int> &cell_attributes,
+                      int &curved, int &read_gf, bool &finalize_topo);
    /* Note NetCDF (optional library) is used for reading cubit files */
 #ifdef MFEM_USE_NETCDF
    void ReadCubit(const char *filename, int &curved, int &read_gf);
@@ -272,6 +312,8 @@ protected:
 
    STable3D *GetFacesTable();
    STable3D *GetElementToFaceTable(int ret_ftbl = 0);
+   /// Sort-based version of GetElementToFaceTable(0), see #sorted_topology.
+   void GetElementToFaceTableSorted();
 
    /** Red refinement. Element with index i is refined. The default
        red refinement for now is Uniform. */
@@ -395,6 +437,8 @@ protected:
        T(i, 0) gives the index of edge in element i that connects vertex 0
        to vertex 1, etc. Returns the number of the edges. */
    int GetElementToEdgeTable(Table &, Array<int> &);
+   /// Sort-based version of GetElementToEdgeTable(), see #sorted_topology.
+   int GetElementToEdgeTableSorted(Table &, Array<int> &);
 
    /// Used in GenerateFaces()
    void AddPointFaceElement(int lf, int gf, int el);
@@ -417,6 +461,8 @@ protected:
    void FreeElement(Element *E);
 
    void GenerateFaces();
+   /// Sort-based version of GenerateFaces() in 2D and 3D.
+   void GenerateFacesSorted();
    void GenerateNCFaceInfo();
 
    /// Begin construction of a mesh
@@ -495,6 +541,16 @@ public:
         int *boundary_attributes, int num_boundary_elements,
         int dimension, int space_dimension= -1);
 
+   /** @brief Construct a Mesh from the given vertices and the (possibly mixed)
+       elements and boundary elements in compact storage.
+
+       The array @a vertices is used as external data, as in the previous
+       constructor, and the Element objects are created from @a elems and
+       @a bdr_elems. This method calls the method FinalizeTopology(). */
+   Mesh(double *vertices, int num_vertices,
+        const CompactElementArray &elems, const CompactElementArray &bdr_elems,
+        int dimension, int space_dimension = -1);
+
    /** @anchor mfem_Mesh_init_ctor
        @brief _Init_ constructor: begin the construction of a Mesh object. */
    Mesh(int _Dim, int NVert, int NElem, int NBdrElem = 0, int _spaceDim = -1)
@@ -613,11 +669,65 @@ public:
        ReorderElements. This is a cheap alternative to GetGeckoElementOrdering.*/
    void GetHilbertElementOrdering(Array<int> &ordering);
 
+   /** @brief Return the index of the point @a x along a Hilbert curve filling
+       the box [@a min, @a max] in @a dim = 1, 2 or 3 dimensions.
+
+       The box is divided into 2^(63/dim) intervals in each direction. Unlike
+       GetHilbertElementOrdering(), the index can be compared across MPI ranks,
+       e.g. for the distributed partitioning of elements by their centers. */
+   static unsigned long long HilbertIndex(int dim, const double *x,
+                                          const double *min,
+                                          const double *max);
+
+   /** @brief Return the index of the point @a x along a Morton (Z-order)
+       curve filling the box [@a min, @a max], see HilbertIndex(). */
+   static unsigned long long MortonIndex(int dim, const double *x,
+                                         const double *min,
+                                         const double *max);
+
    /** Rebuilds the mesh with a different order of elements. For each element i,
        the array ordering[i] contains its desired new index. Note that the method
        reorders vertices, edges and faces along with the elements. */
    void ReorderElements(const Array<int> &ordering, bool reorder_vertices = true);
 
+   /** Return the reverse Cuthill-McKee ordering of the element-to-element
+       graph (elements sharing a face), in the format required by
+       ReorderElements. Every connected component is started from a
+       pseudo-peripheral element. */
+   void GetRCMElementOrdering(Array<int> &ordering);
+
+   /** @brief Reorder the elements with the given ordering (see
+       GetHilbertElementOrdering, GetGeckoElementOrdering and
+       GetRCMElementOrdering) and the vertices in the order in which they are
+       first used by the reordered elements.
+
+       The mesh is marked as locality-ordered: the FiniteElementSpace%s created
+       on it (or updated) afterwards number their dofs in the order in which
+       they are first used by the elements, instead of following the vertex,
+       edge and face numbering, see FiniteElementSpace::GetDofPermutation().
+       This improves the locality of the gather/scatter operations of the
+       element restriction, see ElementRestriction::GetStrideStatistics().
+
+       The original indices of the elements and the vertices are recorded, see
+       GetOriginalElementIndices() and FiniteElementSpace::MapToOriginal(), and
+       remain valid until the mesh is refined. Only serial conforming meshes
+       are supported. */
+   void ReorderForLocality(LocalityOrdering::Type type =
+                              LocalityOrdering::HILBERT);
+
+   /// Return the ordering applied by ReorderForLocality(), if any.
+   LocalityOrdering::Type GetLocalityOrdering() const
+   { return locality_ordering; }
+
+   /** @brief Return the index of every element before ReorderForLocality()
+       was first called; empty if the mesh was not reordered. */
+   const Array<int> &GetOriginalElementIndices() const { return orig_element; }
+
+   /** @brief Return the index of every vertex before ReorderForLocality() was
+       first called (-1 for vertices not used by any element); empty if the
+       mesh was not reordered. */
+   const Array<int> &GetOriginalVertexIndices() const { return orig_vertex; }
+
    /** Creates mesh for the parallelepiped [0,sx]x[0,sy]x[0,sz], divided into
        nx*ny*nz hexahedra if type=HEXAHEDRON or into 6*nx*ny*nz tetrahedrons if
        type=TETRAHEDRON. If sfc_ordering = true (default), elements are ordered
@@ -859,6 +969,21 @@ public:
    void GetBdrElementVertices(int i, Array<int> &v) const
    { boundary[i]->GetVertices(v); }
 
+   /** @brief Copy the vertex indices, attributes and geometries of all
+       elements to the compact storage @a elems. */
+   void GetCompactElements(CompactElementArray &elems) const
+   { elems.MakeFrom(elements, NumOfElements); }
+
+   /** @brief Copy the vertex indices, attributes and geometries of all
+       boundary elements to the compact storage @a bdr_elems. */
+   void GetCompactBdrElements(CompactElementArray &bdr_elems) const
+   { bdr_elems.MakeFrom(boundary, NumOfBdrElements); }
+
+   /** @brief Copy the vertex indices and geometries of all faces (in 2D and
+       3D) to the compact storage @a face_elems. */
+   void GetCompactFaces(CompactElementArray &face_elems) const
+   { face_elems.MakeFrom(faces, Dim > 1 ? faces.Size() : 0); }
+
    /// Return the indices and the orientations of all edges of element i.
    void GetElementEdges(int i, Array<int> &edges, Array<int> &cor) const;
 
@@ -1054,9 +1179,59 @@ public:
    virtual void ReorientTetMesh();
 
    int *CartesianPartitioning(int nxyz[]);
+
+   /** @brief Partition the elements into @a nparts parts and return a new[]
+       allocated array with the part of every element.
+
+       The partitioning method @a part_method is one of:
+       - 0, 1, 2: METIS_PartGraphRecursive, METIS_PartGraphKway and
+         METIS_PartGraphVKway (minimizing the communication volume),
+         respectively, with sorted neighbor lists;
+       - 3, 4, 5: the same with unsorted neighbor lists;
+       - 6, 7: GenerateSFCPartitioning() with the Hilbert and the Morton curve,
+         respectively, with unit element weights.
+
+       The methods 0 to 5 require MFEM_USE_METIS. */
    int *GeneratePartitioning(int nparts, int part_method = 1);
+
+   /** @brief Partition the elements into @a nparts parts of equal weight along
+       a space-filling curve through the element centers, and return a new[]
+       allocated array with the part of every element.
+
+       The elements are sorted along the Hilbert curve (if @a hilbert is true)
+       or the Morton curve through their centers, see HilbertIndex() and
+       MortonIndex(), and the curve is split into consecutive parts of (nearly)
+       equal total weight, none of them empty. The element @a weights, e.g. the
+       number of degrees of freedom of the elements, default to 1.
+
+       The parts along the curve may be disconnected, e.g. in non-convex
+       domains. If @a connected is true, the small connected components of the
+       parts (lighter than a quarter of the average part weight, and not the
+       largest component of their part) are moved to the lightest of their
+       neighboring parts, at the expense of a slightly larger imbalance.
+
+       The computation of the curve indices and the sort are multithreaded with
+       OpenMP, when MFEM_USE_OPENMP is enabled. METIS is not needed. */
+   int *GenerateSFCPartitioning(int nparts, const double *weights = NULL,
+                                bool hilbert = true, bool connected = true);
+
    void CheckPartitioning(int *partitioning);
 
+   /** @brief Compute quality metrics of the element @a partitioning into
+       @a nparts parts.
+
+       @param[out] edge_cut      The number of faces between elements in
+                                 different parts (the edge cut of the dual
+                                 graph, as reported by METIS).
+       @param[out] imbalance     The maximum weight of a part divided by the
+                                 average weight of the parts.
+       @param[out] disconnected  The number of parts that are not connected.
+       @param[in]  weights       The element weights, 1 if NULL. */
+   void GetPartitioningStats(const int *partitioning, int nparts,
+                             int &edge_cut, double &imbalance,
+                             int &disconnected,
+                             const double *weights = NULL);
+
    void CheckDisplacements(const Vector &displacements, double &tmax);
 
    // Vertices are only at the corners of elements, where you would expect them
@@ -1309,6 +1484,13 @@ public:
       PrintCharacteristics(NULL, NULL, out);
    }
 
+   /** @brief Return the number of bytes used by the Mesh (not counting the
+       nodes and the overhead of the heap allocations). */
+   long MemoryUsage() const;
+
+   /// Print the memory usage of the main Mesh data structures.
+   void PrintMemoryDetail(std::ostream &out = mfem::out) const;
+
    void MesquiteSmooth(const int mesquite_option = 0);
 
    /** @brief Find the ids of the elements that contain the given points, and
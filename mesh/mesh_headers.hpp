@@ -16,6 +16,7 @@
 
 #include "vertex.hpp"
 #include "element.hpp"
+#include "compact_elements.hpp"
 #include "point.hpp"
 #include "segment.hpp"
 #include "triangle.hpp"
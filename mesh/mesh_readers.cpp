@@ -12,9 +12,18 @@
 #include "mesh_headers.hpp"
 #include "../fem/fem.hpp"
 #include "../general/text.hpp"
+#include "../general/binaryio.hpp"
 
 #include <iostream>
+#include <sstream>
+#include <algorithm>
 #include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#ifdef MFEM_USE_ZLIB
+#include <zlib.h>
+#endif
 
 #ifdef MFEM_USE_NETCDF
 #include "netcdf.h"
@@ -27,6 +36,211 @@ namespace mfem
 
 bool Mesh::remove_unused_vertices = true;
 
+namespace internal
+{
+
+// Convert the decimal floating-point number in str to x, returning false if
+// str is not a number. Numbers with at most 19 significant digits, whose
+// mantissa and power of ten are both exactly representable, are converted
+// with a single correctly rounded multiplication or division (Clinger's fast
+// path); all other numbers are converted with strtod().
+static bool ParseDouble(const std::string &str, double &x)
+{
+   static const double pow10[23] =
+   {
+      1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12,
+      1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+   };
+   const char *s = str.c_str();
+   const int n = (int) str.size();
+   int i = 0;
+   const bool neg = (i < n && s[i] == '-');
+   if (i < n && (s[i] == '-' || s[i] == '+')) { i++; }
+
+   unsigned long long m = 0;
+   int ndigits = 0, exp10 = 0;
+   bool any = false, exact = true;
+   for ( ; i < n && s[i] >= '0' && s[i] <= '9'; i++)
+   {
+      any = true;
+      if (m == 0 && s[i] == '0') { continue; }
+      if (ndigits == 19) { exact = false; break; }
+      m = 10*m + (s[i] - '0');
+      ndigits++;
+   }
+   if (exact && i < n && s[i] == '.')
+   {
+      for (i++; i < n && s[i] >= '0' && s[i] <= '9'; i++)
+      {
+         any = true;
+         exp10--;
+         if (m == 0 && s[i] == '0') { continue; }
+         if (ndigits == 19) { exact = false; break; }
+         m = 10*m + (s[i] - '0');
+         ndigits++;
+      }
+   }
+   if (exact && any && i < n && (s[i] == 'e' || s[i] == 'E'))
+   {
+      i++;
+      const bool eneg = (i < n && s[i] == '-');
+      if (i < n && (s[i] == '-' || s[i] == '+')) { i++; }
+      int e = 0;
+      if (i == n || s[i] < '0' || s[i] > '9') { return false; }
+      for ( ; i < n && s[i] >= '0' && s[i] <= '9'; i++)
+      {
+         if (e < 100000) { e = 10*e + (s[i] - '0'); }
+      }
+      exp10 += eneg ? -e : e;
+   }
+   if (exact && any && i == n && m <= (1ull << 53) &&
+       exp10 >= -22 && exp10 <= 22)
+   {
+      x = (exp10 >= 0) ? m*pow10[exp10] : m/pow10[-exp10];
+      if (neg) { x = -x; }
+      return true;
+   }
+   if (n == 0) { return false; }
+   char *end;
+   x = strtod(s, &end);
+   return (end == s + n);
+}
+
+/** Tokenizer reading from the buffer of an input stream, used by the readers
+    of large meshes instead of the formatted input of std::istream, which is
+    slow. Nothing is extracted beyond the requested data, so the stream can be
+    used again after the tokenizer. Numbers are delimited by white space or by
+    '<', as in the data of XML files. */
+class StreamTokenizer
+{
+protected:
+   std::streambuf *buf;
+   std::string num; // characters of the last number
+
+   void ReadNumber()
+   {
+      SkipSpace();
+      num.clear();
+      int c = buf->sgetc();
+      while (c != EOF && !IsSpace(c) && c != '<')
+      {
+         num.push_back((char) c);
+         c = buf->snextc();
+      }
+   }
+
+public:
+   explicit StreamTokenizer(std::istream &input) : buf(input.rdbuf()) { }
+
+   static bool IsSpace(int c) { return c == ' ' || (c >= '\t' && c <= '\r'); }
+
+   /// Return the next character without extracting it, or EOF.
+   int Peek() { return buf->sgetc(); }
+
+   /// Extract and return the next character, or EOF.
+   int Get() { return buf->sbumpc(); }
+
+   /// Extract the white space before the next character.
+   void SkipSpace()
+   {
+      int c = buf->sgetc();
+      while (IsSpace(c)) { c = buf->snextc(); }
+   }
+
+   /// Extract the rest of the current line, including the end of line.
+   void SkipLine()
+   {
+      int c;
+      do { c = buf->sbumpc(); }
+      while (c != EOF && c != '\n');
+   }
+
+   /// Extract the rest of the current line, storing it without the end of line.
+   void ReadLine(std::string &line)
+   {
+      line.clear();
+      int c;
+      while ((c = buf->sbumpc()) != EOF && c != '\n')
+      {
+         line.push_back((char) c);
+      }
+      filter_dos(line);
+   }
+
+   /** Extract the characters before the next @a delim (or the end of the
+       stream), appending them to @a str. */
+   void ReadUntil(char delim, std::string &str)
+   {
+      int c = buf->sgetc();
+      while (c != EOF && c != delim)
+      {
+         str.push_back((char) c);
+         c = buf->snextc();
+      }
+   }
+
+   /** Extract the next token delimited by white space. Returns false if the
+       end of the stream is reached before the token. */
+   bool ReadToken(std::string &str)
+   {
+      SkipSpace();
+      str.clear();
+      int c = buf->sgetc();
+      while (c != EOF && !IsSpace(c))
+      {
+         str.push_back((char) c);
+         c = buf->snextc();
+      }
+      return !str.empty();
+   }
+
+   /// Extract an integer.
+   long long ReadInt()
+   {
+      ReadNumber();
+      const char *s = num.c_str();
+      int i = (s[0] == '-' || s[0] == '+') ? 1 : 0;
+      long long val = 0;
+      const int n = (int) num.size();
+      MFEM_VERIFY(i < n, "error reading an integer: '" << num << "'");
+      for ( ; i < n; i++)
+      {
+         MFEM_VERIFY(s[i] >= '0' && s[i] <= '9',
+                     "error reading an integer: '" << num << "'");
+         val = 10*val + (s[i] - '0');
+      }
+      return (s[0] == '-') ? -val : val;
+   }
+
+   /// Extract a floating-point number.
+   double ReadDouble()
+   {
+      ReadNumber();
+      double x = 0.0;
+      MFEM_VERIFY(ParseDouble(num, x),
+                  "error reading a number: '" << num << "'");
+      return x;
+   }
+
+   /// Extract @a nbytes bytes of binary data into @a dst.
+   void ReadBinary(void *dst, size_t nbytes)
+   {
+      const std::streamsize n = buf->sgetn((char *) dst, nbytes);
+      MFEM_VERIFY(n == (std::streamsize) nbytes, "unexpected end of input");
+   }
+
+   /// Extract and discard @a nbytes bytes.
+   void Skip(size_t nbytes)
+   {
+      for (size_t i = 0; i < nbytes; i++)
+      {
+         MFEM_VERIFY(buf->sbumpc() != EOF, "unexpected end of input");
+      }
+   }
+};
+
+} // namespace mfem::internal
+
 void Mesh::ReadMFEMMesh(std::istream &input, bool mfem_v11, int &curved)
 {
    // Read MFEM mesh v1.0 format
@@ -372,194 +586,97 @@ const int Mesh::vtk_quadratic_hex[27] =
    24, 22, 21, 23, 20, 25, 26
 };
 
-void Mesh::ReadVTKMesh(std::istream &input, int &curved, int &read_gf,
-                       bool &finalize_topo)
+void Mesh::CreateVTKMesh(const Vector &points, const Array<int> &cell_data,
+                         const Array<int> &cell_offsets,
+                         const Array<int> &cell_types,
+                         const Array<int> &cell_attributes,
+                         int &curved, int &read_gf, bool &finalize_topo)
 {
-   // VTK resources:
-   //   * https://www.vtk.org/doc/nightly/html/vtkCellType_8h_source.html
-   //   * https://www.vtk.org/doc/nightly/html/classvtkCell.html
-   //   * https://lorensen.github.io/VTKExamples/site/VTKFileFormats
-   //   * https://www.kitware.com/products/books/VTKUsersGuide.pdf
-
-   int i, j, n, attr;
-
-   string buff;
-   getline(input, buff); // comment line
-   getline(input, buff);
-   filter_dos(buff);
-   if (buff != "ASCII")
-   {
-      MFEM_ABORT("VTK mesh is not in ASCII format!");
-      return;
-   }
-   getline(input, buff);
-   filter_dos(buff);
-   if (buff != "DATASET UNSTRUCTURED_GRID")
-   {
-      MFEM_ABORT("VTK mesh is not UNSTRUCTURED_GRID!");
-      return;
-   }
-
-   // Read the points, skipping optional sections such as the FIELD data from
-   // VisIt's VTK export (or from Mesh::PrintVTK with field_data==1).
-   do
-   {
-      input >> buff;
-      if (!input.good())
-      {
-         MFEM_ABORT("VTK mesh does not have POINTS data!");
-      }
-   }
-   while (buff != "POINTS");
-   int np = 0;
-   Vector points;
-   {
-      input >> np >> ws;
-      points.SetSize(3*np);
-      getline(input, buff); // "double"
-      for (i = 0; i < points.Size(); i++)
-      {
-         input >> points(i);
-      }
-   }
-
-   // Read the cells
-   NumOfElements = n = 0;
-   Array<int> cells_data;
-   input >> ws >> buff;
-   if (buff == "CELLS")
-   {
-      input >> NumOfElements >> n >> ws;
-      cells_data.SetSize(n);
-      for (i = 0; i < n; i++)
-      {
-         input >> cells_data[i];
-      }
-   }
+   int i, j, n;
+   const int np = points.Size()/3;
 
-   // Read the cell types
+   // Create the elements from the cells
    Dim = -1;
    int order = -1;
-   input >> ws >> buff;
-   if (buff == "CELL_TYPES")
+   NumOfElements = cell_types.Size();
+   MFEM_VERIFY(cell_offsets.Size() == NumOfElements + 1,
+               "VTK mesh : invalid cell offsets");
+   MFEM_VERIFY(cell_attributes.Size() == 0 ||
+               cell_attributes.Size() == NumOfElements,
+               "VTK mesh : invalid cell attributes");
+   elements.SetSize(NumOfElements);
+   for (i = 0; i < NumOfElements; i++)
    {
-      input >> NumOfElements;
-      elements.SetSize(NumOfElements);
-      for (j = i = 0; i < NumOfElements; i++)
+      const int *v = cell_data.GetData() + cell_offsets[i];
+      int ct = cell_types[i], elem_dim, elem_order = 1;
+      Geometry::Type geom;
+      switch (ct)
       {
-         int ct, elem_dim, elem_order = 1;
-         input >> ct;
-         switch (ct)
-         {
-            case 5:   // triangle
-               elem_dim = 2;
-               elements[i] = new Triangle(&cells_data[j+1]);
-               break;
-            case 9:   // quadrilateral
-               elem_dim = 2;
-               elements[i] = new Quadrilateral(&cells_data[j+1]);
-               break;
-            case 10:  // tetrahedron
-               elem_dim = 3;
-#ifdef MFEM_USE_MEMALLOC
-               elements[i] = TetMemory.Alloc();
-               elements[i]->SetVertices(&cells_data[j+1]);
-#else
-               elements[i] = new Tetrahedron(&cells_data[j+1]);
-#endif
-               break;
-            case 12:  // hexahedron
-               elem_dim = 3;
-               elements[i] = new Hexahedron(&cells_data[j+1]);
-               break;
-            case 13:  // wedge
-               elem_dim = 3;
-               // switch between vtk vertex ordering and mfem vertex ordering:
-               // swap vertices (1,2) and (4,5)
-               elements[i] =
-                  new Wedge(cells_data[j+1], cells_data[j+3], cells_data[j+2],
-                            cells_data[j+4], cells_data[j+6], cells_data[j+5]);
-               break;
+         case 5:   // triangle
+            geom = Geometry::TRIANGLE;
+            break;
+         case 9:   // quadrilateral
+            geom = Geometry::SQUARE;
+            break;
+         case 10:  // tetrahedron
+            geom = Geometry::TETRAHEDRON;
+            break;
+         case 12:  // hexahedron
+            geom = Geometry::CUBE;
+            break;
+         case 13:  // wedge
+            geom = Geometry::PRISM;
+            break;
 
-            case 22:  // quadratic triangle
-               elem_dim = 2;
-               elem_order = 2;
-               elements[i] = new Triangle(&cells_data[j+1]);
-               break;
-            case 28:  // biquadratic quadrilateral
-               elem_dim = 2;
-               elem_order = 2;
-               elements[i] = new Quadrilateral(&cells_data[j+1]);
-               break;
-            case 24:  // quadratic tetrahedron
-               elem_dim = 3;
-               elem_order = 2;
-#ifdef MFEM_USE_MEMALLOC
-               elements[i] = TetMemory.Alloc();
-               elements[i]->SetVertices(&cells_data[j+1]);
-#else
-               elements[i] = new Tetrahedron(&cells_data[j+1]);
-#endif
-               break;
-            case 32: // biquadratic-quadratic wedge
-               elem_dim = 3;
-               elem_order = 2;
-               // switch between vtk vertex ordering and mfem vertex ordering:
-               // swap vertices (1,2) and (4,5)
-               elements[i] =
-                  new Wedge(cells_data[j+1], cells_data[j+3], cells_data[j+2],
-                            cells_data[j+4], cells_data[j+6], cells_data[j+5]);
-               break;
-            case 29:  // triquadratic hexahedron
-               elem_dim = 3;
-               elem_order = 2;
-               elements[i] = new Hexahedron(&cells_data[j+1]);
-               break;
-            default:
-               MFEM_ABORT("VTK mesh : cell type " << ct << " is not supported!");
-               return;
-         }
-         MFEM_VERIFY(Dim == -1 || Dim == elem_dim,
-                     "elements with different dimensions are not supported");
-         MFEM_VERIFY(order == -1 || order == elem_order,
-                     "elements with different orders are not supported");
-         Dim = elem_dim;
-         order = elem_order;
-         j += cells_data[j] + 1;
+         case 22:  // quadratic triangle
+            geom = Geometry::TRIANGLE;
+            elem_order = 2;
+            break;
+         case 28:  // biquadratic quadrilateral
+            geom = Geometry::SQUARE;
+            elem_order = 2;
+            break;
+         case 24:  // quadratic tetrahedron
+            geom = Geometry::TETRAHEDRON;
+            elem_order = 2;
+            break;
+         case 32: // biquadratic-quadratic wedge
+            geom = Geometry::PRISM;
+            elem_order = 2;
+            break;
+         case 29:  // triquadratic hexahedron
+            geom = Geometry::CUBE;
+            elem_order = 2;
+            break;
+         default:
+            MFEM_ABORT("VTK mesh : cell type " << ct << " is not supported!");
+            return;
       }
-   }
-
-   // Read attributes
-   streampos sp = input.tellg();
-   input >> ws >> buff;
-   if (buff == "CELL_DATA")
-   {
-      input >> n >> ws;
-      getline(input, buff);
-      filter_dos(buff);
-      // "SCALARS material dataType numComp"
-      if (!strncmp(buff.c_str(), "SCALARS material", 16))
+      elem_dim = Geometry::Dimension[geom];
+      elements[i] = NewElement(geom);
+      if (geom == Geometry::PRISM)
       {
-         getline(input, buff); // "LOOKUP_TABLE default"
-         for (i = 0; i < NumOfElements; i++)
-         {
-            input >> attr;
-            elements[i]->SetAttribute(attr);
-         }
+         // switch between vtk vertex ordering and mfem vertex ordering:
+         // swap vertices (1,2) and (4,5)
+         const int wv[6] = { v[0], v[2], v[1], v[3], v[5], v[4] };
+         elements[i]->SetVertices(wv);
       }
       else
       {
-         input.seekg(sp);
+         elements[i]->SetVertices(v);
       }
-   }
-   else
-   {
-      input.seekg(sp);
+      elements[i]->SetAttribute(cell_attributes.Size() ?
+                                cell_attributes[i] : 1);
+      MFEM_VERIFY(Dim == -1 || Dim == elem_dim,
+                  "elements with different dimensions are not supported");
+      MFEM_VERIFY(order == -1 || order == elem_order,
+                  "elements with different orders are not supported");
+      Dim = elem_dim;
+      order = elem_order;
    }
 
    if (order == 1)
    {
-      cells_data.DeleteAll();
       NumOfVertices = np;
       vertices.SetSize(np);
       for (i = 0; i < np; i++)
@@ -568,7 +685,6 @@ void Mesh::ReadVTKMesh(std::istream &input, int &curved, int &read_gf,
          vertices[i](1) = points(3*i+1);
          vertices[i](2) = points(3*i+2);
       }
-      points.Destroy();
 
       // No boundary is defined in a VTK mesh
       NumOfBdrElements = 0;
@@ -636,7 +752,7 @@ void Mesh::ReadVTKMesh(std::istream &input, int &curved, int &read_gf,
 
       // Map vtk points to edge/face/element dofs
       Array<int> dofs;
-      for (n = i = 0; i < NumOfElements; i++)
+      for (i = 0; i < NumOfElements; i++)
       {
          fes->GetElementDofs(i, dofs);
          const int *vtk_mfem;
@@ -656,15 +772,15 @@ void Mesh::ReadVTKMesh(std::istream &input, int &curved, int &read_gf,
                break;
          }
 
-         for (n++, j = 0; j < dofs.Size(); j++, n++)
+         for (n = cell_offsets[i], j = 0; j < dofs.Size(); j++, n++)
          {
-            if (pts_dof[cells_data[n]] == -1)
+            if (pts_dof[cell_data[n]] == -1)
             {
-               pts_dof[cells_data[n]] = dofs[vtk_mfem[j]];
+               pts_dof[cell_data[n]] = dofs[vtk_mfem[j]];
             }
             else
             {
-               if (pts_dof[cells_data[n]] != dofs[vtk_mfem[j]])
+               if (pts_dof[cell_data[n]] != dofs[vtk_mfem[j]])
                {
                   MFEM_ABORT("VTK mesh : inconsistent quadratic mesh!");
                }
@@ -690,72 +806,691 @@ void Mesh::ReadVTKMesh(std::istream &input, int &curved, int &read_gf,
    }
 }
 
-void Mesh::ReadNURBSMesh(std::istream &input, int &curved, int &read_gf)
+void Mesh::ReadVTKMesh(std::istream &input, int &curved, int &read_gf,
+                       bool &finalize_topo)
 {
-   NURBSext = new NURBSExtension(input);
+   // VTK resources:
+   //   * https://www.vtk.org/doc/nightly/html/vtkCellType_8h_source.html
+   //   * https://www.vtk.org/doc/nightly/html/classvtkCell.html
+   //   * https://lorensen.github.io/VTKExamples/site/VTKFileFormats
+   //   * https://www.kitware.com/products/books/VTKUsersGuide.pdf
 
-   Dim              = NURBSext->Dimension();
-   NumOfVertices    = NURBSext->GetNV();
-   NumOfElements    = NURBSext->GetNE();
-   NumOfBdrElements = NURBSext->GetNBE();
+   int i, j, n;
 
-   NURBSext->GetElementTopo(elements);
-   NURBSext->GetBdrElementTopo(boundary);
+   internal::StreamTokenizer tok(input);
+   string buff;
+   tok.ReadLine(buff); // comment line
+   tok.ReadLine(buff);
+   if (buff != "ASCII")
+   {
+      MFEM_ABORT("VTK mesh is not in ASCII format!");
+      return;
+   }
+   tok.ReadLine(buff);
+   if (buff != "DATASET UNSTRUCTURED_GRID")
+   {
+      MFEM_ABORT("VTK mesh is not UNSTRUCTURED_GRID!");
+      return;
+   }
 
-   vertices.SetSize(NumOfVertices);
-   curved = 1;
-   if (NURBSext->HavePatches())
+   // Read the points, skipping optional sections such as the FIELD data from
+   // VisIt's VTK export (or from Mesh::PrintVTK with field_data==1).
+   do
    {
-      NURBSFECollection  *fec = new NURBSFECollection(NURBSext->GetOrder());
-      FiniteElementSpace *fes = new FiniteElementSpace(this, fec, Dim,
-                                                       Ordering::byVDIM);
-      Nodes = new GridFunction(fes);
-      Nodes->MakeOwner(fec);
-      NURBSext->SetCoordsFromPatches(*Nodes);
-      own_nodes = 1;
-      read_gf = 0;
-      int vd = Nodes->VectorDim();
-      for (int i = 0; i < vd; i++)
+      if (!tok.ReadToken(buff))
       {
-         Vector vert_val;
-         Nodes->GetNodalValues(vert_val, i+1);
-         for (int j = 0; j < NumOfVertices; j++)
-         {
-            vertices[j](i) = vert_val(j);
-         }
+         MFEM_ABORT("VTK mesh does not have POINTS data!");
       }
    }
-   else
+   while (buff != "POINTS");
+   int np = 0;
+   Vector points;
    {
-      read_gf = 1;
+      np = tok.ReadInt();
+      tok.ReadLine(buff); // "double"
+      points.SetSize(3*np);
+      for (i = 0; i < points.Size(); i++)
+      {
+         points(i) = tok.ReadDouble();
+      }
    }
-}
 
-void Mesh::ReadInlineMesh(std::istream &input, bool generate_edges)
-{
-   // Initialize to negative numbers so that we know if they've been set.  We're
-   // using Element::POINT as our flag, since we're not going to make a 0D mesh,
-   // ever.
-   int nx = -1;
-   int ny = -1;
-   int nz = -1;
-   double sx = -1.0;
-   double sy = -1.0;
-   double sz = -1.0;
-   Element::Type type = Element::POINT;
+   // Read the cells, in compressed row format
+   int num_cells = 0;
+   Array<int> cell_data, cell_offsets(1), cell_types, cell_attributes;
+   cell_offsets[0] = 0;
+   tok.ReadToken(buff);
+   if (buff == "CELLS")
+   {
+      num_cells = tok.ReadInt();
+      n = tok.ReadInt();
+      cell_data.SetSize(n - num_cells);
+      cell_offsets.SetSize(num_cells + 1);
+      for (i = 0; i < num_cells; i++)
+      {
+         const int nv = tok.ReadInt();
+         MFEM_VERIFY(cell_offsets[i] + nv <= cell_data.Size(),
+                     "VTK mesh : invalid CELLS data");
+         for (j = 0; j < nv; j++)
+         {
+            cell_data[cell_offsets[i] + j] = tok.ReadInt();
+         }
+         cell_offsets[i+1] = cell_offsets[i] + nv;
+      }
+   }
 
-   while (true)
+   // Read the cell types
+   tok.ReadToken(buff);
+   if (buff == "CELL_TYPES")
    {
-      skip_comment_lines(input, '#');
-      // Break out if we reached the end of the file after gobbling up the
-      // whitespace and comments after the last keyword.
-      if (!input.good())
+      n = tok.ReadInt();
+      MFEM_VERIFY(n == num_cells, "VTK mesh : invalid CELL_TYPES data");
+      cell_types.SetSize(n);
+      for (i = 0; i < n; i++)
       {
-         break;
+         cell_types[i] = tok.ReadInt();
       }
+   }
 
-      // Read the next keyword
-      std::string name;
+   // Read attributes
+   streampos sp = input.tellg();
+   tok.ReadToken(buff);
+   if (buff == "CELL_DATA")
+   {
+      n = tok.ReadInt();
+      tok.SkipLine();
+      tok.ReadLine(buff);
+      // "SCALARS material dataType numComp"
+      if (!strncmp(buff.c_str(), "SCALARS material", 16))
+      {
+         tok.SkipLine(); // "LOOKUP_TABLE default"
+         cell_attributes.SetSize(num_cells);
+         for (i = 0; i < num_cells; i++)
+         {
+            cell_attributes[i] = tok.ReadInt();
+         }
+      }
+      else
+      {
+         input.seekg(sp);
+      }
+   }
+   else
+   {
+      input.seekg(sp);
+   }
+
+   CreateVTKMesh(points, cell_data, cell_offsets, cell_types, cell_attributes,
+                 curved, read_gf, finalize_topo);
+}
+
+namespace internal
+{
+
+// Start or end tag of an element of an XML file, e.g. <DataArray ...>.
+struct XMLTag
+{
+   std::string name; // starts with '/' for end tags
+   std::vector<std::pair<std::string, std::string> > attributes;
+   bool empty; // tags of the form <name ... />
+
+   // Return the value of the attribute, or def if the tag does not have it.
+   std::string Get(const char *attr, const char *def = "") const
+   {
+      for (size_t i = 0; i < attributes.size(); i++)
+      {
+         if (attributes[i].first == attr) { return attributes[i].second; }
+      }
+      return def;
+   }
+};
+
+// Extract the next tag of an XML file, skipping the content before it, as well
+// as comments, declarations and processing instructions. Returns false at the
+// end of the input.
+static bool ReadXMLTag(StreamTokenizer &tok, XMLTag &tag)
+{
+   int c;
+   for (;;)
+   {
+      while ((c = tok.Get()) != '<')
+      {
+         if (c == EOF) { return false; }
+      }
+      c = tok.Peek();
+      if (c != '?' && c != '!') { break; }
+      tok.Get();
+      if (c == '!' && tok.Peek() == '-')
+      {
+         // comment: skip until "-->"
+         int dashes = 0;
+         while ((c = tok.Get()) != EOF && !(c == '>' && dashes >= 2))
+         {
+            dashes = (c == '-') ? dashes + 1 : 0;
+         }
+      }
+      else
+      {
+         while ((c = tok.Get()) != EOF && c != '>') { }
+      }
+   }
+
+   tag.name.clear();
+   tag.attributes.clear();
+   tag.empty = false;
+   if (tok.Peek() == '/') { tag.name.push_back((char) tok.Get()); }
+   while ((c = tok.Peek()) != EOF && c != '>' && c != '/' &&
+          !StreamTokenizer::IsSpace(c))
+   {
+      tag.name.push_back((char) tok.Get());
+   }
+   for (;;)
+   {
+      tok.SkipSpace();
+      c = tok.Get();
+      if (c == '>') { break; }
+      if (c == '/')
+      {
+         tag.empty = true;
+         MFEM_VERIFY(tok.Get() == '>', "XML: invalid tag " << tag.name);
+         break;
+      }
+      MFEM_VERIFY(c != EOF, "XML: unexpected end of input");
+      std::string attr(1, (char) c), value;
+      while ((c = tok.Peek()) != EOF && c != '=' &&
+             !StreamTokenizer::IsSpace(c))
+      {
+         attr.push_back((char) tok.Get());
+      }
+      tok.SkipSpace();
+      MFEM_VERIFY(tok.Get() == '=', "XML: invalid attribute " << attr);
+      tok.SkipSpace();
+      const int quote = tok.Get();
+      MFEM_VERIFY(quote == '"' || quote == '\'',
+                  "XML: invalid attribute " << attr);
+      tok.ReadUntil((char) quote, value);
+      tok.Get();
+      tag.attributes.push_back(std::make_pair(attr, value));
+   }
+   return true;
+}
+
+// Properties of the binary data of a VTK XML file.
+struct VTKBinaryInfo
+{
+   bool swap;       // the byte order of the file differs from the machine's
+   int header_size; // size of the header entries: 4 (UInt32) or 8 (UInt64)
+   bool compressed; // zlib compression
+
+   // Return the entry k of the header h.
+   uint64_t HeaderEntry(const std::vector<char> &h, int k) const
+   {
+      char b[8];
+      MFEM_VERIFY((size_t) (k+1)*header_size <= h.size(),
+                  "VTK mesh : invalid binary data header");
+      std::memcpy(b, h.data() + k*header_size, header_size);
+      if (swap) { std::reverse(b, b + header_size); }
+      if (header_size == 4)
+      {
+         uint32_t val;
+         std::memcpy(&val, b, 4);
+         return val;
+      }
+      uint64_t val;
+      std::memcpy(&val, b, 8);
+      return val;
+   }
+
+   // Return the number of header entries, given the first entry.
+   int NumHeaderEntries(uint64_t first) const
+   {
+      // compressed: number of blocks, block size, size of the last block and
+      // the compressed sizes of the blocks; otherwise: the number of bytes
+      return compressed ? 3 + (int) first : 1;
+   }
+
+   // Extract the data, of total size 'size', described by the header h.
+   void Extract(const std::vector<char> &h, const char *data, size_t size,
+                std::vector<char> &bytes) const
+   {
+      if (!compressed)
+      {
+         const uint64_t nbytes = HeaderEntry(h, 0);
+         MFEM_VERIFY(nbytes <= size, "VTK mesh : invalid binary data");
+         bytes.assign(data, data + nbytes);
+         return;
+      }
+#ifdef MFEM_USE_ZLIB
+      const uint64_t nblocks = HeaderEntry(h, 0);
+      const uint64_t block_size = HeaderEntry(h, 1);
+      const uint64_t last_size = HeaderEntry(h, 2);
+      const uint64_t nbytes = (nblocks == 0) ? 0 :
+                              (nblocks-1)*block_size +
+                              (last_size ? last_size : block_size);
+      bytes.resize(nbytes);
+      size_t pos = 0, out = 0;
+      for (uint64_t b = 0; b < nblocks; b++)
+      {
+         const uint64_t csize = HeaderEntry(h, 3 + (int) b);
+         uLongf dsize = (b+1 < nblocks || !last_size) ? block_size : last_size;
+         MFEM_VERIFY(pos + csize <= size, "VTK mesh : invalid binary data");
+         const int err = uncompress((Bytef *) bytes.data() + out, &dsize,
+                                    (const Bytef *) data + pos, csize);
+         MFEM_VERIFY(err == Z_OK, "VTK mesh : zlib error " << err);
+         pos += csize;
+         out += dsize;
+      }
+      bytes.resize(out);
+#else
+      MFEM_ABORT("MFEM must be compiled with ZLib support to read compressed "
+                 "VTK data.");
+#endif
+   }
+
+   // Decode the base 64 binary data in the 'length' characters of src, into
+   // bytes. The header and the data are encoded separately, as written by VTK
+   // and by WriteVTKEncodedCompressed().
+   void DecodeBase64(const char *src, size_t length,
+                     std::vector<char> &bytes) const
+   {
+      std::vector<char> h, data;
+      const size_t first = bin_io::NumBase64Chars(3*header_size);
+      bin_io::DecodeBase64(src, std::min(length, first), h);
+      const int nh = NumHeaderEntries(HeaderEntry(h, 0));
+      h.clear();
+      const size_t hlen = bin_io::NumBase64Chars(nh*header_size);
+      const size_t pos = bin_io::DecodeBase64(src, std::min(length, hlen), h);
+      bin_io::DecodeBase64(src + pos, length - pos, data);
+      Extract(h, data.data(), data.size(), bytes);
+   }
+
+   // Extract the raw binary data from the tokenizer, into bytes. Returns the
+   // number of bytes extracted.
+   size_t ReadRaw(StreamTokenizer &tok, std::vector<char> &bytes) const
+   {
+      std::vector<char> h(header_size), data;
+      tok.ReadBinary(h.data(), header_size);
+      const int nh = NumHeaderEntries(HeaderEntry(h, 0));
+      h.resize(nh*header_size);
+      tok.ReadBinary(h.data() + header_size, (nh-1)*header_size);
+      size_t size = 0;
+      if (!compressed) { size = HeaderEntry(h, 0); }
+      for (int k = 3; compressed && k < nh; k++) { size += HeaderEntry(h, k); }
+      data.resize(size);
+      tok.ReadBinary(data.data(), size);
+      Extract(h, data.data(), size, bytes);
+      return h.size() + size;
+   }
+};
+
+// Return the size of the values of the VTK data type, or 0 if the type is not
+// supported.
+static int VTKTypeSize(const std::string &type)
+{
+   if (type == "Int8" || type == "UInt8") { return 1; }
+   if (type == "Int16" || type == "UInt16") { return 2; }
+   if (type == "Int32" || type == "UInt32" || type == "Float32") { return 4; }
+   if (type == "Int64" || type == "UInt64" || type == "Float64") { return 8; }
+   return 0;
+}
+
+template <typename S, typename T>
+static void ConvertVTKValues(const char *src, int n, bool swap, T *dst)
+{
+   char b[sizeof(S)];
+   for (int i = 0; i < n; i++)
+   {
+      std::memcpy(b, src + i*sizeof(S), sizeof(S));
+      if (swap) { std::reverse(b, b + sizeof(S)); }
+      S val;
+      std::memcpy(&val, b, sizeof(S));
+      dst[i] = static_cast<T>(val);
+   }
+}
+
+// DataArray of a VTK XML file, read into one of the arrays 'ints' or 'reals'.
+struct VTKDataArray
+{
+   std::string type;
+   size_t offset; // offset of appended data
+   Array<int> *ints;
+   Vector *reals;
+
+   // Convert the values in the given bytes.
+   template <typename T>
+   void Convert(const std::vector<char> &bytes, bool swap, T *dst) const
+   {
+      const char *src = bytes.data();
+      const int n = (int) (bytes.size()/VTKTypeSize(type));
+      if (type == "Int8") { ConvertVTKValues<int8_t>(src, n, swap, dst); }
+      else if (type == "UInt8")
+      { ConvertVTKValues<uint8_t>(src, n, swap, dst); }
+      else if (type == "Int16")
+      { ConvertVTKValues<int16_t>(src, n, swap, dst); }
+      else if (type == "UInt16")
+      { ConvertVTKValues<uint16_t>(src, n, swap, dst); }
+      else if (type == "Int32")
+      { ConvertVTKValues<int32_t>(src, n, swap, dst); }
+      else if (type == "UInt32")
+      { ConvertVTKValues<uint32_t>(src, n, swap, dst); }
+      else if (type == "Int64")
+      { ConvertVTKValues<int64_t>(src, n, swap, dst); }
+      else if (type == "UInt64")
+      { ConvertVTKValues<uint64_t>(src, n, swap, dst); }
+      else if (type == "Float32")
+      { ConvertVTKValues<float>(src, n, swap, dst); }
+      else { ConvertVTKValues<double>(src, n, swap, dst); }
+   }
+
+   void SetBinary(const std::vector<char> &bytes, bool swap) const
+   {
+      const int n = (int) (bytes.size()/VTKTypeSize(type));
+      if (ints) { ints->SetSize(n); Convert(bytes, swap, ints->GetData()); }
+      else { reals->SetSize(n); Convert(bytes, swap, reals->GetData()); }
+   }
+
+   void ReadASCII(StreamTokenizer &tok) const
+   {
+      Array<double> vals;
+      if (ints) { ints->SetSize(0); }
+      for (tok.SkipSpace(); tok.Peek() != '<' && tok.Peek() != EOF;
+           tok.SkipSpace())
+      {
+         if (ints) { ints->Append((int) tok.ReadInt()); }
+         else { vals.Append(tok.ReadDouble()); }
+      }
+      if (reals) { reals->SetSize(vals.Size()); vals.CopyTo(reals->GetData()); }
+   }
+
+   bool operator<(const VTKDataArray &other) const
+   { return offset < other.offset; }
+};
+
+// Merge the points of a VTK mesh with equal coordinates, e.g. in the output of
+// Mesh::PrintVTU() where every element has its own copies of its vertices,
+// and update the connectivity. The merged points keep the order of their
+// first occurrence.
+static void MergeVTKPoints(Vector &points, Array<int> &connectivity)
+{
+   const int np = points.Size()/3;
+   const double *x = points.GetData();
+   Array<int> order(np), id(np);
+   for (int i = 0; i < np; i++) { order[i] = i; }
+   std::sort(order.begin(), order.end(), [x](int a, int b)
+   {
+      for (int d = 0; d < 3; d++)
+      {
+         if (x[3*a+d] != x[3*b+d]) { return x[3*a+d] < x[3*b+d]; }
+      }
+      return a < b;
+   });
+   // the first point of every group of equal points represents the group
+   for (int k = 0, first = -1; k < np; k++)
+   {
+      const int a = order[k];
+      if (first < 0 || x[3*a] != x[3*first] || x[3*a+1] != x[3*first+1] ||
+          x[3*a+2] != x[3*first+2])
+      {
+         first = a;
+      }
+      id[a] = first;
+   }
+   int n = 0;
+   for (int i = 0; i < np; i++)
+   {
+      if (id[i] == i)
+      {
+         for (int d = 0; d < 3; d++) { points(3*n+d) = points(3*i+d); }
+         id[i] = n++;
+      }
+      else
+      {
+         id[i] = id[id[i]];
+      }
+   }
+   if (n == np) { return; }
+   points.SetSize(3*n);
+   for (int k = 0; k < connectivity.Size(); k++)
+   {
+      MFEM_VERIFY(connectivity[k] >= 0 && connectivity[k] < np,
+                  "VTK mesh : invalid connectivity");
+      connectivity[k] = id[connectivity[k]];
+   }
+}
+
+} // namespace mfem::internal
+
+void Mesh::ReadXML_VTKMesh(std::istream &input, int &curved, int &read_gf,
+                           bool &finalize_topo, const std::string &xml_tag)
+{
+   using namespace internal;
+
+   // The first line of the file, already extracted from the input, contains
+   // the XML declaration or the VTKFile tag.
+   XMLTag tag;
+   bool found = false;
+   {
+      std::istringstream first_line(xml_tag);
+      StreamTokenizer first_tok(first_line);
+      while (!found && ReadXMLTag(first_tok, tag))
+      {
+         found = (tag.name == "VTKFile");
+      }
+   }
+   StreamTokenizer tok(input);
+   while (!found && ReadXMLTag(tok, tag))
+   {
+      found = (tag.name == "VTKFile");
+   }
+   MFEM_VERIFY(found, "VTK mesh : VTKFile tag not found");
+   MFEM_VERIFY(tag.Get("type") == "UnstructuredGrid",
+               "VTK mesh : only UnstructuredGrid files are supported");
+
+   VTKBinaryInfo info;
+   info.swap = (tag.Get("byte_order", VTKByteOrder()) != VTKByteOrder());
+   info.header_size = (tag.Get("header_type", "UInt32") == "UInt64") ? 8 : 4;
+   const std::string compressor = tag.Get("compressor");
+   MFEM_VERIFY(compressor.empty() || compressor == "vtkZLibDataCompressor",
+               "VTK mesh : unsupported compressor " << compressor);
+   info.compressed = !compressor.empty();
+
+   Vector points;
+   Array<int> connectivity, offsets, cell_types, cell_attributes;
+   std::vector<VTKDataArray> appended;
+   std::vector<char> bytes;
+   std::string section, text;
+   int num_pieces = 0;
+   while (ReadXMLTag(tok, tag))
+   {
+      const std::string &name = tag.name;
+      if (name == "Piece")
+      {
+         MFEM_VERIFY(++num_pieces == 1,
+                     "VTK mesh : multiple pieces are not supported");
+      }
+      else if (name == "Points" || name == "Cells" || name == "PointData" ||
+               name == "CellData")
+      {
+         section = name;
+      }
+      else if (name == "DataArray")
+      {
+         VTKDataArray data = { tag.Get("type"), 0, NULL, NULL };
+         const std::string data_name = tag.Get("Name");
+         if (section == "Points") { data.reals = &points; }
+         else if (section == "Cells" && data_name == "connectivity")
+         {
+            data.ints = &connectivity;
+         }
+         else if (section == "Cells" && data_name == "offsets")
+         {
+            data.ints = &offsets;
+         }
+         else if (section == "Cells" && data_name == "types")
+         {
+            data.ints = &cell_types;
+         }
+         else if (section == "CellData" && data_name == "material")
+         {
+            data.ints = &cell_attributes;
+         }
+         if (!data.ints && !data.reals) { continue; } // not needed
+
+         MFEM_VERIFY(VTKTypeSize(data.type) > 0,
+                     "VTK mesh : unsupported data type " << data.type);
+         const std::string format = tag.Get("format");
+         if (format == "ascii")
+         {
+            data.ReadASCII(tok);
+         }
+         else if (format == "binary")
+         {
+            text.clear();
+            tok.SkipSpace();
+            tok.ReadUntil('<', text);
+            info.DecodeBase64(text.data(), text.size(), bytes);
+            data.SetBinary(bytes, info.swap);
+         }
+         else if (format == "appended")
+         {
+            data.offset = std::strtoull(tag.Get("offset").c_str(), NULL, 10);
+            appended.push_back(data);
+         }
+         else
+         {
+            MFEM_ABORT("VTK mesh : unsupported data format " << format);
+         }
+      }
+      else if (name == "AppendedData")
+      {
+         // The data, in the order of the offsets, follows the character '_'.
+         int c;
+         while ((c = tok.Get()) != '_')
+         {
+            MFEM_VERIFY(c != EOF, "VTK mesh : invalid AppendedData");
+         }
+         std::sort(appended.begin(), appended.end());
+         if (tag.Get("encoding", "raw") == "base64")
+         {
+            text.clear();
+            tok.ReadUntil('<', text);
+            for (size_t k = 0; k < appended.size(); k++)
+            {
+               const size_t begin = appended[k].offset;
+               const size_t end = (k+1 < appended.size()) ?
+                                  appended[k+1].offset : text.size();
+               MFEM_VERIFY(begin <= end && end <= text.size(),
+                           "VTK mesh : invalid AppendedData offsets");
+               info.DecodeBase64(text.data() + begin, end - begin, bytes);
+               appended[k].SetBinary(bytes, info.swap);
+            }
+         }
+         else
+         {
+            size_t pos = 0;
+            for (size_t k = 0; k < appended.size(); k++)
+            {
+               MFEM_VERIFY(appended[k].offset >= pos,
+                           "VTK mesh : invalid AppendedData offsets");
+               tok.Skip(appended[k].offset - pos);
+               pos = appended[k].offset + info.ReadRaw(tok, bytes);
+               appended[k].SetBinary(bytes, info.swap);
+            }
+         }
+         appended.clear();
+         break; // the appended data is at the end of the file
+      }
+      else if (name == "/VTKFile")
+      {
+         break;
+      }
+   }
+   MFEM_VERIFY(appended.empty(), "VTK mesh : AppendedData not found");
+   MFEM_VERIFY(points.Size() % 3 == 0, "VTK mesh : invalid Points data");
+   MFEM_VERIFY(offsets.Size() == cell_types.Size(),
+               "VTK mesh : invalid Cells data");
+
+   // VTK stores the end offset of every cell
+   Array<int> cell_offsets(offsets.Size() + 1);
+   cell_offsets[0] = 0;
+   for (int i = 0; i < offsets.Size(); i++)
+   {
+      cell_offsets[i+1] = offsets[i];
+   }
+   MFEM_VERIFY(cell_offsets.Last() <= connectivity.Size(),
+               "VTK mesh : invalid Cells data");
+   MergeVTKPoints(points, connectivity);
+
+   CreateVTKMesh(points, connectivity, cell_offsets, cell_types,
+                 cell_attributes, curved, read_gf, finalize_topo);
+}
+
+void Mesh::ReadNURBSMesh(std::istream &input, int &curved, int &read_gf)
+{
+   NURBSext = new NURBSExtension(input);
+
+   Dim              = NURBSext->Dimension();
+   NumOfVertices    = NURBSext->GetNV();
+   NumOfElements    = NURBSext->GetNE();
+   NumOfBdrElements = NURBSext->GetNBE();
+
+   NURBSext->GetElementTopo(elements);
+   NURBSext->GetBdrElementTopo(boundary);
+
+   vertices.SetSize(NumOfVertices);
+   curved = 1;
+   if (NURBSext->HavePatches())
+   {
+      NURBSFECollection  *fec = new NURBSFECollection(NURBSext->GetOrder());
+      FiniteElementSpace *fes = new FiniteElementSpace(this, fec, Dim,
+                                                       Ordering::byVDIM);
+      Nodes = new GridFunction(fes);
+      Nodes->MakeOwner(fec);
+      NURBSext->SetCoordsFromPatches(*Nodes);
+      own_nodes = 1;
+      read_gf = 0;
+      int vd = Nodes->VectorDim();
+      for (int i = 0; i < vd; i++)
+      {
+         Vector vert_val;
+         Nodes->GetNodalValues(vert_val, i+1);
+         for (int j = 0; j < NumOfVertices; j++)
+         {
+            vertices[j](i) = vert_val(j);
+         }
+      }
+   }
+   else
+   {
+      read_gf = 1;
+   }
+}
+
+void Mesh::ReadInlineMesh(std::istream &input, bool generate_edges)
+{
+   // Initialize to negative numbers so that we know if they've been set.  We're
+   // using Element::POINT as our flag, since we're not going to make a 0D mesh,
+   // ever.
+   int nx = -1;
+   int ny = -1;
+   int nz = -1;
+   double sx = -1.0;
+   double sy = -1.0;
+   double sz = -1.0;
+   Element::Type type = Element::POINT;
+
+   while (true)
+   {
+      skip_comment_lines(input, '#');
+      // Break out if we reached the end of the file after gobbling up the
+      // whitespace and comments after the last keyword.
+      if (!input.good())
+      {
+         break;
+      }
+
+      // Read the next keyword
+      std::string name;
       input >> name;
       input >> std::ws;
       // Make sure there's an equal sign
@@ -887,483 +1622,672 @@ void Mesh::ReadInlineMesh(std::istream &input, bool generate_edges)
    }
 }
 
-void Mesh::ReadGmshMesh(std::istream &input, int &curved, int &read_gf)
+namespace internal
 {
-   string buff;
-   double version;
-   int binary, dsize;
-   input >> version >> binary >> dsize;
-   if (version < 2.2)
+
+// Number of nodes of the Gmsh element types, type is the index of the array + 1
+static const int gmsh_num_nodes[] =
+{
+   2, // 2-node line.
+   3, // 3-node triangle.
+   4, // 4-node quadrangle.
+   4, // 4-node tetrahedron.
+   8, // 8-node hexahedron.
+   6, // 6-node prism.
+   5, // 5-node pyramid.
+   3, /* 3-node second order line (2 nodes associated with the vertices and 1
+         with the edge). */
+   6, /* 6-node second order triangle (3 nodes associated with the vertices
+         and 3 with the edges). */
+   9, /* 9-node second order quadrangle (4 nodes associated with the vertices,
+         4 with the edges and 1 with the face). */
+   10,/* 10-node second order tetrahedron (4 nodes associated with the
+         vertices and 6 with the edges). */
+   27,/* 27-node second order hexahedron (8 nodes associated with the vertices,
+         12 with the edges, 6 with the faces and 1 with the volume). */
+   18,/* 18-node second order prism (6 nodes associated with the vertices, 9
+         with the edges and 3 with the quadrangular faces). */
+   14,/* 14-node second order pyramid (5 nodes associated with the vertices, 8
+         with the edges and 1 with the quadrangular face). */
+   1, // 1-node point.
+   8, /* 8-node second order quadrangle (4 nodes associated with the vertices
+         and 4 with the edges). */
+   20,/* 20-node second order hexahedron (8 nodes associated with the vertices
+         and 12 with the edges). */
+   15,/* 15-node second order prism (6 nodes associated with the vertices and
+         9 with the edges). */
+   13,/* 13-node second order pyramid (5 nodes associated with the vertices
+         and 8 with the edges). */
+   9, /* 9-node third order incomplete triangle (3 nodes associated with the
+         vertices, 6 with the edges) */
+   10,/* 10-node third order triangle (3 nodes associated with the vertices, 6
+         with the edges, 1 with the face) */
+   12,/* 12-node fourth order incomplete triangle (3 nodes associated with the
+         vertices, 9 with the edges) */
+   15,/* 15-node fourth order triangle (3 nodes associated with the vertices, 9
+         with the edges, 3 with the face) */
+   15,/* 15-node fifth order incomplete triangle (3 nodes associated with the
+         vertices, 12 with the edges) */
+   21,/* 21-node fifth order complete triangle (3 nodes associated with the
+         vertices, 12 with the edges, 6 with the face) */
+   4, /* 4-node third order edge (2 nodes associated with the vertices, 2
+         internal to the edge) */
+   5, /* 5-node fourth order edge (2 nodes associated with the vertices, 3
+         internal to the edge) */
+   6, /* 6-node fifth order edge (2 nodes associated with the vertices, 4
+         internal to the edge) */
+   20 /* 20-node third order tetrahedron (4 nodes associated with the vertices,
+         12 with the edges, 4 with the faces) */
+};
+
+static int GmshNumNodes(int type)
+{
+   const int num_types = sizeof(gmsh_num_nodes)/sizeof(gmsh_num_nodes[0]);
+   MFEM_VERIFY(type >= 1 && type <= num_types,
+               "Gmsh file : unknown element type " << type);
+   return gmsh_num_nodes[type-1];
+}
+
+// Geometry of the Gmsh element types supported by MFEM, Geometry::INVALID for
+// the other types.
+static Geometry::Type GmshGeometry(int type)
+{
+   switch (type)
    {
-      MFEM_ABORT("Gmsh file version < 2.2");
+      case 1: return Geometry::SEGMENT;      // 2-node line
+      case 2: return Geometry::TRIANGLE;     // 3-node triangle
+      case 3: return Geometry::SQUARE;       // 4-node quadrangle
+      case 4: return Geometry::TETRAHEDRON;  // 4-node tetrahedron
+      case 5: return Geometry::CUBE;         // 8-node hexahedron
+      case 6: return Geometry::PRISM;        // 6-node prism
+      case 15: return Geometry::POINT;       // 1-node point
+      default: return Geometry::INVALID;
    }
-   if (dsize != sizeof(double))
-   {
-      MFEM_ABORT("Gmsh file : dsize != sizeof(double)");
+}
+
+// Binary Gmsh files store 'int' values with 4 bytes and, in the MSH 4.1
+// format, 'size_t' values with 8 bytes.
+static long long GmshReadInt(StreamTokenizer &tok, bool binary)
+{
+   if (!binary) { return tok.ReadInt(); }
+   int32_t val;
+   tok.ReadBinary(&val, sizeof(val));
+   return val;
+}
+
+static long long GmshReadSize(StreamTokenizer &tok, bool binary)
+{
+   if (!binary) { return tok.ReadInt(); }
+   uint64_t val;
+   tok.ReadBinary(&val, sizeof(val));
+   return (long long) val;
+}
+
+static double GmshReadDouble(StreamTokenizer &tok, bool binary)
+{
+   if (!binary) { return tok.ReadDouble(); }
+   double val;
+   tok.ReadBinary(&val, sizeof(val));
+   return val;
+}
+
+// Map from the node tags of a Gmsh file to the vertex indices. The tags are
+// usually (nearly) contiguous and the map is a dense array; otherwise, it is a
+// sorted array of (tag, index) pairs.
+class GmshNodeMap
+{
+protected:
+   int min_tag;
+   Array<int> dense;
+   Array<Pair<int, int> > sorted;
+
+public:
+   GmshNodeMap() : min_tag(0) { }
+
+   void Make(const Array<int> &tags)
+   {
+      dense.DeleteAll();
+      sorted.DeleteAll();
+      if (tags.Size() == 0) { return; }
+      min_tag = tags.Min();
+      const long long range = (long long) tags.Max() - min_tag + 1;
+      if (range <= 2*(long long) tags.Size() + 1024)
+      {
+         dense.SetSize((int) range);
+         dense = -1;
+         for (int i = 0; i < tags.Size(); i++)
+         {
+            int &v = dense[tags[i] - min_tag];
+            MFEM_VERIFY(v == -1, "Gmsh file : vertices indices are not unique");
+            v = i;
+         }
+      }
+      else
+      {
+         sorted.SetSize(tags.Size());
+         for (int i = 0; i < tags.Size(); i++)
+         {
+            sorted[i] = Pair<int, int>(tags[i], i);
+         }
+         SortPairs<int, int>(sorted, sorted.Size());
+         for (int i = 1; i < sorted.Size(); i++)
+         {
+            MFEM_VERIFY(sorted[i].one != sorted[i-1].one,
+                        "Gmsh file : vertices indices are not unique");
+         }
+      }
    }
-   getline(input, buff);
-   // There is a number 1 in binary format
-   if (binary)
+
+   // Return the vertex index of the node with the given tag.
+   int operator()(long long tag) const
    {
-      int one;
-      input.read(reinterpret_cast<char*>(&one), sizeof(one));
-      if (one != 1)
+      int v = -1;
+      if (dense.Size() > 0)
       {
-         MFEM_ABORT("Gmsh file : wrong binary format");
+         const long long k = tag - min_tag;
+         if (k >= 0 && k < dense.Size()) { v = dense[(int) k]; }
       }
+      else if (sorted.Size() > 0)
+      {
+         const Pair<int, int> *p =
+            std::lower_bound(sorted.begin(), sorted.end(),
+                             Pair<int, int>((int) tag, 0));
+         if (p != sorted.end() && p->one == tag) { v = p->two; }
+      }
+      MFEM_VERIFY(v >= 0, "Gmsh file : vertex index doesn't exist");
+      return v;
    }
+};
 
-   // A map between a serial number of the vertex and its number in the file
-   // (there may be gaps in the numbering, and also Gmsh enumerates vertices
-   // starting from 1, not 0)
-   map<int, int> vertices_map;
-   // Read the lines of the mesh file. If we face specific keyword, we'll treat
-   // the section.
-   while (input >> buff)
+// Elements read from a Gmsh file, sorted by dimension.
+struct GmshElements
+{
+   CompactElementArray elems[4];
+   int num_unsupported;
+
+   GmshElements() : num_unsupported(0) { }
+
+   // Reserve space for n more elements of the given type.
+   void Reserve(int type, long long n)
    {
-      if (buff == "$Nodes") // reading mesh vertices
+      const Geometry::Type geom = GmshGeometry(type);
+      if (geom == Geometry::INVALID) { return; }
+      CompactElementArray &e = elems[Geometry::Dimension[geom]];
+      e.Reserve(e.Size() + (int) n,
+                e.GetIndices().Size() + (int) n*Geometry::NumVerts[geom]);
+   }
+
+   // Add an element of the given type, with the given node tags.
+   template <typename T>
+   void Add(int type, const T *nodes, long long attr, const GmshNodeMap &map)
+   {
+      const Geometry::Type geom = GmshGeometry(type);
+      if (geom == Geometry::INVALID) { num_unsupported++; return; }
+      // non-positive attributes are not allowed in MFEM
+      MFEM_VERIFY(attr > 0, "Non-positive element attribute in Gmsh mesh!");
+      int v[8];
+      const int nv = Geometry::NumVerts[geom];
+      for (int i = 0; i < nv; i++) { v[i] = map((long long) nodes[i]); }
+      elems[Geometry::Dimension[geom]].Append(geom, v, (int) attr);
+   }
+};
+
+// Attributes of the entities of a Gmsh MSH 4.1 file: the first physical tag of
+// an entity, or its tag if it has no physical tags.
+struct GmshEntities
+{
+   std::map<int, int> phys[4];
+
+   int Attribute(int dim, int tag) const
+   {
+      std::map<int, int>::const_iterator it = phys[dim].find(tag);
+      return (it != phys[dim].end()) ? it->second : tag;
+   }
+};
+
+static void ReadGmshEntities(StreamTokenizer &tok, bool binary,
+                             GmshEntities &entities)
+{
+   long long num[4];
+   for (int d = 0; d < 4; d++) { num[d] = GmshReadSize(tok, binary); }
+   for (int d = 0; d < 4; d++)
+   {
+      for (long long i = 0; i < num[d]; i++)
       {
-         input >> NumOfVertices;
-         getline(input, buff);
-         vertices.SetSize(NumOfVertices);
-         int serial_number;
-         const int gmsh_dim = 3; // Gmsh always outputs 3 coordinates
-         double coord[gmsh_dim];
-         for (int ver = 0; ver < NumOfVertices; ++ver)
+         const int tag = (int) GmshReadInt(tok, binary);
+         // point coordinates or bounding box
+         for (int k = 0; k < (d == 0 ? 3 : 6); k++)
+         {
+            GmshReadDouble(tok, binary);
+         }
+         const long long num_phys = GmshReadSize(tok, binary);
+         for (long long k = 0; k < num_phys; k++)
+         {
+            const int phys_tag = (int) GmshReadInt(tok, binary);
+            if (k == 0) { entities.phys[d][tag] = phys_tag; }
+         }
+         if (d > 0)
          {
-            if (binary)
+            // bounding entities
+            const long long num_bdr = GmshReadSize(tok, binary);
+            for (long long k = 0; k < num_bdr; k++)
             {
-               input.read(reinterpret_cast<char*>(&serial_number), sizeof(int));
-               input.read(reinterpret_cast<char*>(coord), gmsh_dim*sizeof(double));
+               GmshReadInt(tok, binary);
             }
-            else // ASCII
-            {
-               input >> serial_number;
-               for (int ci = 0; ci < gmsh_dim; ++ci)
-               {
-                  input >> coord[ci];
-               }
-            }
-            vertices[ver] = Vertex(coord, gmsh_dim);
-            vertices_map[serial_number] = ver;
          }
-         if (static_cast<int>(vertices_map.size()) != NumOfVertices)
+      }
+   }
+}
+
+// Read the nodes of a MSH 2.2 file.
+static void ReadGmshNodes22(StreamTokenizer &tok, bool binary,
+                            Array<Vertex> &vertices, Array<int> &tags)
+{
+   // the number of nodes is in ASCII format, also in binary files
+   const int num_nodes = (int) tok.ReadInt();
+   tok.SkipLine();
+   vertices.SetSize(num_nodes);
+   tags.SetSize(num_nodes);
+   if (binary)
+   {
+      // every node is stored as an int tag followed by 3 double coordinates
+      const int rec = sizeof(int32_t) + 3*sizeof(double);
+      const int chunk = 4096;
+      std::vector<char> buf(chunk*rec);
+      for (int i = 0; i < num_nodes; i += chunk)
+      {
+         const int n = std::min(chunk, num_nodes - i);
+         tok.ReadBinary(buf.data(), n*rec);
+         for (int k = 0; k < n; k++)
          {
-            MFEM_ABORT("Gmsh file : vertices indices are not unique");
+            int32_t tag;
+            std::memcpy(&tag, &buf[k*rec], sizeof(tag));
+            tags[i+k] = tag;
+            std::memcpy(vertices[i+k](), &buf[k*rec + sizeof(tag)],
+                        3*sizeof(double));
          }
-      } // section '$Nodes'
-      else if (buff == "$Elements") // reading mesh elements
+      }
+   }
+   else
+   {
+      for (int i = 0; i < num_nodes; i++)
       {
-         int num_of_all_elements;
-         input >> num_of_all_elements;
-         // = NumOfElements + NumOfBdrElements + (maybe, PhysicalPoints)
-         getline(input, buff);
-
-         int serial_number; // serial number of an element
-         int type_of_element; // ID describing a type of a mesh element
-         int n_tags; // number of different tags describing an element
-         int phys_domain; // element's attribute
-         int elem_domain; // another element's attribute (rarely used)
-         int n_partitions; // number of partitions where an element takes place
-
-         // number of nodes for each type of Gmsh elements, type is the index of
-         // the array + 1
-         int nodes_of_gmsh_element[] =
-         {
-            2, // 2-node line.
-            3, // 3-node triangle.
-            4, // 4-node quadrangle.
-            4, // 4-node tetrahedron.
-            8, // 8-node hexahedron.
-            6, // 6-node prism.
-            5, // 5-node pyramid.
-            3, /* 3-node second order line (2 nodes associated with the vertices
-                    and 1 with the edge). */
-            6, /* 6-node second order triangle (3 nodes associated with the
-                    vertices and 3 with the edges). */
-            9, /* 9-node second order quadrangle (4 nodes associated with the
-                    vertices, 4 with the edges and 1 with the face). */
-            10,/* 10-node second order tetrahedron (4 nodes associated with the
-                     vertices and 6 with the edges). */
-            27,/* 27-node second order hexahedron (8 nodes associated with the
-                     vertices, 12 with the edges, 6 with the faces and 1 with
-                     the volume). */
-            18,/* 18-node second order prism (6 nodes associated with the
-                     vertices, 9 with the edges and 3 with the quadrangular
-                     faces). */
-            14,/* 14-node second order pyramid (5 nodes associated with the
-                     vertices, 8 with the edges and 1 with the quadrangular
-                     face). */
-            1, // 1-node point.
-            8, /* 8-node second order quadrangle (4 nodes associated with the
-                    vertices and 4 with the edges). */
-            20,/* 20-node second order hexahedron (8 nodes associated with the
-                     vertices and 12 with the edges). */
-            15,/* 15-node second order prism (6 nodes associated with the
-                     vertices and 9 with the edges). */
-            13,/* 13-node second order pyramid (5 nodes associated with the
-                     vertices and 8 with the edges). */
-            9, /* 9-node third order incomplete triangle (3 nodes associated
-                    with the vertices, 6 with the edges) */
-            10,/* 10-node third order triangle (3 nodes associated with the
-                     vertices, 6 with the edges, 1 with the face) */
-            12,/* 12-node fourth order incomplete triangle (3 nodes associated
-                     with the vertices, 9 with the edges) */
-            15,/* 15-node fourth order triangle (3 nodes associated with the
-                     vertices, 9 with the edges, 3 with the face) */
-            15,/* 15-node fifth order incomplete triangle (3 nodes associated
-                     with the vertices, 12 with the edges) */
-            21,/* 21-node fifth order complete triangle (3 nodes associated with
-                     the vertices, 12 with the edges, 6 with the face) */
-            4, /* 4-node third order edge (2 nodes associated with the vertices,
-                    2 internal to the edge) */
-            5, /* 5-node fourth order edge (2 nodes associated with the
-                    vertices, 3 internal to the edge) */
-            6, /* 6-node fifth order edge (2 nodes associated with the vertices,
-                    4 internal to the edge) */
-            20 /* 20-node third order tetrahedron (4 nodes associated with the
-                     vertices, 12 with the edges, 4 with the faces) */
-         };
-
-         vector<Element*> elements_0D, elements_1D, elements_2D, elements_3D;
-         elements_0D.reserve(num_of_all_elements);
-         elements_1D.reserve(num_of_all_elements);
-         elements_2D.reserve(num_of_all_elements);
-         elements_3D.reserve(num_of_all_elements);
-
-         if (binary)
-         {
-            int n_elem_part = 0; // partial sum of elements that are read
-            const int header_size = 3;
-            // header consists of 3 numbers: type of the element, number of
-            // elements of this type, and number of tags
-            int header[header_size];
-            int n_elem_one_type; // number of elements of a specific type
-
-            while (n_elem_part < num_of_all_elements)
-            {
-               input.read(reinterpret_cast<char*>(header),
-                          header_size*sizeof(int));
-               type_of_element = header[0];
-               n_elem_one_type = header[1];
-               n_tags          = header[2];
-
-               n_elem_part += n_elem_one_type;
+         tags[i] = (int) tok.ReadInt();
+         for (int d = 0; d < 3; d++) { vertices[i](d) = tok.ReadDouble(); }
+      }
+   }
+}
 
-               const int n_elem_nodes = nodes_of_gmsh_element[type_of_element-1];
-               vector<int> data(1+n_tags+n_elem_nodes);
-               for (int el = 0; el < n_elem_one_type; ++el)
-               {
-                  input.read(reinterpret_cast<char*>(&data[0]),
-                             data.size()*sizeof(int));
-                  int dd = 0; // index for data array
-                  serial_number = data[dd++];
-                  // physical domain - the most important value (to distinguish
-                  // materials with different properties)
-                  phys_domain = (n_tags > 0) ? data[dd++] : 1;
-                  // elementary domain - to distinguish different geometrical
-                  // domains (typically, it's used rarely)
-                  elem_domain = (n_tags > 1) ? data[dd++] : 0;
-                  // the number of tags is bigger than 2 if there are some
-                  // partitions (domain decompositions)
-                  n_partitions = (n_tags > 2) ? data[dd++] : 0;
-                  // we currently just skip the partitions if they exist, and go
-                  // directly to vertices describing the mesh element
-                  vector<int> vert_indices(n_elem_nodes);
-                  for (int vi = 0; vi < n_elem_nodes; ++vi)
-                  {
-                     map<int, int>::const_iterator it =
-                        vertices_map.find(data[1+n_tags+vi]);
-                     if (it == vertices_map.end())
-                     {
-                        MFEM_ABORT("Gmsh file : vertex index doesn't exist");
-                     }
-                     vert_indices[vi] = it->second;
-                  }
-
-                  // non-positive attributes are not allowed in MFEM
-                  if (phys_domain <= 0)
-                  {
-                     MFEM_ABORT("Non-positive element attribute in Gmsh mesh!");
-                  }
-
-                  // initialize the mesh element
-                  switch (type_of_element)
-                  {
-                     case 1: // 2-node line
-                     {
-                        elements_1D.push_back(
-                           new Segment(&vert_indices[0], phys_domain));
-                        break;
-                     }
-                     case 2: // 3-node triangle
-                     {
-                        elements_2D.push_back(
-                           new Triangle(&vert_indices[0], phys_domain));
-                        break;
-                     }
-                     case 3: // 4-node quadrangle
-                     {
-                        elements_2D.push_back(
-                           new Quadrilateral(&vert_indices[0], phys_domain));
-                        break;
-                     }
-                     case 4: // 4-node tetrahedron
-                     {
-#ifdef MFEM_USE_MEMALLOC
-                        elements_3D.push_back(TetMemory.Alloc());
-                        elements_3D.back()->SetVertices(&vert_indices[0]);
-                        elements_3D.back()->SetAttribute(phys_domain);
-#else
-                        elements_3D.push_back(
-                           new Tetrahedron(&vert_indices[0], phys_domain));
-#endif
-                        break;
-                     }
-                     case 5: // 8-node hexahedron
-                     {
-                        elements_3D.push_back(
-                           new Hexahedron(&vert_indices[0], phys_domain));
-                        break;
-                     }
-                     case 15: // 1-node point
-                     {
-                        elements_0D.push_back(
-                           new Point(&vert_indices[0], phys_domain));
-                        break;
-                     }
-                     default: // any other element
-                        MFEM_WARNING("Unsupported Gmsh element type.");
-                        break;
-
-                  } // switch (type_of_element)
-               } // el (elements of one type)
-            } // all elements
-         } // if binary
-         else // ASCII
-         {
-            for (int el = 0; el < num_of_all_elements; ++el)
+// Read the nodes of a MSH 4.1 file, given in blocks by entity.
+static void ReadGmshNodes41(StreamTokenizer &tok, bool binary,
+                            Array<Vertex> &vertices, Array<int> &tags)
+{
+   const long long num_blocks = GmshReadSize(tok, binary);
+   const int num_nodes = (int) GmshReadSize(tok, binary);
+   GmshReadSize(tok, binary); // minimum node tag
+   GmshReadSize(tok, binary); // maximum node tag
+   vertices.SetSize(num_nodes);
+   tags.SetSize(num_nodes);
+   std::vector<uint64_t> buf;
+   int idx = 0;
+   for (long long b = 0; b < num_blocks; b++)
+   {
+      const int entity_dim = (int) GmshReadInt(tok, binary);
+      GmshReadInt(tok, binary); // entity tag
+      const int parametric = (int) GmshReadInt(tok, binary);
+      const int n = (int) GmshReadSize(tok, binary);
+      MFEM_VERIFY(idx + n <= num_nodes, "Gmsh file : invalid $Nodes section");
+      if (binary)
+      {
+         buf.resize(n);
+         tok.ReadBinary(buf.data(), n*sizeof(uint64_t));
+         for (int k = 0; k < n; k++) { tags[idx+k] = (int) buf[k]; }
+      }
+      else
+      {
+         for (int k = 0; k < n; k++) { tags[idx+k] = (int) tok.ReadInt(); }
+      }
+      // the parametric coordinates follow the coordinates of every node
+      const int num_param = parametric ? entity_dim : 0;
+      if (binary && num_param == 0)
+      {
+         tok.ReadBinary(vertices[idx](), n*3*sizeof(double));
+      }
+      else
+      {
+         for (int k = 0; k < n; k++)
+         {
+            for (int d = 0; d < 3; d++)
             {
-               input >> serial_number >> type_of_element >> n_tags;
-               vector<int> data(n_tags);
-               for (int i = 0; i < n_tags; ++i) { input >> data[i]; }
-               // physical domain - the most important value (to distinguish
-               // materials with different properties)
-               phys_domain = (n_tags > 0) ? data[0] : 1;
-               // elementary domain - to distinguish different geometrical
-               // domains (typically, it's used rarely)
-               elem_domain = (n_tags > 1) ? data[1] : 0;
-               // the number of tags is bigger than 2 if there are some
-               // partitions (domain decompositions)
-               n_partitions = (n_tags > 2) ? data[2] : 0;
-               // we currently just skip the partitions if they exist, and go
-               // directly to vertices describing the mesh element
-               const int n_elem_nodes = nodes_of_gmsh_element[type_of_element-1];
-               vector<int> vert_indices(n_elem_nodes);
-               int index;
-               for (int vi = 0; vi < n_elem_nodes; ++vi)
-               {
-                  input >> index;
-                  map<int, int>::const_iterator it = vertices_map.find(index);
-                  if (it == vertices_map.end())
-                  {
-                     MFEM_ABORT("Gmsh file : vertex index doesn't exist");
-                  }
-                  vert_indices[vi] = it->second;
-               }
+               vertices[idx+k](d) = GmshReadDouble(tok, binary);
+            }
+            for (int d = 0; d < num_param; d++) { GmshReadDouble(tok, binary); }
+         }
+      }
+      idx += n;
+   }
+   MFEM_VERIFY(idx == num_nodes, "Gmsh file : invalid $Nodes section");
+}
 
-               // non-positive attributes are not allowed in MFEM
-               if (phys_domain <= 0)
-               {
-                  MFEM_ABORT("Non-positive element attribute in Gmsh mesh!");
-               }
+// Read the elements of a MSH 2.2 file.
+static void ReadGmshElements22(StreamTokenizer &tok, bool binary,
+                               const GmshNodeMap &node_map,
+                               GmshElements &elements)
+{
+   // = NumOfElements + NumOfBdrElements + (maybe, PhysicalPoints)
+   const long long num_elements = tok.ReadInt();
+   tok.SkipLine();
 
-               // initialize the mesh element
-               switch (type_of_element)
-               {
-                  case 1: // 2-node line
-                  {
-                     elements_1D.push_back(
-                        new Segment(&vert_indices[0], phys_domain));
-                     break;
-                  }
-                  case 2: // 3-node triangle
-                  {
-                     elements_2D.push_back(
-                        new Triangle(&vert_indices[0], phys_domain));
-                     break;
-                  }
-                  case 3: // 4-node quadrangle
-                  {
-                     elements_2D.push_back(
-                        new Quadrilateral(&vert_indices[0], phys_domain));
-                     break;
-                  }
-                  case 4: // 4-node tetrahedron
-                  {
-#ifdef MFEM_USE_MEMALLOC
-                     elements_3D.push_back(TetMemory.Alloc());
-                     elements_3D.back()->SetVertices(&vert_indices[0]);
-                     elements_3D.back()->SetAttribute(phys_domain);
-#else
-                     elements_3D.push_back(
-                        new Tetrahedron(&vert_indices[0], phys_domain));
-#endif
-                     break;
-                  }
-                  case 5: // 8-node hexahedron
-                  {
-                     elements_3D.push_back(
-                        new Hexahedron(&vert_indices[0], phys_domain));
-                     break;
-                  }
-                  case 15: // 1-node point
-                  {
-                     elements_0D.push_back(
-                        new Point(&vert_indices[0], phys_domain));
-                     break;
-                  }
-                  default: // any other element
-                     MFEM_WARNING("Unsupported Gmsh element type.");
-                     break;
-
-               } // switch (type_of_element)
-            } // el (all elements)
-         } // if ASCII
-
-         if (!elements_3D.empty())
-         {
-            Dim = 3;
-            NumOfElements = elements_3D.size();
-            elements.SetSize(NumOfElements);
-            for (int el = 0; el < NumOfElements; ++el)
-            {
-               elements[el] = elements_3D[el];
-            }
-            NumOfBdrElements = elements_2D.size();
-            boundary.SetSize(NumOfBdrElements);
-            for (int el = 0; el < NumOfBdrElements; ++el)
-            {
-               boundary[el] = elements_2D[el];
-            }
-            // discard other elements
-            for (size_t el = 0; el < elements_1D.size(); ++el)
-            {
-               delete elements_1D[el];
-            }
-            for (size_t el = 0; el < elements_0D.size(); ++el)
+   long long nodes[32];
+   if (binary)
+   {
+      // blocks of elements of the same type, with a header consisting of the
+      // type of the elements, the number of elements and the number of tags
+      std::vector<int32_t> buf;
+      for (long long n = 0; n < num_elements; )
+      {
+         int32_t header[3];
+         tok.ReadBinary(header, sizeof(header));
+         const int type = header[0], num_tags = header[2];
+         const int num = GmshNumNodes(type);
+         const int rec = 1 + num_tags + num;
+         const int chunk = 4096;
+         elements.Reserve(type, header[1]);
+         buf.resize(chunk*rec);
+         for (int el = 0; el < header[1]; el += chunk)
+         {
+            const int count = std::min(chunk, header[1] - el);
+            tok.ReadBinary(buf.data(), count*rec*sizeof(int32_t));
+            for (int k = 0; k < count; k++)
             {
-               delete elements_0D[el];
+               const int32_t *data = &buf[k*rec];
+               // the physical domain (the first tag) is the attribute
+               elements.Add(type, data + 1 + num_tags,
+                            num_tags > 0 ? data[1] : 1, node_map);
             }
          }
-         else if (!elements_2D.empty())
+         n += header[1];
+      }
+   }
+   else
+   {
+      for (long long el = 0; el < num_elements; el++)
+      {
+         tok.ReadInt(); // serial number
+         const int type = (int) tok.ReadInt();
+         const int num_tags = (int) tok.ReadInt();
+         // the physical domain (the first tag) is the attribute; the other
+         // tags (elementary domain, partitions) are skipped
+         long long attr = 1;
+         for (int k = 0; k < num_tags; k++)
          {
-            Dim = 2;
-            NumOfElements = elements_2D.size();
-            elements.SetSize(NumOfElements);
-            for (int el = 0; el < NumOfElements; ++el)
-            {
-               elements[el] = elements_2D[el];
-            }
-            NumOfBdrElements = elements_1D.size();
-            boundary.SetSize(NumOfBdrElements);
-            for (int el = 0; el < NumOfBdrElements; ++el)
-            {
-               boundary[el] = elements_1D[el];
-            }
-            // discard other elements
-            for (size_t el = 0; el < elements_0D.size(); ++el)
-            {
-               delete elements_0D[el];
-            }
+            const long long tag = tok.ReadInt();
+            if (k == 0) { attr = tag; }
          }
-         else if (!elements_1D.empty())
+         const int num = GmshNumNodes(type);
+         for (int k = 0; k < num; k++) { nodes[k] = tok.ReadInt(); }
+         elements.Add(type, nodes, attr, node_map);
+      }
+   }
+}
+
+// Read the elements of a MSH 4.1 file, given in blocks by entity.
+static void ReadGmshElements41(StreamTokenizer &tok, bool binary,
+                               const GmshNodeMap &node_map,
+                               const GmshEntities &entities,
+                               GmshElements &elements)
+{
+   const long long num_blocks = GmshReadSize(tok, binary);
+   GmshReadSize(tok, binary); // number of elements
+   GmshReadSize(tok, binary); // minimum element tag
+   GmshReadSize(tok, binary); // maximum element tag
+
+   long long nodes[32];
+   std::vector<uint64_t> buf;
+   for (long long b = 0; b < num_blocks; b++)
+   {
+      const int entity_dim = (int) GmshReadInt(tok, binary);
+      const int entity_tag = (int) GmshReadInt(tok, binary);
+      const int type = (int) GmshReadInt(tok, binary);
+      const long long n = GmshReadSize(tok, binary);
+      MFEM_VERIFY(entity_dim >= 0 && entity_dim <= 3,
+                  "Gmsh file : invalid $Elements section");
+      const int attr = entities.Attribute(entity_dim, entity_tag);
+      const int num = GmshNumNodes(type);
+      elements.Reserve(type, n);
+      if (binary)
+      {
+         // every element is stored as its tag followed by its node tags
+         const int rec = 1 + num;
+         const long long chunk = 4096;
+         buf.resize(chunk*rec);
+         for (long long el = 0; el < n; el += chunk)
          {
-            Dim = 1;
-            NumOfElements = elements_1D.size();
-            elements.SetSize(NumOfElements);
-            for (int el = 0; el < NumOfElements; ++el)
-            {
-               elements[el] = elements_1D[el];
-            }
-            NumOfBdrElements = elements_0D.size();
-            boundary.SetSize(NumOfBdrElements);
-            for (int el = 0; el < NumOfBdrElements; ++el)
+            const int count = (int) std::min(chunk, n - el);
+            tok.ReadBinary(buf.data(), count*rec*sizeof(uint64_t));
+            for (int k = 0; k < count; k++)
             {
-               boundary[el] = elements_0D[el];
+               elements.Add(type, &buf[k*rec + 1], attr, node_map);
             }
          }
-         else
+      }
+      else
+      {
+         for (long long el = 0; el < n; el++)
          {
-            MFEM_ABORT("Gmsh file : no elements found");
-            return;
+            tok.ReadInt(); // element tag
+            for (int k = 0; k < num; k++) { nodes[k] = tok.ReadInt(); }
+            elements.Add(type, nodes, attr, node_map);
          }
+      }
+   }
+}
+
+// Read the $Periodic section, setting v2v[slave] = master for all pairs of
+// periodic nodes.
+static void ReadGmshPeriodic(StreamTokenizer &tok, bool v41, bool binary,
+                             const GmshNodeMap &node_map, Array<int> &v2v)
+{
+   // the section is in ASCII format in binary MSH 2.2 files
+   binary = binary && v41;
+   const long long num_links = GmshReadSize(tok, binary);
+   for (long long l = 0; l < num_links; l++)
+   {
+      // entity dimension, entity tag and master entity tag
+      for (int k = 0; k < 3; k++) { GmshReadInt(tok, binary); }
+      // the affine mapping is skipped
+      if (v41)
+      {
+         const long long num_affine = GmshReadSize(tok, binary);
+         for (long long k = 0; k < num_affine; k++)
+         {
+            GmshReadDouble(tok, binary);
+         }
+      }
+      else
+      {
+         tok.SkipSpace();
+         if (tok.Peek() == 'A') { tok.SkipLine(); }
+      }
+      const long long num_nodes = GmshReadSize(tok, binary);
+      for (long long k = 0; k < num_nodes; k++)
+      {
+         const int slave = node_map(GmshReadSize(tok, binary));
+         const int master = node_map(GmshReadSize(tok, binary));
+         v2v[slave] = master;
+      }
+   }
+}
 
-         MFEM_CONTRACT_VAR(n_partitions);
-         MFEM_CONTRACT_VAR(elem_domain);
+} // namespace mfem::internal
 
-      } // section '$Elements'
-      else if (buff == "$Periodic") // Reading master/slave node pairs
+void Mesh::ReadGmshMesh(std::istream &input, int &curved, int &read_gf)
+{
+   using namespace internal;
+
+   // Gmsh file formats:
+   //   * https://gmsh.info/doc/texinfo/gmsh.html#MSH-file-format
+   //   * https://gmsh.info/doc/texinfo/gmsh.html#MSH-file-format-version-2
+   StreamTokenizer tok(input);
+   const double version = tok.ReadDouble();
+   const bool binary = (tok.ReadInt() != 0);
+   const long long dsize = tok.ReadInt();
+   if (version < 2.2)
+   {
+      MFEM_ABORT("Gmsh file version < 2.2");
+   }
+   const bool v41 = (version >= 4.0);
+   if (v41 && version != 4.1)
+   {
+      MFEM_ABORT("Gmsh file : version " << version << " is not supported, "
+                 "use the MSH 2.2 or 4.1 formats");
+   }
+   // this is also sizeof(size_t) in MSH 4.1 files
+   if (dsize != sizeof(double))
+   {
+      MFEM_ABORT("Gmsh file : dsize != sizeof(double)");
+   }
+   tok.SkipLine();
+   // There is a number 1 in binary format
+   if (binary)
+   {
+      int32_t one;
+      tok.ReadBinary(&one, sizeof(one));
+      if (one != 1)
       {
-         curved = 1;
-         read_gf = 0;
-         spaceDim = 3;
+         MFEM_ABORT("Gmsh file : wrong binary format");
+      }
+   }
 
-         Array<int> v2v(NumOfVertices);
-         for (int i = 0; i < v2v.Size(); i++)
+   // A map between the tags of the vertices in the file and their indices
+   // (there may be gaps in the numbering, and also Gmsh enumerates vertices
+   // starting from 1, not 0)
+   GmshNodeMap node_map;
+   GmshEntities entities;
+   GmshElements gmsh_elements;
+   Array<int> node_tags, v2v;
+   bool periodic = false;
+   // Read the sections of the mesh file. Unknown sections are skipped.
+   string buff;
+   while (tok.ReadToken(buff))
+   {
+      // in binary files, the data starts after the end of line
+      tok.SkipLine();
+      if (buff == "$Nodes") // reading mesh vertices
+      {
+         if (v41) { ReadGmshNodes41(tok, binary, vertices, node_tags); }
+         else { ReadGmshNodes22(tok, binary, vertices, node_tags); }
+         NumOfVertices = vertices.Size();
+         node_map.Make(node_tags);
+         node_tags.DeleteAll();
+      }
+      else if (buff == "$Entities" && v41)
+      {
+         ReadGmshEntities(tok, binary, entities);
+      }
+      else if (buff == "$Elements") // reading mesh elements
+      {
+         MFEM_VERIFY(NumOfVertices > 0, "Gmsh file : $Nodes must precede "
+                     "$Elements");
+         if (v41)
          {
-            v2v[i] = i;
+            ReadGmshElements41(tok, binary, node_map, entities, gmsh_elements);
          }
-         int num_per_ent;
-         int num_nodes;
-         int slave, master;
-         input >> num_per_ent;
-         getline(input, buff); // Read end-of-line
-         for (int i = 0; i < num_per_ent; i++)
+         else
          {
-            getline(input, buff); // Read and ignore entity dimension and tags
-            getline(input, buff); // Read and ignore affine mapping
-            // Read master/slave vertex pairs
-            input >> num_nodes;
-            for (int j=0; j<num_nodes; j++)
-            {
-               input >> slave >> master;
-               v2v[slave - 1] = master - 1;
-            }
-            getline(input, buff); // Read end-of-line
+            ReadGmshElements22(tok, binary, node_map, gmsh_elements);
          }
+      }
+      else if (buff == "$Periodic") // Reading master/slave node pairs
+      {
+         if (!periodic)
+         {
+            v2v.SetSize(NumOfVertices);
+            for (int i = 0; i < v2v.Size(); i++) { v2v[i] = i; }
+            periodic = true;
+         }
+         ReadGmshPeriodic(tok, v41, binary, node_map, v2v);
+      }
+      else if (buff[0] == '$' && buff.compare(0, 4, "$End") != 0)
+      {
+         // skip the lines of the section up to its end
+         do { tok.ReadLine(buff); }
+         while (buff.compare(0, 4, "$End") != 0 && tok.Peek() != EOF);
+      }
+   } // we reach the end of the file
 
-         // Convert nodes to discontinuous GridFunction
-         this->SetCurvature(1, true, Dim, Ordering::byVDIM);
+   if (gmsh_elements.num_unsupported)
+   {
+      MFEM_WARNING("Gmsh file : " << gmsh_elements.num_unsupported
+                   << " elements of unsupported types were skipped.");
+   }
+
+   // The elements of the highest dimension are the mesh elements and the
+   // elements of the next lower dimension are the boundary elements. Other
+   // elements are discarded.
+   Dim = 3;
+   while (Dim > 0 && gmsh_elements.elems[Dim].Size() == 0) { Dim--; }
+   if (Dim == 0)
+   {
+      MFEM_ABORT("Gmsh file : no elements found");
+      return;
+   }
+   const CompactElementArray &elems = gmsh_elements.elems[Dim];
+   const CompactElementArray &bdr_elems = gmsh_elements.elems[Dim-1];
+   NumOfElements = elems.Size();
+   elements.SetSize(NumOfElements);
+   for (int i = 0; i < NumOfElements; i++)
+   {
+      elements[i] = NewElement(elems.GetGeometryType(i));
+      elements[i]->SetVertices(elems.GetVertices(i));
+      elements[i]->SetAttribute(elems.GetAttribute(i));
+   }
+   NumOfBdrElements = bdr_elems.Size();
+   boundary.SetSize(NumOfBdrElements);
+   for (int i = 0; i < NumOfBdrElements; i++)
+   {
+      boundary[i] = NewElement(bdr_elems.GetGeometryType(i));
+      boundary[i]->SetVertices(bdr_elems.GetVertices(i));
+      boundary[i]->SetAttribute(bdr_elems.GetAttribute(i));
+   }
+   for (int d = 0; d < 4; d++) { gmsh_elements.elems[d].Clear(); }
 
-         // Replace "slave" vertex indices in the element connectivity
-         // with their corresponding "master" vertex indices.
-         for (int i = 0; i < this->GetNE(); i++)
+   if (periodic)
+   {
+      curved = 1;
+      read_gf = 0;
+      spaceDim = 3;
+
+      // Convert nodes to discontinuous GridFunction
+      this->SetCurvature(1, true, Dim, Ordering::byVDIM);
+
+      // Replace "slave" vertex indices in the element connectivity
+      // with their corresponding "master" vertex indices.
+      for (int i = 0; i < this->GetNE(); i++)
+      {
+         Element *el = this->GetElement(i);
+         int *v = el->GetVertices();
+         int nv = el->GetNVertices();
+         for (int j = 0; j < nv; j++)
          {
-            Element *el = this->GetElement(i);
-            int *v = el->GetVertices();
-            int nv = el->GetNVertices();
-            for (int j = 0; j < nv; j++)
-            {
-               v[j] = v2v[v[j]];
-            }
+            v[j] = v2v[v[j]];
          }
-         // Replace "slave" vertex indices in the boundary element connectivity
-         // with their corresponding "master" vertex indices.
-         for (int i = 0; i < this->GetNBE(); i++)
+      }
+      // Replace "slave" vertex indices in the boundary element connectivity
+      // with their corresponding "master" vertex indices.
+      for (int i = 0; i < this->GetNBE(); i++)
+      {
+         Element *el = this->GetBdrElement(i);
+         int *v = el->GetVertices();
+         int nv = el->GetNVertices();
+         for (int j = 0; j < nv; j++)
          {
-            Element *el = this->GetBdrElement(i);
-            int *v = el->GetVertices();
-            int nv = el->GetNVertices();
-            for (int j = 0; j < nv; j++)
-            {
-               v[j] = v2v[v[j]];
-            }
+            v[j] = v2v[v[j]];
          }
-         this->RemoveUnusedVertices();
-         this->RemoveInternalBoundaries();
       }
-   } // we reach the end of the file
+      this->RemoveUnusedVertices();
+      this->RemoveInternalBoundaries();
+   }
 }
 
 
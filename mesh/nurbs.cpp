@@ -2910,6 +2910,35 @@ void NURBSExtension::GetElementLocalToGlobal(Array<int> &lelem_elem)
       }
 }
 
+void NURBSExtension::GetElementIJK(int el, Array<int> &ijk) const
+{
+   ijk.SetSize(el_to_IJK.NumCols());
+   for (int d = 0; d < ijk.Size(); d++) { ijk[d] = el_to_IJK(el,d); }
+}
+
+void NURBSExtension::GetPatchDofs(int p, Array<int> &dofs) const
+{
+   const KnotVector *kv[3];
+   NURBSPatchMap p2g(this);
+
+   p2g.SetPatchDofMap(p, kv);
+   const int nx = kv[0]->GetNCP(), ny = kv[1]->GetNCP();
+   const int nz = (Dimension() == 3) ? kv[2]->GetNCP() : 1;
+   dofs.SetSize(nx*ny*nz);
+   for (int k = 0, o = 0; k < nz; k++)
+   {
+      for (int j = 0; j < ny; j++)
+      {
+         for (int i = 0; i < nx; i++, o++)
+         {
+            const int dof = (Dimension() == 3) ? DofMap(p2g(i,j,k)) :
+                            DofMap(p2g(i,j));
+            dofs[o] = activeDof[dof] - 1;
+         }
+      }
+   }
+}
+
 void NURBSExtension::LoadFE(int i, const FiniteElement *FE) const
 {
    const NURBSFiniteElement *NURBSFE =
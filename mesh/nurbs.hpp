@@ -226,7 +226,6 @@ protected:
    void CheckBdrPatches();
 
    void GetPatchKnotVectors   (int p, Array<KnotVector *> &kv);
-   void GetPatchKnotVectors   (int p, Array<const KnotVector *> &kv) const;
    void GetBdrPatchKnotVectors(int p, Array<KnotVector *> &kv);
    void GetBdrPatchKnotVectors(int p, Array<const KnotVector *> &kv) const;
 
@@ -374,6 +373,17 @@ public:
    void GetVertexLocalToGlobal(Array<int> &lvert_vert);
    void GetElementLocalToGlobal(Array<int> &lelem_elem);
 
+   /// Return the patch of the (active) element @a el.
+   int GetElementPatch(int el) const { return el_to_patch[el]; }
+   /** @brief Return in @a ijk the knot-span indices of the (active) element
+       @a el in the knot vectors of its patch. */
+   void GetElementIJK(int el, Array<int> &ijk) const;
+   /** @brief Return the (active) dofs of patch @a p in lexicographic order of
+       its control points, with -1 for the inactive dofs. */
+   void GetPatchDofs(int p, Array<int> &dofs) const;
+   /// Return in @a kv the knot vectors of patch @a p, one per direction.
+   void GetPatchKnotVectors(int p, Array<const KnotVector *> &kv) const;
+
    // Load functions
    void LoadFE(int i, const FiniteElement *FE) const;
    void LoadBE(int i, const FiniteElement *BE) const;
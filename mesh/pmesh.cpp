@@ -18,10 +18,13 @@
 #include "../general/sets.hpp"
 #include "../general/sort_pairs.hpp"
 #include "../general/text.hpp"
+#include "../general/tuple_table.hpp"
 #include "../general/globals.hpp"
 
 #include <iostream>
 #include <fstream>
+#include <algorithm>
+#include <climits>
 
 using namespace std;
 
@@ -1077,6 +1080,1027 @@ ParMesh::ParMesh(MPI_Comm comm, istream &input, bool refine)
    // TODO: AMR meshes, NURBS meshes?
 }
 
+namespace internal
+{
+
+// The part of a serial MFEM mesh file read by one rank in the constructor
+// ParMesh(MPI_Comm, const char *, ...): ranges of consecutive elements,
+// boundary elements and vertices.
+struct MeshFileChunk
+{
+   int dim, space_dim;
+   int num_elem, num_bdr, num_vert; // global numbers
+   int elem_offset, bdr_offset;     // global index of the first local entry
+   Array<int> vert_offsets;         // vertex range of every rank
+   // Row i of the (elem_I, elem_J) and (bdr_I, bdr_J) lists: attribute,
+   // geometry and vertices of the element.
+   Array<int> elem_I, elem_J, bdr_I, bdr_J;
+   Array<double> coords;            // 'space_dim' coordinates per vertex
+};
+
+static inline bool IsBlank(char c)
+{
+   return c == ' ' || c == '\t' || c == '\r';
+}
+
+static int ParseInt(const char *&p, const char *filename)
+{
+   while (IsBlank(*p)) { p++; }
+   char *end;
+   const long val = strtol(p, &end, 10);
+   MFEM_VERIFY(end != p && *p != '\n', "invalid data in mesh file "
+               << filename << ": " << std::string(p, strcspn(p, "\n")));
+   p = end;
+   return int(val);
+}
+
+static double ParseDouble(const char *&p, const char *filename)
+{
+   while (IsBlank(*p)) { p++; }
+   char *end;
+   const double val = strtod(p, &end);
+   MFEM_VERIFY(end != p && *p != '\n', "invalid data in mesh file "
+               << filename << ": " << std::string(p, strcspn(p, "\n")));
+   p = end;
+   return val;
+}
+
+static void ParseEndOfLine(const char *p, const char *filename)
+{
+   while (IsBlank(*p)) { p++; }
+   MFEM_VERIFY(*p == '\n', "the distributed mesh reader expects one entity"
+               " per line in mesh file " << filename);
+}
+
+static void ParseElement(const char *p, const char *filename,
+                         Array<int> &I, Array<int> &J)
+{
+   const int attr = ParseInt(p, filename);
+   const int geom = ParseInt(p, filename);
+   MFEM_VERIFY(geom >= 0 && geom < Geometry::NumGeom,
+               "invalid element geometry in mesh file " << filename);
+   J.Append(attr);
+   J.Append(geom);
+   for (int i = 0; i < Geometry::NumVerts[geom]; i++)
+   {
+      J.Append(ParseInt(p, filename));
+   }
+   ParseEndOfLine(p, filename);
+   I.Append(J.Size());
+}
+
+// Read the lines of the mesh file 'filename' (MFEM mesh v1.0 format) that
+// start in the byte range of this rank: the file is split into equal byte
+// ranges, one per rank. The elements, boundary elements and vertices are
+// identified by the byte offsets of the section keywords, which are
+// determined collectively.
+static void ReadMeshFileChunk(MPI_Comm comm, const char *filename,
+                              MeshFileChunk &chunk)
+{
+   int nranks, rank;
+   MPI_Comm_size(comm, &nranks);
+   MPI_Comm_rank(comm, &rank);
+
+   ifstream file(filename, ios::in | ios::binary);
+   MFEM_VERIFY(file.good(), "unable to open mesh file " << filename);
+   file.seekg(0, ios::end);
+   const long long size = file.tellg();
+
+   // read the bytes [begin, end) preceded by one byte and followed by the rest
+   // of the last line
+   const long long begin = size*rank/nranks, end = size*(rank+1)/nranks;
+   const long long start = (begin > 0) ? begin - 1 : 0;
+   std::string buf(end - start, '\0');
+   file.seekg(start);
+   file.read(&buf[0], buf.size());
+   if (end > begin && buf[buf.size()-1] != '\n')
+   {
+      std::string rest;
+      getline(file, rest);
+      buf += rest;
+   }
+   buf += '\n';
+
+   // position of the first line starting in [begin, end)
+   size_t first = begin - start;
+   if (begin > 0 && buf[first-1] != '\n') { first = buf.find('\n', first) + 1; }
+
+   // find the section keywords
+   const int num_kw = 4;
+   const char *keywords[num_kw] = { "dimension", "elements", "boundary",
+                                    "vertices"
+                                  };
+   long long kw_offset[num_kw], glob_kw_offset[num_kw];
+   for (int k = 0; k < num_kw; k++) { kw_offset[k] = LLONG_MAX; }
+   for (size_t i = first; start + (long long)i < end; )
+   {
+      const size_t eol = buf.find('\n', i);
+      size_t j = i;
+      while (IsBlank(buf[j])) { j++; }
+      if (isalpha(buf[j]))
+      {
+         size_t len = 0;
+         while (isalnum(buf[j+len]) || buf[j+len] == '_') { len++; }
+         for (int k = 0; k < num_kw; k++)
+         {
+            if (buf.compare(j, len, keywords[k]) == 0 &&
+                kw_offset[k] == LLONG_MAX)
+            {
+               kw_offset[k] = start + i;
+            }
+         }
+      }
+      i = eol + 1;
+   }
+   MPI_Allreduce(kw_offset, glob_kw_offset, num_kw, MPI_LONG_LONG, MPI_MIN,
+                 comm);
+   for (int k = 0; k < num_kw; k++)
+   {
+      MFEM_VERIFY(glob_kw_offset[k] != LLONG_MAX, "keyword '" << keywords[k]
+                  << "' not found in mesh file " << filename);
+   }
+   MFEM_VERIFY(glob_kw_offset[0] < glob_kw_offset[1] &&
+               glob_kw_offset[1] < glob_kw_offset[2] &&
+               glob_kw_offset[2] < glob_kw_offset[3],
+               "invalid mesh file " << filename);
+
+   // the ranks that found the keywords read the sizes that follow them
+   enum { HEADER, DIM, NE, ELEM_START, NBE, BDR_START, NV, SDIM, VERT_START,
+          CURVED, NUM_INFO
+        };
+   long long info[NUM_INFO], glob_info[NUM_INFO];
+   for (int k = 0; k < NUM_INFO; k++) { info[k] = -1; }
+   if (rank == 0)
+   {
+      std::string header;
+      file.clear();
+      file.seekg(0);
+      getline(file, header);
+      filter_dos(header);
+      while (header.size() && IsBlank(header[header.size()-1]))
+      {
+         header.resize(header.size()-1);
+      }
+      info[HEADER] = (header == "MFEM mesh v1.0");
+   }
+   for (int k = 0; k < num_kw; k++)
+   {
+      if (glob_kw_offset[k] < begin || glob_kw_offset[k] >= end) { continue; }
+      std::string ident;
+      int num;
+      file.clear();
+      file.seekg(glob_kw_offset[k]);
+      file >> ident >> num;
+      switch (k)
+      {
+         case 0: info[DIM] = num; break;
+         case 1: info[NE] = num; info[ELEM_START] = file.tellg(); break;
+         case 2: info[NBE] = num; info[BDR_START] = file.tellg(); break;
+         case 3:
+            info[NV] = num;
+            file >> ws >> ident;
+            info[CURVED] = (ident == "nodes");
+            info[SDIM] = atoi(ident.c_str());
+            info[VERT_START] = file.tellg();
+            break;
+      }
+   }
+   MPI_Allreduce(info, glob_info, NUM_INFO, MPI_LONG_LONG, MPI_MAX, comm);
+   MFEM_VERIFY(glob_info[HEADER] == 1, "the distributed mesh reader supports"
+               " only the MFEM mesh v1.0 format, mesh file: " << filename);
+   MFEM_VERIFY(glob_info[CURVED] == 0, "the distributed mesh reader does not"
+               " support curved meshes, mesh file: " << filename);
+   chunk.dim = glob_info[DIM];
+   chunk.space_dim = glob_info[SDIM];
+   chunk.num_elem = glob_info[NE];
+   chunk.num_bdr = glob_info[NBE];
+   chunk.num_vert = glob_info[NV];
+   MFEM_VERIFY(1 <= chunk.dim && chunk.dim <= 3 &&
+               chunk.dim <= chunk.space_dim && chunk.space_dim <= 3,
+               "invalid dimensions in mesh file " << filename);
+
+   // parse the data lines: element, boundary element and vertex lines start
+   // after the section sizes and end before the next section keyword
+   const int sdim = chunk.space_dim;
+   chunk.elem_I.SetSize(1, 0);
+   chunk.bdr_I.SetSize(1, 0);
+   chunk.elem_J.SetSize(0);
+   chunk.bdr_J.SetSize(0);
+   chunk.coords.SetSize(0);
+   for (size_t i = first; start + (long long)i < end; )
+   {
+      const long long offset = start + i;
+      const size_t eol = buf.find('\n', i);
+      size_t j = i;
+      while (IsBlank(buf[j])) { j++; }
+      const char c = buf[j];
+      const char *p = buf.c_str() + j;
+      if (isdigit(c) || c == '-' || c == '+' || c == '.')
+      {
+         if (offset > glob_info[VERT_START])
+         {
+            for (int d = 0; d < sdim; d++)
+            {
+               chunk.coords.Append(ParseDouble(p, filename));
+            }
+            ParseEndOfLine(p, filename);
+         }
+         else if (offset > glob_info[BDR_START] && offset < glob_kw_offset[3])
+         {
+            ParseElement(p, filename, chunk.bdr_I, chunk.bdr_J);
+         }
+         else if (offset > glob_info[ELEM_START] &&
+                  offset < glob_kw_offset[2])
+         {
+            ParseElement(p, filename, chunk.elem_I, chunk.elem_J);
+         }
+      }
+      i = eol + 1;
+   }
+
+   // global indices of the local entries
+   int loc[3] = { chunk.elem_I.Size()-1, chunk.bdr_I.Size()-1,
+                  chunk.coords.Size()/sdim
+                }, glob[3], offsets[3];
+   MPI_Allreduce(loc, glob, 3, MPI_INT, MPI_SUM, comm);
+   MPI_Exscan(loc, offsets, 3, MPI_INT, MPI_SUM, comm);
+   if (rank == 0) { offsets[0] = offsets[1] = offsets[2] = 0; }
+   MFEM_VERIFY(glob[0] == chunk.num_elem && glob[1] == chunk.num_bdr &&
+               glob[2] == chunk.num_vert,
+               "the numbers of entities do not match in mesh file "
+               << filename);
+   chunk.elem_offset = offsets[0];
+   chunk.bdr_offset = offsets[1];
+   chunk.vert_offsets.SetSize(nranks+1);
+   chunk.vert_offsets[0] = 0;
+   MPI_Allgather(&loc[2], 1, MPI_INT, chunk.vert_offsets.GetData()+1, 1,
+                 MPI_INT, comm);
+   chunk.vert_offsets.PartialSum();
+}
+
+// Send the entries of 'send', grouped by destination rank with 'send_cnt'
+// entries for each rank, to their destinations. On return, 'recv' contains
+// the received entries grouped by source rank, with counts 'recv_cnt'.
+template <typename T>
+static void ExchangeData(MPI_Comm comm, const Array<int> &send_cnt,
+                         const Array<T> &send, Array<int> &recv_cnt,
+                         Array<T> &recv)
+{
+   const int nranks = send_cnt.Size();
+   recv_cnt.SetSize(nranks);
+   MPI_Alltoall(const_cast<int*>(send_cnt.GetData()), 1, MPI_INT,
+                recv_cnt.GetData(), 1, MPI_INT, comm);
+   Array<int> send_off(nranks), recv_off(nranks);
+   int s_off = 0, r_off = 0;
+   for (int r = 0; r < nranks; r++)
+   {
+      send_off[r] = s_off;
+      s_off += send_cnt[r];
+      recv_off[r] = r_off;
+      r_off += recv_cnt[r];
+   }
+   recv.SetSize(r_off);
+   MPI_Alltoallv(const_cast<T*>(send.GetData()),
+                 const_cast<int*>(send_cnt.GetData()), send_off.GetData(),
+                 MPITypeMap<T>::mpi_type, recv.GetData(), recv_cnt.GetData(),
+                 recv_off.GetData(), MPITypeMap<T>::mpi_type, comm);
+}
+
+// Return the rank that read the vertex with global index v.
+static inline int VertexOwner(const MeshFileChunk &chunk, int v)
+{
+   const int *o = chunk.vert_offsets.GetData();
+   return std::upper_bound(o, o + chunk.vert_offsets.Size(), v) - o - 1;
+}
+
+// Get the coordinates of the vertices with the given sorted global indices
+// from the ranks that read them.
+static void FetchVertexCoordinates(MPI_Comm comm, const MeshFileChunk &chunk,
+                                   const Array<int> &verts,
+                                   Array<double> &coords)
+{
+   const int nranks = chunk.vert_offsets.Size()-1;
+   const int sdim = chunk.space_dim;
+   int rank;
+   MPI_Comm_rank(comm, &rank);
+
+   Array<int> send_cnt(nranks), recv_cnt, requests;
+   send_cnt = 0;
+   for (int i = 0; i < verts.Size(); i++)
+   {
+      send_cnt[VertexOwner(chunk, verts[i])]++;
+   }
+   ExchangeData(comm, send_cnt, verts, recv_cnt, requests);
+
+   Array<double> reply(sdim*requests.Size());
+   for (int i = 0; i < requests.Size(); i++)
+   {
+      const int v = requests[i] - chunk.vert_offsets[rank];
+      for (int d = 0; d < sdim; d++)
+      {
+         reply[sdim*i + d] = chunk.coords[sdim*v + d];
+      }
+   }
+   for (int r = 0; r < nranks; r++) { recv_cnt[r] *= sdim; }
+   ExchangeData(comm, recv_cnt, reply, send_cnt, coords);
+}
+
+// Assign the local elements with Hilbert curve indices 'keys' to 'nranks'
+// parts of (nearly) equal size, following the global order of the indices.
+// The index values that split the parts are found by simultaneous bisections,
+// counting the indices below the current guesses on all ranks.
+static void PartitionByKeys(MPI_Comm comm,
+                            const Array<unsigned long long> &keys,
+                            Array<int> &part)
+{
+   typedef unsigned long long ull;
+   int nranks;
+   MPI_Comm_size(comm, &nranks);
+
+   std::vector<ull> sorted(keys.begin(), keys.end());
+   std::sort(sorted.begin(), sorted.end());
+
+   long long loc_size = keys.Size(), glob_size;
+   MPI_Allreduce(&loc_size, &glob_size, 1, MPI_LONG_LONG, MPI_SUM, comm);
+
+   const int ns = nranks-1;
+   std::vector<ull> lo(ns, 0), hi(ns, ull(1) << 63), mid(ns);
+   std::vector<long long> cnt(ns), glob_cnt(ns);
+   for (int iter = 0; iter < 64; iter++)
+   {
+      for (int k = 0; k < ns; k++)
+      {
+         mid[k] = lo[k] + (hi[k] - lo[k])/2;
+         cnt[k] = std::lower_bound(sorted.begin(), sorted.end(), mid[k]) -
+                  sorted.begin();
+      }
+      MPI_Allreduce(cnt.data(), glob_cnt.data(), ns, MPI_LONG_LONG, MPI_SUM,
+                    comm);
+      for (int k = 0; k < ns; k++)
+      {
+         if (lo[k] == hi[k]) { continue; }
+         // lo[k] becomes the smallest index with enough indices below it
+         if (glob_cnt[k] >= (k+1)*glob_size/nranks) { hi[k] = mid[k]; }
+         else { lo[k] = mid[k] + 1; }
+      }
+   }
+
+   part.SetSize(keys.Size());
+   for (int i = 0; i < keys.Size(); i++)
+   {
+      part[i] = std::upper_bound(lo.begin(), lo.end(), keys[i]) - lo.begin();
+   }
+}
+
+// Home rank of an entity with the given sorted global vertex indices, where
+// the entities given by different ranks are matched.
+static inline int EntityHome(const int *tuple, int width, int num_vert,
+                             int nranks)
+{
+   if (width == 1) { return (long long)tuple[0]*nranks/num_vert; }
+   unsigned long long h = 0;
+   for (int j = 0; j < width; j++)
+   {
+      h = (h ^ (unsigned long long)tuple[j])*0x9E3779B97F4A7C15ull;
+      h ^= h >> 29;
+   }
+   return int(h % nranks);
+}
+
+// For each of the entities given by sorted global vertex tuples of length
+// 'width', find the ranks that give the same entity. Row i of 'ent_ranks'
+// lists the sorted ranks of entity i if it is given by more than one rank, and
+// is empty otherwise. The tuples are matched on the ranks given by EntityHome.
+// If 'home_verts' is not NULL (width 1), it returns the pairs (vertex, rank)
+// received by this rank, sorted.
+static void FindEntityRanks(MPI_Comm comm, int width, const Array<int> &tuples,
+                            int num_vert, Table &ent_ranks,
+                            Array<Pair<int,int> > *home_verts = NULL)
+{
+   int nranks;
+   MPI_Comm_size(comm, &nranks);
+   const int n = tuples.Size()/width, rec = width+1;
+
+   // send the records (entity, tuple) to the home ranks
+   Array<int> home(n), send_cnt(nranks), send_off(nranks), recv_cnt;
+   send_cnt = 0;
+   for (int i = 0; i < n; i++)
+   {
+      home[i] = EntityHome(&tuples[width*i], width, num_vert, nranks);
+      send_cnt[home[i]] += rec;
+   }
+   send_off[0] = 0;
+   for (int r = 1; r < nranks; r++)
+   {
+      send_off[r] = send_off[r-1] + send_cnt[r-1];
+   }
+   Array<int> send(rec*n), recv;
+   for (int i = 0; i < n; i++)
+   {
+      int *s = &send[send_off[home[i]]];
+      send_off[home[i]] += rec;
+      s[0] = i;
+      for (int j = 0; j < width; j++) { s[j+1] = tuples[width*i+j]; }
+   }
+   ExchangeData(comm, send_cnt, send, recv_cnt, recv);
+
+   // group the received records by their tuples
+   const int nrecv = recv.Size()/rec;
+   Array<int> src(nrecv), order(nrecv);
+   for (int r = 0, k = 0; r < nranks; r++)
+   {
+      for (int j = 0; j < recv_cnt[r]/rec; j++, k++) { src[k] = r; }
+   }
+   for (int k = 0; k < nrecv; k++) { order[k] = k; }
+   const int *rv = recv.GetData();
+   auto less = [&](int a, int b)
+   {
+      for (int j = 1; j <= width; j++)
+      {
+         if (rv[rec*a+j] != rv[rec*b+j]) { return rv[rec*a+j] < rv[rec*b+j]; }
+      }
+      return src[a] < src[b];
+   };
+   auto equal = [&](int a, int b)
+   {
+      for (int j = 1; j <= width; j++)
+      {
+         if (rv[rec*a+j] != rv[rec*b+j]) { return false; }
+      }
+      return true;
+   };
+   std::sort(order.begin(), order.end(), less);
+
+   if (home_verts)
+   {
+      home_verts->SetSize(nrecv);
+      for (int k = 0; k < nrecv; k++)
+      {
+         (*home_verts)[k] = Pair<int,int>(rv[rec*order[k]+1], src[order[k]]);
+      }
+   }
+
+   // reply (entity, number of ranks, ranks) to the ranks of the shared ones
+   Array<int> reply_cnt(nranks), reply_off(nranks), reply;
+   for (int pass = 0; pass < 2; pass++)
+   {
+      reply_cnt = 0;
+      for (int a = 0, b; a < nrecv; a = b)
+      {
+         for (b = a+1; b < nrecv && equal(order[a], order[b]); b++) { }
+         if (b - a == 1) { continue; }
+         for (int k = a; k < b; k++)
+         {
+            const int r = src[order[k]];
+            if (pass == 1)
+            {
+               int *s = &reply[reply_off[r] + reply_cnt[r]];
+               s[0] = rv[rec*order[k]];
+               s[1] = b - a;
+               for (int l = a; l < b; l++) { s[2+l-a] = src[order[l]]; }
+            }
+            reply_cnt[r] += 2 + b - a;
+         }
+      }
+      if (pass == 0)
+      {
+         int total = 0;
+         for (int r = 0; r < nranks; r++)
+         {
+            reply_off[r] = total;
+            total += reply_cnt[r];
+         }
+         reply.SetSize(total);
+      }
+   }
+   ExchangeData(comm, reply_cnt, reply, recv_cnt, recv);
+
+   // build the table of ranks
+   ent_ranks.MakeI(n);
+   for (int k = 0; k < recv.Size(); k += 2 + recv[k+1])
+   {
+      ent_ranks.AddColumnsInRow(recv[k], recv[k+1]);
+   }
+   ent_ranks.MakeJ();
+   for (int k = 0; k < recv.Size(); k += 2 + recv[k+1])
+   {
+      ent_ranks.AddConnections(recv[k], &recv[k+2], recv[k+1]);
+   }
+   ent_ranks.ShiftUpI();
+}
+
+} // namespace internal
+
+ParMesh::ParMesh(MPI_Comm comm, const char *filename, bool refine,
+                 bool fix_orientation, bool sfc_partitioning)
+   : glob_elem_offset(-1)
+   , glob_offset_sequence(-1)
+   , gtopo(comm)
+{
+   using namespace internal;
+
+   MyComm = comm;
+   MPI_Comm_size(MyComm, &NRanks);
+   MPI_Comm_rank(MyComm, &MyRank);
+
+   have_face_nbr_data = false;
+   pncmesh = NULL;
+
+   MeshFileChunk chunk;
+   ReadMeshFileChunk(MyComm, filename, chunk);
+   Dim = chunk.dim;
+   spaceDim = chunk.space_dim;
+
+   // coordinates of the vertices of the elements read by this rank
+   const int num_el = chunk.elem_I.Size()-1;
+   Array<int> el_verts;
+   for (int i = 0; i < num_el; i++)
+   {
+      const int *row = &chunk.elem_J[chunk.elem_I[i]];
+      el_verts.Append(row + 2, Geometry::NumVerts[row[1]]);
+   }
+   el_verts.Sort();
+   el_verts.Unique();
+   Array<double> el_coords;
+   FetchVertexCoordinates(MyComm, chunk, el_verts, el_coords);
+
+   // partition the elements
+   Array<int> partitioning(num_el);
+   if (sfc_partitioning)
+   {
+      // bounding box of the mesh, stored as (-min, max)
+      double bb[6], glob_bb[6];
+      for (int d = 0; d < 6; d++) { bb[d] = -numeric_limits<double>::max(); }
+      for (int i = 0; i < chunk.coords.Size(); i++)
+      {
+         const int d = i % spaceDim;
+         bb[d] = std::max(bb[d], -chunk.coords[i]);
+         bb[3+d] = std::max(bb[3+d], chunk.coords[i]);
+      }
+      MPI_Allreduce(bb, glob_bb, 6, MPI_DOUBLE, MPI_MAX, MyComm);
+      for (int d = 0; d < 3; d++) { glob_bb[d] = -glob_bb[d]; }
+
+      // Hilbert curve indices of the element centers
+      Array<unsigned long long> keys(num_el);
+      for (int i = 0; i < num_el; i++)
+      {
+         const int *row = &chunk.elem_J[chunk.elem_I[i]];
+         const int nv = Geometry::NumVerts[row[1]];
+         double center[3] = { 0.0, 0.0, 0.0 };
+         for (int j = 0; j < nv; j++)
+         {
+            const int k = el_verts.FindSorted(row[2+j]);
+            for (int d = 0; d < spaceDim; d++)
+            {
+               center[d] += el_coords[spaceDim*k + d]/nv;
+            }
+         }
+         keys[i] = HilbertIndex(spaceDim, center, glob_bb, glob_bb+3);
+      }
+      PartitionByKeys(MyComm, keys, partitioning);
+   }
+   else
+   {
+      for (int i = 0; i < num_el; i++)
+      {
+         partitioning[i] =
+            (long long)(chunk.elem_offset + i)*NRanks/chunk.num_elem;
+      }
+   }
+
+   // send the elements, with the coordinates of their vertices, to their
+   // ranks as records (global index, attribute, geometry, vertices)
+   Array<int> elem_data;
+   Array<double> elem_coords;
+   {
+      Array<int> send_cnt(NRanks), coord_cnt(NRanks), send_off(NRanks);
+      Array<int> coord_off(NRanks), recv_cnt;
+      send_cnt = 0;
+      coord_cnt = 0;
+      for (int i = 0; i < num_el; i++)
+      {
+         const int nv = chunk.elem_I[i+1] - chunk.elem_I[i] - 2;
+         send_cnt[partitioning[i]] += 3 + nv;
+         coord_cnt[partitioning[i]] += spaceDim*nv;
+      }
+      send_off[0] = coord_off[0] = 0;
+      for (int r = 1; r < NRanks; r++)
+      {
+         send_off[r] = send_off[r-1] + send_cnt[r-1];
+         coord_off[r] = coord_off[r-1] + coord_cnt[r-1];
+      }
+      Array<int> send(send_off.Last() + send_cnt.Last());
+      Array<double> send_coords(coord_off.Last() + coord_cnt.Last());
+      for (int i = 0; i < num_el; i++)
+      {
+         const int *row = &chunk.elem_J[chunk.elem_I[i]];
+         const int nv = chunk.elem_I[i+1] - chunk.elem_I[i] - 2;
+         const int p = partitioning[i];
+         int *s = &send[send_off[p]];
+         double *c = &send_coords[coord_off[p]];
+         send_off[p] += 3 + nv;
+         coord_off[p] += spaceDim*nv;
+         s[0] = chunk.elem_offset + i;
+         for (int j = 0; j < 2 + nv; j++) { s[j+1] = row[j]; }
+         for (int j = 0; j < nv; j++)
+         {
+            const int k = el_verts.FindSorted(row[2+j]);
+            for (int d = 0; d < spaceDim; d++)
+            {
+               c[spaceDim*j + d] = el_coords[spaceDim*k + d];
+            }
+         }
+      }
+      chunk.elem_I.DeleteAll();
+      chunk.elem_J.DeleteAll();
+      chunk.coords.DeleteAll();
+      el_verts.DeleteAll();
+      el_coords.DeleteAll();
+
+      ExchangeData(MyComm, send_cnt, send, recv_cnt, elem_data);
+      ExchangeData(MyComm, coord_cnt, send_coords, recv_cnt, elem_coords);
+   }
+
+   Array<int> vert_global;
+   LoadDistributedElements(elem_data, elem_coords, vert_global);
+   elem_data.DeleteAll();
+   elem_coords.DeleteAll();
+
+   BuildDistributedSharedData(chunk.num_vert, vert_global, chunk.bdr_offset,
+                              chunk.bdr_I, chunk.bdr_J);
+   MFEM_VERIFY(ReduceInt(NumOfBdrElements) == chunk.num_bdr,
+               "some boundary elements are not faces of the elements in mesh"
+               " file " << filename);
+
+   // Missing boundary elements are not generated: the boundary read from the
+   // file is already distributed.
+   FinalizeTopology(false);
+   ReduceMeshGen(); // determine the global 'meshgen'
+   Finalize(refine, fix_orientation);
+}
+
+void ParMesh::LoadDistributedElements(const Array<int> &elem_data,
+                                      const Array<double> &elem_coords,
+                                      Array<int> &vert_global)
+{
+   // positions of the element records and their coordinates
+   Array<int> rec_off, coord_off, order;
+   vert_global.SetSize(0);
+   for (int k = 0, c = 0; k < elem_data.Size(); )
+   {
+      const int nv = Geometry::NumVerts[elem_data[k+2]];
+      rec_off.Append(k);
+      coord_off.Append(c);
+      vert_global.Append(&elem_data[k+3], nv);
+      k += 3 + nv;
+      c += spaceDim*nv;
+   }
+   vert_global.Sort();
+   vert_global.Unique();
+
+   // order the elements by their global indices
+   order.SetSize(rec_off.Size());
+   for (int i = 0; i < order.Size(); i++) { order[i] = i; }
+   order.Sort([&](int a, int b)
+   { return elem_data[rec_off[a]] < elem_data[rec_off[b]]; });
+
+   NumOfVertices = vert_global.Size();
+   vertices.SetSize(NumOfVertices);
+   NumOfElements = order.Size();
+   elements.SetSize(NumOfElements);
+   Array<int> v;
+   for (int i = 0; i < NumOfElements; i++)
+   {
+      const int *rec = &elem_data[rec_off[order[i]]];
+      const double *coords = &elem_coords[coord_off[order[i]]];
+      const int nv = Geometry::NumVerts[rec[2]];
+      v.SetSize(nv);
+      for (int j = 0; j < nv; j++)
+      {
+         v[j] = vert_global.FindSorted(rec[3+j]);
+         vertices[v[j]].SetCoords(spaceDim, coords + spaceDim*j);
+      }
+      elements[i] = NewElement(rec[2]);
+      elements[i]->SetAttribute(rec[1]);
+      elements[i]->SetVertices(v);
+   }
+}
+
+void ParMesh::BuildDistributedSharedData(int num_vert_glob,
+                                         const Array<int> &vert_global,
+                                         int bdr_offset,
+                                         const Array<int> &bdr_I,
+                                         const Array<int> &bdr_J)
+{
+   using namespace internal;
+
+   // The faces of the elements, identified by their (up to) three smallest
+   // vertices: the local numbering of the vertices follows the global one, so
+   // these are the same on all ranks.
+   const int fw = std::min(Dim, 3);
+   Array<int> face_tuples, face_occ;
+   for (int i = 0; i < NumOfElements; i++)
+   {
+      const Element *el = elements[i];
+      const int nf = (Dim == 3) ? el->GetNFaces() :
+                     (Dim == 2) ? el->GetNEdges() : el->GetNVertices();
+      for (int f = 0; f < nf; f++)
+      {
+         int fv[4];
+         const int nfv = GetDistributedFaceVertices(el, f, fv);
+         std::sort(fv, fv + nfv);
+         face_tuples.Append(fv, fw);
+         face_occ.Append(i);
+         face_occ.Append(f);
+      }
+   }
+   TupleTable faces(face_tuples.GetData(), face_tuples.Size()/fw, fw,
+                    NumOfVertices);
+   face_tuples.DeleteAll();
+
+   // the faces in only one element of this rank, in the order of their tuples
+   Array<int> exp_faces, face_group(faces.NumberOfEntries());
+   for (int g = 0; g < faces.NumberOfEntries(); g++)
+   {
+      face_group[faces.GetGroupNumber(g)] = g;
+      if (faces.GetGroupSize(g) == 1) { exp_faces.Append(g); }
+   }
+
+   // ranks of the vertices
+   Table vert_ranks, edge_ranks, face_ranks;
+   Array<Pair<int,int> > home_verts;
+   FindEntityRanks(MyComm, 1, vert_global, num_vert_glob, vert_ranks,
+                   &home_verts);
+
+   // ranks of the exposed faces and, in 3D, of their edges
+   Array<int> exp_face_tuples, exp_edges;
+   TupleTable edges;
+   for (int k = 0; k < exp_faces.Size(); k++)
+   {
+      const int *t = faces.GetGroupTuple(exp_faces[k]);
+      for (int j = 0; j < fw; j++)
+      {
+         exp_face_tuples.Append(vert_global[t[j]]);
+      }
+   }
+   if (Dim == 3)
+   {
+      Array<int> edge_tuples;
+      for (int k = 0; k < exp_faces.Size(); k++)
+      {
+         const int *occ = &face_occ[2*faces.GetGroup(exp_faces[k])[0]];
+         int fv[4];
+         const int nfv = GetDistributedFaceVertices(elements[occ[0]], occ[1],
+                                                    fv);
+         for (int j = 0; j < nfv; j++)
+         {
+            const int a = fv[j], b = fv[(j+1)%nfv];
+            edge_tuples.Append(std::min(a, b));
+            edge_tuples.Append(std::max(a, b));
+         }
+      }
+      edges.Make(edge_tuples.GetData(), edge_tuples.Size()/2, 2,
+                 NumOfVertices);
+      for (int g = 0; g < edges.NumberOfEntries(); g++)
+      {
+         const int *t = edges.GetGroupTuple(g);
+         exp_edges.Append(vert_global[t[0]]);
+         exp_edges.Append(vert_global[t[1]]);
+      }
+      FindEntityRanks(MyComm, 2, exp_edges, num_vert_glob, edge_ranks);
+   }
+   if (Dim > 1)
+   {
+      FindEntityRanks(MyComm, fw, exp_face_tuples, num_vert_glob, face_ranks);
+   }
+
+   // Create the groups. The shared entities of each group are listed in the
+   // order of their global vertex indices, which is the same on all ranks.
+   ListOfIntegerSets groups;
+   IntegerSet group;
+   group.Recreate(1, &MyRank);
+   groups.Insert(group);
+
+   Array<int> svert_group, sedge_group, sface_group, sface_exp;
+   for (int i = 0; i < NumOfVertices; i++)
+   {
+      if (vert_ranks.RowSize(i) == 0) { continue; }
+      group.Recreate(vert_ranks.RowSize(i), vert_ranks.GetRow(i));
+      svert_group.Append(groups.Insert(group) - 1);
+      svert_lvert.Append(i);
+   }
+   if (Dim == 3)
+   {
+      for (int g = 0; g < edges.NumberOfEntries(); g++)
+      {
+         if (edge_ranks.RowSize(g) == 0) { continue; }
+         group.Recreate(edge_ranks.RowSize(g), edge_ranks.GetRow(g));
+         sedge_group.Append(groups.Insert(group) - 1);
+         const int *t = edges.GetGroupTuple(g);
+         shared_edges.Append(new Segment(t[0], t[1], 1));
+      }
+   }
+   Array<int> face_owner(faces.NumberOfEntries());
+   face_owner = MyRank;
+   for (int k = 0; k < svert_lvert.Size() && Dim == 1; k++)
+   {
+      const int f = faces.Index(&svert_lvert[k]);
+      face_owner[f] = vert_ranks.GetRow(svert_lvert[k])[0];
+   }
+   for (int k = 0; k < exp_faces.Size() && Dim > 1; k++)
+   {
+      if (face_ranks.RowSize(k) == 0) { continue; }
+      group.Recreate(face_ranks.RowSize(k), face_ranks.GetRow(k));
+      sface_group.Append(groups.Insert(group) - 1);
+      face_owner[faces.GetGroupNumber(exp_faces[k])] = face_ranks.GetRow(k)[0];
+
+      const int *occ = &face_occ[2*faces.GetGroup(exp_faces[k])[0]];
+      int fv[4];
+      const int nfv = GetDistributedFaceVertices(elements[occ[0]], occ[1], fv);
+      if (Dim == 2)
+      {
+         sedge_group.Append(sface_group.Last());
+         shared_edges.Append(new Segment(std::min(fv[0], fv[1]),
+                                         std::max(fv[0], fv[1]), 1));
+      }
+      else if (nfv == 3)
+      {
+         std::sort(fv, fv + 3);
+         shared_trias.Append(Vert3(fv[0], fv[1], fv[2]));
+      }
+      else
+      {
+         // start at the smallest vertex, towards its smaller neighbor
+         int s = 0;
+         for (int j = 1; j < 4; j++) { if (fv[j] < fv[s]) { s = j; } }
+         const int dir = (fv[(s+1)%4] < fv[(s+3)%4]) ? 1 : 3;
+         shared_quads.Append(Vert4(fv[s], fv[(s+dir)%4], fv[(s+2*dir)%4],
+                                   fv[(s+3*dir)%4]));
+      }
+      sface_exp.Append(nfv);
+   }
+   const int ngroups = groups.Size();
+
+   // build the tables of the shared entities of the groups
+   auto make_group_table = [&](Table &group_ent, const Array<int> &ent_group,
+                               const Array<int> *ent_nv, int nv)
+   {
+      group_ent.MakeI(ngroups-1);
+      for (int i = 0; i < ent_group.Size(); i++)
+      {
+         if (!ent_nv || (*ent_nv)[i] == nv)
+         {
+            group_ent.AddAColumnInRow(ent_group[i]);
+         }
+      }
+      group_ent.MakeJ();
+      for (int i = 0, j = 0; i < ent_group.Size(); i++)
+      {
+         if (!ent_nv || (*ent_nv)[i] == nv)
+         {
+            group_ent.AddConnection(ent_group[i], j++);
+         }
+      }
+      group_ent.ShiftUpI();
+   };
+   make_group_table(group_svert, svert_group, NULL, 0);
+   make_group_table(group_sedge, sedge_group, NULL, 0);
+   if (Dim == 3)
+   {
+      make_group_table(group_stria, sface_group, &sface_exp, 3);
+      make_group_table(group_squad, sface_group, &sface_exp, 4);
+   }
+   else
+   {
+      group_stria.SetSize(ngroups-1, 0);
+      group_squad.SetSize(ngroups-1, 0);
+   }
+   gtopo.Create(groups, 822);
+
+   // Send the boundary elements to the home ranks of their smallest vertices,
+   // which forward them to all ranks with that vertex. Each rank keeps the
+   // boundary elements that are faces of its elements; a boundary element on
+   // a shared face is kept by the lowest of the ranks sharing the face.
+   Array<int> send_cnt(NRanks), send_off(NRanks), recv_cnt, send, recv;
+   const int num_bdr = bdr_I.Size()-1;
+   Array<int> home(num_bdr);
+   send_cnt = 0;
+   for (int i = 0; i < num_bdr; i++)
+   {
+      const int *row = &bdr_J[bdr_I[i]];
+      const int nv = bdr_I[i+1] - bdr_I[i] - 2;
+      const int vmin = *std::min_element(row + 2, row + 2 + nv);
+      home[i] = EntityHome(&vmin, 1, num_vert_glob, NRanks);
+      send_cnt[home[i]] += 3 + nv;
+   }
+   send_off[0] = 0;
+   for (int r = 1; r < NRanks; r++)
+   {
+      send_off[r] = send_off[r-1] + send_cnt[r-1];
+   }
+   send.SetSize(send_off.Last() + send_cnt.Last());
+   for (int i = 0; i < num_bdr; i++)
+   {
+      int *s = &send[send_off[home[i]]];
+      send_off[home[i]] += bdr_I[i+1] - bdr_I[i] + 1;
+      s[0] = bdr_offset + i;
+      for (int j = bdr_I[i]; j < bdr_I[i+1]; j++)
+      {
+         s[1 + j - bdr_I[i]] = bdr_J[j];
+      }
+   }
+   ExchangeData(MyComm, send_cnt, send, recv_cnt, recv);
+
+   // forward the received boundary elements
+   for (int pass = 0; pass < 2; pass++)
+   {
+      send_cnt = 0;
+      for (int k = 0; k < recv.Size(); )
+      {
+         const int len = 3 + Geometry::NumVerts[recv[k+2]];
+         const int vmin = *std::min_element(&recv[k+3], &recv[k] + len);
+         const Pair<int,int> *hv =
+            std::lower_bound(home_verts.begin(), home_verts.end(),
+                             Pair<int,int>(vmin, -1));
+         for ( ; hv != home_verts.end() && hv->one == vmin; hv++)
+         {
+            if (pass == 1)
+            {
+               std::copy(&recv[k], &recv[k] + len,
+                         &send[send_off[hv->two] + send_cnt[hv->two]]);
+            }
+            send_cnt[hv->two] += len;
+         }
+         k += len;
+      }
+      if (pass == 0)
+      {
+         send_off[0] = 0;
+         for (int r = 1; r < NRanks; r++)
+         {
+            send_off[r] = send_off[r-1] + send_cnt[r-1];
+         }
+         send.SetSize(send_off.Last() + send_cnt.Last());
+      }
+   }
+   ExchangeData(MyComm, send_cnt, send, recv_cnt, recv);
+
+   // keep the boundary elements of this rank, ordered by their global indices
+   Array<Pair<int,int> > bdr_rec;
+   for (int k = 0; k < recv.Size(); )
+   {
+      const int nv = Geometry::NumVerts[recv[k+2]];
+      int fv[4], f = -1;
+      bool found = true;
+      for (int j = 0; j < nv && found; j++)
+      {
+         fv[j] = vert_global.FindSorted(recv[k+3+j]);
+         found = (fv[j] >= 0);
+      }
+      if (found)
+      {
+         std::sort(fv, fv + nv);
+         f = faces.Index(fv);
+      }
+      if (f >= 0 && face_owner[f] == MyRank)
+      {
+         bdr_rec.Append(Pair<int,int>(recv[k], k));
+      }
+      k += 3 + nv;
+   }
+   bdr_rec.Sort();
+
+   NumOfBdrElements = bdr_rec.Size();
+   boundary.SetSize(NumOfBdrElements);
+   Array<int> v;
+   for (int i = 0; i < NumOfBdrElements; i++)
+   {
+      const int *rec = &recv[bdr_rec[i].two];
+      const int nv = Geometry::NumVerts[rec[2]];
+      v.SetSize(nv);
+      for (int j = 0; j < nv; j++) { v[j] = vert_global.FindSorted(rec[3+j]); }
+      boundary[i] = NewElement(rec[2]);
+      boundary[i]->SetAttribute(rec[1]);
+      boundary[i]->SetVertices(v);
+   }
+}
+
+int ParMesh::GetDistributedFaceVertices(const Element *el, int f,
+                                        int *fv) const
+{
+   const int *v = el->GetVertices();
+   if (Dim == 1)
+   {
+      fv[0] = v[f];
+      return 1;
+   }
+   const int nfv = (Dim == 3) ? el->GetNFaceVertices(f) : 2;
+   const int *lv = (Dim == 3) ? el->GetFaceVertices(f) :
+                   el->GetEdgeVertices(f);
+   for (int j = 0; j < nfv; j++) { fv[j] = v[lv[j]]; }
+   return nfv;
+}
+
 ParMesh::ParMesh(ParMesh *orig_mesh, int ref_factor, int ref_type)
    : Mesh(orig_mesh, ref_factor, ref_type),
      MyComm(orig_mesh->GetComm()),
@@ -1338,7 +2362,7 @@ long ParMesh::GetGlobalElementNum(int local_element_num) const
 void ParMesh::DistributeAttributes(Array<int> &attr)
 {
    // Determine the largest attribute number across all processors
-   int max_attr = attr.Max();
+   int max_attr = attr.Size() ? attr.Max() : 1;
    int glb_max_attr = -1;
    MPI_Allreduce(&max_attr, &glb_max_attr, 1, MPI_INT, MPI_MAX, MyComm);
 
@@ -3384,7 +4408,24 @@ void ParMesh::Rebalance(const Array<int> &partition)
    RebalanceImpl(&partition);
 }
 
-void ParMesh::RebalanceImpl(const Array<int> *partition)
+bool ParMesh::Rebalance(const Array<double> &elem_weights,
+                        double max_imbalance)
+{
+   MFEM_VERIFY(Nonconforming(), "Load balancing is currently not supported "
+               "for conforming meshes.");
+
+   // hysteresis: migrating the mesh is not worth it for a small imbalance
+   if (pncmesh->GetLoadImbalance(&elem_weights) <= max_imbalance)
+   {
+      return false;
+   }
+
+   RebalanceImpl(NULL, &elem_weights);
+   return true;
+}
+
+void ParMesh::RebalanceImpl(const Array<int> *partition,
+                            const Array<double> *weights)
 {
    if (Conforming())
    {
@@ -3411,7 +4452,14 @@ void ParMesh::RebalanceImpl(const Array<int> *partition)
 
    DeleteFaceNbrData();
 
-   pncmesh->Rebalance(partition);
+   if (weights)
+   {
+      pncmesh->Rebalance(*weights);
+   }
+   else
+   {
+      pncmesh->Rebalance(partition);
+   }
 
    ParMesh* pmesh2 = new ParMesh(*pncmesh);
    pncmesh->OnMeshUpdated(pmesh2);
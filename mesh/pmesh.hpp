@@ -148,7 +148,8 @@ protected:
                                           double threshold, int nc_limit = 0,
                                           int op = 1);
 
-   void RebalanceImpl(const Array<int> *partition);
+   void RebalanceImpl(const Array<int> *partition,
+                      const Array<double> *weights = NULL);
 
    void DeleteFaceNbrData();
 
@@ -202,6 +203,18 @@ protected:
    /// Ensure that bdr_attributes and attributes agree across processors
    void DistributeAttributes(Array<int> &attr);
 
+   // Helpers of the constructor reading a serial mesh file in parallel. The
+   // local vertices are numbered in the order of their global indices,
+   // 'vert_global'.
+   void LoadDistributedElements(const Array<int> &elem_data,
+                                const Array<double> &elem_coords,
+                                Array<int> &vert_global);
+   void BuildDistributedSharedData(int num_vert_glob,
+                                   const Array<int> &vert_global,
+                                   int bdr_offset, const Array<int> &bdr_I,
+                                   const Array<int> &bdr_J);
+   int GetDistributedFaceVertices(const Element *el, int f, int *fv) const;
+
 public:
    /** Copy constructor. Performs a deep copy of (almost) all data, so that the
        source mesh can be modified (e.g. deleted, refined) without affecting the
@@ -216,6 +229,29 @@ public:
    /** The @a refine parameter is passed to the method Mesh::Finalize(). */
    ParMesh(MPI_Comm comm, std::istream &input, bool refine = true);
 
+   /** @brief Read a serial mesh file in parallel, without constructing the
+       serial mesh on any rank.
+
+       Each rank reads an equal part of the file @a filename, the elements are
+       partitioned in parallel and sent to their ranks, and the shared
+       entities are determined by matching the element faces, edges and
+       vertices of the ranks on the ranks given by their global vertex indices.
+       The memory usage per rank is thus proportional to the size of the file
+       divided by the number of ranks.
+
+       If @a sfc_partitioning is true, the elements are ordered along a Hilbert
+       curve through their centers (see Mesh::HilbertIndex()) and split into
+       parts of equal size; otherwise, the elements are split into blocks of
+       consecutive elements, in the order of the file.
+
+       The parameters @a refine and @a fix_orientation are passed to the method
+       Mesh::Finalize().
+
+       @note Only linear, conforming meshes in the "MFEM mesh v1.0" format with
+       one element, boundary element or vertex per line are supported. */
+   ParMesh(MPI_Comm comm, const char *filename, bool refine = true,
+           bool fix_orientation = true, bool sfc_partitioning = true);
+
    /// Create a uniformly refined (by any factor) version of @a orig_mesh.
    /** @param[in] orig_mesh  The starting coarse mesh.
        @param[in] ref_factor The refinement factor, an integer > 1.
@@ -326,6 +362,16 @@ public:
        for 0 <= i < GetNE(). */
    void Rebalance(const Array<int> &partition);
 
+   /** Load balance a nonconforming mesh by splitting the global space-filling
+       sequence of elements into parts of equal total weight, where
+       elem_weights[i] >= 0 is the cost of the local element 'i' (e.g., its
+       number of DOFs or its measured computation time). The mesh is left
+       unchanged if its current load imbalance (the maximum weight of a
+       processor divided by the average) does not exceed 'max_imbalance'.
+       Returns true if the mesh was rebalanced. */
+   bool Rebalance(const Array<double> &elem_weights,
+                  double max_imbalance = 1.0);
+
    /** Print the part of the mesh in the calling processor adding the interface
        as boundary (for visualization purposes) using the mfem v1.0 format. */
    virtual void Print(std::ostream &out = mfem::out) const;
@@ -1795,12 +1795,6 @@ void ParNCMesh::CheckDerefinementNCLevel(const Table &deref_table,
 
 void ParNCMesh::Rebalance(const Array<int> *custom_partition)
 {
-   send_rebalance_dofs.clear();
-   recv_rebalance_dofs.clear();
-
-   Array<int> old_elements;
-   leaf_elements.GetSubArray(0, NElements, old_elements);
-
    if (!custom_partition) // SFC based partitioning
    {
       Array<int> new_ranks(leaf_elements.Size());
@@ -1826,7 +1820,7 @@ void ParNCMesh::Rebalance(const Array<int> *custom_partition)
                             - PartitionFirstIndex(MyRank, total_elems);
 
       // assign the new ranks and send elements (plus ghosts) to new owners
-      RedistributeElements(new_ranks, target_elements, true);
+      RebalanceElements(new_ranks, target_elements);
    }
    else // whatever partitioning the user has passed
    {
@@ -1839,9 +1833,89 @@ void ParNCMesh::Rebalance(const Array<int> *custom_partition)
 
       new_ranks.SetSize(leaf_elements.Size(), -1); // make room for ghosts
 
-      RedistributeElements(new_ranks, -1, true);
+      RebalanceElements(new_ranks, -1);
+   }
+}
+
+void ParNCMesh::Rebalance(const Array<double> &elem_weights)
+{
+   MFEM_VERIFY(elem_weights.Size() == NElements,
+               "Size of the weight array must match the number "
+               "of local mesh elements (ParMesh::GetNE()).");
+
+   double local_weight = 0.0, total_weight = 0.0;
+   for (int i = 0; i < NElements; i++)
+   {
+      MFEM_ASSERT(elem_weights[i] >= 0.0, "negative element weight");
+      local_weight += elem_weights[i];
+   }
+   MPI_Allreduce(&local_weight, &total_weight, 1, MPI_DOUBLE, MPI_SUM, MyComm);
+   MFEM_VERIFY(total_weight > 0.0, "the total weight must be positive");
+
+   double first_weight = 0.0;
+   MPI_Scan(&local_weight, &first_weight, 1, MPI_DOUBLE, MPI_SUM, MyComm);
+   first_weight -= local_weight;
+
+   // each element goes to the processor whose equal share of the total weight
+   // contains the midpoint of the element's interval in the weighted sequence
+   Array<int> new_ranks(leaf_elements.Size());
+   new_ranks = -1;
+
+   Array<int> rank_elems(NRanks);
+   rank_elems = 0;
+
+   double weight = first_weight;
+   for (int i = 0; i < NElements; i++)
+   {
+      double mid = weight + 0.5*elem_weights[i];
+      int rank = (int) (mid * NRanks / total_weight);
+      new_ranks[i] = std::min(std::max(rank, 0), NRanks-1);
+      rank_elems[new_ranks[i]]++;
+      weight += elem_weights[i];
+   }
+
+   // the number of elements each processor will own is not a simple function
+   // of its rank, sum up the assignments so the cheaper SFC exchange is used
+   int target_elements = 0;
+   MPI_Reduce_scatter_block(rank_elems.GetData(), &target_elements, 1,
+                            MPI_INT, MPI_SUM, MyComm);
+
+   RebalanceElements(new_ranks, target_elements);
+}
+
+double ParNCMesh::GetLoadImbalance(const Array<double> *elem_weights) const
+{
+   double local_weight = NElements;
+   if (elem_weights)
+   {
+      MFEM_VERIFY(elem_weights->Size() == NElements,
+                  "Size of the weight array must match the number "
+                  "of local mesh elements (ParMesh::GetNE()).");
+      local_weight = 0.0;
+      for (int i = 0; i < NElements; i++)
+      {
+         local_weight += (*elem_weights)[i];
+      }
    }
 
+   double max_weight = 0.0, total_weight = 0.0;
+   MPI_Allreduce(&local_weight, &max_weight, 1, MPI_DOUBLE, MPI_MAX, MyComm);
+   MPI_Allreduce(&local_weight, &total_weight, 1, MPI_DOUBLE, MPI_SUM, MyComm);
+
+   return (total_weight > 0.0) ? max_weight * NRanks / total_weight : 1.0;
+}
+
+void ParNCMesh::RebalanceElements(Array<int> &new_ranks, int target_elements)
+{
+   send_rebalance_dofs.clear();
+   recv_rebalance_dofs.clear();
+   rebalance_stats = RebalanceStats();
+
+   Array<int> old_elements;
+   leaf_elements.GetSubArray(0, NElements, old_elements);
+
+   RedistributeElements(new_ranks, target_elements, true);
+
    // set up the old index array
    old_index_or_rank.SetSize(NElements);
    old_index_or_rank = -1;
@@ -2016,6 +2090,10 @@ void ParNCMesh::RedistributeElements(Array<int> &new_ranks, int target_elements,
             if (record_comm)
             {
                send_rebalance_dofs[rank].SetElements(rank_elems, this);
+
+               rebalance_stats.messages++;
+               rebalance_stats.elements += rank_elems.Size();
+               rebalance_stats.element_bytes += msg.data.length();
             }
          }
 
@@ -2160,6 +2238,12 @@ void ParNCMesh::SendRebalanceDofs(int old_ndofs,
 
    // send the DOFs to element recipients from last Rebalance()
    RebalanceDofMessage::IsendAll(send_rebalance_dofs, MyComm);
+
+   for (it = send_rebalance_dofs.begin(); it != send_rebalance_dofs.end(); ++it)
+   {
+      rebalance_stats.dofs += it->second.dofs.size();
+      rebalance_stats.dof_bytes += it->second.data.length();
+   }
 }
 
 
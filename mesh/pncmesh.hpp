@@ -94,6 +94,19 @@ public:
        passed. */
    void Rebalance(const Array<int> *custom_partition = NULL);
 
+   /** Weighted version of Rebalance(): the space-filling sequence of leaf
+       elements is split so that each processor receives (nearly) the same
+       total weight instead of the same number of elements. The weight of the
+       local element 'i' (0 <= i < GetNElements()), e.g., its number of DOFs,
+       its number of particles or its measured computation time, is given by
+       elem_weights[i] and must be nonnegative. */
+   void Rebalance(const Array<double> &elem_weights);
+
+   /** Return the load imbalance of the current partitioning, i.e., the maximum
+       total weight of a processor divided by the average. If 'elem_weights'
+       is NULL, all elements have unit weight. This is a collective call. */
+   double GetLoadImbalance(const Array<double> *elem_weights = NULL) const;
+
 
    // interface for ParFiniteElementSpace
 
@@ -202,6 +215,24 @@ public:
    /// Receive element DOFs sent by SendRebalanceDofs().
    void RecvRebalanceDofs(Array<int> &elements, Array<long> &dofs);
 
+   /** Amount of data sent by this processor to other processors in the last
+       Rebalance() and in the SendRebalanceDofs() calls that followed it (one
+       for each finite element space that was updated). */
+   struct RebalanceStats
+   {
+      int messages;       ///< Number of element messages sent.
+      long elements;      ///< Number of local elements given to other ranks.
+      long element_bytes; ///< Size of the element messages (including ghosts).
+      long dofs;          ///< Number of (vector) DOFs sent.
+      long dof_bytes;     ///< Size of the DOF messages.
+
+      RebalanceStats()
+         : messages(0), elements(0), element_bytes(0), dofs(0), dof_bytes(0) {}
+   };
+
+   /// Return the local migration statistics of the last Rebalance().
+   const RebalanceStats& GetRebalanceStats() const { return rebalance_stats; }
+
    /** Get previous indices (pre-Rebalance) of current elements. Index of -1
        indicates that an element didn't exist in the mesh before. */
    const Array<int>& GetRebalanceOldIndex() const { return old_index_or_rank; }
@@ -526,6 +557,14 @@ protected: // implementation
    void RedistributeElements(Array<int> &new_ranks, int target_elements,
                              bool record_comm);
 
+   /** Common part of the Rebalance() variants: migrate the elements according
+       to 'new_ranks' (see RedistributeElements) and set up the old index
+       array and the communication pattern for Send/RecvRebalanceDofs. */
+   void RebalanceElements(Array<int> &new_ranks, int target_elements);
+
+   /// Migration statistics of the last Rebalance(), see GetRebalanceStats().
+   RebalanceStats rebalance_stats;
+
    /** Recorded communication pattern from last Rebalance. Used by
        Send/RecvRebalanceDofs to ship element DOFs. */
    RebalanceDofMessage::Map send_rebalance_dofs;
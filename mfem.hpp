@@ -22,8 +22,10 @@
 #include "general/mem_alloc.hpp"
 #include "general/sort_pairs.hpp"
 #include "general/stable3d.hpp"
+#include "general/tuple_table.hpp"
 #include "general/table.hpp"
 #include "general/tic_toc.hpp"
+#include "general/kernel_stats.hpp"
 #ifdef MFEM_USE_ADIOS2
 #include "general/adios2stream.hpp"
 #endif
@@ -0,0 +1,533 @@
+// Copyright (c) 2010-2020, Lawrence Livermore National Security, LLC. Produced
+// at the Lawrence Livermore National Laboratory. All Rights reserved. See files
+// LICENSE and NOTICE for details. LLNL-CODE-806117.
+//
+// This file is part of the MFEM library. For more information and source code
+// availability visit https://mfem.org.
+//
+// MFEM is free software; you can redistribute it and/or modify it under the
+// terms of the BSD-3 license. We welcome feedback and contributions, see file
+// CONTRIBUTING.md for details.
+//
+//        ---------------------------------------------------------------
+//        Mesh Benchmark Miniapp:  Memory usage and topology construction
+//        ---------------------------------------------------------------
+//
+// This miniapp measures the memory used by the Mesh data structures on a given
+// mesh refined uniformly several times. For every refinement level, it reports
+// the total memory of the Mesh, the memory of its Element objects (elements,
+// boundary elements and faces), and the memory of the same entities stored in
+// a CompactElementArray, where the vertex indices, attributes and geometries
+// are kept in flat arrays. It also verifies that the Mesh reconstructed from
+// the compact storage has the same topology.
+//
+// In addition, the miniapp compares the time to construct a Cartesian mesh
+// (edges, faces and face info included) with the hash tables DSTable and
+// STable3D and with the sort-based TupleTable, see Mesh::sorted_topology, and
+// checks that the two topologies are the same. The sort-based construction is
+// multithreaded when MFEM is built with OpenMP (MFEM_USE_OPENMP=YES), and the
+// number of threads can be set with OMP_NUM_THREADS.
+//
+// The miniapp also times the mesh readers on the refined mesh written in the
+// MFEM, VTK (legacy and XML) and Gmsh (MSH 4.1, ASCII and binary) formats.
+//
+// If a number of parts is given with -p, the refined mesh is partitioned along
+// the Hilbert and Morton space-filling curves, see
+// Mesh::GenerateSFCPartitioning(), with unit weights and with the number of
+// dofs of the elements as weights, and with METIS if MFEM is built with it.
+// The time, the edge cut, the load imbalance and the number of disconnected
+// parts of every partitioning are reported.
+//
+// Finally, if a locality ordering is given with -l, the miniapp shuffles the
+// elements of the refined mesh (emulating an unstructured mesh with a poor
+// ordering), reorders it with Mesh::ReorderForLocality(), and compares the
+// time of the partially assembled diffusion operator and the gather/scatter
+// stride statistics of the ElementRestriction on the shuffled and on the
+// reordered mesh. The solution on the reordered mesh, mapped back to the
+// original numbering, is checked against the one on the shuffled mesh.
+//
+// Compile with: make mesh-benchmark
+//
+// Sample runs:  mesh-benchmark
+//               mesh-benchmark -m ../../data/beam-tet.mesh -r 4
+//               mesh-benchmark -m ../../data/fichera-mixed.mesh -r 3
+//               mesh-benchmark -m ../../data/star.mesh -r 5 -d
+//               mesh-benchmark -r 0 -c 100 -t hex
+//               mesh-benchmark -r 0 -c 60 -t tet
+//               mesh-benchmark -m ../../data/fichera.mesh -r 2 -c 0 -l hilbert
+//               mesh-benchmark -m ../../data/star.mesh -r 4 -c 0 -l rcm -o 3
+//               mesh-benchmark -m ../../data/escher.mesh -r 3 -c 0 -p 64
+
+#include "mfem.hpp"
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <cstring>
+#include <map>
+
+using namespace std;
+using namespace mfem;
+
+// Return true if the two meshes have the same edges, faces and face info.
+bool SameTopology(const Mesh &a, const Mesh &b)
+{
+   if (a.GetNEdges() != b.GetNEdges() || a.GetNFaces() != b.GetNFaces())
+   {
+      return false;
+   }
+   const Table *tbl[2][2] = { { &a.ElementToEdgeTable(),
+                                &b.ElementToEdgeTable() },
+                              { &a.ElementToFaceTable(),
+                                &b.ElementToFaceTable() }
+                            };
+   for (int k = 0; k < 2; k++)
+   {
+      const int nnz = tbl[k][0]->Size_of_connections();
+      if (nnz != tbl[k][1]->Size_of_connections() ||
+          memcmp(tbl[k][0]->GetJ(), tbl[k][1]->GetJ(), nnz*sizeof(int)))
+      {
+         return false;
+      }
+   }
+   for (int f = 0; f < a.GetNumFaces(); f++)
+   {
+      int ea[2], eb[2], ia[2], ib[2];
+      a.GetFaceElements(f, &ea[0], &ea[1]);
+      b.GetFaceElements(f, &eb[0], &eb[1]);
+      a.GetFaceInfos(f, &ia[0], &ia[1]);
+      b.GetFaceInfos(f, &ib[0], &ib[1]);
+      if (ea[0] != eb[0] || ea[1] != eb[1] || ia[0] != ib[0] || ia[1] != ib[1])
+      {
+         return false;
+      }
+   }
+   return true;
+}
+
+// Shuffle the elements of the mesh with a pseudo-random permutation.
+void ShuffleElements(Mesh &mesh)
+{
+   Array<int> ordering(mesh.GetNE());
+   for (int i = 0; i < ordering.Size(); i++) { ordering[i] = i; }
+   srand(1);
+   for (int i = ordering.Size()-1; i > 0; i--)
+   {
+      Swap(ordering[i], ordering[rand() % (i+1)]);
+   }
+   mesh.ReorderElements(ordering);
+}
+
+// Writer of the values of a Gmsh file, in ASCII or binary format.
+struct GmshWriter
+{
+   ostream &out;
+   bool binary;
+
+   template <typename T> void Bin(T v)
+   { out.write(reinterpret_cast<const char*>(&v), sizeof(T)); }
+   void Int(int v)
+   { if (binary) { Bin<int32_t>(v); } else { out << v << ' '; } }
+   void Size(long v)
+   { if (binary) { Bin<uint64_t>(v); } else { out << v << ' '; } }
+   void Double(double v)
+   { if (binary) { Bin(v); } else { out << v << ' '; } }
+   void EndLine() { if (!binary) { out << '\n'; } }
+};
+
+// Write a linear mesh in the Gmsh MSH 4.1 format, ASCII or binary. The
+// elements and the boundary elements are written in blocks of elements with
+// the same geometry and attribute; the attribute is the entity tag of the
+// block, and no $Entities section is written.
+void PrintGmsh41(Mesh &mesh, ostream &out, bool binary)
+{
+   GmshWriter w = { out, binary };
+   const int gmsh_type[Geometry::NumGeom] = { 15, 1, 2, 3, 4, 5, 6 };
+
+   out << setprecision(17);
+   out << "$MeshFormat\n4.1 " << binary << " 8\n";
+   if (binary) { w.Int(1); out << '\n'; }
+   out << "$EndMeshFormat\n$Nodes\n";
+   const int nv = mesh.GetNV(), sdim = mesh.SpaceDimension();
+   w.Size(1); w.Size(nv); w.Size(1); w.Size(nv); w.EndLine();
+   w.Int(mesh.Dimension()); w.Int(1); w.Int(0); w.Size(nv); w.EndLine();
+   for (int i = 0; i < nv; i++) { w.Size(i+1); w.EndLine(); }
+   for (int i = 0; i < nv; i++)
+   {
+      for (int d = 0; d < 3; d++)
+      {
+         w.Double(d < sdim ? mesh.GetVertex(i)[d] : 0.0);
+      }
+      w.EndLine();
+   }
+   out << "\n$EndNodes\n$Elements\n";
+
+   // blocks of the elements (k = 0) and boundary elements (k = 1)
+   std::map<std::pair<int, int>, Array<int> > blocks[2];
+   for (int k = 0; k < 2; k++)
+   {
+      const int n = (k == 0) ? mesh.GetNE() : mesh.GetNBE();
+      for (int i = 0; i < n; i++)
+      {
+         const Element *el = (k == 0) ? mesh.GetElement(i) :
+                             mesh.GetBdrElement(i);
+         blocks[k][std::make_pair((int) el->GetGeometryType(),
+                                  el->GetAttribute())].Append(i);
+      }
+   }
+   w.Size(blocks[0].size() + blocks[1].size());
+   w.Size(mesh.GetNE() + mesh.GetNBE()); w.Size(1);
+   w.Size(mesh.GetNE() + mesh.GetNBE()); w.EndLine();
+   long tag = 1;
+   for (int k = 0; k < 2; k++)
+   {
+      for (auto &block : blocks[k])
+      {
+         const int geom = block.first.first;
+         const Array<int> &elems = block.second;
+         w.Int(Geometry::Dimension[geom]); w.Int(block.first.second);
+         w.Int(gmsh_type[geom]); w.Size(elems.Size()); w.EndLine();
+         for (int i = 0; i < elems.Size(); i++)
+         {
+            const Element *el = (k == 0) ? mesh.GetElement(elems[i]) :
+                                mesh.GetBdrElement(elems[i]);
+            w.Size(tag++);
+            for (int j = 0; j < el->GetNVertices(); j++)
+            {
+               w.Size(el->GetVertices()[j] + 1);
+            }
+            w.EndLine();
+         }
+      }
+   }
+   out << "\n$EndElements\n";
+}
+
+// Return the time to read the mesh from the input string, and check that it
+// has the given number of elements.
+double TimeRead(const string &input, int ne)
+{
+   istringstream in(input);
+   tic();
+   Mesh mesh(in, 1, 1);
+   const double t = toc();
+   MFEM_VERIFY(mesh.GetNE() == ne, "wrong number of elements");
+   return t;
+}
+
+// Return the time of the action of the partially assembled diffusion operator
+// on the space of y, averaged over nmult actions, and print the stride
+// statistics of its element restriction. The result of the action on the
+// interpolant of a smooth function is returned in y.
+double TimeDiffusionPA(int nmult, GridFunction &y)
+{
+   FiniteElementSpace *fes = y.FESpace();
+   FunctionCoefficient u([](const Vector &x)
+   {
+      double r = 1.0;
+      for (int d = 0; d < x.Size(); d++) { r *= sin(1.0 + x(d)); }
+      return r;
+   });
+   GridFunction x(fes);
+   x.ProjectCoefficient(u);
+
+   BilinearForm a(fes);
+   a.SetAssemblyLevel(AssemblyLevel::PARTIAL);
+   a.AddDomainIntegrator(new DiffusionIntegrator);
+   a.Assemble();
+
+   a.Mult(x, y);
+   tic();
+   for (int i = 0; i < nmult; i++) { a.Mult(x, y); }
+   const double t = toc()/nmult;
+
+   const ElementRestriction *R = dynamic_cast<const ElementRestriction*>(
+      fes->GetElementRestriction(ElementDofOrdering::LEXICOGRAPHIC));
+   if (R) { R->PrintStrideStatistics(cout); }
+   return t;
+}
+
+int main(int argc, char *argv[])
+{
+   const char *mesh_file = "../../data/beam-tet.mesh";
+   int ref_levels = 3;
+   bool detail = false;
+   int cart_n = 10;
+   const char *cart_type = "hex";
+   const char *locality = "none";
+   int order = 2;
+   int nmult = 20;
+   bool readers = true;
+   int nparts = 16;
+
+   OptionsParser args(argc, argv);
+   args.AddOption(&mesh_file, "-m", "--mesh",
+                  "Mesh file to use.");
+   args.AddOption(&ref_levels, "-r", "--refine",
+                  "Number of uniform refinements of the mesh.");
+   args.AddOption(&detail, "-d", "--detail", "-no-d", "--no-detail",
+                  "Print the memory usage of the Mesh data structures.");
+   args.AddOption(&cart_n, "-c", "--cartesian",
+                  "Number of elements in each direction of the Cartesian mesh"
+                  " used to time the topology construction (0 to skip).");
+   args.AddOption(&cart_type, "-t", "--type",
+                  "Element type of the Cartesian mesh: hex, tet or wedge.");
+   args.AddOption(&locality, "-l", "--locality",
+                  "Locality ordering to benchmark: none, hilbert, gecko or"
+                  " rcm.");
+   args.AddOption(&order, "-o", "--order",
+                  "Order of the space used for the locality benchmark.");
+   args.AddOption(&nmult, "-n", "--num-mult",
+                  "Number of operator actions timed in the locality"
+                  " benchmark.");
+   args.AddOption(&readers, "-rd", "--readers", "-no-rd", "--no-readers",
+                  "Time the mesh readers on the refined mesh.");
+   args.AddOption(&nparts, "-p", "--parts",
+                  "Number of parts of the partitioning benchmark (0 to"
+                  " skip).");
+   args.Parse();
+   if (!args.Good())
+   {
+      args.PrintUsage(cout);
+      return 1;
+   }
+   args.PrintOptions(cout);
+
+   Mesh mesh(mesh_file, 1, 1);
+   const int dim = mesh.Dimension();
+   const double MiB = 1024.*1024.;
+
+   cout << "\n level         NE   Mesh [MiB]  B/elem   Element objects [MiB]"
+        << "   compact [MiB]   ratio\n";
+   for (int l = 0; l <= ref_levels; l++)
+   {
+      if (l > 0) { mesh.UniformRefinement(); }
+
+      CompactElementArray elems, bdr_elems, face_elems;
+      tic();
+      mesh.GetCompactElements(elems);
+      mesh.GetCompactBdrElements(bdr_elems);
+      mesh.GetCompactFaces(face_elems);
+      const double t_compact = toc();
+
+      // Memory of the Element objects and the arrays of pointers to them, for
+      // the elements, the boundary elements and the faces.
+      long el_mem = 0;
+      const int ne[3] = { mesh.GetNE(), mesh.GetNBE(),
+                          dim > 1 ? mesh.GetNumFaces() : 0
+                        };
+      for (int k = 0; k < 3; k++)
+      {
+         for (int i = 0; i < ne[k]; i++)
+         {
+            const Element *el = (k == 0) ? mesh.GetElement(i) :
+                                (k == 1) ? mesh.GetBdrElement(i) :
+                                mesh.GetFace(i);
+            el_mem += el->MemoryUsage();
+            el_mem += sizeof(Element*);
+         }
+      }
+      const long compact_mem = elems.MemoryUsage() + bdr_elems.MemoryUsage() +
+                               face_elems.MemoryUsage();
+      const long mesh_mem = mesh.MemoryUsage();
+
+      cout << setw(6) << l << setw(11) << mesh.GetNE()
+           << setw(13) << mesh_mem/MiB
+           << setw(8) << mesh_mem/mesh.GetNE()
+           << setw(24) << el_mem/MiB
+           << setw(16) << compact_mem/MiB
+           << setw(8) << setprecision(3) << double(el_mem)/compact_mem
+           << setprecision(6) << endl;
+
+      if (l == ref_levels)
+      {
+         cout << "\nTime to build the compact storage: " << t_compact
+              << " s\n";
+         if (detail)
+         {
+            cout << "\nMemory usage of the Mesh data structures (bytes):\n";
+            mesh.PrintMemoryDetail(cout);
+         }
+
+         // Reconstruct the mesh from the compact storage, reusing the vertex
+         // coordinates of the original mesh, and compare the topology.
+         Vector vert(3*mesh.GetNV());
+         for (int i = 0; i < mesh.GetNV(); i++)
+         {
+            for (int d = 0; d < 3; d++)
+            {
+               vert(3*i + d) = (d < mesh.SpaceDimension()) ?
+                               mesh.GetVertex(i)[d] : 0.0;
+            }
+         }
+         Mesh copy(vert.GetData(), mesh.GetNV(), elems, bdr_elems, dim,
+                   mesh.SpaceDimension());
+         const bool same = (copy.GetNE() == mesh.GetNE() &&
+                            copy.GetNBE() == mesh.GetNBE() &&
+                            copy.GetNEdges() == mesh.GetNEdges() &&
+                            copy.GetNFaces() == mesh.GetNFaces());
+         cout << "Mesh reconstructed from the compact storage: "
+              << (same ? "same" : "DIFFERENT") << " topology\n";
+         if (!same) { return 2; }
+      }
+   }
+
+   if (cart_n > 0)
+   {
+      Element::Type type;
+      if (!strcmp(cart_type, "hex")) { type = Element::HEXAHEDRON; }
+      else if (!strcmp(cart_type, "tet")) { type = Element::TETRAHEDRON; }
+      else if (!strcmp(cart_type, "wedge")) { type = Element::WEDGE; }
+      else
+      {
+         cout << "Unknown element type: " << cart_type << endl;
+         return 1;
+      }
+
+      // Construct the Cartesian mesh with the hash tables and with sorting.
+      const bool sorted_topology = Mesh::sorted_topology;
+      Mesh *cart[2];
+      double t_cart[2];
+      for (int k = 0; k < 2; k++)
+      {
+         Mesh::sorted_topology = (k == 1);
+         tic();
+         cart[k] = new Mesh(cart_n, cart_n, cart_n, type);
+         t_cart[k] = toc();
+      }
+      Mesh::sorted_topology = sorted_topology;
+
+      cout << "\nCartesian " << cart_type << " mesh with " << cart[0]->GetNE()
+           << " elements, " << cart[0]->GetNFaces() << " faces and "
+           << cart[0]->GetNEdges() << " edges\n"
+           << "Construction with hash tables: " << t_cart[0] << " s\n"
+           << "Construction with sorting:     " << t_cart[1] << " s\n"
+           << "Speedup: " << t_cart[0]/t_cart[1] << endl;
+      const bool same = SameTopology(*cart[0], *cart[1]);
+      cout << "Topology: " << (same ? "same" : "DIFFERENT") << endl;
+      delete cart[0];
+      delete cart[1];
+      if (!same) { return 2; }
+   }
+
+   if (readers && !mesh.NURBSext && !mesh.GetNodes())
+   {
+      // Write the refined mesh in several formats and time the readers.
+      const int num_formats = 6;
+      const char *names[num_formats] =
+      {
+         "MFEM", "VTK legacy", "VTU ascii", "VTU binary", "Gmsh 4.1 ascii",
+         "Gmsh 4.1 binary"
+      };
+      ostringstream out[num_formats];
+      mesh.Print(out[0]);
+      mesh.PrintVTK(out[1]);
+      for (int k = 2; k <= 3; k++)
+      {
+         out[k] << "<VTKFile type=\"UnstructuredGrid\" version=\"0.1\""
+                << " byte_order=\"" << VTKByteOrder() << "\">\n"
+                << "<UnstructuredGrid>\n";
+         mesh.PrintVTU(out[k], 1,
+                       k == 2 ? VTKFormat::ASCII : VTKFormat::BINARY);
+         out[k] << "</Piece>\n</UnstructuredGrid>\n</VTKFile>\n";
+      }
+      PrintGmsh41(mesh, out[4], false);
+      PrintGmsh41(mesh, out[5], true);
+
+      cout << "\nReading the refined mesh with " << mesh.GetNE()
+           << " elements:\n format             size [MiB]    time [s]"
+           << "   MiB/s\n";
+      for (int k = 0; k < num_formats; k++)
+      {
+         const string input = out[k].str();
+         const double t = TimeRead(input, mesh.GetNE());
+         cout << ' ' << left << setw(16) << names[k] << right
+              << setw(13) << input.size()/MiB << setw(12) << t
+              << setw(8) << input.size()/MiB/t << endl;
+      }
+   }
+
+   if (nparts > 0 && !mesh.NURBSext)
+   {
+      // Partition the refined mesh with the space-filling curves and METIS.
+      H1_FECollection fec(order, dim);
+      FiniteElementSpace fes(&mesh, &fec);
+      Array<double> dof_weights(mesh.GetNE());
+      for (int i = 0; i < mesh.GetNE(); i++)
+      {
+         dof_weights[i] = fes.GetFE(i)->GetDof();
+      }
+
+      cout << "\nPartitioning the refined mesh into " << nparts << " parts:\n"
+           << " method                time [s]   edge cut   imbalance"
+           << "   disconnected\n";
+      const int num_methods = 4;
+      const char *names[num_methods] =
+      {
+         "Hilbert", "Morton", "Hilbert, dof weights", "METIS k-way"
+      };
+      for (int k = 0; k < num_methods; k++)
+      {
+#ifndef MFEM_USE_METIS
+         if (k == 3) { continue; }
+#endif
+         const double *weights = (k == 2) ? dof_weights.GetData() : NULL;
+         tic();
+         int *partitioning = (k == 3) ?
+                             mesh.GeneratePartitioning(nparts, 1) :
+                             mesh.GenerateSFCPartitioning(nparts, weights,
+                                                          k != 1);
+         const double t = toc();
+         int edge_cut, disconnected;
+         double imbalance;
+         mesh.GetPartitioningStats(partitioning, nparts, edge_cut, imbalance,
+                                   disconnected, weights);
+         cout << ' ' << left << setw(20) << names[k] << right << setw(10) << t
+              << setw(11) << edge_cut << setw(12) << imbalance
+              << setw(15) << disconnected << endl;
+         delete [] partitioning;
+      }
+   }
+
+   typedef LocalityOrdering LO;
+   LO::Type loc_type;
+   if (!strcmp(locality, "none")) { loc_type = LO::NONE; }
+   else if (!strcmp(locality, "hilbert")) { loc_type = LO::HILBERT; }
+   else if (!strcmp(locality, "gecko")) { loc_type = LO::GECKO; }
+   else if (!strcmp(locality, "rcm")) { loc_type = LO::RCM; }
+   else
+   {
+      cout << "Unknown locality ordering: " << locality << endl;
+      return 1;
+   }
+   if (loc_type != LO::NONE && !mesh.NURBSext)
+   {
+      ShuffleElements(mesh);
+      Mesh reordered(mesh);
+      tic();
+      reordered.ReorderForLocality(loc_type);
+      const double t_reorder = toc();
+
+      H1_FECollection fec(order, dim);
+      FiniteElementSpace fes(&mesh, &fec), reordered_fes(&reordered, &fec);
+      GridFunction y(&fes), reordered_y(&reordered_fes), mapped_y(&fes);
+
+      cout << "\nShuffled mesh, " << fes.GetNDofs() << " dofs of order "
+           << order << ":\n";
+      const double t_shuffled = TimeDiffusionPA(nmult, y);
+      cout << "Reordered mesh (" << locality << "):\n";
+      const double t_reordered = TimeDiffusionPA(nmult, reordered_y);
+      cout << "Time to reorder the mesh: " << t_reorder << " s\n"
+           << "PA diffusion action, shuffled:  " << t_shuffled << " s\n"
+           << "PA diffusion action, reordered: " << t_reordered << " s\n"
+           << "Speedup: " << t_shuffled/t_reordered << endl;
+
+      reordered_fes.MapToOriginal(fes, reordered_y, mapped_y);
+      mapped_y -= y;
+      const double err = mapped_y.Normlinf()/y.Normlinf();
+      cout << "Result mapped to the original numbering: relative difference "
+           << err << endl;
+      if (err > 1e-10) { return 2; }
+   }
+
+   return 0;
+}
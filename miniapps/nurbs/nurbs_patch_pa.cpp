@@ -0,0 +1,166 @@
+//                 MFEM NURBS Patch-wise Partial Assembly Benchmark
+//
+// Compile with: make nurbs_patch_pa
+//
+// Sample runs:  nurbs_patch_pa
+//               nurbs_patch_pa -m ../../data/square-disc-nurbs.mesh -o 4
+//               nurbs_patch_pa -m ../../data/pipe-nurbs.mesh -o 3 -r 1
+//               nurbs_patch_pa -m ../../data/cube-nurbs.mesh -o 4 -r 2 -q 3
+//
+// Description:  This miniapp compares the element-wise assembly of the NURBS
+//               mass + diffusion operator, where the rational shape functions
+//               are evaluated element by element, with the patch-wise partial
+//               assembly (see NURBSPatchPA), which tabulates the B-spline
+//               bases once per patch and direction and applies the operator
+//               with sum factorization over each patch.
+//
+//               The setup and application times of both paths are reported,
+//               together with the relative difference of their actions on a
+//               random vector. With the option -q, the patch-wise path uses a
+//               reduced number of Gauss points per knot span. Finally, the
+//               problem -Delta u + u = 1 with homogeneous Dirichlet boundary
+//               conditions is solved with PCG and a Jacobi preconditioner
+//               based on the partially assembled diagonal.
+
+#include "mfem.hpp"
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+
+using namespace std;
+using namespace mfem;
+
+int main(int argc, char *argv[])
+{
+   // 1. Parse command-line options.
+   const char *mesh_file = "../../data/square-nurbs.mesh";
+   int ref_levels = 2;
+   int order = 3;
+   int q1d = 0;
+   int nmult = 10;
+   bool solve = true;
+
+   OptionsParser args(argc, argv);
+   args.AddOption(&mesh_file, "-m", "--mesh",
+                  "NURBS mesh file to use.");
+   args.AddOption(&ref_levels, "-r", "--refine",
+                  "Number of times to refine the mesh uniformly.");
+   args.AddOption(&order, "-o", "--order",
+                  "Order (degree) of the NURBS space.");
+   args.AddOption(&q1d, "-q", "--points-per-span",
+                  "Gauss points per knot span of the patch-wise assembly,"
+                  " 0 = same rule as the element-wise assembly.");
+   args.AddOption(&nmult, "-n", "--num-mult",
+                  "Number of operator applications to time.");
+   args.AddOption(&solve, "-s", "--solve", "-no-s", "--no-solve",
+                  "Solve a Poisson-type problem with the patch-wise operator.");
+   args.Parse();
+   if (!args.Good())
+   {
+      args.PrintUsage(cout);
+      return 1;
+   }
+   args.PrintOptions(cout);
+
+   // 2. Read and refine the mesh, and define the NURBS space of the given
+   //    order on it.
+   Mesh mesh(mesh_file, 1, 1);
+   MFEM_VERIFY(mesh.NURBSext, "a NURBS mesh is required");
+   for (int l = 0; l < ref_levels; l++) { mesh.UniformRefinement(); }
+   NURBSFECollection fec(order);
+   NURBSExtension *ext = new NURBSExtension(mesh.NURBSext, order);
+   FiniteElementSpace fespace(&mesh, ext, &fec);
+   cout << "Number of patches: " << mesh.NURBSext->GetNP()
+        << ", elements: " << mesh.GetNE()
+        << ", unknowns: " << fespace.GetTrueVSize() << endl;
+
+   ConstantCoefficient one(1.0);
+   Vector x(fespace.GetVSize()), y_ea(x.Size()), y_pa(x.Size());
+   x.Randomize(1);
+   StopWatch sw;
+
+   // 3. Element-wise assembly of the sparse matrix, and its action.
+   BilinearForm a_ea(&fespace);
+   a_ea.AddDomainIntegrator(new DiffusionIntegrator(one));
+   a_ea.AddDomainIntegrator(new MassIntegrator(one));
+   sw.Clear(); sw.Start();
+   a_ea.Assemble();
+   a_ea.Finalize();
+   sw.Stop();
+   const double ea_setup = sw.RealTime();
+   sw.Clear(); sw.Start();
+   for (int i = 0; i < nmult; i++) { a_ea.Mult(x, y_ea); }
+   sw.Stop();
+   const double ea_mult = sw.RealTime() / nmult;
+
+   // 4. Patch-wise partial assembly, and its action.
+   BilinearForm a_pa(&fespace);
+   a_pa.SetAssemblyLevel(AssemblyLevel::PARTIAL);
+   DiffusionIntegrator *diff = new DiffusionIntegrator(one);
+   MassIntegrator *mass = new MassIntegrator(one);
+   diff->SetPatchPointsPerSpan(q1d);
+   mass->SetPatchPointsPerSpan(q1d);
+   a_pa.AddDomainIntegrator(diff);
+   a_pa.AddDomainIntegrator(mass);
+   sw.Clear(); sw.Start();
+   a_pa.Assemble();
+   sw.Stop();
+   const double pa_setup = sw.RealTime();
+   a_pa.Mult(x, y_pa);
+   sw.Clear(); sw.Start();
+   for (int i = 0; i < nmult; i++) { a_pa.Mult(x, y_pa); }
+   sw.Stop();
+   const double pa_mult = sw.RealTime() / nmult;
+
+   Vector diff_y(y_pa);
+   diff_y -= y_ea;
+   cout << "\n                 setup [s]     mult [s]\n"
+        << "element-wise  " << setw(12) << ea_setup << " "
+        << setw(12) << ea_mult << '\n'
+        << "patch-wise    " << setw(12) << pa_setup << " "
+        << setw(12) << pa_mult << '\n'
+        << "\nspeedup: setup " << ea_setup / pa_setup
+        << ", setup + " << nmult << " mult "
+        << (ea_setup + nmult*ea_mult) / (pa_setup + nmult*pa_mult)
+        << "\nrelative difference of the actions: "
+        << diff_y.Normlinf() / y_ea.Normlinf() << endl;
+
+   // 5. Solve -Delta u + u = 1 with homogeneous Dirichlet boundary conditions
+   //    with the patch-wise operator and a Jacobi preconditioner.
+   if (solve)
+   {
+      Array<int> ess_tdof_list;
+      if (mesh.bdr_attributes.Size())
+      {
+         Array<int> ess_bdr(mesh.bdr_attributes.Max());
+         ess_bdr = 1;
+         fespace.GetEssentialTrueDofs(ess_bdr, ess_tdof_list);
+      }
+      LinearForm b(&fespace);
+      b.AddDomainIntegrator(new DomainLFIntegrator(one));
+      b.Assemble();
+      GridFunction u(&fespace);
+      u = 0.0;
+
+      OperatorPtr A;
+      Vector B, X;
+      a_pa.FormLinearSystem(ess_tdof_list, u, b, A, X, B);
+      OperatorJacobiSmoother M(a_pa, ess_tdof_list);
+      CGSolver cg;
+      cg.SetRelTol(1e-10);
+      cg.SetMaxIter(2000);
+      cg.SetPrintLevel(0);
+      cg.SetOperator(*A);
+      cg.SetPreconditioner(M);
+      sw.Clear(); sw.Start();
+      cg.Mult(B, X);
+      sw.Stop();
+      a_pa.RecoverFEMSolution(X, b, u);
+      cout << "\nPCG with Jacobi: " << cg.GetNumIterations()
+           << " iterations, " << sw.RealTime() << " s, "
+           << (cg.GetConverged() ? "converged" : "NOT converged")
+           << ", max(u) = " << u.Max() << endl;
+   }
+
+   return 0;
+}
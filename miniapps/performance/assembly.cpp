@@ -0,0 +1,174 @@
+//                 MFEM Assembly Miniapp - Full vs. Partial Assembly
+//
+// Compile with: make assembly
+//
+// Sample runs:  assembly
+//               assembly -m ../../data/beam-tet.mesh -r 2 -o 3
+//               assembly -m ../../data/escher.mesh -r 1 -o 2
+//               assembly -m ../../data/escher-p2.mesh -r 1 -o 4
+//               assembly -m ../../data/square-disc.mesh -r 3 -o 4
+//               assembly -m ../../data/star-mixed.mesh -r 3 -o 4
+//               assembly -m ../../data/fichera-mixed.mesh -r 2 -o 3
+//               assembly -m ../../data/beam-hex.mesh -r 2 -o 3 -d cuda
+//
+// Description:  This miniapp compares the full (sparse matrix) assembly of the
+//               H1 mass + diffusion operator with its partial assembly, on any
+//               mesh. On meshes of triangles or tetrahedra, where the elements
+//               have no tensor-product basis, the partially assembled operator
+//               is applied with the full basis matrices of the element as a
+//               product batched over all elements, instead of with sum
+//               factorization. On meshes with mixed element types, each
+//               geometry is a separate batch with its own kernels.
+//
+//               The setup and application times of both assembly levels are
+//               reported, together with the relative difference of their
+//               actions on a random vector and the time and number of
+//               iterations of PCG with a Jacobi preconditioner for the problem
+//               -Delta u + u = 1 with homogeneous Dirichlet conditions.
+
+#include "mfem.hpp"
+#include "../../general/forall.hpp"
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+
+using namespace std;
+using namespace mfem;
+
+int main(int argc, char *argv[])
+{
+   // 1. Parse command-line options.
+   const char *mesh_file = "../../data/beam-tet.mesh";
+   int ref_levels = 1;
+   int order = 2;
+   int nmult = 10;
+   const char *device_config = "cpu";
+
+   OptionsParser args(argc, argv);
+   args.AddOption(&mesh_file, "-m", "--mesh",
+                  "Mesh file to use.");
+   args.AddOption(&ref_levels, "-r", "--refine",
+                  "Number of times to refine the mesh uniformly.");
+   args.AddOption(&order, "-o", "--order",
+                  "Finite element order (polynomial degree).");
+   args.AddOption(&nmult, "-n", "--num-mult",
+                  "Number of operator applications to time.");
+   args.AddOption(&device_config, "-d", "--device",
+                  "Device configuration string, see Device::Configure().");
+   args.Parse();
+   if (!args.Good())
+   {
+      args.PrintUsage(cout);
+      return 1;
+   }
+   args.PrintOptions(cout);
+
+   Device device(device_config);
+   device.Print();
+
+   // 2. Read and refine the mesh, and define the H1 space on it.
+   Mesh mesh(mesh_file, 1, 1);
+   for (int l = 0; l < ref_levels; l++) { mesh.UniformRefinement(); }
+   H1_FECollection fec(order, mesh.Dimension());
+   FiniteElementSpace fespace(&mesh, &fec);
+   cout << "Number of elements: " << mesh.GetNE()
+        << ", unknowns: " << fespace.GetTrueVSize() << endl;
+
+   ConstantCoefficient one(1.0);
+   Vector x(fespace.GetVSize()), y_fa(x.Size()), y_pa(x.Size());
+   x.UseDevice(true);
+   y_fa.UseDevice(true);
+   y_pa.UseDevice(true);
+   x.Randomize(1);
+   StopWatch sw;
+
+   // 3. Full assembly of the sparse matrix, and its action.
+   BilinearForm a_fa(&fespace);
+   a_fa.AddDomainIntegrator(new DiffusionIntegrator(one));
+   a_fa.AddDomainIntegrator(new MassIntegrator(one));
+   sw.Clear(); sw.Start();
+   a_fa.Assemble();
+   a_fa.Finalize();
+   sw.Stop();
+   const double fa_setup = sw.RealTime();
+   a_fa.Mult(x, y_fa);
+   MFEM_DEVICE_SYNC;
+   sw.Clear(); sw.Start();
+   for (int i = 0; i < nmult; i++) { a_fa.Mult(x, y_fa); }
+   MFEM_DEVICE_SYNC;
+   sw.Stop();
+   const double fa_mult = sw.RealTime() / nmult;
+
+   // 4. Partial assembly, and its action.
+   BilinearForm a_pa(&fespace);
+   a_pa.SetAssemblyLevel(AssemblyLevel::PARTIAL);
+   a_pa.AddDomainIntegrator(new DiffusionIntegrator(one));
+   a_pa.AddDomainIntegrator(new MassIntegrator(one));
+   sw.Clear(); sw.Start();
+   a_pa.Assemble();
+   MFEM_DEVICE_SYNC;
+   sw.Stop();
+   const double pa_setup = sw.RealTime();
+   a_pa.Mult(x, y_pa);
+   MFEM_DEVICE_SYNC;
+   sw.Clear(); sw.Start();
+   for (int i = 0; i < nmult; i++) { a_pa.Mult(x, y_pa); }
+   MFEM_DEVICE_SYNC;
+   sw.Stop();
+   const double pa_mult = sw.RealTime() / nmult;
+
+   Vector diff_y(y_pa);
+   diff_y -= y_fa;
+   cout << "\n                 setup [s]     mult [s]\n"
+        << "full          " << setw(12) << fa_setup << " "
+        << setw(12) << fa_mult << '\n'
+        << "partial       " << setw(12) << pa_setup << " "
+        << setw(12) << pa_mult << '\n'
+        << "\nspeedup: setup " << fa_setup / pa_setup
+        << ", mult " << fa_mult / pa_mult
+        << ", setup + " << nmult << " mult "
+        << (fa_setup + nmult*fa_mult) / (pa_setup + nmult*pa_mult)
+        << "\nrelative difference of the actions: "
+        << diff_y.Normlinf() / y_fa.Normlinf() << endl;
+
+   // 5. Solve -Delta u + u = 1 with homogeneous Dirichlet boundary conditions
+   //    with both operators and a Jacobi preconditioner.
+   Array<int> ess_tdof_list;
+   if (mesh.bdr_attributes.Size())
+   {
+      Array<int> ess_bdr(mesh.bdr_attributes.Max());
+      ess_bdr = 1;
+      fespace.GetEssentialTrueDofs(ess_bdr, ess_tdof_list);
+   }
+   LinearForm b(&fespace);
+   b.AddDomainIntegrator(new DomainLFIntegrator(one));
+   b.Assemble();
+   for (int level = 0; level < 2; level++)
+   {
+      BilinearForm &a = level ? a_pa : a_fa;
+      GridFunction u(&fespace);
+      u = 0.0;
+      OperatorPtr A;
+      Vector B, X;
+      a.FormLinearSystem(ess_tdof_list, u, b, A, X, B);
+      OperatorJacobiSmoother M(a, ess_tdof_list);
+      CGSolver cg;
+      cg.SetRelTol(1e-8);
+      cg.SetMaxIter(2000);
+      cg.SetPrintLevel(0);
+      cg.SetOperator(*A);
+      cg.SetPreconditioner(M);
+      sw.Clear(); sw.Start();
+      cg.Mult(B, X);
+      MFEM_DEVICE_SYNC;
+      sw.Stop();
+      a.RecoverFEMSolution(X, b, u);
+      cout << (level ? "\nPCG, partial: " : "\nPCG, full:    ")
+           << cg.GetNumIterations() << " iterations, " << sw.RealTime()
+           << " s, " << (cg.GetConverged() ? "converged" : "NOT converged")
+           << ", max(u) = " << u.Max();
+   }
+   cout << endl;
+
+   return 0;
+}
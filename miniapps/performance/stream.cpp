@@ -0,0 +1,160 @@
+//                 MFEM STREAM Miniapp - Vector Memory Bandwidth
+//
+// Compile with: make stream
+//
+// Sample runs:  stream
+//               stream -n 20000000 -r 20
+//               stream -d omp
+//               stream -d omp:pin
+//               stream -d omp:numa
+//               stream -d cuda
+//
+// Description:  This miniapp measures the sustainable memory bandwidth of the
+//               MFEM Vector kernels on the selected device, in the spirit of
+//               the STREAM benchmark of J. McCalpin. The four STREAM kernels
+//
+//                  Copy:   y = x
+//                  Scale:  z = a y
+//                  Add:    y = x + z
+//                  Triad:  x = z + a y
+//
+//               are run with MFEM_FORALL and the Vector methods Set() and
+//               add(), and the best rate over the repetitions is reported.
+//
+//               With the OpenMP backend, the option 'omp:numa' allocates the
+//               vectors with MemoryType::HOST_NUMA, whose pages are first
+//               touched by the threads that use them in the kernels, and pins
+//               the threads to the available CPUs. Comparing 'omp' and
+//               'omp:numa' on a multi-socket node shows the effect of the
+//               first-touch placement.
+
+#include "mfem.hpp"
+#include "../../general/forall.hpp"
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+
+using namespace std;
+using namespace mfem;
+
+int main(int argc, char *argv[])
+{
+   // 1. Parse command-line options.
+   int size = 10000000;
+   int reps = 10;
+   const char *device_config = "cpu";
+
+   OptionsParser args(argc, argv);
+   args.AddOption(&size, "-n", "--size",
+                  "Number of entries in each of the three vectors.");
+   args.AddOption(&reps, "-r", "--repetitions",
+                  "Number of times each kernel is run.");
+   args.AddOption(&device_config, "-d", "--device",
+                  "Device configuration string, see Device::Configure().");
+   args.Parse();
+   if (!args.Good() || size < 1 || reps < 1)
+   {
+      args.PrintUsage(cout);
+      return 1;
+   }
+   args.PrintOptions(cout);
+
+   // 2. Enable hardware devices such as GPUs, and programming models such as
+   //    CUDA, OCCA, RAJA and OpenMP based on command line options.
+   Device device(device_config);
+   device.Print();
+
+   // 3. Allocate the vectors with the host memory type of the device, e.g.
+   //    MemoryType::HOST_NUMA for 'omp:numa', and initialize them on the
+   //    device, so that the first touch is done by the kernels' threads.
+   const double a = 3.0;
+   Vector x(size), y(size), z(size);
+   x.UseDevice(true);
+   y.UseDevice(true);
+   z.UseDevice(true);
+   x = 1.0;
+   y = 2.0;
+   z = 0.0;
+
+   // 4. Run the kernels, the copy is written with MFEM_FORALL since
+   //    Vector::operator=(const Vector&) uses memcpy.
+   const int num_kernels = 4;
+   const char *name[num_kernels] = { "Copy:", "Scale:", "Add:", "Triad:" };
+   const double bytes[num_kernels] =
+   {
+      2.0*sizeof(double)*size, 2.0*sizeof(double)*size,
+      3.0*sizeof(double)*size, 3.0*sizeof(double)*size
+   };
+   double t_min[num_kernels], t_avg[num_kernels], t_max[num_kernels];
+   for (int k = 0; k < num_kernels; k++)
+   {
+      t_min[k] = infinity();
+      t_avg[k] = t_max[k] = 0.0;
+   }
+
+   StopWatch sw;
+   for (int r = 0; r < reps; r++)
+   {
+      for (int k = 0; k < num_kernels; k++)
+      {
+         MFEM_DEVICE_SYNC;
+         sw.Clear();
+         sw.Start();
+         switch (k)
+         {
+            case 0:
+            {
+               const auto d_x = x.Read();
+               auto d_y = y.Write();
+               MFEM_FORALL(i, size, d_y[i] = d_x[i];);
+               break;
+            }
+            case 1: z.Set(a, y); break;
+            case 2: add(x, z, y); break;
+            case 3: add(z, a, y, x); break;
+         }
+         MFEM_DEVICE_SYNC;
+         sw.Stop();
+         // the first repetition is a warm-up, as in STREAM
+         if (r == 0 && reps > 1) { continue; }
+         const double t = sw.RealTime();
+         t_min[k] = std::min(t_min[k], t);
+         t_max[k] = std::max(t_max[k], t);
+         t_avg[k] += t / std::max(reps - 1, 1);
+      }
+   }
+
+   // 5. Report the bandwidth, in GB/s, based on the best time of each kernel.
+   cout << "\nFunction    Best Rate GB/s  Avg time     Min time     Max time\n";
+   for (int k = 0; k < num_kernels; k++)
+   {
+      cout << setw(12) << left << name[k] << right << fixed << setprecision(1)
+           << setw(14) << 1e-9*bytes[k]/t_min[k] << "  " << setprecision(6)
+           << setw(11) << t_avg[k] << "  " << setw(11) << t_min[k] << "  "
+           << setw(11) << t_max[k] << '\n';
+   }
+   cout.unsetf(ios::floatfield);
+
+   // 6. Verify the results: every entry follows the same recurrence.
+   double xe = 1.0, ye = 2.0, ze = 0.0;
+   for (int r = 0; r < reps; r++)
+   {
+      ye = xe;
+      ze = a*ye;
+      ye = xe + ze;
+      xe = ze + a*ye;
+   }
+   const double *h_x = x.HostRead(), *h_y = y.HostRead(), *h_z = z.HostRead();
+   double err = 0.0;
+   for (int i = 0; i < size; i++)
+   {
+      err = std::max(err, std::abs(h_x[i] - xe) / std::abs(xe));
+      err = std::max(err, std::abs(h_y[i] - ye) / std::abs(ye));
+      err = std::max(err, std::abs(h_z[i] - ze) / std::abs(ze));
+   }
+   const bool ok = err < 1e-13;
+   cout << "\nSolution " << (ok ? "validates" : "FAILED") << ", relative error "
+        << err << endl;
+
+   return ok ? 0 : 1;
+}
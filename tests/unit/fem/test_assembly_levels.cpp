@@ -155,4 +155,52 @@ TEST_CASE("Assembly Levels", "[AssemblyLevel]")
    }
 } // test case
 
+TEST_CASE("Full Assembly High Valence", "[AssemblyLevel]")
+{
+   // Refined tetrahedral meshes have vertices shared by more than 16 elements
+   Mesh mesh("../../data/beam-tet.mesh", 1, 1);
+   mesh.UniformRefinement();
+   Table *vert_elem = mesh.GetVertexToElementTable();
+   int max_valence = 0;
+   for (int v = 0; v < vert_elem->Size(); v++)
+   {
+      max_valence = std::max(max_valence, vert_elem->RowSize(v));
+   }
+   delete vert_elem;
+   REQUIRE(max_valence > 16);
+
+   for (int order : {1, 2})
+   {
+      H1_FECollection fec(order, mesh.Dimension());
+      FiniteElementSpace fespace(&mesh, &fec);
+      ConstantCoefficient coeff(1.0);
+
+      BilinearForm k_test(&fespace);
+      k_test.SetAssemblyLevel(AssemblyLevel::FULL);
+      k_test.AddDomainIntegrator(new MassIntegrator(coeff));
+      k_test.AddDomainIntegrator(new DiffusionIntegrator);
+      k_test.Assemble();
+
+      // The second assembly reuses the sparsity pattern of the first one
+      for (double c : {1.0, 3.0})
+      {
+         coeff.constant = c;
+         if (c != 1.0) { k_test.Assemble(); }
+
+         BilinearForm k_ref(&fespace);
+         k_ref.AddDomainIntegrator(new MassIntegrator(coeff));
+         k_ref.AddDomainIntegrator(new DiffusionIntegrator);
+         k_ref.Assemble();
+         k_ref.Finalize();
+
+         GridFunction x(&fespace), y_ref(&fespace), y_test(&fespace);
+         x.Randomize(1);
+         k_ref.Mult(x, y_ref);
+         k_test.Mult(x, y_test);
+         y_test -= y_ref;
+         REQUIRE(y_test.Normlinf() < 1.e-12 * y_ref.Normlinf());
+      }
+   }
+}
+
 } // namespace pa_kernels
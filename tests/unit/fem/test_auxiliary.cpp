@@ -0,0 +1,147 @@
+// Copyright (c) 2010-2020, Lawrence Livermore National Security, LLC. Produced
+// at the Lawrence Livermore National Laboratory. All Rights reserved. See files
+// LICENSE and NOTICE for details. LLNL-CODE-806117.
+//
+// This file is part of the MFEM library. For more information and source code
+// availability visit https://mfem.org.
+//
+// MFEM is free software; you can redistribute it and/or modify it under the
+// terms of the BSD-3 license. We welcome feedback and contributions, see file
+// CONTRIBUTING.md for details.
+
+#include "catch.hpp"
+#include "mfem.hpp"
+
+using namespace mfem;
+
+namespace auxiliary
+{
+
+double beta_func(const Vector &x)
+{
+   return 1.0 + x(0)*x(0) + 0.5*x(1);
+}
+
+// Return the number of PCG iterations for the partially assembled H(curl)
+// (with 'hdiv' false) or H(div) problem, preconditioned with the matrix-free
+// AMS/ADS (with 'aux') or with Jacobi. Also check that the matrix-free
+// preconditioner is symmetric and that PCG converges with it.
+int test_auxiliary(const char *mesh_file, int ref, int order, bool hdiv,
+                   bool aux)
+{
+   Mesh mesh(mesh_file, 1, 1);
+   for (int l = 0; l < ref; l++) { mesh.UniformRefinement(); }
+   const int dim = mesh.Dimension();
+   FiniteElementCollection *fec = hdiv ?
+                                  (FiniteElementCollection*)
+                                  new RT_FECollection(order-1, dim) :
+                                  new ND_FECollection(order, dim);
+   FiniteElementSpace fespace(&mesh, fec);
+
+   Array<int> ess_bdr(mesh.bdr_attributes.Max());
+   ess_bdr = 1;
+   Array<int> ess_tdof_list;
+   fespace.GetEssentialTrueDofs(ess_bdr, ess_tdof_list);
+
+   ConstantCoefficient alpha(1.0);
+   FunctionCoefficient beta(beta_func);
+   BilinearForm a(&fespace);
+   a.SetAssemblyLevel(AssemblyLevel::PARTIAL);
+   if (hdiv) { a.AddDomainIntegrator(new DivDivIntegrator(alpha)); }
+   else { a.AddDomainIntegrator(new CurlCurlIntegrator(alpha)); }
+   a.AddDomainIntegrator(new VectorFEMassIntegrator(beta));
+   a.Assemble();
+
+   GridFunction x(&fespace);
+   x = 0.0;
+   Vector f(fespace.GetVSize());
+   f.Randomize(1);
+   OperatorPtr A;
+   Vector X, B;
+   a.FormLinearSystem(ess_tdof_list, x, f, A, X, B);
+
+   Solver *prec;
+   if (!aux)
+   {
+      prec = new OperatorJacobiSmoother(a, ess_tdof_list);
+   }
+   else if (hdiv)
+   {
+      prec = new MatrixFreeADS(a, ess_bdr, alpha, beta);
+   }
+   else
+   {
+      prec = new MatrixFreeAMS(a, ess_bdr, alpha, &beta);
+   }
+
+   if (aux)
+   {
+      const int n = A->Height();
+      Vector u(n), v(n), Mu(n), Mv(n);
+      u.Randomize(2);
+      v.Randomize(3);
+      prec->Mult(u, Mu);
+      prec->Mult(v, Mv);
+      REQUIRE(fabs(u*Mv - v*Mu) < 1e-10 * fabs(u*Mv));
+   }
+
+   CGSolver cg;
+   cg.SetRelTol(1e-8);
+   cg.SetMaxIter(1000);
+   cg.SetOperator(*A);
+   cg.SetPreconditioner(*prec);
+   cg.Mult(B, X);
+   if (aux)
+   {
+      REQUIRE(cg.GetConverged());
+
+      // Check the residual with the operator of the form
+      Vector res(B.Size());
+      A->Mult(X, res);
+      res -= B;
+      REQUIRE(res.Norml2() < 1e-6 * B.Norml2());
+   }
+
+   delete prec;
+   delete fec;
+   return cg.GetNumIterations();
+}
+
+TEST_CASE("Matrix-free auxiliary space preconditioners",
+          "[PartialAssembly][AuxiliarySpace]")
+{
+   SECTION("AMS")
+   {
+      for (int order : {1, 2, 3})
+      {
+         const int it_quad_jac =
+            test_auxiliary("../../data/star.mesh", 2, order, false, false);
+         const int it_quad_ams =
+            test_auxiliary("../../data/star.mesh", 2, order, false, true);
+         REQUIRE(it_quad_ams < it_quad_jac);
+         const int it_hex_jac =
+            test_auxiliary("../../data/inline-hex.mesh", 0, order, false,
+                           false);
+         const int it_hex_ams =
+            test_auxiliary("../../data/inline-hex.mesh", 0, order, false,
+                           true);
+         REQUIRE(it_hex_ams < it_hex_jac);
+      }
+   }
+
+   SECTION("ADS")
+   {
+      for (int order : {1, 2})
+      {
+         const int it_jac =
+            test_auxiliary("../../data/inline-hex.mesh", 0, order, true,
+                           false);
+         const int it_ads =
+            test_auxiliary("../../data/inline-hex.mesh", 0, order, true,
+                           true);
+         REQUIRE(it_ads < it_jac);
+      }
+   }
+}
+
+} // namespace auxiliary
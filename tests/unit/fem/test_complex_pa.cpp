@@ -0,0 +1,172 @@
+// Copyright (c) 2010-2020, Lawrence Livermore National Security, LLC. Produced
+// at the Lawrence Livermore National Laboratory. All Rights reserved. See files
+// LICENSE and NOTICE for details. LLNL-CODE-806117.
+//
+// This file is part of the MFEM library. For more information and source code
+// availability visit https://mfem.org.
+//
+// MFEM is free software; you can redistribute it and/or modify it under the
+// terms of the BSD-3 license. We welcome feedback and contributions, see file
+// CONTRIBUTING.md for details.
+
+#include "catch.hpp"
+#include "mfem.hpp"
+
+using namespace mfem;
+
+namespace complex_pa
+{
+
+double coeff_real(const Vector &x)
+{
+   return 1.0 + x(0)*x(0) + 0.5*x(1);
+}
+
+double coeff_imag(const Vector &x)
+{
+   return 0.5 + x(1) - 0.25*x(0)*x(1);
+}
+
+// Compare the fused partial assembly of a complex operator with the full
+// assembly. With 'hcurl', the operator is curl-curl + i-weighted H(curl)
+// mass, otherwise diffusion + complex mass; in both cases an imaginary
+// diffusion-type term without a real counterpart is added with 'imag_only'.
+void test_complex_pa(const char *mesh_file, int ref, int order, bool hcurl,
+                     bool imag_only, ComplexOperator::Convention conv)
+{
+   Mesh mesh(mesh_file, 1, 1);
+   for (int l = 0; l < ref; l++) { mesh.UniformRefinement(); }
+   const int dim = mesh.Dimension();
+   FiniteElementCollection *fec = hcurl ?
+                                  (FiniteElementCollection*)
+                                  new ND_FECollection(order, dim) :
+                                  new H1_FECollection(order, dim);
+   FiniteElementSpace fespace(&mesh, fec);
+
+   Array<int> ess_tdof_list;
+   Array<int> ess_bdr(mesh.bdr_attributes.Max());
+   ess_bdr = 0;
+   ess_bdr[0] = 1;
+   fespace.GetEssentialTrueDofs(ess_bdr, ess_tdof_list);
+
+   ConstantCoefficient one(1.0);
+   FunctionCoefficient c_r(coeff_real), c_i(coeff_imag);
+   SesquilinearForm a_fa(&fespace, conv), a_pa(&fespace, conv);
+   a_pa.SetAssemblyLevel(AssemblyLevel::PARTIAL);
+   for (SesquilinearForm *a : { &a_fa, &a_pa })
+   {
+      if (hcurl)
+      {
+         a->AddDomainIntegrator(new CurlCurlIntegrator(one), NULL);
+         a->AddDomainIntegrator(new VectorFEMassIntegrator(c_r),
+                                new VectorFEMassIntegrator(c_i));
+         if (imag_only)
+         {
+            a->AddDomainIntegrator(NULL, new CurlCurlIntegrator(c_i));
+         }
+      }
+      else
+      {
+         a->AddDomainIntegrator(new DiffusionIntegrator(one), NULL);
+         a->AddDomainIntegrator(new MassIntegrator(c_r),
+                                new MassIntegrator(c_i));
+         if (imag_only)
+         {
+            a->AddDomainIntegrator(NULL, new DiffusionIntegrator(c_i));
+         }
+      }
+      a->Assemble();
+   }
+   a_fa.Finalize();
+
+   const int n = fespace.GetTrueVSize();
+   Vector diag_fa, diag_pa;
+   a_fa.AssembleDiagonal(diag_fa);
+   a_pa.AssembleDiagonal(diag_pa);
+   REQUIRE(diag_pa.Size() == 2*n);
+   Vector diff(diag_pa);
+   diff -= diag_fa;
+   REQUIRE(diff.Normlinf() < 1e-12 * diag_fa.Normlinf());
+
+   OperatorHandle A_fa, A_pa;
+   a_fa.FormSystemMatrix(ess_tdof_list, A_fa);
+   a_pa.FormSystemMatrix(ess_tdof_list, A_pa);
+   REQUIRE(dynamic_cast<PAComplexOperator*>(A_pa.Ptr()) != NULL);
+
+   Vector x(2*n), y_fa(2*n), y_pa(2*n);
+   x.Randomize(1);
+   A_fa->Mult(x, y_fa);
+   A_pa->Mult(x, y_pa);
+   y_pa -= y_fa;
+   REQUIRE(y_pa.Normlinf() < 1e-12 * y_fa.Normlinf());
+
+   // The complex Jacobi smoother inverts the diagonal of the operator, which
+   // acts as the identity on the essential dofs.
+   Array<bool> ess(n);
+   ess = false;
+   for (int k = 0; k < ess_tdof_list.Size(); k++)
+   {
+      ess[ess_tdof_list[k]] = true;
+   }
+   const double s = (conv == ComplexOperator::HERMITIAN) ? 1.0 : -1.0;
+   Vector z(2*n), w(2*n);
+   for (int k = 0; k < n; k++)
+   {
+      const double d_r = ess[k] ? 1.0 : diag_pa(k);
+      const double d_i = ess[k] ? 0.0 : diag_pa(n + k);
+      z(k) = d_r * x(k) - d_i * x(n + k);
+      z(n + k) = s * (d_i * x(k) + d_r * x(n + k));
+   }
+   ComplexJacobiSmoother jacobi(diag_pa, ess_tdof_list, conv);
+   jacobi.Mult(z, w);
+   w -= x;
+   REQUIRE(w.Normlinf() < 1e-12 * x.Normlinf());
+
+   delete fec;
+}
+
+TEST_CASE("Fused complex PA", "[PartialAssembly][ComplexOperator]")
+{
+   const auto conventions = { ComplexOperator::HERMITIAN,
+                              ComplexOperator::BLOCK_SYMMETRIC
+                            };
+   SECTION("H1")
+   {
+      for (auto conv : conventions)
+      {
+         for (bool imag_only : { false, true })
+         {
+            for (int order : {1, 2, 3})
+            {
+               test_complex_pa("../../data/inline-quad.mesh", 1, order, false,
+                               imag_only, conv);
+               test_complex_pa("../../data/inline-hex.mesh", 0, order, false,
+                               imag_only, conv);
+               test_complex_pa("../../data/inline-tri.mesh", 0, order, false,
+                               imag_only, conv);
+               test_complex_pa("../../data/star-mixed.mesh", 0, order, false,
+                               imag_only, conv);
+            }
+         }
+      }
+   }
+
+   SECTION("H(curl)")
+   {
+      for (auto conv : conventions)
+      {
+         for (bool imag_only : { false, true })
+         {
+            for (int order : {1, 2})
+            {
+               test_complex_pa("../../data/inline-quad.mesh", 1, order, true,
+                               imag_only, conv);
+               test_complex_pa("../../data/inline-hex.mesh", 0, order, true,
+                               imag_only, conv);
+            }
+         }
+      }
+   }
+}
+
+} // namespace complex_pa
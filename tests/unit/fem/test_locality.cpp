@@ -0,0 +1,179 @@
+// Copyright (c) 2010-2020, Lawrence Livermore National Security, LLC. Produced
+// at the Lawrence Livermore National Laboratory. All Rights reserved. See files
+// LICENSE and NOTICE for details. LLNL-CODE-806117.
+//
+// This file is part of the MFEM library. For more information and source code
+// availability visit https://mfem.org.
+//
+// MFEM is free software; you can redistribute it and/or modify it under the
+// terms of the BSD-3 license. We welcome feedback and contributions, see file
+// CONTRIBUTING.md for details.
+
+#include "mfem.hpp"
+using namespace mfem;
+
+#include "catch.hpp"
+
+namespace locality
+{
+
+double u_exact(const Vector &x)
+{
+   double r = 1.0;
+   for (int d = 0; d < x.Size(); d++) { r *= sin(1.0 + d + x(d)); }
+   return r;
+}
+
+void E_exact(const Vector &x, Vector &E)
+{
+   E.SetSize(x.Size());
+   for (int d = 0; d < x.Size(); d++) { E(d) = cos(x((d+1) % x.Size())); }
+}
+
+// Shuffle the elements of the mesh with a fixed pseudo-random permutation.
+static void ShuffleElements(Mesh &mesh)
+{
+   Array<int> ordering(mesh.GetNE());
+   for (int i = 0; i < ordering.Size(); i++) { ordering[i] = i; }
+   for (int i = ordering.Size()-1, s = 1; i > 0; i--)
+   {
+      s = (1103515245*s + 12345) & 0x7fffffff;
+      Swap(ordering[i], ordering[s % (i+1)]);
+   }
+   mesh.ReorderElements(ordering);
+}
+
+// Solve a diffusion problem with partial assembly on the space fes, with
+// homogeneous Dirichlet boundary conditions.
+static void Solve(FiniteElementSpace &fes, GridFunction &x)
+{
+   Array<int> ess_tdof_list, ess_bdr(fes.GetMesh()->bdr_attributes.Max());
+   ess_bdr = 1;
+   fes.GetEssentialTrueDofs(ess_bdr, ess_tdof_list);
+
+   FunctionCoefficient f(u_exact);
+   LinearForm b(&fes);
+   b.AddDomainIntegrator(new DomainLFIntegrator(f));
+   b.Assemble();
+
+   BilinearForm a(&fes);
+   a.SetAssemblyLevel(AssemblyLevel::PARTIAL);
+   a.AddDomainIntegrator(new DiffusionIntegrator);
+   a.Assemble();
+
+   x.SetSpace(&fes);
+   x = 0.0;
+   OperatorPtr A;
+   Vector B, X;
+   a.FormLinearSystem(ess_tdof_list, x, b, A, X, B);
+   CG(*A, B, X, 0, 1000, 1e-24, 0.0);
+   a.RecoverFEMSolution(X, b, x);
+}
+
+// Reorder a copy of the mesh and check that the solution and the projection
+// mapped back to the original numbering match the ones on the original mesh.
+static void TestReordering(Mesh &orig_mesh, LocalityOrdering::Type type)
+{
+   const int dim = orig_mesh.Dimension();
+   Mesh mesh(orig_mesh);
+   mesh.ReorderForLocality(type);
+   REQUIRE(mesh.GetLocalityOrdering() == type);
+
+   const Array<int> &orig_el = mesh.GetOriginalElementIndices();
+   const Array<int> &orig_v = mesh.GetOriginalVertexIndices();
+   REQUIRE(orig_el.Size() == mesh.GetNE());
+   REQUIRE(orig_v.Size() == mesh.GetNV());
+   for (int i = 0; i < mesh.GetNV(); i++)
+   {
+      for (int d = 0; d < mesh.SpaceDimension(); d++)
+      {
+         REQUIRE(mesh.GetVertex(i)[d] == orig_mesh.GetVertex(orig_v[i])[d]);
+      }
+   }
+   for (int i = 0; i < mesh.GetNE(); i++)
+   {
+      REQUIRE(mesh.GetAttribute(i) == orig_mesh.GetAttribute(orig_el[i]));
+   }
+
+   H1_FECollection h1(3, dim);
+   FiniteElementSpace orig_fes(&orig_mesh, &h1), fes(&mesh, &h1);
+   REQUIRE(orig_fes.GetDofPermutation().Size() == 0);
+   const Array<int> &perm = fes.GetDofPermutation();
+   REQUIRE(perm.Size() == fes.GetNDofs());
+   Array<int> marker(perm.Size());
+   marker = 0;
+   for (int i = 0; i < perm.Size(); i++) { marker[perm[i]]++; }
+   for (int i = 0; i < perm.Size(); i++) { REQUIRE(marker[i] == 1); }
+
+   // the first element uses the first dofs
+   Array<int> dofs;
+   fes.GetElementDofs(0, dofs);
+   dofs.Sort();
+   REQUIRE(dofs.Last() == dofs.Size()-1);
+
+   GridFunction orig_x, x, x_mapped(&orig_fes);
+   Solve(orig_fes, orig_x);
+   Solve(fes, x);
+   fes.MapToOriginal(orig_fes, x, x_mapped);
+   x_mapped -= orig_x;
+   REQUIRE(x_mapped.Normlinf() < 1e-8*orig_x.Normlinf());
+
+   // vector-valued space with signed dofs
+   ND_FECollection nd(2, dim);
+   FiniteElementSpace orig_nd_fes(&orig_mesh, &nd), nd_fes(&mesh, &nd);
+   VectorFunctionCoefficient E(dim, E_exact);
+   GridFunction orig_E(&orig_nd_fes), E_h(&nd_fes), E_mapped(&orig_nd_fes);
+   orig_E.ProjectCoefficient(E);
+   E_h.ProjectCoefficient(E);
+   nd_fes.MapToOriginal(orig_nd_fes, E_h, E_mapped);
+   E_mapped -= orig_E;
+   REQUIRE(E_mapped.Normlinf() < 1e-12*orig_E.Normlinf());
+}
+
+// Return the mean dof span of the elements of an H1 space on the mesh.
+static double MeanSpan(Mesh &mesh)
+{
+   H1_FECollection h1(2, mesh.Dimension());
+   FiniteElementSpace fes(&mesh, &h1);
+   ElementRestriction R(fes, ElementDofOrdering::LEXICOGRAPHIC);
+   ElementRestriction::StrideStatistics stats;
+   R.GetStrideStatistics(stats);
+   REQUIRE(stats.max_stride > 0);
+   REQUIRE(stats.mean_cache_lines >= 1.0);
+   return stats.mean_span;
+}
+
+} // namespace locality
+
+TEST_CASE("Locality ordering", "[FiniteElementSpace]")
+{
+   using namespace locality;
+
+   SECTION("2D")
+   {
+      Mesh mesh("../../data/star.mesh", 1, 1);
+      mesh.UniformRefinement();
+      ShuffleElements(mesh);
+      TestReordering(mesh, LocalityOrdering::HILBERT);
+      TestReordering(mesh, LocalityOrdering::RCM);
+      TestReordering(mesh, LocalityOrdering::GECKO);
+   }
+
+   SECTION("3D")
+   {
+      Mesh mesh("../../data/fichera.mesh", 1, 1);
+      ShuffleElements(mesh);
+      TestReordering(mesh, LocalityOrdering::HILBERT);
+      TestReordering(mesh, LocalityOrdering::RCM);
+   }
+
+   SECTION("Stride statistics")
+   {
+      Mesh mesh(8, 8, 8, Element::HEXAHEDRON);
+      ShuffleElements(mesh);
+      const double shuffled_span = MeanSpan(mesh);
+      mesh.ReorderForLocality(LocalityOrdering::RCM);
+      const double rcm_span = MeanSpan(mesh);
+      REQUIRE(rcm_span < 0.5*shuffled_span);
+   }
+}
@@ -0,0 +1,155 @@
+// Copyright (c) 2010-2020, Lawrence Livermore National Security, LLC. Produced
+// at the Lawrence Livermore National Laboratory. All Rights reserved. See files
+// LICENSE and NOTICE for details. LLNL-CODE-806117.
+//
+// This file is part of the MFEM library. For more information and source code
+// availability visit https://mfem.org.
+//
+// MFEM is free software; you can redistribute it and/or modify it under the
+// terms of the BSD-3 license. We welcome feedback and contributions, see file
+// CONTRIBUTING.md for details.
+
+#include "mfem.hpp"
+#include "catch.hpp"
+
+using namespace mfem;
+
+namespace lor
+{
+
+enum SpaceType { H1_SPACE, ND_SPACE, RT_SPACE, L2_SPACE };
+
+static void AddIntegrators(BilinearForm &a, SpaceType type)
+{
+   switch (type)
+   {
+      case H1_SPACE:
+         a.AddDomainIntegrator(new DiffusionIntegrator);
+         a.AddDomainIntegrator(new MassIntegrator);
+         break;
+      case ND_SPACE:
+         a.AddDomainIntegrator(new CurlCurlIntegrator);
+         a.AddDomainIntegrator(new VectorFEMassIntegrator);
+         break;
+      case RT_SPACE:
+         a.AddDomainIntegrator(new DivDivIntegrator);
+         a.AddDomainIntegrator(new VectorFEMassIntegrator);
+         break;
+      case L2_SPACE:
+         a.AddDomainIntegrator(new MassIntegrator);
+         break;
+   }
+}
+
+// Solve a high-order system with CG preconditioned by the (exact) inverse of
+// the LOR system and return the number of iterations.
+static int SolveLOR(Mesh &mesh, SpaceType type, int order)
+{
+   const int dim = mesh.Dimension();
+   FiniteElementCollection *fec = NULL;
+   switch (type)
+   {
+      case H1_SPACE: fec = new H1_FECollection(order, dim); break;
+      case ND_SPACE: fec = new ND_FECollection(order, dim); break;
+      case RT_SPACE: fec = new RT_FECollection(order-1, dim); break;
+      case L2_SPACE: fec = new L2_FECollection(order, dim); break;
+   }
+   FiniteElementSpace fes(&mesh, fec);
+
+   Array<int> ess_dofs;
+   if (type != L2_SPACE)
+   {
+      Array<int> ess_bdr(mesh.bdr_attributes.Max());
+      ess_bdr = 1;
+      fes.GetEssentialTrueDofs(ess_bdr, ess_dofs);
+   }
+
+   BilinearForm a(&fes);
+   AddIntegrators(a, type);
+   a.Assemble();
+   OperatorPtr A;
+   a.FormSystemMatrix(ess_dofs, A);
+
+   LORSolver<CGSolver> lor_solver(a, ess_dofs);
+   lor_solver.GetSolver().SetRelTol(1e-14);
+   lor_solver.GetSolver().SetAbsTol(0.0);
+   lor_solver.GetSolver().SetMaxIter(1000);
+
+   // The dof permutation must be a bijection.
+   const Array<int> &perm = lor_solver.GetLOR().GetDofPermutation();
+   Array<int> count(perm.Size());
+   count = 0;
+   for (int i = 0; i < perm.Size(); i++)
+   {
+      REQUIRE(perm[i] >= 0);
+      REQUIRE(perm[i] < perm.Size());
+      count[perm[i]]++;
+   }
+   for (int i = 0; i < perm.Size(); i++) { REQUIRE(count[i] == 1); }
+
+   Vector B(fes.GetTrueVSize()), X(fes.GetTrueVSize());
+   B.Randomize(1);
+   for (int i = 0; i < ess_dofs.Size(); i++) { B(ess_dofs[i]) = 0.0; }
+   X = 0.0;
+
+   CGSolver cg;
+   cg.SetRelTol(1e-8);
+   cg.SetAbsTol(0.0);
+   cg.SetMaxIter(500);
+   cg.SetOperator(*A);
+   cg.SetPreconditioner(lor_solver);
+   cg.Mult(B, X);
+   REQUIRE(cg.GetConverged());
+
+   delete fec;
+   return cg.GetNumIterations();
+}
+
+TEST_CASE("LOR Preconditioner", "[LOR]")
+{
+   for (int dim = 2; dim <= 3; dim++)
+   {
+      const int order = (dim == 2) ? 4 : 2;
+      const int ne = (dim == 2) ? 4 : 2;
+      Mesh *mesh = (dim == 2) ?
+                   new Mesh(ne, ne, Element::QUADRILATERAL, true) :
+                   new Mesh(ne, ne, ne, Element::HEXAHEDRON, true);
+      for (int type = H1_SPACE; type <= L2_SPACE; type++)
+      {
+         // The number of iterations is bounded independently of the mesh
+         // size for spectrally equivalent LOR discretizations.
+         const int its = SolveLOR(*mesh, SpaceType(type), order);
+         std::cout << "LOR: dim " << dim << ", space " << type
+                   << ", iterations " << its << std::endl;
+         REQUIRE(its < 40);
+      }
+      delete mesh;
+   }
+}
+
+TEST_CASE("LOR Reassembly", "[LOR]")
+{
+   Mesh mesh(4, 4, Element::QUADRILATERAL, true);
+   H1_FECollection fec(3, 2);
+   FiniteElementSpace fes(&mesh, &fec);
+   Array<int> ess_dofs;
+
+   ConstantCoefficient coeff(1.0);
+   BilinearForm a(&fes);
+   a.AddDomainIntegrator(new MassIntegrator(coeff));
+   a.SetAssemblyLevel(AssemblyLevel::PARTIAL);
+   a.Assemble();
+
+   LORDiscretization lor(a, ess_dofs);
+   const Mesh *mesh_lor = &lor.GetLORMesh();
+   const double norm1 = lor.GetAssembledMatrix().MaxNorm();
+
+   // Changing the coefficient and reassembling reuses the LOR mesh and scales
+   // the LOR matrix accordingly.
+   coeff.constant = 2.0;
+   lor.AssembleSystem(a, ess_dofs);
+   REQUIRE(&lor.GetLORMesh() == mesh_lor);
+   REQUIRE(lor.GetAssembledMatrix().MaxNorm() == Approx(2.0*norm1));
+}
+
+} // namespace lor
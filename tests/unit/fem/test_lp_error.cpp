@@ -0,0 +1,119 @@
+// Copyright (c) 2010-2020, Lawrence Livermore National Security, LLC. Produced
+// at the Lawrence Livermore National Laboratory. All Rights reserved. See files
+// LICENSE and NOTICE for details. LLNL-CODE-806117.
+//
+// This file is part of the MFEM library. For more information and source code
+// availability visit https://mfem.org.
+//
+// MFEM is free software; you can redistribute it and/or modify it under the
+// terms of the BSD-3 license. We welcome feedback and contributions, see file
+// CONTRIBUTING.md for details.
+
+#include "mfem.hpp"
+#include "catch.hpp"
+
+using namespace mfem;
+
+namespace lp_error
+{
+
+static double scalar_func(const Vector &x)
+{
+   double val = 1.0;
+   for (int d = 0; d < x.Size(); d++) { val *= sin(M_PI*x(d) + d); }
+   return val;
+}
+
+static void vector_func(const Vector &x, Vector &v)
+{
+   for (int d = 0; d < v.Size(); d++) { v(d) = cos(M_PI*x(d)) + x(0)*x(1); }
+}
+
+static double TestScalar(Mesh &mesh, FiniteElementCollection &fec,
+                         double p, Coefficient *weight)
+{
+   FiniteElementSpace fes(&mesh, &fec);
+   GridFunction u(&fes);
+   u.Randomize(1);
+   FunctionCoefficient exsol(scalar_func);
+   return u.ComputeLpError(p, exsol, weight);
+}
+
+static double TestVector(Mesh &mesh, FiniteElementCollection &fec, int vdim,
+                         double p, VectorCoefficient *v_weight)
+{
+   const int dim = mesh.Dimension();
+   FiniteElementSpace fes(&mesh, &fec, vdim);
+   GridFunction u(&fes);
+   u.Randomize(1);
+   VectorFunctionCoefficient exsol(dim, vector_func);
+   return u.ComputeLpError(p, exsol, NULL, v_weight);
+}
+
+// The errors computed with the batched evaluation (used for meshes with
+// nodes) match the element-by-element evaluation (used for meshes without
+// nodes).
+TEST_CASE("Batched Lp Error", "[GridFunction]")
+{
+   for (int dim = 2; dim <= 3; dim++)
+   {
+      Mesh *mesh = (dim == 2) ?
+                   new Mesh(3, 3, Element::QUADRILATERAL, true) :
+                   new Mesh(2, 2, 2, Element::HEXAHEDRON, true);
+      Mesh *mesh_nodes = new Mesh(*mesh);
+      mesh_nodes->EnsureNodes();
+      REQUIRE(mesh->GetNodes() == NULL);
+
+      mesh->SetAttribute(0, 2);
+      mesh->SetAttributes();
+      mesh_nodes->SetAttribute(0, 2);
+      mesh_nodes->SetAttributes();
+      Vector pw(2);
+      pw(0) = 1.0;
+      pw(1) = 3.0;
+      PWConstCoefficient weight(pw);
+      Vector vw_vec(dim);
+      vw_vec = 0.5;
+      VectorConstantCoefficient v_weight(vw_vec);
+
+      H1_FECollection h1_fec(2, dim);
+      L2_FECollection l2_fec(1, dim);
+      ND_FECollection nd_fec(2, dim);
+      RT_FECollection rt_fec(1, dim);
+
+      const double ps[] = { 1.0, 2.0, 3.0, infinity() };
+      for (int i = 0; i < 4; i++)
+      {
+         const double p = ps[i];
+         for (int w = 0; w < 2; w++)
+         {
+            Coefficient *c = w ? &weight : NULL;
+            VectorCoefficient *vc = w ? &v_weight : NULL;
+            REQUIRE(TestScalar(*mesh_nodes, h1_fec, p, c) ==
+                    Approx(TestScalar(*mesh, h1_fec, p, c)));
+            REQUIRE(TestScalar(*mesh_nodes, l2_fec, p, c) ==
+                    Approx(TestScalar(*mesh, l2_fec, p, c)));
+            REQUIRE(TestVector(*mesh_nodes, h1_fec, dim, p, vc) ==
+                    Approx(TestVector(*mesh, h1_fec, dim, p, vc)));
+            REQUIRE(TestVector(*mesh_nodes, nd_fec, 1, p, vc) ==
+                    Approx(TestVector(*mesh, nd_fec, 1, p, vc)));
+            REQUIRE(TestVector(*mesh_nodes, rt_fec, 1, p, vc) ==
+                    Approx(TestVector(*mesh, rt_fec, 1, p, vc)));
+         }
+      }
+
+      // The geometric factors are recomputed when the mesh nodes move.
+      FiniteElementSpace fes(mesh_nodes, &h1_fec);
+      GridFunction u(&fes);
+      u = 0.0;
+      ConstantCoefficient one(1.0);
+      REQUIRE(u.ComputeL1Error(one) == Approx(1.0));
+      *mesh_nodes->GetNodes() *= 2.0;
+      REQUIRE(u.ComputeL1Error(one) == Approx(pow(2.0, dim)));
+
+      delete mesh_nodes;
+      delete mesh;
+   }
+}
+
+} // namespace lp_error
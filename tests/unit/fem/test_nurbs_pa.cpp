@@ -0,0 +1,123 @@
+// Copyright (c) 2010-2020, Lawrence Livermore National Security, LLC. Produced
+// at the Lawrence Livermore National Laboratory. All Rights reserved. See files
+// LICENSE and NOTICE for details. LLNL-CODE-806117.
+//
+// This file is part of the MFEM library. For more information and source code
+// availability visit https://mfem.org.
+//
+// MFEM is free software; you can redistribute it and/or modify it under the
+// terms of the BSD-3 license. We welcome feedback and contributions, see file
+// CONTRIBUTING.md for details.
+
+#include "catch.hpp"
+#include "mfem.hpp"
+
+using namespace mfem;
+
+namespace nurbs_pa
+{
+
+double coeff_function(const Vector &x)
+{
+   return 1.0 + x(0)*x(0) + 0.5*x(1);
+}
+
+void test_nurbs_pa(const char *mesh_file, int order, int ref, int pb)
+{
+   Mesh mesh(mesh_file, 1, 1);
+   for (int l = 0; l < ref; l++) { mesh.UniformRefinement(); }
+   NURBSFECollection fec(order);
+   FiniteElementSpace fespace(&mesh, new NURBSExtension(mesh.NURBSext, order),
+                              &fec);
+
+   FunctionCoefficient coeff(coeff_function);
+   BilinearForm k_ref(&fespace), k_test(&fespace);
+   for (BilinearForm *k : { &k_ref, &k_test })
+   {
+      if (pb == 0 || pb == 2)
+      {
+         k->AddDomainIntegrator(new MassIntegrator(coeff));
+      }
+      if (pb == 1 || pb == 2)
+      {
+         k->AddDomainIntegrator(new DiffusionIntegrator(coeff));
+      }
+   }
+   k_ref.Assemble();
+   k_ref.Finalize();
+   k_test.SetAssemblyLevel(AssemblyLevel::PARTIAL);
+   k_test.Assemble();
+
+   GridFunction x(&fespace), y_ref(&fespace), y_test(&fespace);
+   x.Randomize(1);
+   k_ref.Mult(x, y_ref);
+   k_test.Mult(x, y_test);
+   y_test -= y_ref;
+   REQUIRE(y_test.Normlinf() < 1e-12 * y_ref.Normlinf());
+
+   Vector diag_ref, diag_test(fespace.GetVSize());
+   k_ref.SpMat().GetDiag(diag_ref);
+   k_test.AssembleDiagonal(diag_test);
+   diag_test -= diag_ref;
+   REQUIRE(diag_test.Normlinf() < 1e-12 * diag_ref.Normlinf());
+}
+
+TEST_CASE("NURBS patch-wise PA", "[NURBS][PartialAssembly]")
+{
+   for (int pb : {0, 1, 2})
+   {
+      SECTION("2D")
+      {
+         for (int order : {2, 3})
+         {
+            test_nurbs_pa("../../data/square-disc-nurbs.mesh", order, 1, pb);
+            test_nurbs_pa("../../data/pipe-nurbs-2d.mesh", order, 1, pb);
+         }
+      }
+
+      SECTION("3D")
+      {
+         test_nurbs_pa("../../data/pipe-nurbs.mesh", 2, 0, pb);
+         test_nurbs_pa("../../data/cube-nurbs.mesh", 3, 1, pb);
+      }
+   }
+}
+
+TEST_CASE("NURBS patch-wise PA reduced quadrature", "[NURBS][PartialAssembly]")
+{
+   Mesh mesh("../../data/square-disc-nurbs.mesh", 1, 1);
+   mesh.UniformRefinement();
+   NURBSFECollection fec(3);
+   FiniteElementSpace fespace(&mesh, new NURBSExtension(mesh.NURBSext, 3),
+                              &fec);
+
+   // With fewer points per knot span the operator changes, but it stays
+   // symmetric and still integrates the constants accurately.
+   ConstantCoefficient one(1.0);
+   BilinearForm m_ref(&fespace), m_test(&fespace);
+   m_ref.AddDomainIntegrator(new MassIntegrator(one));
+   MassIntegrator *mass = new MassIntegrator(one);
+   mass->SetPatchPointsPerSpan(3);
+   m_test.AddDomainIntegrator(mass);
+   m_ref.Assemble();
+   m_ref.Finalize();
+   m_test.SetAssemblyLevel(AssemblyLevel::PARTIAL);
+   m_test.Assemble();
+
+   GridFunction x(&fespace), y(&fespace), z(&fespace);
+   x.Randomize(1);
+   z.Randomize(2);
+   m_test.Mult(x, y);
+   const double zAx = z * y;
+   m_test.Mult(z, y);
+   REQUIRE(fabs(zAx - x * y) < 1e-12 * fabs(zAx));
+
+   GridFunction ones(&fespace);
+   ones = 1.0;
+   m_ref.Mult(ones, y);
+   const double area_ref = ones * y;
+   m_test.Mult(ones, y);
+   REQUIRE(fabs(ones * y - area_ref) < 1e-6 * area_ref);
+}
+
+} // namespace nurbs_pa
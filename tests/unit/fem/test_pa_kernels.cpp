@@ -457,4 +457,99 @@ TEST_CASE("PA Convection", "[PartialAssembly]")
    }
 }//test case
 
+double simplex_coeff(const Vector &x)
+{
+   return 1.0 + x(0)*x(0) + 0.5*x(1);
+}
+
+// Compare the PA and EA actions and the PA diagonal with the full assembly
+// for the mass (pb = 0), diffusion (pb = 1), or both (pb = 2), on meshes
+// whose elements do not all have a tensor basis. Element assembly is not
+// available on meshes with mixed element types.
+void test_pa_simplex(Mesh &&mesh, int order, int pb)
+{
+   const bool test_ea = mesh.GetNumGeometries(mesh.Dimension()) == 1;
+   const int dim = mesh.Dimension();
+   H1_FECollection fec(order, dim);
+   FiniteElementSpace fes(&mesh, &fec);
+   FunctionCoefficient coeff(simplex_coeff);
+
+   BilinearForm k_fa(&fes), k_pa(&fes), k_ea(&fes);
+   for (BilinearForm *k : { &k_fa, &k_pa, &k_ea })
+   {
+      if (pb != 1) { k->AddDomainIntegrator(new MassIntegrator(coeff)); }
+      if (pb != 0) { k->AddDomainIntegrator(new DiffusionIntegrator(coeff)); }
+   }
+   k_fa.Assemble();
+   k_fa.Finalize();
+   k_pa.SetAssemblyLevel(AssemblyLevel::PARTIAL);
+   k_pa.Assemble();
+   k_ea.SetAssemblyLevel(AssemblyLevel::ELEMENT);
+   if (test_ea) { k_ea.Assemble(); }
+
+   GridFunction x(&fes), y_fa(&fes), y_pa(&fes), y_ea(&fes);
+   x.Randomize(1);
+   k_fa.Mult(x, y_fa);
+   k_pa.Mult(x, y_pa);
+   y_pa -= y_fa;
+   REQUIRE(y_pa.Normlinf() < 1e-12 * y_fa.Normlinf());
+   if (test_ea)
+   {
+      k_ea.Mult(x, y_ea);
+      y_ea -= y_fa;
+      REQUIRE(y_ea.Normlinf() < 1e-12 * y_fa.Normlinf());
+   }
+
+   Vector diag_fa, diag_pa(fes.GetVSize());
+   k_fa.SpMat().GetDiag(diag_fa);
+   k_pa.AssembleDiagonal(diag_pa);
+   diag_pa -= diag_fa;
+   REQUIRE(diag_pa.Normlinf() < 1e-12 * diag_fa.Normlinf());
+}
+
+TEST_CASE("PA Simplices", "[PartialAssembly]")
+{
+   for (int pb : {0, 1, 2})
+   {
+      SECTION("2D")
+      {
+         for (int order : {1, 2, 3, 4})
+         {
+            test_pa_simplex(Mesh("../../data/square-disc.mesh", 1, 1),
+                            order, pb);
+            test_pa_simplex(Mesh("../../data/square-disc-p3.mesh", 1, 1),
+                            order, pb);
+         }
+      }
+
+      SECTION("3D")
+      {
+         for (int order : {1, 2, 3})
+         {
+            test_pa_simplex(Mesh("../../data/beam-tet.mesh", 1, 1),
+                            order, pb);
+            test_pa_simplex(Mesh("../../data/escher-p2.mesh", 1, 1),
+                            order, pb);
+         }
+      }
+   }
+}
+
+TEST_CASE("PA Mixed Meshes", "[PartialAssembly]")
+{
+   for (int pb : {0, 1, 2})
+   {
+      for (int order : {1, 2, 3})
+      {
+         test_pa_simplex(Mesh("../../data/star-mixed.mesh", 1, 1), order, pb);
+         test_pa_simplex(Mesh("../../data/star-mixed-p2.mesh", 1, 1),
+                         order, pb);
+         test_pa_simplex(Mesh("../../data/fichera-mixed.mesh", 1, 1),
+                         order, pb);
+         test_pa_simplex(Mesh("../../data/fichera-mixed-p2.mesh", 1, 1),
+                         order, pb);
+      }
+   }
+}
+
 }// namespace pa_kernels
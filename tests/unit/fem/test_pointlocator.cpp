@@ -0,0 +1,172 @@
+// Copyright (c) 2010-2020, Lawrence Livermore National Security, LLC. Produced
+// at the Lawrence Livermore National Laboratory. All Rights reserved. See files
+// LICENSE and NOTICE for details. LLNL-CODE-806117.
+//
+// This file is part of the MFEM library. For more information and source code
+// availability visit https://mfem.org.
+//
+// MFEM is free software; you can redistribute it and/or modify it under the
+// terms of the BSD-3 license. We welcome feedback and contributions, see file
+// CONTRIBUTING.md for details.
+
+#include "mfem.hpp"
+#include "catch.hpp"
+
+using namespace mfem;
+
+namespace pointlocator
+{
+
+static double linear_func(const Vector &x)
+{
+   double val = 1.0;
+   for (int d = 0; d < x.Size(); d++) { val += (d+1)*x(d); }
+   return val;
+}
+
+// Generate 'npts' points at random reference positions in the interior of
+// random elements of the mesh, ordered by nodes.
+static void RandomPoints(Mesh &mesh, int npts, Array<int> &elems,
+                         Array<IntegrationPoint> &ips, Vector &pos)
+{
+   const int sdim = mesh.SpaceDimension();
+   elems.SetSize(npts);
+   ips.SetSize(npts);
+   pos.SetSize(npts*sdim);
+   Vector x(sdim), r(3);
+   srand(1);
+   for (int i = 0; i < npts; i++)
+   {
+      elems[i] = rand() % mesh.GetNE();
+      r.Randomize(i+1);
+      ips[i].Set(0.1 + 0.8*r(0), 0.1 + 0.8*r(1), 0.1 + 0.8*r(2), 1.0);
+      if (mesh.GetElementBaseGeometry(elems[i]) == Geometry::TRIANGLE)
+      {
+         ips[i].x *= 0.5;
+         ips[i].y *= 0.5;
+      }
+      ElementTransformation *T = mesh.GetElementTransformation(elems[i]);
+      T->Transform(ips[i], x);
+      for (int d = 0; d < sdim; d++) { pos(i + d*npts) = x(d); }
+   }
+}
+
+TEST_CASE("PointLocator FindPoints", "[PointLocator]")
+{
+   const char *mesh_files[] = { "../../data/star-q3.mesh",
+                                "../../data/fichera-q2.mesh"
+                              };
+   for (int m = 0; m < 2; m++)
+   {
+      Mesh mesh(mesh_files[m], 1, 1);
+      const int dim = mesh.Dimension();
+      const int npts = 50;
+      Array<int> elems;
+      Array<IntegrationPoint> ips;
+      Vector pos;
+      RandomPoints(mesh, npts, elems, ips, pos);
+
+      PointLocator finder;
+      finder.Setup(mesh);
+      finder.FindPoints(pos);
+      const Array<int> &code = finder.GetCode();
+      const Array<int> &elem = finder.GetElem();
+      const Vector &ref = finder.GetReferencePosition();
+      REQUIRE(code.Size() == npts);
+      for (int i = 0; i < npts; i++)
+      {
+         REQUIRE(code[i] == PointLocator::INSIDE);
+         REQUIRE(finder.GetProc()[i] == 0);
+         REQUIRE(elem[i] == elems[i]);
+         REQUIRE(finder.GetDist()(i) < 1e-10);
+         const double ip_ref[3] = { ips[i].x, ips[i].y, ips[i].z };
+         for (int d = 0; d < dim; d++)
+         {
+            REQUIRE(fabs(ref(i*dim + d) - ip_ref[d]) < 1e-8);
+         }
+      }
+
+      // The interpolated values match the values computed element-wise, for
+      // both scalar and vector fields.
+      H1_FECollection h1_fec(3, dim);
+      FiniteElementSpace h1_fes(&mesh, &h1_fec, 2);
+      GridFunction u(&h1_fes);
+      u.Randomize(1);
+      ND_FECollection nd_fec(2, dim);
+      FiniteElementSpace nd_fes(&mesh, &nd_fec);
+      GridFunction w(&nd_fes);
+      w.Randomize(2);
+
+      Vector u_vals, w_vals, val;
+      finder.Interpolate(u, u_vals);
+      finder.Interpolate(w, w_vals);
+      REQUIRE(u_vals.Size() == 2*npts);
+      REQUIRE(w_vals.Size() == dim*npts);
+      for (int i = 0; i < npts; i++)
+      {
+         ElementTransformation *T = mesh.GetElementTransformation(elems[i]);
+         T->SetIntPoint(&ips[i]);
+         u.GetVectorValue(*T, ips[i], val);
+         for (int c = 0; c < 2; c++)
+         {
+            REQUIRE(u_vals(i + c*npts) == Approx(val(c)));
+         }
+         w.GetVectorValue(*T, ips[i], val);
+         for (int c = 0; c < dim; c++)
+         {
+            REQUIRE(w_vals(i + c*npts) == Approx(val(c)));
+         }
+      }
+
+      // Points far outside of the mesh are not found.
+      Vector far(dim);
+      far = 1e3;
+      finder.FindPoints(far);
+      REQUIRE(finder.GetCode()[0] == PointLocator::NOT_FOUND);
+      REQUIRE(finder.GetElem()[0] == -1);
+      finder.Interpolate(u, u_vals);
+      REQUIRE(u_vals.Normlinf() == 0.0);
+   }
+}
+
+TEST_CASE("PointLocator Field Transfer", "[PointLocator]")
+{
+   // Transfer a linear function from a triangular mesh to the nodes of a
+   // quadratic, curved quadrilateral mesh covering a subset of the domain.
+   Mesh mesh_src(5, 5, Element::TRIANGLE, true);
+   H1_FECollection fec_src(1, 2);
+   FiniteElementSpace fes_src(&mesh_src, &fec_src);
+   GridFunction u_src(&fes_src);
+   FunctionCoefficient coeff(linear_func);
+   u_src.ProjectCoefficient(coeff);
+
+   Mesh mesh_tgt(3, 3, Element::QUADRILATERAL, true);
+   mesh_tgt.SetCurvature(2, false, -1, Ordering::byNODES);
+   GridFunction &nodes = *mesh_tgt.GetNodes();
+   const int nnodes = nodes.Size()/2;
+   for (int i = 0; i < nnodes; i++)
+   {
+      const double x = nodes(i), y = nodes(i + nnodes);
+      nodes(i) = 0.1 + 0.8*x + 0.05*sin(M_PI*y);
+      nodes(i + nnodes) = 0.1 + 0.8*y;
+   }
+
+   FiniteElementSpace fes_tgt(&mesh_tgt, nodes.FESpace()->FEColl());
+   REQUIRE(fes_tgt.GetNDofs() == nnodes);
+   GridFunction u_tgt(&fes_tgt);
+
+   PointLocator finder;
+   finder.Setup(mesh_src);
+   finder.Interpolate(nodes, u_src, u_tgt);
+   for (int i = 0; i < finder.GetCode().Size(); i++)
+   {
+      REQUIRE(finder.GetCode()[i] != PointLocator::NOT_FOUND);
+   }
+
+   GridFunction u_exact(&fes_tgt);
+   u_exact.ProjectCoefficient(coeff);
+   u_tgt -= u_exact;
+   REQUIRE(u_tgt.Normlinf() < 1e-10);
+}
+
+} // namespace pointlocator
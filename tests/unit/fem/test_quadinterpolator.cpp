@@ -0,0 +1,113 @@
+// Copyright (c) 2010-2020, Lawrence Livermore National Security, LLC. Produced
+// at the Lawrence Livermore National Laboratory. All Rights reserved. See files
+// LICENSE and NOTICE for details. LLNL-CODE-806117.
+//
+// This file is part of the MFEM library. For more information and source code
+// availability visit https://mfem.org.
+//
+// MFEM is free software; you can redistribute it and/or modify it under the
+// terms of the BSD-3 license. We welcome feedback and contributions, see file
+// CONTRIBUTING.md for details.
+
+#include "mfem.hpp"
+#include "catch.hpp"
+
+using namespace mfem;
+
+namespace quadinterpolator
+{
+
+static void perturb(const Vector &x, Vector &p)
+{
+   p = x;
+   p(0) += 0.1*sin(M_PI*x(1)) + 0.05*x(0)*x(0);
+   p(1) += 0.1*sin(M_PI*x(0));
+   if (x.Size() == 3) { p(2) += 0.1*x(0)*x(1); }
+}
+
+// Compare the sum-factorized evaluation of an ND or RT field with the
+// element-wise evaluation, for both output layouts.
+static void TestVectorFE(int dim, bool nd, int order)
+{
+   Mesh *mesh_ptr = (dim == 2) ?
+                    new Mesh(2, 3, Element::QUADRILATERAL, true) :
+                    new Mesh(2, 2, 3, Element::HEXAHEDRON, true);
+   Mesh &mesh = *mesh_ptr;
+   mesh.SetCurvature(2);
+   mesh.Transform(perturb);
+
+   FiniteElementCollection *fec = nd ?
+                                  (FiniteElementCollection*)
+                                  new ND_FECollection(order, dim) :
+                                  (FiniteElementCollection*)
+                                  new RT_FECollection(order-1, dim);
+   FiniteElementSpace fes(&mesh, fec);
+   GridFunction u(&fes);
+   u.Randomize(1);
+
+   const IntegrationRule &ir =
+      IntRules.Get(mesh.GetElementBaseGeometry(0), 2*order + 1);
+   const int nq = ir.GetNPoints(), ne = mesh.GetNE();
+
+   const Operator *R = fes.GetElementRestriction(
+                          ElementDofOrdering::LEXICOGRAPHIC);
+   Vector u_e(R->Height());
+   R->Mult(u, u_e);
+
+   const QuadratureInterpolator *qi = fes.GetQuadratureInterpolator(ir);
+   const int ncd = (nd && dim == 3) ? 3 : 1;
+   for (int l = 0; l < 2; l++)
+   {
+      const bool byvdim = (l == 1);
+      qi->SetOutputLayout(byvdim ? QVectorLayout::byVDIM :
+                          QVectorLayout::byNODES);
+      Vector q_val, q_der;
+      qi->Values(u_e, q_val);
+      if (nd) { qi->Curl(u_e, q_der); }
+      else { qi->Divergence(u_e, q_der); }
+      REQUIRE(q_val.Size() == dim*nq*ne);
+      REQUIRE(q_der.Size() == ncd*nq*ne);
+
+      Vector val(dim), der(ncd);
+      double max_err = 0.0;
+      for (int e = 0; e < ne; e++)
+      {
+         ElementTransformation *T = mesh.GetElementTransformation(e);
+         for (int q = 0; q < nq; q++)
+         {
+            const IntegrationPoint &ip = ir.IntPoint(q);
+            T->SetIntPoint(&ip);
+            u.GetVectorValue(*T, ip, val);
+            if (nd) { u.GetCurl(*T, der); }
+            else { der(0) = u.GetDivergence(*T); }
+            for (int c = 0; c < dim; c++)
+            {
+               const int i = byvdim ? c + dim*(q + nq*e) : q + nq*(c + dim*e);
+               max_err = std::max(max_err, fabs(q_val(i) - val(c)));
+            }
+            for (int c = 0; c < ncd; c++)
+            {
+               const int i = byvdim ? c + ncd*(q + nq*e) : q + nq*(c + ncd*e);
+               max_err = std::max(max_err, fabs(q_der(i) - der(c)));
+            }
+         }
+      }
+      REQUIRE(max_err < 1e-10);
+   }
+   delete fec;
+   delete mesh_ptr;
+}
+
+TEST_CASE("QuadratureInterpolator Vector FE", "[QuadratureInterpolator]")
+{
+   for (int dim = 2; dim <= 3; dim++)
+   {
+      for (int order = 1; order <= 3; order++)
+      {
+         TestVectorFE(dim, true, order);
+         TestVectorFE(dim, false, order);
+      }
+   }
+}
+
+} // namespace quadinterpolator
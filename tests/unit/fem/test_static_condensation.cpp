@@ -0,0 +1,139 @@
+// Copyright (c) 2010-2020, Lawrence Livermore National Security, LLC. Produced
+// at the Lawrence Livermore National Laboratory. All Rights reserved. See files
+// LICENSE and NOTICE for details. LLNL-CODE-806117.
+//
+// This file is part of the MFEM library. For more information and source code
+// availability visit https://mfem.org.
+//
+// MFEM is free software; you can redistribute it and/or modify it under the
+// terms of the BSD-3 license. We welcome feedback and contributions, see file
+// CONTRIBUTING.md for details.
+
+#include "catch.hpp"
+#include "mfem.hpp"
+
+using namespace mfem;
+
+namespace static_condensation
+{
+
+void velocity(const Vector &x, Vector &v)
+{
+   v = 0.0;
+   v(0) = 1.0 + x(1);
+   v(1) = 0.5 - x(0);
+}
+
+// Compare the reduced systems and the recovered solutions of static
+// condensation (or hybridization, with 'hybrid') with the legacy full assembly
+// and with the element assembly. With 'convection', the private blocks are not
+// symmetric and they are factored with LU instead of Cholesky. The triangle
+// cases use orders with interior dofs.
+void test_reduction(const char *mesh_file, int ref, int order,
+                    bool convection, bool hybrid)
+{
+   Mesh mesh(mesh_file, 1, 1);
+   for (int l = 0; l < ref; l++) { mesh.UniformRefinement(); }
+   const int dim = mesh.Dimension();
+   H1_FECollection fec(order, dim);
+   FiniteElementSpace fespace(&mesh, &fec);
+   H1_Trace_FECollection hfec(order, dim);
+   FiniteElementSpace hfespace(&mesh, &hfec);
+
+   Array<int> ess_tdof_list;
+   Array<int> ess_bdr(mesh.bdr_attributes.Max());
+   ess_bdr = 1;
+   fespace.GetEssentialTrueDofs(ess_bdr, ess_tdof_list);
+
+   ConstantCoefficient one(1.0);
+   VectorFunctionCoefficient vel(dim, velocity);
+   LinearForm b(&fespace);
+   b.AddDomainIntegrator(new DomainLFIntegrator(one));
+   b.Assemble();
+
+   OperatorPtr A[2];
+   Vector X[2], B[2], x[2];
+   for (int k = 0; k < 2; k++)
+   {
+      BilinearForm a(&fespace);
+      if (k == 1) { a.SetAssemblyLevel(AssemblyLevel::ELEMENT); }
+      if (hybrid)
+      {
+         a.EnableHybridization(&hfespace, new TraceJumpIntegrator(),
+                               ess_tdof_list);
+      }
+      else
+      {
+         a.EnableStaticCondensation();
+         REQUIRE(a.StaticCondensationIsEnabled());
+      }
+      a.AddDomainIntegrator(new DiffusionIntegrator(one));
+      a.AddDomainIntegrator(new MassIntegrator(one));
+      if (convection)
+      {
+         a.AddDomainIntegrator(new ConvectionIntegrator(vel));
+      }
+      a.Assemble();
+      a.Finalize();
+
+      GridFunction u(&fespace);
+      u = 0.0;
+      Vector rhs(b);
+      a.FormLinearSystem(ess_tdof_list, u, rhs, A[k], X[k], B[k]);
+
+      // Recover a full solution from a fixed reduced one
+      Vector Xr(X[k].Size());
+      Xr.Randomize(1);
+      x[k].SetSize(fespace.GetVSize());
+      x[k] = 0.0;
+      a.RecoverFEMSolution(Xr, rhs, x[k]);
+      A[k].SetOperatorOwner(false);
+      A[k].Reset(new SparseMatrix(*A[k].As<SparseMatrix>()));
+   }
+
+   REQUIRE(A[1]->Height() == A[0]->Height());
+   Vector v(A[0]->Width()), y0(A[0]->Height()), y1(A[1]->Height());
+   v.Randomize(2);
+   A[0]->Mult(v, y0);
+   A[1]->Mult(v, y1);
+   y1 -= y0;
+   REQUIRE(y1.Normlinf() < 1e-10 * y0.Normlinf());
+
+   B[1] -= B[0];
+   REQUIRE(B[1].Normlinf() < 1e-10 * B[0].Normlinf());
+
+   x[1] -= x[0];
+   REQUIRE(x[1].Normlinf() < 1e-10 * x[0].Normlinf());
+}
+
+TEST_CASE("Batched static condensation",
+          "[StaticCondensation][ElementAssembly]")
+{
+   SECTION("Static condensation")
+   {
+      for (bool convection : { false, true })
+      {
+         for (int order : {2, 3})
+         {
+            test_reduction("../../data/inline-quad.mesh", 1, order,
+                           convection, false);
+            test_reduction("../../data/inline-hex.mesh", 0, order,
+                           convection, false);
+         }
+      }
+      // Element assembly of the convection term requires tensor elements
+      test_reduction("../../data/inline-tri.mesh", 0, 3, false, false);
+      test_reduction("../../data/inline-tri.mesh", 0, 4, false, false);
+   }
+
+   SECTION("Hybridization")
+   {
+      for (int order : {1, 2})
+      {
+         test_reduction("../../data/inline-quad.mesh", 1, order, false, true);
+         test_reduction("../../data/inline-hex.mesh", 0, order, false, true);
+      }
+   }
+}
+
+} // namespace static_condensation
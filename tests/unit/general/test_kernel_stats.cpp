@@ -0,0 +1,65 @@
+// Copyright (c) 2010-2020, Lawrence Livermore National Security, LLC. Produced
+// at the Lawrence Livermore National Laboratory. All Rights reserved. See files
+// LICENSE and NOTICE for details. LLNL-CODE-806117.
+//
+// This file is part of the MFEM library. For more information and source code
+// availability visit https://mfem.org.
+//
+// MFEM is free software; you can redistribute it and/or modify it under the
+// terms of the BSD-3 license. We welcome feedback and contributions, see file
+// CONTRIBUTING.md for details.
+
+#include "mfem.hpp"
+#include "catch.hpp"
+
+#include <sstream>
+
+using namespace mfem;
+
+TEST_CASE("KernelStats", "[KernelStats]")
+{
+   Mesh mesh(2, 2, Element::QUADRILATERAL, true);
+   H1_FECollection fec(1, 2);
+   FiniteElementSpace fes(&mesh, &fec);
+   // The default rule uses a specialized mass kernel, (D1D,Q1D) = (2,3) uses
+   // the generic one.
+   const IntegrationRule *irs[] =
+   { NULL, &IntRules.Get(Geometry::SQUARE, 4) };
+   for (int i = 0; i < 2; i++)
+   {
+      BilinearForm a(&fes);
+      a.SetAssemblyLevel(AssemblyLevel::PARTIAL);
+      a.AddDomainIntegrator(new MassIntegrator(irs[i]));
+      a.Assemble();
+      GridFunction x(&fes), y(&fes);
+      x = 1.0;
+
+      KernelStats::Enable(KernelStats::JSON);
+      a.Mult(x, y);
+      a.Mult(x, y);
+      KernelStats::Disable();
+      a.Mult(x, y);
+   }
+
+   std::ostringstream table, json;
+   KernelStats::SetPeaks(10.0, 100.0);
+   KernelStats::Print(table);
+   KernelStats::Report(json);
+   KernelStats::SetPeaks(0.0, 0.0);
+
+   // Each configuration is recorded twice, and the generic kernel is flagged.
+   const std::string js = json.str();
+   REQUIRE(js.find("\"kernel\": \"MassIntegrator::AddMultPA\", \"dim\": 2,"
+                   " \"D1D\": 2, \"Q1D\": 2, \"calls\": 2,"
+                   " \"fallback_calls\": 0") != std::string::npos);
+   REQUIRE(js.find("\"D1D\": 2, \"Q1D\": 3, \"calls\": 2,"
+                   " \"fallback_calls\": 2") != std::string::npos);
+   REQUIRE(table.str().find("MassIntegrator::AddMultPA *") !=
+           std::string::npos);
+   REQUIRE(table.str().find("roofline") != std::string::npos);
+
+   // The statistics are cleared by Report().
+   std::ostringstream empty;
+   KernelStats::Report(empty);
+   REQUIRE(empty.str().empty());
+}
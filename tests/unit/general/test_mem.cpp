@@ -111,4 +111,83 @@ TEST_CASE("MemoryManager", "[MemoryManager]")
    }
 }
 
+TEST_CASE("MemoryPool", "[MemoryManager]")
+{
+   // The memory manager may have been destroyed by a previous Device.
+   mm.Init();
+
+   const int N = 1000;
+   const MemoryPoolStats h_start = mm.GetPoolStats(MemoryType::HOST_POOL);
+
+   SECTION("Host")
+   {
+      Vector x, y;
+      x.SetSize(N, MemoryType::HOST_POOL);
+      REQUIRE(x.GetMemory().GetMemoryType() == MemoryType::HOST_POOL);
+      REQUIRE((uintptr_t)x.GetData() % 64 == 0);
+      x = 1.0;
+      x.Destroy();
+
+      // A block of the same size class is reused.
+      y.SetSize(N - 50, MemoryType::HOST_POOL);
+      y = 2.0;
+      REQUIRE(y*y == Approx(4.0*(N - 50)));
+
+      MemoryPoolStats stats = mm.GetPoolStats(MemoryType::HOST_POOL);
+      REQUIRE(stats.allocs - h_start.allocs == 2);
+      REQUIRE(stats.hits - h_start.hits == 1);
+      REQUIRE(stats.live_bytes - h_start.live_bytes >= N*sizeof(double)/2);
+      REQUIRE(stats.peak_bytes >= stats.live_bytes);
+
+      y.Destroy();
+      mm.ReleasePool(MemoryType::HOST_POOL);
+      stats = mm.GetPoolStats(MemoryType::HOST_POOL);
+      REQUIRE(stats.live_bytes == h_start.live_bytes);
+      REQUIRE(stats.pool_bytes == stats.live_bytes);
+   }
+
+   SECTION("Device")
+   {
+      const MemoryPoolStats d_start = mm.GetPoolStats(MemoryType::DEVICE_POOL);
+      Vector h_x(N), h_y(N);
+      h_x.Randomize(1);
+      for (int i = 0; i < 3; i++)
+      {
+         Memory<double> d_mem(N, MemoryType::DEVICE_POOL);
+         d_mem.Write(MemoryClass::DEVICE, N);
+         d_mem.CopyFromHost(h_x.GetData(), N);
+         d_mem.CopyToHost(h_y.GetData(), N);
+         d_mem.Delete();
+         h_y -= h_x;
+         REQUIRE(h_y.Normlinf() == 0.0);
+      }
+      const MemoryPoolStats stats = mm.GetPoolStats(MemoryType::DEVICE_POOL);
+      REQUIRE(stats.allocs - d_start.allocs == 3);
+      REQUIRE(stats.hits - d_start.hits == 2);
+      REQUIRE(stats.live_bytes == d_start.live_bytes);
+   }
+}
+
 #endif // _WIN32
+
+TEST_CASE("MemoryNuma", "[MemoryManager]")
+{
+   // The memory manager may have been destroyed by a previous Device.
+   mm.Init();
+
+   // Small sizes are 64-byte aligned, large ones are first touched page-wise.
+   for (int n : { 10, 1000, 1000000 })
+   {
+      Vector x(n, MemoryType::HOST_NUMA);
+      REQUIRE(x.GetMemory().GetMemoryType() == MemoryType::HOST_NUMA);
+      REQUIRE((uintptr_t)x.GetData() % 64 == 0);
+      REQUIRE(mm.IsKnown(x.GetData()));
+      x = 1.0;
+      Vector y(x);
+      y *= 2.0;
+      REQUIRE(x*y == Approx(2.0*n));
+      Vector z;
+      z.MakeRef(x, n/2, n - n/2);
+      REQUIRE(z.Sum() == Approx(n - n/2));
+   }
+}
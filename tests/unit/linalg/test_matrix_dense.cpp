@@ -293,3 +293,47 @@ TEST_CASE("DenseTensor LinearSolve methods",
       }
    }
 }
+
+TEST_CASE("DenseTensor Cholesky methods",
+          "[DenseMatrix]")
+{
+   const int N = 4, NE = 10;
+   const double tol = 1e-12;
+   DenseTensor A_batch(N,N,NE);
+   Vector X_batch(N*NE), B_batch(N*NE);
+   X_batch.Randomize(1);
+
+   // Symmetric, diagonally dominant matrices: B = A X
+   auto a_batch = mfem::Reshape(A_batch.HostWrite(),N,N,NE);
+   auto x_batch = mfem::Reshape(X_batch.HostRead(),N,NE);
+   auto b_batch = mfem::Reshape(B_batch.HostWrite(),N,NE);
+   for (int e=0; e<NE; ++e)
+   {
+      for (int c=0; c<N; ++c)
+      {
+         for (int r=0; r<N; ++r)
+         {
+            a_batch(r,c,e) = (r == c) ? N + e : 1.0/(1.0 + r + c + e);
+         }
+      }
+      for (int r=0; r<N; ++r)
+      {
+         b_batch(r,e) = 0.0;
+         for (int c=0; c<N; ++c)
+         {
+            b_batch(r,e) += a_batch(r,c,e)*x_batch(c,e);
+         }
+      }
+   }
+
+   REQUIRE(BatchCholeskyFactor(A_batch));
+   BatchCholeskySolve(A_batch, B_batch);
+   B_batch -= X_batch;
+   REQUIRE(B_batch.Normlinf() < tol);
+
+   // A matrix that is not positive definite is detected
+   DenseTensor C_batch(2,2,1);
+   C_batch(0)(0,0) = 1.0; C_batch(0)(0,1) = 2.0;
+   C_batch(0)(1,0) = 2.0; C_batch(0)(1,1) = 1.0;
+   REQUIRE(!BatchCholeskyFactor(C_batch));
+}
@@ -0,0 +1,151 @@
+// Copyright (c) 2010-2020, Lawrence Livermore National Security, LLC. Produced
+// at the Lawrence Livermore National Laboratory. All Rights reserved. See files
+// LICENSE and NOTICE for details. LLNL-CODE-806117.
+//
+// This file is part of the MFEM library. For more information and source code
+// availability visit https://mfem.org.
+//
+// MFEM is free software; you can redistribute it and/or modify it under the
+// terms of the BSD-3 license. We welcome feedback and contributions, see file
+// CONTRIBUTING.md for details.
+
+#include "mfem.hpp"
+using namespace mfem;
+
+#include "catch.hpp"
+
+namespace compact_elements
+{
+
+// Check that the compact array contains the same entities as the elements (or
+// the boundary elements if bdr is true) of the mesh.
+static void CheckSame(const CompactElementArray &c, const Mesh &mesh, bool bdr)
+{
+   const int n = bdr ? mesh.GetNBE() : mesh.GetNE();
+   REQUIRE(c.Size() == n);
+   Array<int> v;
+   for (int i = 0; i < n; i++)
+   {
+      const Element *el = bdr ? mesh.GetBdrElement(i) : mesh.GetElement(i);
+      CompactElementArray::View view = c[i];
+      REQUIRE(view.GetGeometryType() == el->GetGeometryType());
+      REQUIRE(view.GetAttribute() == el->GetAttribute());
+      REQUIRE(view.GetNVertices() == el->GetNVertices());
+      view.GetVertices(v);
+      for (int j = 0; j < v.Size(); j++)
+      {
+         REQUIRE(v[j] == el->GetVertices()[j]);
+      }
+   }
+}
+
+// Create a 2D mesh with one quadrilateral and two triangles.
+static Mesh *MakeMixedMesh()
+{
+   Mesh *mesh = new Mesh(2, 5, 3, 4);
+   const double vert[5][2] = { {0,0}, {1,0}, {1,1}, {0,1}, {2,0.5} };
+   for (int i = 0; i < 5; i++) { mesh->AddVertex(vert[i]); }
+   const int quad[4] = { 0, 1, 2, 3 };
+   const int tri[2][3] = { {1, 4, 2}, {2, 4, 3} };
+   const int seg[4][2] = { {0, 1}, {1, 4}, {4, 3}, {3, 0} };
+   mesh->AddQuad(quad, 1);
+   for (int i = 0; i < 2; i++) { mesh->AddTriangle(tri[i], 2+i); }
+   for (int i = 0; i < 4; i++) { mesh->AddBdrSegment(seg[i], 1+i/2); }
+   mesh->FinalizeMesh();
+   return mesh;
+}
+
+} // namespace compact_elements
+
+TEST_CASE("Compact element storage", "[Mesh]")
+{
+   using namespace compact_elements;
+
+   SECTION("Append")
+   {
+      CompactElementArray c;
+      REQUIRE(c.Size() == 0);
+      const int tri[3] = { 0, 1, 2 }, quad[4] = { 3, 4, 5, 6 };
+      c.Append(Geometry::TRIANGLE, tri, 7);
+      c.Append(Geometry::TRIANGLE, tri, 8);
+      REQUIRE(c.IsUniform());
+      REQUIRE(c.GetOffsets().Size() == 0);
+      c.Append(Geometry::SQUARE, quad, 9);
+      REQUIRE(!c.IsUniform());
+      REQUIRE(c.Size() == 3);
+      REQUIRE(c.GetIndices().Size() == 10);
+      REQUIRE(c.GetGeometryType(1) == Geometry::TRIANGLE);
+      REQUIRE(c.GetGeometryType(2) == Geometry::SQUARE);
+      REQUIRE(c.GetNVertices(1) == 3);
+      REQUIRE(c.GetNVertices(2) == 4);
+      REQUIRE(c.GetVertices(2)[3] == 6);
+      REQUIRE(c.GetAttribute(1) == 8);
+      c.SetAttribute(1, 5);
+      REQUIRE(c[1].GetAttribute() == 5);
+      c.Clear();
+      REQUIRE(c.Size() == 0);
+      REQUIRE(c.IsUniform());
+   }
+
+   SECTION("Uniform mesh")
+   {
+      Mesh mesh(2, 3, 2, Element::TETRAHEDRON);
+      CompactElementArray elems, bdr_elems, faces;
+      mesh.GetCompactElements(elems);
+      mesh.GetCompactBdrElements(bdr_elems);
+      mesh.GetCompactFaces(faces);
+      REQUIRE(elems.IsUniform());
+      CheckSame(elems, mesh, false);
+      CheckSame(bdr_elems, mesh, true);
+      REQUIRE(faces.Size() == mesh.GetNumFaces());
+
+      // The compact storage uses less memory than the Element objects.
+      long el_mem = 0;
+      for (int i = 0; i < mesh.GetNE(); i++)
+      {
+         el_mem += mesh.GetElement(i)->MemoryUsage() + sizeof(Element*);
+      }
+      REQUIRE(elems.MemoryUsage() < el_mem);
+      REQUIRE(mesh.MemoryUsage() > el_mem);
+   }
+
+   SECTION("Mixed mesh")
+   {
+      Mesh *mesh = MakeMixedMesh();
+      CompactElementArray elems, bdr_elems;
+      mesh->GetCompactElements(elems);
+      mesh->GetCompactBdrElements(bdr_elems);
+      REQUIRE(!elems.IsUniform());
+      REQUIRE(bdr_elems.IsUniform());
+      CheckSame(elems, *mesh, false);
+      CheckSame(bdr_elems, *mesh, true);
+      delete mesh;
+   }
+
+   SECTION("Mesh from compact storage")
+   {
+      Mesh *mesh = MakeMixedMesh();
+      mesh->UniformRefinement();
+      CompactElementArray elems, bdr_elems;
+      mesh->GetCompactElements(elems);
+      mesh->GetCompactBdrElements(bdr_elems);
+
+      Vector vert(3*mesh->GetNV());
+      vert = 0.0;
+      for (int i = 0; i < mesh->GetNV(); i++)
+      {
+         for (int d = 0; d < 2; d++) { vert(3*i+d) = mesh->GetVertex(i)[d]; }
+      }
+      Mesh copy(vert.GetData(), mesh->GetNV(), elems, bdr_elems, 2);
+      REQUIRE(copy.GetNE() == mesh->GetNE());
+      REQUIRE(copy.GetNBE() == mesh->GetNBE());
+      REQUIRE(copy.GetNEdges() == mesh->GetNEdges());
+      CheckSame(elems, copy, false);
+      for (int i = 0; i < mesh->GetNE(); i++)
+      {
+         REQUIRE(copy.GetElementVolume(i) ==
+                 Approx(mesh->GetElementVolume(i)));
+      }
+      delete mesh;
+   }
+}
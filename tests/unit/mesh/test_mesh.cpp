@@ -91,3 +91,141 @@ TEST_CASE("Gecko integration in MFEM", "[Mesh]")
       }
    }
 }
+
+TEST_CASE("Space-filling curve partitioning", "[Mesh]")
+{
+   const char *mesh_files[3] =
+   {
+      "../../data/star.mesh", "../../data/beam-tet.mesh",
+      "../../data/fichera.mesh"
+   };
+   const int nparts[3] = { 3, 7, 16 };
+   for (int f = 0; f < 3; f++)
+   {
+      Mesh mesh(mesh_files[f], 1, 1);
+      mesh.UniformRefinement();
+      mesh.UniformRefinement();
+      const int ne = mesh.GetNE();
+      Array<double> weights(ne);
+      for (int i = 0; i < ne; i++) { weights[i] = 1 + i % 3; }
+
+      for (int k = 0; k < 3; k++)
+      {
+         const int np = nparts[k];
+         for (int hilbert = 0; hilbert <= 1; hilbert++)
+         {
+            // Without the connectivity cleanup, the parts are consecutive
+            // along the curve and each part weight is within the largest
+            // element weight from the average.
+            int *part = mesh.GenerateSFCPartitioning(np, weights, hilbert,
+                                                     false);
+            Array<double> part_weight(np);
+            part_weight = 0.0;
+            for (int i = 0; i < ne; i++)
+            {
+               REQUIRE((0 <= part[i] && part[i] < np));
+               part_weight[part[i]] += weights[i];
+            }
+            REQUIRE(part_weight.Min() > 0.0);
+            REQUIRE(part_weight.Max() - part_weight.Min() <= 2*3.0);
+
+            int edge_cut, disconnected;
+            double imbalance;
+            mesh.GetPartitioningStats(part, np, edge_cut, imbalance,
+                                      disconnected, weights);
+            REQUIRE(imbalance == Approx(part_weight.Max()*np/
+                                        weights.Sum()));
+            REQUIRE(edge_cut > 0);
+            delete [] part;
+
+            // With the cleanup, no part is empty and the imbalance is
+            // bounded.
+            part = mesh.GenerateSFCPartitioning(np, NULL, hilbert);
+            mesh.GetPartitioningStats(part, np, edge_cut, imbalance,
+                                      disconnected);
+            Array<int> part_size(np);
+            part_size = 0;
+            for (int i = 0; i < ne; i++) { part_size[part[i]]++; }
+            REQUIRE(part_size.Min() > 0);
+            REQUIRE(imbalance < 1.5);
+            delete [] part;
+         }
+
+         // part_method 6 is the Hilbert partitioning with unit weights
+         int *part = mesh.GeneratePartitioning(np, 6);
+         int *sfc_part = mesh.GenerateSFCPartitioning(np);
+         bool same = true;
+         for (int i = 0; i < ne; i++) { same &= (part[i] == sfc_part[i]); }
+         REQUIRE(same);
+         delete [] part;
+         delete [] sfc_part;
+      }
+   }
+}
+
+#ifdef MFEM_USE_MPI
+
+TEST_CASE("Weighted rebalancing of nonconforming meshes", "[Mesh][Parallel]")
+{
+   Mesh mesh("../../data/star.mesh", 1, 1);
+   mesh.EnsureNCMesh();
+   mesh.UniformRefinement();
+   mesh.UniformRefinement();
+
+   ParMesh pmesh(MPI_COMM_WORLD, mesh);
+   const long global_ne = pmesh.ReduceInt(pmesh.GetNE());
+
+   // Elements on the right are five times as expensive as the others.
+   auto get_weights = [&pmesh](Array<double> &weights)
+   {
+      Vector center;
+      weights.SetSize(pmesh.GetNE());
+      for (int i = 0; i < pmesh.GetNE(); i++)
+      {
+         pmesh.GetElementCenter(i, center);
+         weights[i] = (center(0) > 0.0) ? 5.0 : 1.0;
+      }
+   };
+
+   H1_FECollection fec(2, pmesh.Dimension());
+   ParFiniteElementSpace fes(&pmesh, &fec);
+   ParGridFunction x(&fes);
+   FunctionCoefficient coeff([](const Vector &p) { return p(0) - 2*p(1); });
+   x.ProjectCoefficient(coeff);
+
+   Array<double> weights;
+   get_weights(weights);
+   const double imbalance = pmesh.pncmesh->GetLoadImbalance(&weights);
+
+   // Never rebalance if the threshold is not exceeded.
+   REQUIRE_FALSE(pmesh.Rebalance(weights, imbalance));
+
+   REQUIRE(pmesh.Rebalance(weights, 0.0));
+   fes.Update();
+   x.Update();
+   REQUIRE(pmesh.ReduceInt(pmesh.GetNE()) == global_ne);
+   REQUIRE(x.ComputeL2Error(coeff) < 1e-12);
+
+   // The imbalance is at most one element away from the optimum.
+   get_weights(weights);
+   double total_weight = 0.0, local_weight = weights.Sum();
+   MPI_Allreduce(&local_weight, &total_weight, 1, MPI_DOUBLE, MPI_SUM,
+                 MPI_COMM_WORLD);
+   const int num_procs = pmesh.GetNRanks();
+   REQUIRE(pmesh.pncmesh->GetLoadImbalance(&weights) <=
+           1.0 + 5.0*num_procs/total_weight + 1e-12);
+
+   // The statistics count the elements that changed owner.
+   const ParNCMesh::RebalanceStats &stats = pmesh.pncmesh->GetRebalanceStats();
+   const Array<int> &old_index = pmesh.pncmesh->GetRebalanceOldIndex();
+   int received = 0;
+   for (int i = 0; i < old_index.Size(); i++)
+   {
+      received += (old_index[i] < 0);
+   }
+   REQUIRE(pmesh.ReduceInt(received) == pmesh.ReduceInt(stats.elements));
+   REQUIRE((stats.elements == 0 || stats.dofs > 0));
+   REQUIRE((stats.dofs == 0 || stats.dof_bytes > 0));
+}
+
+#endif // MFEM_USE_MPI
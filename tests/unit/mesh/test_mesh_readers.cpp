@@ -0,0 +1,413 @@
+// Copyright (c) 2010-2020, Lawrence Livermore National Security, LLC. Produced
+// at the Lawrence Livermore National Laboratory. All Rights reserved. See files
+// LICENSE and NOTICE for details. LLNL-CODE-806117.
+//
+// This file is part of the MFEM library. For more information and source code
+// availability visit https://mfem.org.
+//
+// MFEM is free software; you can redistribute it and/or modify it under the
+// terms of the BSD-3 license. We welcome feedback and contributions, see file
+// CONTRIBUTING.md for details.
+
+#include "mfem.hpp"
+#include "general/binaryio.hpp"
+using namespace mfem;
+
+#include "catch.hpp"
+
+#include <cstdint>
+#include <sstream>
+
+namespace mesh_readers
+{
+
+// Unit square split into two triangles, with four boundary segments and a
+// point element. The node tags are not contiguous.
+const int node_tags[4] = { 1, 2, 3, 5000 };
+const double node_coords[4][3] = { {0,0,0}, {1,0,0}, {1,1,0}, {0,1,0} };
+const int tri_nodes[2][3] = { {1, 2, 3}, {1, 3, 5000} };
+const int seg_nodes[4][2] = { {1, 2}, {2, 3}, {3, 5000}, {5000, 1} };
+
+// Writer of the values of a Gmsh file, in ASCII or binary format.
+struct GmshWriter
+{
+   bool binary;
+   std::ostringstream out;
+
+   template <typename T> void Bin(T val)
+   { out.write(reinterpret_cast<const char*>(&val), sizeof(T)); }
+
+   void Int(int val)
+   { if (binary) { Bin<int32_t>(val); } else { out << val << '\n'; } }
+   void Size(long long val)
+   { if (binary) { Bin<uint64_t>(val); } else { out << val << '\n'; } }
+   void Double(double val)
+   { if (binary) { Bin(val); } else { out << val << '\n'; } }
+
+   void Header(const char *version)
+   {
+      out << "$MeshFormat\n" << version << ' ' << binary << " 8\n";
+      if (binary) { Bin<int32_t>(1); out << '\n'; }
+      out << "$EndMeshFormat\n";
+      // a section unknown to the reader
+      out << "$PhysicalNames\n2\n1 3 \"boundary\"\n2 7 \"domain\"\n"
+          << "$EndPhysicalNames\n";
+   }
+};
+
+std::string WriteGmsh22(bool binary)
+{
+   GmshWriter w;
+   w.binary = binary;
+   w.Header("2.2");
+   w.out << "$Nodes\n4\n";
+   for (int i = 0; i < 4; i++)
+   {
+      w.Int(node_tags[i]);
+      for (int d = 0; d < 3; d++) { w.Double(node_coords[i][d]); }
+   }
+   w.out << "\n$EndNodes\n$Elements\n7\n";
+   int tag = 1;
+   // element: tag, type, number of tags, tags, nodes; in binary files the
+   // elements of the same type are preceded by a header, without the type
+   // and the number of tags
+   if (binary) { w.Int(15); w.Int(1); w.Int(2); }
+   w.Int(tag++);
+   if (!binary) { w.Int(15); w.Int(2); }
+   w.Int(1); w.Int(1); w.Int(1);
+   if (binary) { w.Int(1); w.Int(4); w.Int(2); }
+   for (int i = 0; i < 4; i++)
+   {
+      w.Int(tag++);
+      if (!binary) { w.Int(1); w.Int(2); }
+      w.Int(3); w.Int(i+1);
+      w.Int(seg_nodes[i][0]); w.Int(seg_nodes[i][1]);
+   }
+   if (binary) { w.Int(2); w.Int(2); w.Int(2); }
+   for (int i = 0; i < 2; i++)
+   {
+      w.Int(tag++);
+      if (!binary) { w.Int(2); w.Int(2); }
+      w.Int(7); w.Int(1);
+      for (int j = 0; j < 3; j++) { w.Int(tri_nodes[i][j]); }
+   }
+   w.out << "\n$EndElements\n";
+   return w.out.str();
+}
+
+std::string WriteGmsh41(bool binary)
+{
+   GmshWriter w;
+   w.binary = binary;
+   w.Header("4.1");
+
+   // one point, one curve and one surface; the point has no physical tag
+   w.out << "$Entities\n";
+   w.Size(1); w.Size(1); w.Size(1); w.Size(0);
+   w.Int(1);
+   for (int d = 0; d < 3; d++) { w.Double(0.0); }
+   w.Size(0);
+   for (int e = 0; e < 2; e++)
+   {
+      w.Int(1);
+      for (int d = 0; d < 6; d++) { w.Double(d < 3 ? 0.0 : 1.0); }
+      w.Size(1); w.Int(e == 0 ? 3 : 7);
+      w.Size(0);
+   }
+   w.out << "\n$EndEntities\n";
+
+   // one block of nodes on the surface, with parametric coordinates
+   w.out << "$Nodes\n";
+   w.Size(1); w.Size(4); w.Size(1); w.Size(5000);
+   w.Int(2); w.Int(1); w.Int(1); w.Size(4);
+   for (int i = 0; i < 4; i++) { w.Size(node_tags[i]); }
+   for (int i = 0; i < 4; i++)
+   {
+      for (int d = 0; d < 3; d++) { w.Double(node_coords[i][d]); }
+      w.Double(-1.0); w.Double(-2.0);
+   }
+   w.out << "\n$EndNodes\n";
+
+   w.out << "$Elements\n";
+   w.Size(3); w.Size(7); w.Size(1); w.Size(7);
+   int tag = 1;
+   w.Int(0); w.Int(1); w.Int(15); w.Size(1);
+   w.Size(tag++); w.Size(1);
+   w.Int(1); w.Int(1); w.Int(1); w.Size(4);
+   for (int i = 0; i < 4; i++)
+   {
+      w.Size(tag++); w.Size(seg_nodes[i][0]); w.Size(seg_nodes[i][1]);
+   }
+   w.Int(2); w.Int(1); w.Int(2); w.Size(2);
+   for (int i = 0; i < 2; i++)
+   {
+      w.Size(tag++);
+      for (int j = 0; j < 3; j++) { w.Size(tri_nodes[i][j]); }
+   }
+   w.out << "\n$EndElements\n";
+   return w.out.str();
+}
+
+void CheckSquareMesh(Mesh &mesh)
+{
+   REQUIRE(mesh.Dimension() == 2);
+   REQUIRE(mesh.GetNV() == 4);
+   REQUIRE(mesh.GetNE() == 2);
+   REQUIRE(mesh.GetNBE() == 4);
+   for (int i = 0; i < 2; i++)
+   {
+      REQUIRE(mesh.GetAttribute(i) == 7);
+      const int *v = mesh.GetElement(i)->GetVertices();
+      for (int j = 0; j < 3; j++)
+      {
+         const int n = (tri_nodes[i][j] == 5000) ? 3 : tri_nodes[i][j] - 1;
+         for (int d = 0; d < 2; d++)
+         {
+            REQUIRE(mesh.GetVertex(v[j])[d] == node_coords[n][d]);
+         }
+      }
+   }
+   for (int i = 0; i < 4; i++)
+   {
+      REQUIRE(mesh.GetBdrAttribute(i) == 3);
+   }
+}
+
+// Check that the meshes have the same elements, up to the numbering of the
+// vertices, with coordinates equal up to the relative tolerance tol.
+void CheckSameElements(Mesh &a, Mesh &b, double tol)
+{
+   REQUIRE(a.GetNE() == b.GetNE());
+   REQUIRE(a.GetNV() == b.GetNV());
+   for (int i = 0; i < a.GetNE(); i++)
+   {
+      REQUIRE(a.GetAttribute(i) == b.GetAttribute(i));
+      REQUIRE(a.GetElementBaseGeometry(i) == b.GetElementBaseGeometry(i));
+      const Element *ea = a.GetElement(i), *eb = b.GetElement(i);
+      for (int j = 0; j < ea->GetNVertices(); j++)
+      {
+         const double *xa = a.GetVertex(ea->GetVertices()[j]);
+         const double *xb = b.GetVertex(eb->GetVertices()[j]);
+         for (int d = 0; d < a.SpaceDimension(); d++)
+         {
+            REQUIRE(std::abs(xa[d] - xb[d]) <= tol*(1.0 + std::abs(xa[d])));
+         }
+      }
+   }
+}
+
+// Write the mesh in VTU format and read it back. The meshes are not refined,
+// so that the order of the element vertices is preserved.
+void TestVTU(const char *mesh_file, VTKFormat format, int compression_level)
+{
+   Mesh mesh(mesh_file, 1, 0, false);
+   mesh.PrintVTU("mesh_readers_test", format, false, compression_level);
+   Mesh vtu_mesh("mesh_readers_test.vtu", 1, 0, false);
+   CheckSameElements(mesh, vtu_mesh,
+                     (format == VTKFormat::ASCII) ? 1e-5 : 0.0);
+   remove("mesh_readers_test.vtu");
+}
+
+template <typename T>
+void AppendValues(std::vector<char> &buf, const T *vals, int n)
+{
+   for (int i = 0; i < n; i++) { bin_io::AppendBytes(buf, vals[i]); }
+}
+
+// VTU file of a quadrilateral and a triangle with appended data, raw or base
+// 64 encoded, with UInt64 headers and various data types.
+std::string WriteAppendedVTU(bool base64)
+{
+   const float points[15] = { 0,0,0, 1,0,0, 1,1,0, 0,1,0, 2,0,0 };
+   const int64_t connectivity[7] = { 0, 1, 2, 3, 1, 4, 2 };
+   const int64_t offsets[2] = { 4, 7 };
+   const uint8_t types[2] = { 9, 5 };
+   const int32_t material[2] = { 3, 5 };
+
+   std::vector<char> arrays[5];
+   AppendValues(arrays[0], points, 15);
+   AppendValues(arrays[1], connectivity, 7);
+   AppendValues(arrays[2], offsets, 2);
+   AppendValues(arrays[3], types, 2);
+   AppendValues(arrays[4], material, 2);
+
+   // every array is preceded by its size in bytes
+   std::ostringstream data;
+   size_t offset[5];
+   for (int k = 0; k < 5; k++)
+   {
+      offset[k] = data.str().size();
+      const uint64_t nbytes = arrays[k].size();
+      if (base64)
+      {
+         bin_io::WriteBase64(data, &nbytes, sizeof(nbytes));
+         bin_io::WriteBase64(data, arrays[k].data(), nbytes);
+      }
+      else
+      {
+         data.write(reinterpret_cast<const char*>(&nbytes), sizeof(nbytes));
+         data.write(arrays[k].data(), nbytes);
+      }
+   }
+
+   const char *names[5] = { "", "connectivity", "offsets", "types",
+                            "material"
+                          };
+   const char *vtk_types[5] = { "Float32", "Int64", "Int64", "UInt8", "Int32" };
+   std::ostringstream out;
+   out << "<?xml version=\"1.0\"?>\n"
+       << "<VTKFile type=\"UnstructuredGrid\" version=\"1.0\" byte_order=\""
+       << VTKByteOrder() << "\" header_type=\"UInt64\">\n"
+       << "<!-- comment with <tags> -->\n"
+       << "<UnstructuredGrid>\n<Piece NumberOfPoints=\"5\" "
+       << "NumberOfCells=\"2\">\n";
+   for (int k = 0; k < 5; k++)
+   {
+      if (k == 0) { out << "<Points>\n"; }
+      if (k == 1) { out << "</Points>\n<Cells>\n"; }
+      if (k == 4) { out << "</Cells>\n<CellData Scalars='material'>\n"; }
+      out << "<DataArray type=\"" << vtk_types[k] << "\" Name=\"" << names[k]
+          << "\" NumberOfComponents=\"" << (k == 0 ? 3 : 1)
+          << "\" format=\"appended\" offset=\"" << offset[k] << "\"/>\n";
+   }
+   out << "</CellData>\n</Piece>\n</UnstructuredGrid>\n"
+       << "<AppendedData encoding=\"" << (base64 ? "base64" : "raw")
+       << "\">\n_" << data.str() << "\n</AppendedData>\n</VTKFile>\n";
+   return out.str();
+}
+
+} // namespace mesh_readers
+
+TEST_CASE("Gmsh mesh reader", "[Mesh]")
+{
+   using namespace mesh_readers;
+
+   SECTION("MSH 2.2")
+   {
+      for (int binary = 0; binary <= 1; binary++)
+      {
+         std::istringstream input(WriteGmsh22(binary));
+         Mesh mesh(input, 1, 0);
+         CheckSquareMesh(mesh);
+      }
+   }
+
+   SECTION("MSH 4.1")
+   {
+      for (int binary = 0; binary <= 1; binary++)
+      {
+         std::istringstream input(WriteGmsh41(binary));
+         Mesh mesh(input, 1, 0);
+         CheckSquareMesh(mesh);
+      }
+   }
+
+   SECTION("Periodic meshes")
+   {
+      Mesh mesh("../../data/periodic-annulus-sector.msh", 1, 1);
+      REQUIRE(mesh.Dimension() == 2);
+      REQUIRE(mesh.GetNodes() != NULL);
+      REQUIRE(mesh.GetNE() > 0);
+      Mesh mesh3d("../../data/periodic-torus-sector.msh", 1, 1);
+      REQUIRE(mesh3d.Dimension() == 3);
+      REQUIRE(mesh3d.GetNodes() != NULL);
+   }
+}
+
+TEST_CASE("VTK mesh readers", "[Mesh]")
+{
+   using namespace mesh_readers;
+
+   SECTION("Legacy VTK")
+   {
+      Mesh mesh("../../data/star.mesh", 1, 1);
+      Mesh vtk_mesh("../../data/star.vtk", 1, 1);
+      REQUIRE(vtk_mesh.GetNE() == mesh.GetNE());
+      REQUIRE(vtk_mesh.GetNV() == mesh.GetNV());
+      Mesh q2_mesh("../../data/fichera-mixed-p2.vtk", 1, 1);
+      REQUIRE(q2_mesh.GetNodes() != NULL);
+   }
+
+   SECTION("VTU output of PrintVTU")
+   {
+      const char *mesh_files[3] =
+      {
+         "../../data/star-mixed.mesh", "../../data/fichera.mesh",
+         "../../data/beam-tet.mesh"
+      };
+      for (int i = 0; i < 3; i++)
+      {
+         TestVTU(mesh_files[i], VTKFormat::ASCII, 0);
+         TestVTU(mesh_files[i], VTKFormat::BINARY, 0);
+#ifdef MFEM_USE_ZLIB
+         TestVTU(mesh_files[i], VTKFormat::BINARY, 6);
+#endif
+      }
+   }
+
+   SECTION("VTU appended data")
+   {
+      for (int base64 = 0; base64 <= 1; base64++)
+      {
+         std::istringstream input(WriteAppendedVTU(base64));
+         Mesh mesh(input, 1, 0, false);
+         REQUIRE(mesh.Dimension() == 2);
+         REQUIRE(mesh.GetNE() == 2);
+         REQUIRE(mesh.GetNV() == 5);
+         REQUIRE(mesh.GetElementBaseGeometry(0) == Geometry::SQUARE);
+         REQUIRE(mesh.GetElementBaseGeometry(1) == Geometry::TRIANGLE);
+         REQUIRE(mesh.GetAttribute(0) == 3);
+         REQUIRE(mesh.GetAttribute(1) == 5);
+         REQUIRE(mesh.GetVertex(4)[0] == 2.0);
+         REQUIRE(mesh.GetElement(1)->GetVertices()[2] == 2);
+      }
+   }
+}
+
+#ifdef MFEM_USE_MPI
+
+TEST_CASE("Distributed reader of serial meshes", "[Mesh][Parallel]")
+{
+   const char *mesh_files[5] =
+   {
+      "../../data/star.mesh", "../../data/square-disc.mesh",
+      "../../data/beam-tet.mesh", "../../data/fichera.mesh",
+      "../../data/beam-wedge.mesh"
+   };
+   for (int i = 0; i < 5; i++)
+   {
+      Mesh mesh(mesh_files[i], 1, 1);
+      H1_FECollection fec(3, mesh.Dimension());
+      FiniteElementSpace fes(&mesh, &fec);
+      double volume = 0.0;
+      for (int e = 0; e < mesh.GetNE(); e++)
+      {
+         volume += mesh.GetElementVolume(e);
+      }
+
+      for (int sfc = 0; sfc <= 1; sfc++)
+      {
+         ParMesh pmesh(MPI_COMM_WORLD, mesh_files[i], true, true, sfc);
+         REQUIRE(pmesh.Dimension() == mesh.Dimension());
+         REQUIRE(pmesh.ReduceInt(pmesh.GetNE()) == mesh.GetNE());
+         REQUIRE(pmesh.ReduceInt(pmesh.GetNBE()) == mesh.GetNBE());
+         REQUIRE(pmesh.bdr_attributes.Size() == mesh.bdr_attributes.Size());
+
+         double loc_volume = 0.0, glob_volume;
+         for (int e = 0; e < pmesh.GetNE(); e++)
+         {
+            loc_volume += pmesh.GetElementVolume(e);
+         }
+         MPI_Allreduce(&loc_volume, &glob_volume, 1, MPI_DOUBLE, MPI_SUM,
+                       MPI_COMM_WORLD);
+         REQUIRE(glob_volume == Approx(volume));
+
+         // the shared entities are matched if the global number of true dofs
+         // is the same as in serial
+         ParFiniteElementSpace pfes(&pmesh, &fec);
+         REQUIRE(pfes.GlobalTrueVSize() == fes.GetVSize());
+      }
+   }
+}
+
+#endif // MFEM_USE_MPI
@@ -0,0 +1,162 @@
+// Copyright (c) 2010-2020, Lawrence Livermore National Security, LLC. Produced
+// at the Lawrence Livermore National Laboratory. All Rights reserved. See files
+// LICENSE and NOTICE for details. LLNL-CODE-806117.
+//
+// This file is part of the MFEM library. For more information and source code
+// availability visit https://mfem.org.
+//
+// MFEM is free software; you can redistribute it and/or modify it under the
+// terms of the BSD-3 license. We welcome feedback and contributions, see file
+// CONTRIBUTING.md for details.
+
+#include "mfem.hpp"
+using namespace mfem;
+
+#include "catch.hpp"
+
+namespace topology
+{
+
+static void CheckSameTable(const Table &a, const Table &b)
+{
+   REQUIRE(a.Size() == b.Size());
+   REQUIRE(a.Size_of_connections() == b.Size_of_connections());
+   for (int i = 0; i <= a.Size(); i++)
+   {
+      REQUIRE(a.GetI()[i] == b.GetI()[i]);
+   }
+   for (int k = 0; k < a.Size_of_connections(); k++)
+   {
+      REQUIRE(a.GetJ()[k] == b.GetJ()[k]);
+   }
+}
+
+// Check that the meshes a and b have the same edges, faces and face info.
+static void CheckSameTopology(Mesh &a, Mesh &b)
+{
+   const int dim = a.Dimension();
+   REQUIRE(a.GetNEdges() == b.GetNEdges());
+   REQUIRE(a.GetNFaces() == b.GetNFaces());
+   REQUIRE(a.GetNumFaces() == b.GetNumFaces());
+   CheckSameTable(a.ElementToEdgeTable(), b.ElementToEdgeTable());
+   if (dim == 3)
+   {
+      CheckSameTable(a.ElementToFaceTable(), b.ElementToFaceTable());
+   }
+
+   Array<int> va, vb, oa, ob;
+   for (int f = 0; f < a.GetNumFaces(); f++)
+   {
+      int e1a, e2a, e1b, e2b, i1a, i2a, i1b, i2b;
+      a.GetFaceElements(f, &e1a, &e2a);
+      b.GetFaceElements(f, &e1b, &e2b);
+      a.GetFaceInfos(f, &i1a, &i2a);
+      b.GetFaceInfos(f, &i1b, &i2b);
+      REQUIRE(e1a == e1b);
+      REQUIRE(e2a == e2b);
+      REQUIRE(i1a == i1b);
+      REQUIRE(i2a == i2b);
+      a.GetFaceVertices(f, va);
+      b.GetFaceVertices(f, vb);
+      REQUIRE(va.Size() == vb.Size());
+      for (int j = 0; j < va.Size(); j++) { REQUIRE(va[j] == vb[j]); }
+   }
+
+   for (int i = 0; i < a.GetNBE(); i++)
+   {
+      REQUIRE(a.GetBdrElementEdgeIndex(i) == b.GetBdrElementEdgeIndex(i));
+      if (dim == 3)
+      {
+         a.GetBdrElementEdges(i, va, oa);
+         b.GetBdrElementEdges(i, vb, ob);
+         REQUIRE(va.Size() == vb.Size());
+         for (int j = 0; j < va.Size(); j++)
+         {
+            REQUIRE(va[j] == vb[j]);
+            REQUIRE(oa[j] == ob[j]);
+         }
+      }
+   }
+}
+
+// Build the mesh with the hash tables and with the sort-based topology
+// construction, refine both, and compare the topology.
+template <typename MakeMesh>
+static void CompareTopology(MakeMesh make_mesh)
+{
+   const bool sorted_topology = Mesh::sorted_topology;
+
+   Mesh::sorted_topology = false;
+   Mesh *a = make_mesh();
+   Mesh::sorted_topology = true;
+   Mesh *b = make_mesh();
+   CheckSameTopology(*a, *b);
+
+   Mesh::sorted_topology = false;
+   a->UniformRefinement();
+   Mesh::sorted_topology = true;
+   b->UniformRefinement();
+   CheckSameTopology(*a, *b);
+
+   Mesh::sorted_topology = sorted_topology;
+   delete a;
+   delete b;
+}
+
+} // namespace topology
+
+TEST_CASE("TupleTable", "[Mesh]")
+{
+   // tuples with duplicates, numbered in the order of first occurrence
+   const int tuples[] = { 4, 1,  2, 7,  4, 1,  0, 3,  2, 7,  4, 2 };
+   TupleTable tbl(tuples, 6, 2, 8);
+   REQUIRE(tbl.NumberOfEntries() == 4);
+   const int num[] = { 0, 1, 0, 2, 1, 3 };
+   for (int i = 0; i < 6; i++) { REQUIRE(tbl.GetNumbers()[i] == num[i]); }
+
+   const int t1[2] = { 2, 7 }, t2[2] = { 2, 6 };
+   REQUIRE(tbl.Index(t1) == 1);
+   REQUIRE(tbl.Index(t2) == -1);
+
+   // groups sorted by tuple, positions in increasing order
+   REQUIRE(tbl.GetGroupTuple(0)[0] == 0);
+   REQUIRE(tbl.GetGroupSize(1) == 2);
+   REQUIRE(tbl.GetGroup(1)[0] == 1);
+   REQUIRE(tbl.GetGroup(1)[1] == 4);
+   REQUIRE(tbl.GetGroupNumber(1) == 1);
+
+   // triples, with equal first entries
+   const int tri[] = { 5, 9, 7,  3, 8, 4,  5, 9, 7,  5, 2, 9,  3, 8, 4 };
+   TupleTable tri_tbl(tri, 5, 3, 10);
+   REQUIRE(tri_tbl.NumberOfEntries() == 3);
+   REQUIRE(tri_tbl.GetNumbers()[2] == 0);
+   REQUIRE(tri_tbl.GetNumbers()[4] == 1);
+   REQUIRE(tri_tbl.GetGroupTuple(0)[0] == 3);
+   REQUIRE(tri_tbl.GetGroupTuple(1)[1] == 2);
+   REQUIRE(tri_tbl.GetGroupNumber(1) == 2);
+   REQUIRE(tri_tbl.Index(tri + 9) == 2);
+}
+
+TEST_CASE("Sorted mesh topology", "[Mesh]")
+{
+   using namespace topology;
+
+   SECTION("2D meshes")
+   {
+      CompareTopology([]() { return new Mesh(4, 3, Element::QUADRILATERAL); });
+      CompareTopology([]() { return new Mesh(3, 5, Element::TRIANGLE); });
+      CompareTopology([]()
+      { return new Mesh("../../data/star-mixed.mesh", 1, 1); });
+   }
+
+   SECTION("3D meshes")
+   {
+      CompareTopology([]()
+      { return new Mesh(3, 2, 4, Element::HEXAHEDRON); });
+      CompareTopology([]()
+      { return new Mesh(2, 3, 2, Element::TETRAHEDRON); });
+      CompareTopology([]() { return new Mesh(2, 2, 3, Element::WEDGE); });
+      CompareTopology([]()
+      { return new Mesh("../../data/fichera-mixed.mesh", 1, 1); });
+   }
+}